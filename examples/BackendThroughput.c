@@ -0,0 +1,156 @@
+/*
+ *  Compare the storage backends on loading and saving the same file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME     "BackendThroughput.ini"
+#define NUMBACKENDS  4
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void report( const char *backend, const char *what, int count, double seconds, size_t length )
+{
+    ANY_LOG( 0, "%-8s %-6s %6d times in %8.3f s = %8.3f ms, %8.1f MB/s",
+             ANY_LOG_INFO, backend, what, count, seconds, seconds * 1e3 / count,
+             (double)length * count / seconds / 1e6 );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int numSections = ( argc > 1 ) ? atoi( argv[1] ) : 20000;
+    int numRounds = ( argc > 2 ) ? atoi( argv[2] ) : 50;
+    IniConfigMemoryBackend *memory = IniConfigMemoryBackend_new();
+    const IniConfigBackend *backends[NUMBACKENDS];
+    IniConfigDocument document;
+    IniConfigFile *ini = NULL;
+    char *contents = NULL;
+    size_t length = 0;
+    size_t size = 0;
+    double start = 0.0;
+    FILE *fp = NULL;
+    int i = 0;
+    int j = 0;
+
+    if( memory == NULL || !IniConfigMemoryBackend_init( memory ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    size = (size_t)numSections * 80 + 64;
+    contents = (char *)ANY_BALLOC( size );
+
+    if( contents == NULL )
+    {
+        return EXIT_FAILURE;
+    }
+
+    for( i = 0; i < numSections; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length,
+                                "[Joint%d]\nangle = %d ; degrees\nspeed=%d.5\nname=\"joint %d\"\n", i, i, i, i );
+    }
+
+    fp = fopen( FILENAME, "wb" );
+
+    if( fp == NULL )
+    {
+        return EXIT_FAILURE;
+    }
+
+    fwrite( contents, 1, length, fp );
+    fclose( fp );
+
+    IniConfigMemoryBackend_putFile( memory, FILENAME, contents, length );
+
+    backends[0] = IniConfigBackend_getPosix();
+    backends[1] = IniConfigBackend_getStdio();
+    backends[2] = IniConfigBackend_getMmap();
+    backends[3] = IniConfigMemoryBackend_getBackend( memory );
+
+    ANY_LOG( 0, "%d sections, %lu bytes", ANY_LOG_INFO, numSections, (unsigned long)length );
+
+    /* the same workload for every backend: loads, then a put and a save each */
+    for( i = 0; i < NUMBACKENDS; i++ )
+    {
+        /* documents are loaded, a file would add the same store rebuild for every backend */
+        IniConfigDocument_init( &document );
+        IniConfigDocument_setBackend( &document, backends[i] );
+
+        start = now();
+
+        for( j = 0; j < numRounds; j++ )
+        {
+            if( !IniConfigDocument_load( &document, FILENAME ) )
+            {
+                ANY_LOG( 0, "%s: load failed", ANY_LOG_ERROR, backends[i]->name );
+                break;
+            }
+        }
+
+        report( backends[i]->name, "load", numRounds, now() - start, length );
+
+        IniConfigDocument_clear( &document );
+
+        ini = IniConfigFile_new();
+        IniConfigFile_initWithBackend( ini, FILENAME, backends[i] );
+        IniConfigFile_load( ini );
+
+        start = now();
+
+        for( j = 0; j < numRounds; j++ )
+        {
+            IniConfigFile_putInt( ini, "Joint7", "angle", j );
+
+            if( !IniConfigFile_save( ini ) )
+            {
+                ANY_LOG( 0, "%s: save failed", ANY_LOG_ERROR, backends[i]->name );
+                break;
+            }
+        }
+
+        report( backends[i]->name, "save", numRounds, now() - start, length );
+
+        IniConfigFile_clear( ini );
+        IniConfigFile_delete( ini );
+    }
+
+    remove( FILENAME );
+    ANY_FREE( contents );
+
+    IniConfigMemoryBackend_clear( memory );
+    IniConfigMemoryBackend_delete( memory );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
@@ -0,0 +1,179 @@
+/*
+ *  Compare batch lookups with a loop of single gets on a large file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "BatchThroughput.ini"
+#define NUMSECTIONS   256
+#define BATCHSIZE     256
+#define NAMESIZE      32
+
+
+static long long now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static bool writeFile( int numKeys )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    for( i = 0; i < numKeys; i++ )
+    {
+        if( i % ( numKeys / NUMSECTIONS ) == 0 )
+        {
+            fprintf( fp, "[Section%d]\n", i / ( numKeys / NUMSECTIONS ) );
+        }
+
+        fprintf( fp, "key%d=%d.25\n", i, i );
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static void add( void *context, unsigned int i, const char *value )
+{
+    (void)i;
+
+    *(double *)context += ( value != NULL ) ? atof( value ) : 0.0;
+}
+
+
+/*
+ * Resolves random batches both ways, returns the speedup of the batches
+ */
+static double measure( IniConfigFile *ini, const char *mode, int numKeys, int rounds )
+{
+    static char names[BATCHSIZE][2][NAMESIZE];
+    const char *sections[BATCHSIZE];
+    const char *keys[BATCHSIZE];
+    char value[64];
+    unsigned int seed = 4711;
+    long long singleTime = 0;
+    long long batchTime = 0;
+    double singleSum = 0.0;
+    double batchSum = 0.0;
+    int round = 0;
+    int i = 0;
+
+    for( round = 0; round < rounds; round++ )
+    {
+        long long start = 0;
+
+        for( i = 0; i < BATCHSIZE; i++ )
+        {
+            int k = (int)( rand_r( &seed ) % (unsigned int)numKeys );
+
+            Any_snprintf( names[i][0], NAMESIZE, "Section%d", k / ( numKeys / NUMSECTIONS ) );
+            Any_snprintf( names[i][1], NAMESIZE, "key%d", k );
+            sections[i] = names[i][0];
+            keys[i] = names[i][1];
+        }
+
+        /* alternate the order, so neither side profits from the other's cache */
+        if( round % 2 == 0 )
+        {
+            start = now();
+
+            for( i = 0; i < BATCHSIZE; i++ )
+            {
+                IniConfigFile_getString( ini, sections[i], keys[i], "0", value, sizeof( value ) );
+                singleSum += atof( value );
+            }
+
+            singleTime += now() - start;
+
+            start = now();
+            IniConfigFile_getBatch( ini, BATCHSIZE, sections, keys, add, &batchSum );
+            batchTime += now() - start;
+        }
+        else
+        {
+            start = now();
+            IniConfigFile_getBatch( ini, BATCHSIZE, sections, keys, add, &batchSum );
+            batchTime += now() - start;
+
+            start = now();
+
+            for( i = 0; i < BATCHSIZE; i++ )
+            {
+                IniConfigFile_getString( ini, sections[i], keys[i], "0", value, sizeof( value ) );
+                singleSum += atof( value );
+            }
+
+            singleTime += now() - start;
+        }
+    }
+
+    ANY_LOG( 0, "%-8s single gets %6.1f ns/key, batches %6.1f ns/key, speedup %.2fx%s", ANY_LOG_INFO, mode,
+             (double)singleTime / ( (double)rounds * BATCHSIZE ), (double)batchTime / ( (double)rounds * BATCHSIZE ),
+             (double)singleTime / (double)batchTime, ( singleSum == batchSum ) ? "" : " (VALUES DIFFER)" );
+
+    return (double)singleTime / (double)batchTime;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int numKeys = ( argc > 1 ) ? atoi( argv[1] ) : 1000000;
+    int rounds = ( argc > 2 ) ? atoi( argv[2] ) : 2000;
+    IniConfigFile *ini = IniConfigFile_new();
+
+    if( numKeys < NUMSECTIONS || rounds < 1 || !writeFile( numKeys ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_load( ini );
+
+    ANY_LOG( 0, "%d keys, %d batches of %d random keys", ANY_LOG_INFO, numKeys, rounds, BATCHSIZE );
+
+    measure( ini, "loaded:", numKeys, rounds );
+
+    IniConfigFile_freeze( ini );
+    measure( ini, "frozen:", numKeys, rounds );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
@@ -0,0 +1,167 @@
+/*
+ *  Measure how fast binary values are decoded from base64 and hex
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME   "BlobThroughput.ini"
+
+
+static long long now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * What decoding looks like without IniConfigBlob: one character at a time
+ */
+static long naiveDecode( int encoding, const char *text, size_t length, unsigned char *out )
+{
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    unsigned int bits = 0;
+    int numBits = 0;
+    long size = 0;
+    size_t i = 0;
+
+    for( i = 0; i < length && text[i] != '='; i++ )
+    {
+        const char *digit = ( encoding == INICONFIGBLOB_HEX ) ? strchr( "0123456789abcdef", text[i] )
+                                                              : strchr( digits, text[i] );
+
+        if( digit == NULL || *digit == '\0' )
+        {
+            return -1;
+        }
+
+        if( encoding == INICONFIGBLOB_HEX )
+        {
+            bits = ( bits << 4 ) | (unsigned int)( digit - "0123456789abcdef" );
+            numBits += 4;
+        }
+        else
+        {
+            bits = ( bits << 6 ) | (unsigned int)( digit - digits );
+            numBits += 6;
+        }
+
+        if( numBits >= 8 )
+        {
+            numBits -= 8;
+            out[size++] = (unsigned char)( bits >> numBits );
+        }
+    }
+
+    return size;
+}
+
+
+static void measure( const IniConfigFile *ini, int encoding, const char *key, const char *text, size_t size,
+                     int rounds, unsigned char *out )
+{
+    size_t length = strlen( text );
+    long long naiveTime = 0;
+    long long decodeTime = 0;
+    long long getTime = 0;
+    long long start = 0;
+    bool same = true;
+    int round = 0;
+
+    for( round = 0; round < rounds; round++ )
+    {
+        start = now();
+        same = ( naiveDecode( encoding, text, length, out ) == (long)size ) && same;
+        naiveTime += now() - start;
+
+        start = now();
+        same = ( IniConfigBlob_decode( encoding, text, length, out, size ) == (long)size ) && same;
+        decodeTime += now() - start;
+
+        start = now();
+        same = ( IniConfigFile_getBlob( ini, "Blobs", key, encoding, out, size ) == (long)size ) && same;
+        getTime += now() - start;
+    }
+
+    /* throughput in bytes of text per nanosecond, which is GB/s */
+    ANY_LOG( 0, "%-6s naive %5.2f GB/s, IniConfigBlob_decode() %5.2f GB/s, IniConfigFile_getBlob() %5.2f GB/s%s",
+             ANY_LOG_INFO, ( encoding == INICONFIGBLOB_HEX ) ? "hex" : "base64",
+             (double)length * rounds / (double)naiveTime, (double)length * rounds / (double)decodeTime,
+             (double)length * rounds / (double)getTime, same ? "" : " (DECODING FAILED)" );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    long size = ( argc > 1 ) ? atol( argv[1] ) : 1000000;
+    int rounds = ( argc > 2 ) ? atoi( argv[2] ) : 20;
+    IniConfigFile *ini = IniConfigFile_new();
+    unsigned char *data = (unsigned char *)NULL;
+    char *base64 = (char *)NULL;
+    char *hex = (char *)NULL;
+    long i = 0;
+
+    if( size < 1 || rounds < 1 )
+    {
+        return EXIT_FAILURE;
+    }
+
+    data = ANY_BALLOC( size );
+    base64 = ANY_BALLOC( IniConfigBlob_getEncodedLength( INICONFIGBLOB_BASE64, size ) + 1 );
+    hex = ANY_BALLOC( IniConfigBlob_getEncodedLength( INICONFIGBLOB_HEX, size ) + 1 );
+
+    for( i = 0; i < size; i++ )
+    {
+        data[i] = (unsigned char)( i * 7919 );
+    }
+
+    IniConfigBlob_encode( INICONFIGBLOB_BASE64, data, size, base64 );
+    IniConfigBlob_encode( INICONFIGBLOB_HEX, data, size, hex );
+
+    remove( FILENAME );
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_load( ini );
+    IniConfigFile_putString( ini, "Blobs", "base64", base64 );
+    IniConfigFile_putString( ini, "Blobs", "hex", hex );
+
+    ANY_LOG( 0, "Decoding %ld bytes %d times", ANY_LOG_INFO, size, rounds );
+
+    measure( ini, INICONFIGBLOB_BASE64, "base64", base64, size, rounds, data );
+    measure( ini, INICONFIGBLOB_HEX, "hex", hex, size, rounds, data );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( hex );
+    ANY_FREE( base64 );
+    ANY_FREE( data );
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
@@ -0,0 +1,129 @@
+/*
+ *  Compare summing a numeric section key by key with summing its column
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME   "ColumnSum.ini"
+
+
+static long long now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static bool writeFile( int numKeys )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "[Calibration]\n" );
+
+    for( i = 0; i < numKeys; i++ )
+    {
+        fprintf( fp, "offset%d=%d.125\n", i, i % 1000 );
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int numKeys = ( argc > 1 ) ? atoi( argv[1] ) : 10000;
+    int rounds = ( argc > 2 ) ? atoi( argv[2] ) : 100;
+    IniConfigFile *ini = IniConfigFile_new();
+    IniConfigColumnsSpan span;
+    long long keyTime = 0;
+    long long columnTime = 0;
+    long long start = 0;
+    double keySum = 0.0;
+    double columnSum = 0.0;
+    int round = 0;
+    int i = 0;
+
+    if( numKeys < 1 || rounds < 1 || !writeFile( numKeys ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_setColumnar( ini, true );
+
+    start = now();
+    IniConfigFile_load( ini );
+
+    ANY_LOG( 0, "%d keys loaded with columns in %.1f ms", ANY_LOG_INFO, numKeys, (double)( now() - start ) / 1e6 );
+
+    for( round = 0; round < rounds; round++ )
+    {
+        char key[32];
+
+        start = now();
+
+        for( i = 0; i < numKeys; i++ )
+        {
+            Any_snprintf( key, sizeof( key ), "offset%d", i );
+            keySum += IniConfigFile_getDouble( ini, "Calibration", key, 0.0 );
+        }
+
+        keyTime += now() - start;
+
+        /* the span lookup belongs to the measurement, the sum vectorizes */
+        start = now();
+
+        if( IniConfigFile_getColumns( ini, "Calibration", &span ) )
+        {
+            for( i = 0; i < (int)span.count; i++ )
+            {
+                columnSum += span.doubles[i];
+            }
+        }
+
+        columnTime += now() - start;
+    }
+
+    ANY_LOG( 0, "getDouble() %8.2f ns/key, column %6.2f ns/key, speedup %.0fx%s", ANY_LOG_INFO,
+             (double)keyTime / ( (double)rounds * numKeys ), (double)columnTime / ( (double)rounds * numKeys ),
+             (double)keyTime / (double)columnTime, ( keySum == columnSum ) ? "" : " (SUMS DIFFER)" );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
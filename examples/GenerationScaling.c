@@ -0,0 +1,139 @@
+/*
+ *  Measure how compare-and-set puts scale with the number of threads
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "GenerationScaling.ini"
+#define MAXTHREADS  32
+
+
+typedef struct Worker
+{
+    IniConfigFile *ini;
+    pthread_t thread;
+    int id;
+    int iterations;
+    long conflicts;
+}
+Worker;
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Increments a private counter, and every 16th time a shared one
+ */
+static void *Worker_run( void *arg )
+{
+    Worker *self = (Worker *)arg;
+    char key[32];
+    char value[32];
+    int i = 0;
+
+    Any_snprintf( key, 32, "counter%d", self->id );
+
+    for( i = 0; i < self->iterations; i++ )
+    {
+        const char *name = ( i % 16 == 0 ) ? "shared" : key;
+
+        for( ;; )
+        {
+            unsigned long generation = IniConfigFile_getGeneration( self->ini, "Counters", name );
+            long count = IniConfigFile_getLong( self->ini, "Counters", name, 0 );
+
+            Any_snprintf( value, 32, "%ld", count + 1 );
+
+            if( IniConfigFile_putIfUnchanged( self->ini, "Counters", name, value, generation ) )
+            {
+                break;
+            }
+
+            self->conflicts++;
+        }
+    }
+
+    return NULL;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int iterations = ( argc > 1 ) ? atoi( argv[1] ) : 100000;
+    Worker workers[MAXTHREADS];
+    int numThreads = 0;
+    int i = 0;
+
+    for( numThreads = 1; numThreads <= MAXTHREADS; numThreads *= 2 )
+    {
+        IniConfigFile *ini = IniConfigFile_new();
+        long conflicts = 0;
+        long expected = 0;
+        double start = 0.0;
+        double seconds = 0.0;
+
+        remove( FILENAME );
+        IniConfigFile_init( ini, FILENAME );
+        IniConfigFile_load( ini );
+
+        start = now();
+
+        for( i = 0; i < numThreads; i++ )
+        {
+            workers[i].ini = ini;
+            workers[i].id = i;
+            workers[i].iterations = iterations;
+            workers[i].conflicts = 0;
+
+            pthread_create( &workers[i].thread, NULL, Worker_run, &workers[i] );
+        }
+
+        for( i = 0; i < numThreads; i++ )
+        {
+            pthread_join( workers[i].thread, NULL );
+            conflicts += workers[i].conflicts;
+            expected += ( iterations + 15 ) / 16;
+        }
+
+        seconds = now() - start;
+
+        ANY_LOG( 0, "%2d threads: %12.0f updates/s, %8ld conflicts, shared counter %s",
+                 ANY_LOG_INFO, numThreads, numThreads * (double)iterations / seconds, conflicts,
+                 IniConfigFile_getLong( ini, "Counters", "shared", 0 ) == expected ? "ok" : "WRONG" );
+
+        IniConfigFile_clear( ini );
+        IniConfigFile_delete( ini );
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
@@ -0,0 +1,202 @@
+/*
+ *  Measure random lookup latencies of a large index on small and huge pages
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "LookupLatency.ini"
+#define NUMSECTIONS   256
+
+
+typedef struct Variant
+{
+    const char *name;
+    int flags;
+}
+Variant;
+
+
+static long long now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static int compare( const void *a, const void *b )
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+static bool writeFile( int numKeys )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    for( i = 0; i < numKeys; i++ )
+    {
+        if( i % ( numKeys / NUMSECTIONS ) == 0 )
+        {
+            fprintf( fp, "[Section%d]\n", i / ( numKeys / NUMSECTIONS ) );
+        }
+
+        fprintf( fp, "key%d=%d.25 ; a comment and a value of typical length\n", i, i );
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+/*
+ * Smaps reports how much of the process actually sits on huge pages
+ */
+static long readHugePages( void )
+{
+    char line[256];
+    long size = 0;
+    FILE *fp = fopen( "/proc/self/smaps", "r" );
+
+    if( fp == NULL )
+    {
+        return -1;
+    }
+
+    while( fgets( line, sizeof( line ), fp ) != NULL )
+    {
+        if( strncmp( line, "AnonHugePages:", 14 ) == 0 )
+        {
+            size += atol( line + 14 );
+        }
+    }
+
+    fclose( fp );
+
+    return size;
+}
+
+
+static void measure( IniConfigFile *ini, const Variant *variant, int numKeys, int lookups, long long *samples )
+{
+    IniConfigIndex *index = IniConfigIndex_new();
+    unsigned int seed = 12345;
+    char section[32];
+    char key[32];
+    double sum = 0.0;
+    long long start = 0;
+    long long buildTime = 0;
+    int i = 0;
+
+    IniConfigIndex_init( index );
+
+    start = now();
+
+    if( !IniConfigFile_buildIndex( ini, index, variant->flags ) )
+    {
+        ANY_LOG( 0, "%-18s not available here", ANY_LOG_INFO, variant->name );
+        IniConfigIndex_delete( index );
+        return;
+    }
+
+    buildTime = now() - start;
+
+    /* the first lookups after the build, as a reader sees them after a reload */
+    for( i = 0; i < lookups; i++ )
+    {
+        int k = (int)( rand_r( &seed ) % (unsigned int)numKeys );
+
+        Any_snprintf( section, sizeof( section ), "Section%d", k / ( numKeys / NUMSECTIONS ) );
+        Any_snprintf( key, sizeof( key ), "key%d", k );
+
+        start = now();
+        sum += IniConfigIndex_getDouble( index, section, key, 0.0 );
+        samples[i] = now() - start;
+    }
+
+    qsort( samples, lookups, sizeof( long long ), compare );
+
+    ANY_LOG( 0, "%-18s build %5lld ms, %ld kB on huge pages, p50 %4lld ns, p99 %5lld ns, p99.9 %6lld ns, "
+             "max %7lld ns (checksum %g)", ANY_LOG_INFO, variant->name, buildTime / 1000000, readHugePages(),
+             samples[lookups / 2], samples[lookups * 99 / 100], samples[lookups * 999 / 1000],
+             samples[lookups - 1], sum );
+
+    IniConfigIndex_clear( index );
+    IniConfigIndex_delete( index );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int numKeys = ( argc > 1 ) ? atoi( argv[1] ) : 400000;
+    int lookups = ( argc > 2 ) ? atoi( argv[2] ) : 1000000;
+    const Variant variants[] = {
+        { "small pages:",      INICONFIGINDEX_NONE },
+        { "small, locked:",    INICONFIGINDEX_LOCKED },
+        { "transparent huge:", INICONFIGINDEX_HUGEPAGES },
+        { "huge, locked:",     INICONFIGINDEX_HUGEPAGES | INICONFIGINDEX_LOCKED },
+        { "reserved huge:",    INICONFIGINDEX_HUGETLB } };
+    IniConfigFile *ini = IniConfigFile_new();
+    long long *samples = NULL;
+    unsigned int i = 0;
+
+    if( numKeys < NUMSECTIONS || lookups < 1 || !writeFile( numKeys ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    samples = ANY_NTALLOC( lookups, long long );
+
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_load( ini );
+
+    ANY_LOG( 0, "%d keys, %d random lookups per variant", ANY_LOG_INFO, numKeys, lookups );
+
+    for( i = 0; i < sizeof( variants ) / sizeof( variants[0] ); i++ )
+    {
+        measure( ini, &variants[i], numKeys, lookups, samples );
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( samples );
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
@@ -0,0 +1,183 @@
+/*
+ *  Measure the put rate of a loaded file while it is persisted periodically
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "PutThroughput.ini"
+#define MAXTHREADS  32
+#define NUMKEYS     256
+
+
+typedef struct Worker
+{
+    IniConfigFile *ini;
+    pthread_t thread;
+    int id;
+    int iterations;
+}
+Worker;
+
+
+typedef struct Persister
+{
+    IniConfigFile *ini;
+    pthread_t thread;
+    volatile int running;
+    int persists;
+}
+Persister;
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Cycles through the keys of its own section
+ */
+static void *Worker_run( void *arg )
+{
+    Worker *self = (Worker *)arg;
+    char section[32];
+    char key[32];
+    int i = 0;
+
+    Any_snprintf( section, 32, "Worker%d", self->id );
+
+    for( i = 0; i < self->iterations; i++ )
+    {
+        Any_snprintf( key, 32, "param%d", i % NUMKEYS );
+        IniConfigFile_putLong( self->ini, section, key, i );
+    }
+
+    return NULL;
+}
+
+
+static void *Persister_run( void *arg )
+{
+    Persister *self = (Persister *)arg;
+
+    while( self->running )
+    {
+        usleep( 50000 );
+
+        IniConfigFile_persist( self->ini );
+        self->persists++;
+    }
+
+    return NULL;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int iterations = ( argc > 1 ) ? atoi( argv[1] ) : 200000;
+    Worker workers[MAXTHREADS];
+    Persister persister;
+    int numThreads = 0;
+    int i = 0;
+
+    for( numThreads = 1; numThreads <= MAXTHREADS; numThreads *= 2 )
+    {
+        IniConfigFile *ini = IniConfigFile_new();
+        IniConfigFile *check = IniConfigFile_new();
+        double start = 0.0;
+        double seconds = 0.0;
+        bool ok = true;
+
+        remove( FILENAME );
+        IniConfigFile_init( ini, FILENAME );
+        IniConfigFile_load( ini );
+
+        persister.ini = ini;
+        persister.running = 1;
+        persister.persists = 0;
+
+        pthread_create( &persister.thread, NULL, Persister_run, &persister );
+
+        start = now();
+
+        for( i = 0; i < numThreads; i++ )
+        {
+            workers[i].ini = ini;
+            workers[i].id = i;
+            workers[i].iterations = iterations;
+
+            pthread_create( &workers[i].thread, NULL, Worker_run, &workers[i] );
+        }
+
+        for( i = 0; i < numThreads; i++ )
+        {
+            pthread_join( workers[i].thread, NULL );
+        }
+
+        seconds = now() - start;
+
+        persister.running = 0;
+        pthread_join( persister.thread, NULL );
+
+        IniConfigFile_persist( ini );
+
+        /* the last value of every worker must have reached the file */
+        IniConfigFile_init( check, FILENAME );
+
+        for( i = 0; i < numThreads; i++ )
+        {
+            char section[32];
+            char key[32];
+
+            Any_snprintf( section, 32, "Worker%d", i );
+            Any_snprintf( key, 32, "param%d", ( iterations - 1 ) % NUMKEYS );
+
+            if( IniConfigFile_getLong( check, section, key, -1 ) != iterations - 1 )
+            {
+                ok = false;
+            }
+        }
+
+        ANY_LOG( 0, "%2d threads: %12.0f puts/s, %4d persists during the run, file %s",
+                 ANY_LOG_INFO, numThreads, numThreads * (double)iterations / seconds, persister.persists,
+                 ok ? "ok" : "WRONG" );
+
+        IniConfigFile_clear( check );
+        IniConfigFile_delete( check );
+
+        IniConfigFile_clear( ini );
+        IniConfigFile_delete( ini );
+    }
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
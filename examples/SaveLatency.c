@@ -0,0 +1,155 @@
+/*
+ *  Measure the cost of the save durability levels and of group commits
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define MAXFILES  64
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void report( const char *name, int saves, double seconds )
+{
+    ANY_LOG( 0, "%-40s %6d saves in %8.3f s = %10.3f ms/save",
+             ANY_LOG_INFO, name, saves, seconds, seconds * 1e3 / saves );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    static const char *levelNames[] = { "none", "data", "full" };
+    int numSaves = ( argc > 1 ) ? atoi( argv[1] ) : 50;
+    int numFiles = ( argc > 2 ) ? atoi( argv[2] ) : 16;
+    IniConfigFile *files[MAXFILES];
+    IniConfigCommitGroup *group = NULL;
+    char name[64];
+    double start = 0.0;
+    int level = 0;
+    int i = 0;
+    int j = 0;
+
+    if( numFiles > MAXFILES )
+    {
+        numFiles = MAXFILES;
+    }
+
+    for( i = 0; i < numFiles; i++ )
+    {
+        Any_snprintf( name, 64, "SaveLatency%d.ini", i );
+
+        files[i] = IniConfigFile_new();
+        IniConfigFile_init( files[i], name );
+        IniConfigFile_load( files[i] );
+
+        for( j = 0; j < 100; j++ )
+        {
+            Any_snprintf( name, 64, "key%d", j );
+            IniConfigFile_putInt( files[i], "Robot", name, i * j );
+        }
+    }
+
+    /* a single file saved with each durability level */
+    for( level = INICONFIGATOMICFILE_DURABILITY_NONE; level <= INICONFIGATOMICFILE_DURABILITY_FULL; level++ )
+    {
+        IniConfigFile_setDurability( files[0], (IniConfigAtomicFileDurability)level );
+        start = now();
+
+        for( i = 0; i < numSaves; i++ )
+        {
+            IniConfigFile_putInt( files[0], "Robot", "counter", i );
+            IniConfigFile_save( files[0] );
+        }
+
+        Any_snprintf( name, 64, "single file, %s", levelNames[level] );
+        report( name, numSaves, now() - start );
+    }
+
+    /* many files, saved one after the other or as a group */
+    for( i = 0; i < numFiles; i++ )
+    {
+        IniConfigFile_setDurability( files[i], INICONFIGATOMICFILE_DURABILITY_FULL );
+    }
+
+    start = now();
+
+    for( j = 0; j < numSaves; j++ )
+    {
+        for( i = 0; i < numFiles; i++ )
+        {
+            IniConfigFile_save( files[i] );
+        }
+    }
+
+    Any_snprintf( name, 64, "%d files, one by one", numFiles );
+    report( name, numSaves * numFiles, now() - start );
+
+    /*
+     * from INICONFIGCOMMITGROUP_SYNCFSFILES files on one file system on, the
+     * group flushes it with one syncfs() instead of one fdatasync() per file;
+     * syncfs() also writes back what other processes left dirty there, so
+     * compare both sides of the threshold while the file system is busy
+     */
+    group = IniConfigCommitGroup_new();
+    IniConfigCommitGroup_init( group, INICONFIGATOMICFILE_DURABILITY_FULL );
+
+    start = now();
+
+    for( j = 0; j < numSaves; j++ )
+    {
+        for( i = 0; i < numFiles; i++ )
+        {
+            IniConfigFile_saveGroup( files[i], group );
+        }
+
+        if( !IniConfigCommitGroup_commit( group ) )
+        {
+            ANY_LOG( 0, "Group commit failed", ANY_LOG_ERROR );
+        }
+    }
+
+    Any_snprintf( name, 64, "%d files, group commit (%s)", numFiles,
+                  ( numFiles >= INICONFIGCOMMITGROUP_SYNCFSFILES ) ? "syncfs" : "fdatasync" );
+    report( name, numSaves * numFiles, now() - start );
+
+    IniConfigCommitGroup_clear( group );
+    IniConfigCommitGroup_delete( group );
+
+    for( i = 0; i < numFiles; i++ )
+    {
+        remove( files[i]->fileName );
+        IniConfigFile_clear( files[i] );
+        IniConfigFile_delete( files[i] );
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
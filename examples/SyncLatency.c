@@ -0,0 +1,162 @@
+/*
+ *  Measure the worst-case cost of IniConfigFile_sync() in a control loop
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "SyncLatency.ini"
+#define NUMKEYS     1000
+
+
+typedef struct Publisher
+{
+    IniConfigFile *ini;
+    pthread_t thread;
+    int running;
+    long publishes;
+}
+Publisher;
+
+
+static long long now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static int compare( const void *a, const void *b )
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+/*
+ * Publishes new versions as fast as it can
+ */
+static void *Publisher_run( void *arg )
+{
+    Publisher *self = (Publisher *)arg;
+    long i = 0;
+
+    while( __atomic_load_n( &self->running, __ATOMIC_ACQUIRE ) )
+    {
+        IniConfigFile_putLong( self->ini, "Control", "cycle", i++ );
+        IniConfigFile_publish( self->ini );
+        self->publishes++;
+    }
+
+    return NULL;
+}
+
+
+static void report( const char *what, long long *samples, int count )
+{
+    qsort( samples, count, sizeof( long long ), compare );
+
+    ANY_LOG( 0, "%-14s p50 %6lld ns, p99 %6lld ns, p99.9 %6lld ns, max %8lld ns", ANY_LOG_INFO, what,
+             samples[count / 2], samples[count * 99 / 100], samples[count * 999 / 1000], samples[count - 1] );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int cycles = ( argc > 1 ) ? atoi( argv[1] ) : 200000;
+    long long *syncTimes = NULL;
+    long long *switchTimes = NULL;
+    IniConfigFile *ini = IniConfigFile_new();
+    Publisher publisher;
+    char key[32];
+    double sum = 0.0;
+    int numSwitches = 0;
+    int i = 0;
+
+    syncTimes = ANY_NTALLOC( cycles, long long );
+    switchTimes = ANY_NTALLOC( cycles, long long );
+
+    remove( FILENAME );
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE );
+    IniConfigFile_load( ini );
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        Any_snprintf( key, 32, "param%d", i );
+        IniConfigFile_putDouble( ini, "Control", key, i * 0.5 );
+    }
+
+    publisher.ini = ini;
+    publisher.running = 1;
+    publisher.publishes = 0;
+
+    pthread_create( &publisher.thread, NULL, Publisher_run, &publisher );
+
+    for( i = 0; i < cycles; i++ )
+    {
+        long long start = now();
+        bool switched = IniConfigFile_sync( ini );
+        long long cost = now() - start;
+
+        syncTimes[i] = cost;
+
+        if( switched )
+        {
+            switchTimes[numSwitches++] = cost;
+        }
+
+        /* the work of a control cycle */
+        sum += IniConfigFile_getDouble( ini, "Control", "param10", 0.0 );
+        sum += (double)IniConfigFile_getLong( ini, "Control", "cycle", 0 );
+    }
+
+    __atomic_store_n( &publisher.running, 0, __ATOMIC_RELEASE );
+    pthread_join( publisher.thread, NULL );
+
+    ANY_LOG( 0, "%d cycles, %d switches, %ld versions published (checksum %g)", ANY_LOG_INFO,
+             cycles, numSwitches, publisher.publishes, sum );
+
+    report( "any sync:", syncTimes, cycles );
+
+    if( numSwitches > 0 )
+    {
+        report( "switching sync:", switchTimes, numSwitches );
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( syncTimes );
+    ANY_FREE( switchTimes );
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
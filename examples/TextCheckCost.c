@@ -0,0 +1,141 @@
+/*
+ *  Compare the cost of the text checks with the cost of loading a file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME   "TextCheckCost.ini"
+
+
+static long long now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static bool writeFile( int numKeys )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    for( i = 0; i < numKeys; i++ )
+    {
+        if( i % 100 == 0 )
+        {
+            fprintf( fp, "[Section%d]\n", i / 100 );
+        }
+
+        /* mostly ASCII, some keys with umlauts and symbols */
+        fprintf( fp, ( i % 10 == 0 ) ? "label%d=Gr\xc3\xb6\xc3\x9f" "e %d \xe2\x82\xac\n" : "value%d=%d.25\n", i, i );
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static long long measureLoad( IniConfigFile *ini, int flags, int rounds )
+{
+    long long total = 0;
+    int round = 0;
+
+    IniConfigFile_setTextFlags( ini, flags );
+
+    for( round = 0; round < rounds; round++ )
+    {
+        long long start = now();
+
+        IniConfigFile_load( ini );
+        total += now() - start;
+    }
+
+    return total / rounds;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int numKeys = ( argc > 1 ) ? atoi( argv[1] ) : 100000;
+    int rounds = ( argc > 2 ) ? atoi( argv[2] ) : 10;
+    IniConfigFile *ini = IniConfigFile_new();
+    long long plain = 0;
+    long long checked = 0;
+    long long validate = 0;
+    long long start = 0;
+    size_t length = 0;
+    size_t valid = 0;
+    char *text = (char *)NULL;
+    FILE *fp = (FILE *)NULL;
+    int round = 0;
+
+    if( numKeys < 1 || rounds < 1 || !writeFile( numKeys ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    IniConfigFile_init( ini, FILENAME );
+
+    plain = measureLoad( ini, INICONFIGTEXT_NONE, rounds );
+    checked = measureLoad( ini, INICONFIGTEXT_TRANSCODE | INICONFIGTEXT_VALIDATE, rounds );
+
+    /* the validator alone */
+    fp = fopen( FILENAME, "rb" );
+    fseek( fp, 0, SEEK_END );
+    length = (size_t)ftell( fp );
+    rewind( fp );
+    text = ANY_BALLOC( length );
+    length = fread( text, 1, length, fp );
+    fclose( fp );
+
+    for( round = 0; round < rounds; round++ )
+    {
+        start = now();
+        valid += ( IniConfigText_validate( text, length ) == length );
+        validate += now() - start;
+    }
+
+    ANY_LOG( 0, "%d keys, %zu bytes: load %.2f ms, with checks %.2f ms (%+.1f%%), validation alone %.2f GB/s%s",
+             ANY_LOG_INFO, numKeys, length, (double)plain / 1e6, (double)checked / 1e6,
+             100.0 * (double)( checked - plain ) / (double)plain, (double)length * rounds / (double)validate,
+             ( valid == (size_t)rounds ) ? "" : " (VALIDATION FAILED)" );
+
+    ANY_FREE( text );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return EXIT_SUCCESS;
+}
+
+
+/* EOF */
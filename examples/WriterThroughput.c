@@ -0,0 +1,143 @@
+/*
+ *  Compare the throughput of IniConfigWriter with the put* API
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+#include <IniConfigWriter.h>
+
+
+#define FILENAME  "WriterThroughput.ini"
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void report( const char *name, int entries, double seconds )
+{
+    ANY_LOG( 0, "%-24s %8d entries in %8.3f s = %12.0f entries/s",
+             ANY_LOG_INFO, name, entries, seconds, entries / seconds );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int numEntries = ( argc > 1 ) ? atoi( argv[1] ) : 200000;
+    int numPuts = ( argc > 2 ) ? atoi( argv[2] ) : 2000;
+    IniConfigWriter *writer = NULL;
+    IniConfigFile *ini = NULL;
+    double start = 0.0;
+    char key[64];
+    int i = 0;
+
+    /* streaming writer */
+    writer = IniConfigWriter_new();
+    start = now();
+
+    IniConfigWriter_init( writer, FILENAME, 0 );
+
+    for( i = 0; i < numEntries; i++ )
+    {
+        if( i % 1000 == 0 )
+        {
+            Any_snprintf( key, 64, "Section%d", i / 1000 );
+            IniConfigWriter_putSection( writer, key );
+        }
+
+        Any_snprintf( key, 64, "key%d", i );
+
+        switch( i % 3 )
+        {
+            case 0:
+                IniConfigWriter_putLong( writer, key, i * 7919L );
+                break;
+
+            case 1:
+                IniConfigWriter_putDouble( writer, key, i * 0.001 );
+                break;
+
+            default:
+                IniConfigWriter_putString( writer, key, "some text value" );
+                break;
+        }
+    }
+
+    if( !IniConfigWriter_close( writer ) )
+    {
+        ANY_LOG( 0, "IniConfigWriter failed", ANY_LOG_ERROR );
+    }
+
+    report( "IniConfigWriter", numEntries, now() - start );
+
+    IniConfigWriter_clear( writer );
+    IniConfigWriter_delete( writer );
+
+    remove( FILENAME );
+
+    /* in-memory document, saved once */
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    start = now();
+
+    IniConfigFile_load( ini );
+
+    for( i = 0; i < numEntries; i++ )
+    {
+        Any_snprintf( key, 64, "key%d", i );
+        IniConfigFile_putLong( ini, "Section", key, i * 7919L );
+    }
+
+    IniConfigFile_save( ini );
+
+    report( "IniConfigFile_load/save", numEntries, now() - start );
+
+    IniConfigFile_clear( ini );
+    remove( FILENAME );
+
+    /* one file rewrite per put */
+    IniConfigFile_init( ini, FILENAME );
+
+    start = now();
+
+    for( i = 0; i < numPuts; i++ )
+    {
+        Any_snprintf( key, 64, "key%d", i );
+        IniConfigFile_putLong( ini, "Section", key, i * 7919L );
+    }
+
+    report( "IniConfigFile_putLong", numPuts, now() - start );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( EXIT_SUCCESS );
+}
+
+
+/* EOF */
@@ -0,0 +1,81 @@
+/*
+ *  Fuzzing harness loading arbitrary bytes as an INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define NAMESIZE  64
+
+
+/*
+ * The input is the file. It is parsed, every section and key listed and
+ * read, then parsed a second time.
+ */
+int LLVMFuzzerTestOneInput( const uint8_t *data, size_t size )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    char section[NAMESIZE];
+    char key[NAMESIZE];
+    char value[NAMESIZE];
+    int numSections = 0;
+    int i = 0;
+    int j = 0;
+
+    if( ini == NULL )
+    {
+        return 0;
+    }
+
+    if( !IniConfigFile_initFromBuffer( ini, (const char *)data, size, true ) )
+    {
+        IniConfigFile_delete( ini );
+        return 0;
+    }
+
+    numSections = IniConfigFile_countSections( ini );
+
+    /* the global section first, then the listed ones */
+    for( i = -1; i < numSections; i++ )
+    {
+        section[0] = '\0';
+
+        if( i >= 0 )
+        {
+            IniConfigFile_getSection( ini, i, section, NAMESIZE );
+        }
+
+        for( j = 0; IniConfigFile_getKey( ini, section, j, key, NAMESIZE ) > 0; j++ )
+        {
+            IniConfigFile_getString( ini, section, key, "", value, NAMESIZE );
+        }
+
+        IniConfigFile_countKeys( ini, section );
+    }
+
+    IniConfigFile_load( ini );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return 0;
+}
+
+
+/* EOF */
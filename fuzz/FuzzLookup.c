@@ -0,0 +1,95 @@
+/*
+ *  Fuzzing harness looking up arbitrary names in an arbitrary INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define VALUESIZE  64
+
+
+/*
+ * The input is the file up to its first zero byte, followed by
+ * zero-separated pairs of section and key names to read with every getter
+ */
+int LLVMFuzzerTestOneInput( const uint8_t *data, size_t size )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    char value[VALUESIZE];
+    unsigned char blob[VALUESIZE];
+    const char *section = NULL;
+    const char *key = NULL;
+    const char *end = NULL;
+    char *input = NULL;
+    size_t length = 0;
+
+    input = (char *)ANY_BALLOC( size + 2 );
+
+    if( ini == NULL || input == NULL )
+    {
+        IniConfigFile_delete( ini );
+        ANY_FREE( input );
+        return 0;
+    }
+
+    /* two zeros at the end, the last key is always terminated */
+    memcpy( input, data, size );
+    end = input + size + 1;
+    length = strlen( input );
+
+    if( !IniConfigFile_initFromBuffer( ini, input, length, true ) )
+    {
+        IniConfigFile_delete( ini );
+        ANY_FREE( input );
+        return 0;
+    }
+
+    for( section = input + length + 1; section < end; section = key + strlen( key ) + 1 )
+    {
+        key = section + strlen( section ) + 1;
+
+        if( key >= end )
+        {
+            break;
+        }
+
+        /* short buffers truncate, their size comes from the input too */
+        IniConfigFile_getString( ini, section, key, "default", value, 1 + (int)( strlen( key ) % VALUESIZE ) );
+        IniConfigFile_getLong( ini, section, key, 0 );
+        IniConfigFile_getDouble( ini, section, key, 0.0 );
+        IniConfigFile_getDuration( ini, section, key, 0 );
+        IniConfigFile_getByteSize( ini, section, key, 0 );
+        IniConfigFile_getFrequency( ini, section, key, 0.0 );
+        IniConfigFile_getBlob( ini, section, key, INICONFIGBLOB_BASE64, blob, sizeof( blob ) );
+        IniConfigFile_getBlob( ini, section, key, INICONFIGBLOB_HEX, blob, sizeof( blob ) );
+        IniConfigFile_getKey( ini, section, (int)strlen( key ), value, VALUESIZE );
+        IniConfigFile_countKeys( ini, section );
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( input );
+
+    return 0;
+}
+
+
+/* EOF */
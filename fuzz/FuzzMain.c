@@ -0,0 +1,116 @@
+/*
+ *  Runs a fuzzing harness on given inputs, for compilers without libFuzzer
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+
+int LLVMFuzzerTestOneInput( const uint8_t *data, size_t size );
+
+
+/*
+ * Reads a whole stream, NULL if memory ran out
+ */
+static char *readAll( FILE *fp, size_t *length )
+{
+    size_t size = 4096;
+    char *contents = (char *)ANY_BALLOC( size );
+    char *larger = NULL;
+    size_t count = 0;
+
+    *length = 0;
+
+    while( contents != NULL && ( count = fread( contents + *length, 1, size - *length, fp ) ) > 0 )
+    {
+        *length += count;
+
+        if( *length < size )
+        {
+            continue;
+        }
+
+        larger = (char *)ANY_BALLOC( size * 2 );
+
+        if( larger != NULL )
+        {
+            memcpy( larger, contents, size );
+        }
+
+        ANY_FREE( contents );
+        contents = larger;
+        size *= 2;
+    }
+
+    return contents;
+}
+
+
+/*
+ * Every argument is a file given to the harness once, without arguments
+ * the standard input is. Crashes reproduce like with libFuzzer.
+ */
+int main( int argc, char *argv[] )
+{
+    char *contents = NULL;
+    size_t length = 0;
+    FILE *fp = NULL;
+    int i = 0;
+
+    if( argc < 2 )
+    {
+        contents = readAll( stdin, &length );
+
+        if( contents == NULL )
+        {
+            return( EXIT_FAILURE );
+        }
+
+        LLVMFuzzerTestOneInput( (const uint8_t *)contents, length );
+        ANY_FREE( contents );
+
+        return( EXIT_SUCCESS );
+    }
+
+    for( i = 1; i < argc; i++ )
+    {
+        fp = fopen( argv[i], "rb" );
+
+        if( fp == NULL )
+        {
+            ANY_LOG( 0, "Unable to open %s", ANY_LOG_ERROR, argv[i] );
+            return( EXIT_FAILURE );
+        }
+
+        contents = readAll( fp, &length );
+        fclose( fp );
+
+        if( contents == NULL )
+        {
+            return( EXIT_FAILURE );
+        }
+
+        LLVMFuzzerTestOneInput( (const uint8_t *)contents, length );
+        ANY_FREE( contents );
+    }
+
+    return( EXIT_SUCCESS );
+}
+
+
+/* EOF */
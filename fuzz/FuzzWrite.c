@@ -0,0 +1,151 @@
+/*
+ *  Fuzzing harness writing arbitrary keys into an arbitrary INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME   "FuzzWrite.ini"
+#define VALUESIZE  64
+
+
+static IniConfigMemoryBackend *memory = NULL;
+
+
+static bool isPlain( const char *name )
+{
+    size_t i = 0;
+
+    for( i = 0; name[i] != '\0'; i++ )
+    {
+        if( !isalnum( (unsigned char)name[i] ) )
+        {
+            return false;
+        }
+    }
+
+    return i > 0 && i < VALUESIZE;
+}
+
+
+/*
+ * The input is the file up to its first zero byte, followed by
+ * zero-separated triples of section, key and value to put; an empty value
+ * removes the key. The file is saved to a memory backend and loaded again,
+ * the last put must read back if all its names are plain.
+ */
+int LLVMFuzzerTestOneInput( const uint8_t *data, size_t size )
+{
+    const IniConfigBackend *backend = NULL;
+    IniConfigFile *ini = IniConfigFile_new();
+    IniConfigFile *other = IniConfigFile_new();
+    char value[VALUESIZE];
+    const char *section = NULL;
+    const char *key = NULL;
+    const char *text = NULL;
+    const char *last[3] = { NULL, NULL, NULL };
+    const char *end = NULL;
+    char *input = NULL;
+    size_t length = 0;
+
+    if( memory == NULL )
+    {
+        memory = IniConfigMemoryBackend_new();
+
+        if( memory == NULL || !IniConfigMemoryBackend_init( memory ) )
+        {
+            abort();
+        }
+    }
+
+    backend = IniConfigMemoryBackend_getBackend( memory );
+    input = (char *)ANY_BALLOC( size + 3 );
+
+    if( ini == NULL || other == NULL || input == NULL )
+    {
+        goto out;
+    }
+
+    /* three zeros at the end, the last value is always terminated */
+    memcpy( input, data, size );
+    end = input + size + 1;
+    length = strlen( input );
+
+    if( !IniConfigMemoryBackend_putFile( memory, FILENAME, input, length ) ||
+        !IniConfigFile_initWithBackend( ini, FILENAME, backend ) )
+    {
+        goto out;
+    }
+
+    for( section = input + length + 1; section < end; section = text + strlen( text ) + 1 )
+    {
+        key = section + strlen( section ) + 1;
+        text = key + strlen( key ) + 1;
+
+        if( text >= end )
+        {
+            break;
+        }
+
+        if( text[0] == '\0' )
+        {
+            IniConfigFile_removeKey( ini, section, key );
+            last[0] = NULL;
+        }
+        else if( IniConfigFile_putString( ini, section, key, text ) )
+        {
+            last[0] = section;
+            last[1] = key;
+            last[2] = text;
+        }
+    }
+
+    if( IniConfigFile_save( ini ) && IniConfigFile_initWithBackend( other, FILENAME, backend ) )
+    {
+        if( last[0] != NULL && isPlain( last[0] ) && isPlain( last[1] ) && isPlain( last[2] ) &&
+            ( IniConfigFile_getString( other, last[0], last[1], "", value, VALUESIZE ) <= 0 ||
+              strcmp( value, last[2] ) != 0 ) )
+        {
+            ANY_LOG( 0, "[%s] %s=%s did not read back, found '%s'", ANY_LOG_ERROR, last[0], last[1], last[2],
+                     value );
+            abort();
+        }
+
+        IniConfigFile_clear( other );
+    }
+
+    IniConfigFile_clear( ini );
+
+    out:
+
+    IniConfigFile_delete( ini );
+    IniConfigFile_delete( other );
+
+    IniConfigMemoryBackend_removeFile( memory, FILENAME );
+
+    ANY_FREE( input );
+
+    return 0;
+}
+
+
+/* EOF */
@@ -17,8 +17,336 @@
 #define CPPINICONFIGFILE_H
 
 #include <IniConfigFile.h>
+#include <IniConfigSection.h>
 
 #include <string>
+#include <vector>
+
+#if __cplusplus >= 201103L
+#include <chrono>
+#endif
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+
+/*!
+ * \brief Snapshot of the values of a loaded CppIniConfigFile
+ *
+ * \see CppIniConfigFile::snapshot()
+ */
+class CppIniConfigSnapshot
+{
+    friend class CppIniConfigFile;
+
+    private:
+    IniConfigSnapshot *snapshot;        /**< Instance pointer */
+
+    CppIniConfigSnapshot( const CppIniConfigSnapshot & );
+    CppIniConfigSnapshot &operator=( const CppIniConfigSnapshot & );
+
+    public:
+
+    /*!
+     * \brief Constructor
+     *
+     * The snapshot is empty until CppIniConfigFile::snapshot() fills it.
+     */
+    CppIniConfigSnapshot(
+    void )
+    {
+        snapshot = IniConfigSnapshot_new();
+        ANY_REQUIRE( snapshot );
+
+        IniConfigSnapshot_init( snapshot );
+    }
+
+    /*!
+     * \brief Destructor
+     */
+    ~CppIniConfigSnapshot(
+    void )
+    {
+        ANY_REQUIRE( snapshot );
+
+        IniConfigSnapshot_clear( snapshot );
+        IniConfigSnapshot_delete( snapshot );
+    }
+
+    /*!
+     * \brief Get a string value as it was when the snapshot was taken
+     *
+     * \param section   the name of the section
+     * \param key       the name of the entry
+     * \param defValue  returned if the key did not exist
+     *
+     * \return The value located at Key
+     */
+    std::string
+    get(
+    const std::string
+    &section,
+    const std::string
+    &key,
+    const std::string
+    &defValue = "" ) const
+    {
+        char buffer[INICONFIGFILE_BUFFERSIZE];
+
+        IniConfigSnapshot_getString( snapshot, section.c_str(), key.c_str(), defValue.c_str(), buffer,
+                                     INICONFIGFILE_BUFFERSIZE );
+
+        return buffer;
+    }
+
+    /*!
+     * \brief Change a value of the snapshot only
+     *
+     * \param section  the name of the section
+     * \param key      the name of the entry
+     * \param value    the new value
+     *
+     * \return true on success, false otherwise
+     */
+    bool put( const std::string
+    &section,
+    const std::string
+    &key,
+    const std::string
+    &value )
+    {
+        return IniConfigSnapshot_putString( snapshot, section.c_str(), key.c_str(), value.c_str());
+    }
+};
+
+
+/*!
+ * \brief Real-time safe, read-only view of a CppIniConfigFile
+ *
+ * Construction and CppIniConfigFile::buildIndex() allocate; all getters
+ * take plain C strings and never allocate, lock or make system calls
+ * (see \ref IniConfigIndex).
+ *
+ * \code
+ *  CppIniConfigFile myIniFile( "myConfig.ini" );
+ *  CppIniConfigIndex index;
+ *
+ *  myIniFile.load();
+ *  myIniFile.buildIndex( index, INICONFIGINDEX_LOCKED );
+ *
+ *  // in the control loop
+ *  double gain = index.get( "Arm", "gain", 1.0 );
+ * \endcode
+ */
+class CppIniConfigIndex
+{
+    friend class CppIniConfigFile;
+
+    private:
+    IniConfigIndex *index;              /**< Instance pointer */
+
+    CppIniConfigIndex( const CppIniConfigIndex & );
+    CppIniConfigIndex &operator=( const CppIniConfigIndex & );
+
+    public:
+
+    /*!
+     * \brief Constructor
+     *
+     * The index is empty until CppIniConfigFile::buildIndex() fills it.
+     */
+    CppIniConfigIndex(
+    void )
+    {
+        index = IniConfigIndex_new();
+        ANY_REQUIRE( index );
+
+        IniConfigIndex_init( index );
+    }
+
+    /*!
+     * \brief Destructor
+     */
+    ~CppIniConfigIndex(
+    void )
+    {
+        ANY_REQUIRE( index );
+
+        IniConfigIndex_clear( index );
+        IniConfigIndex_delete( index );
+    }
+
+    /*!
+     * \brief Get a string value without copying it
+     *
+     * \param section   the name of the section, NULL for the global area
+     * \param key       the name of the entry
+     * \param defValue  returned if the key does not exist
+     *
+     * \return The value inside the index, valid until it is rebuilt
+     */
+    const char *get( const char *section, const char *key, const char *defValue = "" ) const
+    {
+        const char *value = IniConfigIndex_find( index, section, key );
+
+        return ( value != NULL ) ? value : defValue;
+    }
+
+    /*!
+     * \brief Get a double
+     *
+     * \param section   the name of the section, NULL for the global area
+     * \param key       the name of the entry
+     * \param defValue  returned if the key does not exist or is empty
+     *
+     * \return The value located at Key
+     */
+    double get( const char *section, const char *key, double defValue ) const
+    {
+        return IniConfigIndex_getDouble( index, section, key, defValue );
+    }
+
+    /*!
+     * \brief Get a long
+     *
+     * \param section   the name of the section, NULL for the global area
+     * \param key       the name of the entry
+     * \param defValue  returned if the key does not exist or is empty
+     *
+     * \return The value located at Key
+     */
+    long get( const char *section, const char *key, long defValue ) const
+    {
+        return IniConfigIndex_getLong( index, section, key, defValue );
+    }
+
+    /*!
+     * \brief Get an int
+     *
+     * \param section   the name of the section, NULL for the global area
+     * \param key       the name of the entry
+     * \param defValue  returned if the key does not exist or is empty
+     *
+     * \return The value located at Key
+     */
+    int get( const char *section, const char *key, int defValue ) const
+    {
+        return IniConfigIndex_getInt( index, section, key, defValue );
+    }
+};
+
+
+/*!
+ * \brief How CppIniConfigFile::get<T>() reads a value of type T
+ *
+ * Types with a member <tt>static bool parse( const char *text, T &value )</tt>
+ * work as they are; other types specialize this template with a static
+ * get() of the same signature. Missing keys and values parse() rejects
+ * give the default.
+ *
+ * \code
+ *  struct Color
+ *  {
+ *    static bool parse( const char *text, Color &value );
+ *  };
+ *
+ *  Color background = myIniFile.get<Color>( "Display", "Background", Color() );
+ * \endcode
+ */
+template <typename T>
+struct CppIniConfigValue
+{
+    static T get( const IniConfigFile *ini, const char *section, const char *key, const T &defValue )
+    {
+        char buffer[INICONFIGFILE_BUFFERSIZE];
+        T value;
+
+        if( IniConfigFile_getString( ini, section, key, "", buffer, INICONFIGFILE_BUFFERSIZE ) <= 0 ||
+            !T::parse( buffer, value ) )
+        {
+            return defValue;
+        }
+
+        return value;
+    }
+};
+
+template <>
+struct CppIniConfigValue<double>
+{
+    static double get( const IniConfigFile *ini, const char *section, const char *key, double defValue )
+    {
+        return IniConfigFile_getDouble( ini, section, key, defValue );
+    }
+};
+
+template <>
+struct CppIniConfigValue<long>
+{
+    static long get( const IniConfigFile *ini, const char *section, const char *key, long defValue )
+    {
+        return IniConfigFile_getLong( ini, section, key, defValue );
+    }
+};
+
+template <>
+struct CppIniConfigValue<int>
+{
+    static int get( const IniConfigFile *ini, const char *section, const char *key, int defValue )
+    {
+        return IniConfigFile_getLong( ini, section, key, (long)defValue );
+    }
+};
+
+template <>
+struct CppIniConfigValue<std::string>
+{
+    static std::string get( const IniConfigFile *ini, const char *section, const char *key,
+                            const std::string &defValue )
+    {
+        char buffer[INICONFIGFILE_BUFFERSIZE];
+
+        IniConfigFile_getString( ini, section, key, defValue.c_str(), buffer, INICONFIGFILE_BUFFERSIZE );
+
+        return buffer;
+    }
+};
+
+#if __cplusplus >= 201103L
+
+/*!
+ * \brief Reads durations with units, see IniConfigFile_getDuration()
+ */
+template <typename Rep, typename Period>
+struct CppIniConfigValue<std::chrono::duration<Rep, Period> >
+{
+    typedef std::chrono::duration<Rep, Period> Duration;
+
+    static Duration get( const IniConfigFile *ini, const char *section, const char *key, const Duration &defValue )
+    {
+        const long long missing = (long long)0x8000000000000000ULL;
+        long long ns = IniConfigFile_getDuration( ini, section, key, missing );
+
+        if( ns == missing )
+        {
+            return defValue;
+        }
+
+        return std::chrono::duration_cast<Duration>( std::chrono::nanoseconds( ns ) );
+    }
+};
+
+#endif
+
+/*!
+ * \brief Keeps CppIniConfigFile::get<T>() from deducing T from its default
+ */
+template <typename T>
+struct CppIniConfigIdentity
+{
+    typedef T Type;
+};
 
 
 /*!
@@ -29,9 +357,199 @@ class CppIniConfigFile
     private:
     IniConfigFile *ini;                 /**< Instance pointer */
     std::string fileName;               /**< Store the ini file name */
+    bool valid;                         /**< The constructor read its input */
+
+    /*!
+     * \brief Record the outcome of a constructor
+     *
+     * An instance whose input could not be read or parsed is initialized
+     * as an empty file, so that the object stays usable and destructible.
+     */
+    void setValid( bool initialized )
+    {
+        valid = initialized;
+
+        if( !valid )
+        {
+            bool empty = IniConfigFile_initFromBuffer( ini, "", 0, true );
+
+            ANY_REQUIRE_MSG( empty, "Unable to initialize an empty file" );
+        }
+    }
+
+    /*!
+     * \brief Copy a value found by getBatch()
+     */
+    static void assign( void *context, unsigned int i, const char *value )
+    {
+        if( value != NULL )
+        {
+            ( *static_cast<std::vector<std::string> *>( context ) )[i] = value;
+        }
+    }
 
     public:
 
+    /*!
+     * \brief View on the keys of one section
+     *
+     * \see section(), \ref IniConfigSection
+     */
+    class Section
+    {
+        private:
+        IniConfigSection view;          /**< C view */
+
+        public:
+
+        /*!
+         * \brief Create a view on a section of a file
+         *
+         * \param file  the file, must outlive the view
+         * \param name  the section name
+         */
+        Section( const CppIniConfigFile
+        &file,
+        const std::string
+        &name )
+        {
+            IniConfigSection_init( &view, file.ini, name.c_str() );
+        }
+
+        /*!
+         * \brief Copy a view
+         */
+        Section( const Section &other )
+        {
+            IniConfigSection_init( &view, other.view.file, other.view.name );
+        }
+
+        /*!
+         * \brief Assign a view
+         */
+        Section &operator=( const Section &other )
+        {
+            if( this != &other )
+            {
+                IniConfigSection_clear( &view );
+                IniConfigSection_init( &view, other.view.file, other.view.name );
+            }
+
+            return *this;
+        }
+
+        /*!
+         * \brief Destructor
+         */
+        ~Section()
+        {
+            IniConfigSection_clear( &view );
+        }
+
+        /*!
+         * \brief Get a double
+         */
+        double get( const std::string
+        &key,
+        double defValue = 0.0 ) const
+        {
+            return IniConfigSection_getDouble( &view, key.c_str(), defValue );
+        }
+
+        /*!
+         * \brief Get a long
+         */
+        long get( const std::string
+        &key,
+        long defValue ) const
+        {
+            return IniConfigSection_getLong( &view, key.c_str(), defValue );
+        }
+
+        /*!
+         * \brief Get an int
+         */
+        int get( const std::string
+        &key,
+        int defValue ) const
+        {
+            return IniConfigSection_getInt( &view, key.c_str(), defValue );
+        }
+
+        /*!
+         * \brief Get a string
+         */
+        std::string
+        get(
+        const std::string
+        &key,
+        const std::string
+        &defValue ) const
+        {
+            char buffer[INICONFIGFILE_BUFFERSIZE];
+
+            IniConfigSection_getString( &view, key.c_str(), defValue.c_str(), buffer, INICONFIGFILE_BUFFERSIZE );
+
+            return buffer;
+        }
+
+        /*!
+         * \brief Get the name of a key of the section
+         *
+         * \param idx  the zero-based number of the key
+         *
+         * \return The key name, empty after the last key
+         */
+        std::string getKey( int idx ) const
+        {
+            char buffer[INICONFIGFILE_BUFFERSIZE];
+
+            IniConfigSection_getKey( &view, idx, buffer, INICONFIGFILE_BUFFERSIZE );
+
+            return buffer;
+        }
+
+        /*!
+         * \brief Write a long
+         */
+        bool put( const std::string
+        &key,
+        long value ) const
+        {
+            return IniConfigSection_putLong( &view, key.c_str(), value );
+        }
+
+        /*!
+         * \brief Write a double
+         */
+        bool put( const std::string
+        &key,
+        double value ) const
+        {
+            return IniConfigSection_putDouble( &view, key.c_str(), value );
+        }
+
+        /*!
+         * \brief Write a string
+         */
+        bool put( const std::string
+        &key,
+        const std::string
+        &value ) const
+        {
+            return IniConfigSection_putString( &view, key.c_str(), value.c_str() );
+        }
+
+        /*!
+         * \brief Remove a key
+         */
+        void removeKey( const std::string
+        &key ) const
+        {
+            IniConfigSection_removeKey( &view, key.c_str() );
+        }
+    };
+
     /*!
      * \brief Constructor
      *
@@ -47,10 +565,113 @@ class CppIniConfigFile
         ANY_REQUIRE( ini );
 
         fileName = filename;
+        valid = true;
 
         IniConfigFile_init( ini, fileName.c_str());
     }
 
+    /*!
+     * \brief Constructor for a file loaded and saved through a backend
+     *
+     * \param filename Name of the file within the backend
+     * \param backend  backend to use, it must outlive the object
+     *
+     * Files of backends which are not on disk are loaded right away; if
+     * that fails, isValid() returns false and the object holds an empty
+     * file.
+     *
+     * \see IniConfigFile_initWithBackend()
+     */
+    CppIniConfigFile( const std::string &filename, const IniConfigBackend *backend )
+    {
+        ini = IniConfigFile_new();
+        ANY_REQUIRE( ini );
+
+        fileName = filename;
+
+        setValid( IniConfigFile_initWithBackend( ini, fileName.c_str(), backend ) );
+    }
+
+    /*!
+     * \brief Constructor for INI contents in memory
+     *
+     * \param buffer INI file contents
+     * \param length number of bytes in buffer
+     * \param borrow use buffer in place, it must then outlive the object
+     *
+     * The contents are parsed right away, the object behaves like a loaded
+     * file which cannot be saved. If they cannot be parsed, isValid()
+     * returns false and the object holds an empty file.
+     *
+     * \see IniConfigFile_initFromBuffer()
+     */
+    CppIniConfigFile( const char *buffer, size_t length, bool borrow )
+    {
+        ini = IniConfigFile_new();
+        ANY_REQUIRE( ini );
+
+        setValid( IniConfigFile_initFromBuffer( ini, buffer, length, borrow ) );
+    }
+
+#if __cplusplus >= 201703L
+
+    /*!
+     * \brief Constructor for INI contents in memory
+     *
+     * \param text   INI file contents
+     * \param borrow use text in place, it must then outlive the object
+     *
+     * \see IniConfigFile_initFromBuffer()
+     */
+    CppIniConfigFile( std::string_view text, bool borrow )
+    {
+        ini = IniConfigFile_new();
+        ANY_REQUIRE( ini );
+
+        setValid( IniConfigFile_initFromBuffer( ini, text.data(), text.size(), borrow ) );
+    }
+
+#endif
+
+    /*!
+     * \brief Constructor reading a file descriptor
+     *
+     * \param fd file descriptor of a file, pipe or socket, read up to its
+     *           end and left open
+     *
+     * A read error, e.g. EAGAIN on a non-blocking descriptor or EIO, makes
+     * isValid() return false and leaves the object with an empty file.
+     *
+     * \see IniConfigFile_initFromFd()
+     */
+    explicit CppIniConfigFile( int fd )
+    {
+        ini = IniConfigFile_new();
+        ANY_REQUIRE( ini );
+
+        setValid( IniConfigFile_initFromFd( ini, fd ) );
+    }
+
+    /*!
+     * \brief Tell whether the constructor could read its input
+     *
+     * \code
+     *  CppIniConfigFile myIniFile( fd );
+     *
+     *  if( !myIniFile.isValid() )
+     *  {
+     *    ANY_LOG( 0, "Unable to read the configuration", ANY_LOG_ERROR );
+     *  }
+     * \endcode
+     *
+     * \return false if the buffer, descriptor or backend constructor failed
+     *         to read or parse its input, true otherwise
+     */
+    bool isValid( void ) const
+    {
+        return valid;
+    }
+
     /*!
      * \brief Destructor
      *
@@ -65,6 +686,93 @@ class CppIniConfigFile
         IniConfigFile_delete( ini );
     }
 
+    /*!
+     * \brief Check and convert the encoding of the file when loading it
+     *
+     * \param flags or-ed IniConfigTextFlags
+     *
+     * \see IniConfigFile_setTextFlags()
+     */
+    void setTextFlags( int flags )
+    {
+        IniConfigFile_setTextFlags( ini, flags );
+    }
+
+    /*!
+     * \brief Line which made the last load() fail the checks of setTextFlags()
+     *
+     * \return The line number starting at 1, 0 if the last load passed them
+     */
+    int getInvalidLine( void ) const
+    {
+        return IniConfigFile_getInvalidLine( ini );
+    }
+
+    /*!
+     * \brief Load the whole file into memory
+     *
+     * After this call all get and put methods work on an in-memory copy of
+     * the file, which is written back with save().
+     *
+     * \code
+     *  CppIniConfigFile myIniFile( "myConfig.ini" );
+     *
+     *  myIniFile.load();
+     *  myIniFile.put( "MySection", "LongValue", 1234567L );
+     *  myIniFile.save();
+     * \endcode
+     *
+     * \return true if successful, false otherwise
+     *
+     * \see save()
+     */
+    bool load( void )
+    {
+        return IniConfigFile_load( ini );
+    }
+
+    /*!
+     * \brief Write the in-memory document back to the file
+     *
+     * Only the modified lines are re-serialized, comments and the layout of
+     * all other lines are preserved.
+     *
+     * \return true if successful, false otherwise
+     *
+     * \see load()
+     */
+    bool save( void )
+    {
+        return IniConfigFile_save( ini );
+    }
+
+    /*!
+     * \brief Write pending puts back to the file if there are any
+     *
+     * Cheap to call periodically, the file is not touched if nothing has
+     * changed since the last save.
+     *
+     * \return true if successful, false otherwise
+     *
+     * \see save()
+     */
+    bool persist( void )
+    {
+        return IniConfigFile_persist( ini );
+    }
+
+    /*!
+     * \brief Serialize writes with other processes updating the same file
+     *
+     * \param locking true to take the advisory file lock around every write
+     *
+     * \see IniConfigFile_setLocking()
+     */
+    void setLocking( bool locking )
+    {
+        IniConfigFile_setLocking( ini, locking );
+    }
+
     /*!
      * \brief Get a double
      *
@@ -92,105 +800,323 @@ class CppIniConfigFile
     &key,
     double defValue = 0.0 ) const
     {
-        return IniConfigFile_getDouble( ini, section.c_str(), key.c_str(), defValue );
+        return IniConfigFile_getDouble( ini, section.c_str(), key.c_str(), defValue );
+    }
+
+    /*!
+     * \brief Get a long
+     *
+     * \param section the name of the section to search for
+     * \param key the name of the entry to find the value of
+     * \param defValue the default value in the event of a failed read
+     *
+     * This method return the corresponding key long value from the requested section. If the value doesn't
+     * exist it will return the specified default value
+     *
+     * \code
+     *  IniConfigFile myIniFile( "myConfig.ini" );
+     *  long myLongValue = 0;
+     *
+     *  myLongValue = myIniFile.getLong( "MySection", "LongValue", 0 );
+     *
+     *  ANY_LOG( 0, "myLongValue is %ld", ANY_LOG_INFO, myLongValue );
+     * \endcode
+     *
+     * \return The value located at Key
+     */
+    long get( const std::string
+    &section,
+    const std::string
+    &key,
+    long defValue = 0 ) const
+    {
+        return IniConfigFile_getLong( ini, section.c_str(), key.c_str(), defValue );
+    }
+
+    /*!
+     * \brief Get a int
+     *
+     * \param section the name of the section to search for
+     * \param key the name of the entry to find the value of
+     * \param defValue the default value in the event of a failed read
+     *
+     * This method return the corresponding key int value from the requested section. If the value doesn't
+     * exist it will return the specified default value
+     *
+     * \code
+     *  IniConfigFile myIniFile( "myConfig.ini" );
+     *  int myIntValue = 0;
+     *
+     *  myIntValue = myIniFile.getInt( "MySection", "IntValue", 0 );
+     *
+     *  ANY_LOG( 0, "myIntValue is %d", ANY_LOG_INFO, myIntValue );
+     * \endcode
+     *
+     * \return The value located at Key
+     */
+    int get( const std::string
+    &section,
+    const std::string
+    &key,
+    int defValue = 0 ) const
+    {
+        return IniConfigFile_getLong( ini, section.c_str(), key.c_str(), (long)defValue );
+    }
+
+    /*!
+     * \brief Get a string
+     *
+     * \param section the name of the section to search for
+     * \param key the name of the entry to find the value of
+     * \param defValue the default value in the event of a failed read
+     *
+     * This method return the corresponding key string value from the requested section. If the value doesn't
+     * exist it will return the specified default value
+     *
+     * \code
+     *  IniConfigFile myIniFile( "myConfig.ini" );
+     *  std::string myString;
+     *
+     *  myString = myIniFile.getString( "MySection", "StringValue", "" );
+     *
+     *  ANY_LOG( 0, "myString is %s", ANY_LOG_INFO, myString.c_str() );
+     * \endcode
+     *
+     * \return The value located at Key
+     */
+    std::string
+    get(
+    const std::string
+    &section,
+    const std::string
+    &key,
+    const std::string
+    &defValue = "" ) const
+    {
+        char buffer[INICONFIGFILE_BUFFERSIZE];
+
+        IniConfigFile_getString( ini, section.c_str(), key.c_str(), defValue.c_str(), buffer,
+                                 INICONFIGFILE_BUFFERSIZE );
+
+        return buffer;
+    }
+
+    /*!
+     * \brief Get a value of any type
+     *
+     * \param section the name of the section to search for
+     * \param key the name of the entry to find the value of
+     * \param defValue the default value in the event of a failed read
+     *
+     * T must be named explicitly. Besides double, long, int and std::string
+     * it may be a std::chrono::duration or a type CppIniConfigValue knows.
+     *
+     * \code
+     *  std::chrono::milliseconds timeout = myIniFile.get<std::chrono::milliseconds>( "Network", "Timeout" );
+     * \endcode
+     *
+     * \return The value located at Key
+     */
+    template <typename T>
+    T get( const std::string &section, const std::string &key,
+           const typename CppIniConfigIdentity<T>::Type &defValue = T() ) const
+    {
+        return CppIniConfigValue<T>::get( ini, section.c_str(), key.c_str(), defValue );
+    }
+
+#if __cplusplus >= 201103L
+
+    /*!
+     * \brief Get a duration
+     *
+     * \param section the name of the section to search for
+     * \param key the name of the entry to find the value of
+     * \param defValue the default value in the event of a failed read
+     *
+     * \code
+     *  auto period = myIniFile.get( "Loop", "Period", std::chrono::microseconds( 1000 ) );
+     * \endcode
+     *
+     * \return The duration located at Key, in the type of defValue
+     *
+     * \see IniConfigFile_getDuration()
+     */
+    template <typename Rep, typename Period>
+    std::chrono::duration<Rep, Period> get( const std::string &section, const std::string &key,
+                                            const std::chrono::duration<Rep, Period> &defValue ) const
+    {
+        return CppIniConfigValue<std::chrono::duration<Rep, Period> >::get( ini, section.c_str(), key.c_str(),
+                                                                           defValue );
+    }
+
+#endif
+
+    /*!
+     * \brief Decode a binary value into a buffer
+     *
+     * \return The size of the value, -1 if it does not exist or is not valid
+     *
+     * \see IniConfigFile_getBlob()
+     */
+    long getBlob( const std::string &section, const std::string &key, void *buffer, size_t bufferSize,
+                  int encoding = INICONFIGBLOB_BASE64 ) const
+    {
+        return IniConfigFile_getBlob( ini, section.c_str(), key.c_str(), encoding, buffer, bufferSize );
+    }
+
+    /*!
+     * \brief Decode a binary value
+     *
+     * \code
+     *  std::vector<unsigned char> table = myIniFile.getBlob( "Firmware", "Table" );
+     * \endcode
+     *
+     * \return The bytes of the value, none if it does not exist or is not valid
+     *
+     * \see IniConfigFile_getBlob()
+     */
+    std::vector<unsigned char> getBlob( const std::string &section, const std::string &key,
+                                        int encoding = INICONFIGBLOB_BASE64 ) const
+    {
+        std::vector<unsigned char> bytes;
+        long size = IniConfigFile_getBlob( ini, section.c_str(), key.c_str(), encoding, NULL, 0 );
+
+        /* a put between both calls may change the size */
+        while( size > 0 )
+        {
+            bytes.resize( (size_t)size );
+            size = IniConfigFile_getBlob( ini, section.c_str(), key.c_str(), encoding, &bytes[0], bytes.size() );
+
+            if( size < 0 || (size_t)size <= bytes.size() )
+            {
+                break;
+            }
+        }
+
+        bytes.resize( ( size > 0 ) ? (size_t)size : 0 );
+
+        return bytes;
+    }
+
+    /*!
+     * \brief Encode and write a binary value
+     *
+     * \return true if successful, false otherwise
+     *
+     * \see IniConfigFile_putBlob()
+     */
+    bool putBlob( const std::string &section, const std::string &key, const void *data, size_t size,
+                  int encoding = INICONFIGBLOB_BASE64 ) const
+    {
+        return IniConfigFile_putBlob( ini, section.c_str(), key.c_str(), encoding, data, size ) != 0;
+    }
+
+    /*!
+     * \brief Encode and write a binary value
+     *
+     * \return true if successful, false otherwise
+     */
+    bool putBlob( const std::string &section, const std::string &key, const std::vector<unsigned char> &bytes,
+                  int encoding = INICONFIGBLOB_BASE64 ) const
+    {
+        return putBlob( section, key, bytes.empty() ? NULL : &bytes[0], bytes.size(), encoding );
+    }
+
+    /*!
+     * \brief Get a duration in nanoseconds
+     *
+     * \see IniConfigFile_getDuration()
+     */
+    long long getDuration( const std::string &section, const std::string &key, long long defValue = 0 ) const
+    {
+        return IniConfigFile_getDuration( ini, section.c_str(), key.c_str(), defValue );
+    }
+
+    /*!
+     * \brief Get a size in bytes
+     *
+     * \see IniConfigFile_getByteSize()
+     */
+    long long getByteSize( const std::string &section, const std::string &key, long long defValue = 0 ) const
+    {
+        return IniConfigFile_getByteSize( ini, section.c_str(), key.c_str(), defValue );
     }
 
     /*!
-     * \brief Get a long
-     *
-     * \param section the name of the section to search for
-     * \param key the name of the entry to find the value of
-     * \param defValue the default value in the event of a failed read
-     *
-     * This method return the corresponding key long value from the requested section. If the value doesn't
-     * exist it will return the specified default value
-     *
-     * \code
-     *  IniConfigFile myIniFile( "myConfig.ini" );
-     *  long myLongValue = 0;
-     *
-     *  myLongValue = myIniFile.getLong( "MySection", "LongValue", 0 );
-     *
-     *  ANY_LOG( 0, "myLongValue is %ld", ANY_LOG_INFO, myLongValue );
-     * \endcode
+     * \brief Get a frequency in hertz
      *
-     * \return The value located at Key
+     * \see IniConfigFile_getFrequency()
      */
-    long get( const std::string
-    &section,
-    const std::string
-    &key,
-    long defValue = 0 ) const
+    double getFrequency( const std::string &section, const std::string &key, double defValue = 0.0 ) const
     {
-        return IniConfigFile_getLong( ini, section.c_str(), key.c_str(), defValue );
+        return IniConfigFile_getFrequency( ini, section.c_str(), key.c_str(), defValue );
     }
 
     /*!
-     * \brief Get a int
+     * \brief Get the values of many keys at once
      *
-     * \param section the name of the section to search for
-     * \param key the name of the entry to find the value of
-     * \param defValue the default value in the event of a failed read
+     * \param sections  the section of every key
+     * \param keys      the keys, as many as sections
+     * \param defValue  the value of keys which do not exist
      *
-     * This method return the corresponding key int value from the requested section. If the value doesn't
-     * exist it will return the specified default value
+     * Requires load(). Much faster than one get() per key from a few dozen
+     * keys on, see IniConfigFile_getBatch().
      *
      * \code
-     *  IniConfigFile myIniFile( "myConfig.ini" );
-     *  int myIntValue = 0;
-     *
-     *  myIntValue = myIniFile.getInt( "MySection", "IntValue", 0 );
-     *
-     *  ANY_LOG( 0, "myIntValue is %d", ANY_LOG_INFO, myIntValue );
+     *  std::vector<std::string> values = myIniFile.getBatch( sections, keys );
      * \endcode
      *
-     * \return The value located at Key
+     * \return The values, in the order of the keys
      */
-    int get( const std::string
-    &section,
+    std::vector<std::string>
+    getBatch(
+    const std::vector<std::string>
+    &sections,
+    const std::vector<std::string>
+    &keys,
     const std::string
-    &key,
-    int defValue = 0 ) const
+    &defValue = "" ) const
     {
-        return IniConfigFile_getLong( ini, section.c_str(), key.c_str(), (long)defValue );
+        std::vector<const char *> sectionNames( sections.size() );
+        std::vector<const char *> keyNames( keys.size() );
+        std::vector<std::string> values( keys.size(), defValue );
+        size_t i = 0;
+
+        ANY_REQUIRE( sections.size() == keys.size() );
+
+        for( i = 0; i < keys.size(); i++ )
+        {
+            sectionNames[i] = sections[i].c_str();
+            keyNames[i] = keys[i].c_str();
+        }
+
+        if( !keys.empty() )
+        {
+            IniConfigFile_getBatch( ini, (unsigned int)keys.size(), &sectionNames[0], &keyNames[0],
+                                    CppIniConfigFile::assign, &values );
+        }
+
+        return values;
     }
 
     /*!
-     * \brief Get a string
-     *
-     * \param section the name of the section to search for
-     * \param key the name of the entry to find the value of
-     * \param defValue the default value in the event of a failed read
+     * \brief Get a view on the keys of one section
      *
-     * This method return the corresponding key string value from the requested section. If the value doesn't
-     * exist it will return the specified default value
+     * \param name  the section name
      *
      * \code
-     *  IniConfigFile myIniFile( "myConfig.ini" );
-     *  std::string myString;
-     *
-     *  myString = myIniFile.getString( "MySection", "StringValue", "" );
+     *  CppIniConfigFile::Section arm = myIniFile.section( "Arm" );
      *
-     *  ANY_LOG( 0, "myString is %s", ANY_LOG_INFO, myString.c_str() );
+     *  kp = arm.get( "kp", 1.0 );
+     *  ki = arm.get( "ki", 0.0 );
      * \endcode
      *
-     * \return The value located at Key
+     * \return The view, valid as long as this object
      */
-    std::string
-    get(
-    const std::string
-    &section,
-    const std::string
-    &key,
-    const std::string
-    &defValue = "" ) const
+    Section section( const std::string
+    &name ) const
     {
-        char buffer[INICONFIGFILE_BUFFERSIZE];
-
-        IniConfigFile_getString( ini, section.c_str(), key.c_str(), defValue.c_str(), buffer,
-                                 INICONFIGFILE_BUFFERSIZE );
-
-        return buffer;
+        return Section( *this, name );
     }
 
     /*!
@@ -277,6 +1203,32 @@ class CppIniConfigFile
         return buffer;
     }
 
+    /*!
+     * \brief Return the number of sections
+     *
+     * \return The number of sections getSection() returns
+     *
+     * \see countKeys()
+     */
+    int countSections() const
+    {
+        return IniConfigFile_countSections( ini );
+    }
+
+    /*!
+     * \brief Return the number of keys in a section
+     *
+     * \param section the name of the section
+     *
+     * \return The number of keys getKey() returns for the section
+     *
+     * \see countSections()
+     */
+    int countKeys( const std::string &section ) const
+    {
+        return IniConfigFile_countKeys( ini, section.c_str() );
+    }
+
     /*!
      * \brief Write a long value using the specified key into a section
      *
@@ -381,6 +1333,320 @@ class CppIniConfigFile
         return IniConfigFile_putString( ini, section.c_str(), key.c_str(), value.c_str());
     }
 
+    /*!
+     * \brief Return the generation of a key
+     *
+     * \param section     the name of the section
+     * \param key         the name of the entry
+     *
+     * Requires load(). Read the generation before the value it guards.
+     *
+     * \return The generation of the last put to the key, 0 if never put
+     *
+     * \see compareAndPut()
+     */
+    unsigned long getGeneration( const std::string
+    &section,
+    const std::string
+    &key ) const
+    {
+        return IniConfigFile_getGeneration( ini, section.c_str(), key.c_str());
+    }
+
+    /*!
+     * \brief Return the generation of the whole document
+     *
+     * \return The generation of the last put to any key
+     *
+     * \see compareAndPut()
+     */
+    unsigned long getGeneration( void ) const
+    {
+        return IniConfigFile_getGeneration( ini, NULL, NULL );
+    }
+
+    /*!
+     * \brief Write a string value only if nobody changed it in the meantime
+     *
+     * \param section        the name of the section to write the value in
+     * \param key            the name of the entry to write
+     * \param value          the value to write
+     * \param generation     the generation observed by the caller
+     * \param wholeDocument  compare against the document generation instead of the key generation
+     *
+     * \code
+     *  CppIniConfigFile myIniFile( "myConfig.ini" );
+     *  unsigned long generation = 0;
+     *  long count = 0;
+     *
+     *  myIniFile.load();
+     *
+     *  do
+     *  {
+     *    generation = myIniFile.getGeneration( "Stats", "count" );
+     *    count = myIniFile.get( "Stats", "count", 0L );
+     *  }
+     *  while( !myIniFile.compareAndPut( "Stats", "count", std::to_string( count + 1 ), generation ) );
+     * \endcode
+     *
+     * \return true if the value has been written, false if it had changed
+     *
+     * \see IniConfigFile_putIfUnchanged()
+     */
+    bool compareAndPut( const std::string
+    &section,
+    const std::string
+    &key,
+    const std::string
+    &value,
+    unsigned long generation,
+    bool wholeDocument = false ) const
+    {
+        if( wholeDocument )
+        {
+            return IniConfigFile_putIfDocumentUnchanged( ini, section.c_str(), key.c_str(), value.c_str(),
+                                                         generation );
+        }
+
+        return IniConfigFile_putIfUnchanged( ini, section.c_str(), key.c_str(), value.c_str(), generation );
+    }
+
+    /*!
+     * \brief Capture all values
+     *
+     * \param snapshot  receives the values, a previous capture is dropped
+     *
+     * Requires load(). The snapshot shares all values with the file, so
+     * taking it does not depend on the size of the file.
+     *
+     * \code
+     *  CppIniConfigFile myIniFile( "myConfig.ini" );
+     *  CppIniConfigSnapshot before;
+     *
+     *  myIniFile.load();
+     *  myIniFile.snapshot( before );
+     *  myIniFile.put( "Arm", "gain", 2.5 );
+     *  myIniFile.rollback( before );
+     * \endcode
+     *
+     * \return true on success, false otherwise
+     *
+     * \see rollback()
+     */
+    bool snapshot( CppIniConfigSnapshot
+    &snapshot ) const
+    {
+        return IniConfigFile_snapshot( ini, snapshot.snapshot );
+    }
+
+    /*!
+     * \brief Put back the values of a snapshot
+     *
+     * \param snapshot  a snapshot taken from this file
+     *
+     * Only the keys which differ from the snapshot are written.
+     *
+     * \return true on success, false otherwise
+     */
+    bool rollback( const CppIniConfigSnapshot
+    &snapshot )
+    {
+        return IniConfigFile_rollback( ini, snapshot.snapshot );
+    }
+
+    /*!
+     * \brief Copy all values into an index for real-time readers
+     *
+     * \param index  receives the values, a previous build is dropped
+     * \param flags  or-ed IniConfigIndexFlags
+     *
+     * Requires load().
+     *
+     * \return true on success, false otherwise
+     */
+    bool buildIndex( CppIniConfigIndex
+    &index,
+    int flags = INICONFIGINDEX_NONE )
+    {
+        return IniConfigFile_buildIndex( ini, index.index, flags );
+    }
+
+    /*!
+     * \brief Choose how the indexes of frozen and double-buffered files are mapped
+     *
+     * \param flags  or-ed IniConfigIndexFlags, e.g. INICONFIGINDEX_HUGEPAGES
+     *
+     * \see IniConfigFile_setIndexFlags()
+     */
+    void setIndexFlags( int flags )
+    {
+        IniConfigFile_setIndexFlags( ini, flags );
+    }
+
+    /*!
+     * \brief Make the loaded file read-only before forking workers
+     *
+     * Afterwards no get writes to the values, so forked processes keep
+     * sharing their pages with their parent. Puts fail until the next
+     * load().
+     *
+     * \return true on success, false otherwise
+     *
+     * \see IniConfigFile_freeze()
+     */
+    bool freeze( void )
+    {
+        return IniConfigFile_freeze( ini );
+    }
+
+    /*!
+     * \brief Reload the frozen file while other threads read it
+     *
+     * Gets answer from the old version until the new one has been loaded
+     * completely, then from the new one.
+     *
+     * \return true on success, false if the file cannot be loaded
+     *
+     * \see IniConfigFile_refreeze()
+     */
+    bool refreeze( void )
+    {
+        return IniConfigFile_refreeze( ini );
+    }
+
+    /*!
+     * \brief Load the file as a frozen copy shared with the other files of
+     *        the process
+     *
+     * Calling it again switches to the latest version of the file.
+     *
+     * \return true on success, false otherwise
+     *
+     * \see IniConfigFile_loadShared()
+     */
+    bool loadShared( void )
+    {
+        return IniConfigFile_loadShared( ini );
+    }
+
+    /*!
+     * \brief Get notified of new versions of the shared file
+     *
+     * \param listener called after a new version has been loaded, NULL for
+     *                 no notifications
+     * \param context  passed to listener
+     *
+     * \return true on success, false otherwise
+     *
+     * \see IniConfigFile_setListener()
+     */
+    bool setListener( IniConfigRegistryListener listener, void *context )
+    {
+        return IniConfigFile_setListener( ini, listener, context );
+    }
+
+    /*!
+     * \brief Keep a copy of a frozen file in the memory of every NUMA node
+     *
+     * \param enable  true for one copy per node, takes effect at the next freeze()
+     *
+     * \see IniConfigFile_setNumaReplicas()
+     */
+    void setNumaReplicas( bool enable )
+    {
+        IniConfigFile_setNumaReplicas( ini, enable );
+    }
+
+    /*!
+     * \brief Keep the numbers of every section in contiguous columns
+     *
+     * \param enable  true to build the columns at every load()
+     *
+     * \see IniConfigFile_setColumnar()
+     */
+    void setColumnar( bool enable )
+    {
+        IniConfigFile_setColumnar( ini, enable );
+    }
+
+    /*!
+     * \brief Get all numeric values of a section without copying them
+     *
+     * \param section  the section name
+     * \param span     receives the key names and values in key order
+     *
+     * \code
+     *  IniConfigColumnsSpan span;
+     *
+     *  myIniFile.setColumnar( true );
+     *  myIniFile.load();
+     *
+     *  if( myIniFile.getColumns( "Calibration", span ) )
+     *  {
+     *    applyOffsets( span.doubles, span.count );
+     *  }
+     * \endcode
+     *
+     * \return true if the section has numeric keys
+     *
+     * \see IniConfigFile_getColumns()
+     */
+    bool getColumns( const std::string &section, IniConfigColumnsSpan &span ) const
+    {
+        return IniConfigFile_getColumns( ini, section.c_str(), &span );
+    }
+
+    /*!
+     * \brief Let one consumer thread read a version that changes only at its safe points
+     *
+     * \param enable  true to switch double buffering on
+     * \param flags   or-ed IniConfigIndexFlags of the published versions
+     *
+     * \code
+     *  CppIniConfigFile myIniFile( "myConfig.ini" );
+     *
+     *  myIniFile.setDoubleBuffering( true );
+     *  myIniFile.load();
+     *
+     *  // control loop
+     *  for( ;; )
+     *  {
+     *    myIniFile.sync();
+     *    kp = myIniFile.get( "Pid", "kp", 1.0 );
+     *  }
+     * \endcode
+     *
+     * \return true on success, false otherwise
+     *
+     * \see IniConfigFile_setDoubleBuffering()
+     */
+    bool setDoubleBuffering( bool enable, int flags = INICONFIGINDEX_NONE )
+    {
+        return IniConfigFile_setDoubleBuffering( ini, enable, flags );
+    }
+
+    /*!
+     * \brief Turn the puts made so far into the version the next sync() installs
+     *
+     * \return true on success, false otherwise
+     */
+    bool publish( void )
+    {
+        return IniConfigFile_publish( ini );
+    }
+
+    /*!
+     * \brief Switch the consumer thread to the latest published version
+     *
+     * Wait-free, only the consumer thread may call it.
+     *
+     * \return true if a newer version has been installed
+     */
+    bool sync( void )
+    {
+        return IniConfigFile_sync( ini );
+    }
+
     /*!
      * \brief Remove the requested key from the given section
      *
@@ -0,0 +1,719 @@
+/*
+ *  Atomic replacement of INI files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <Any.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <IniConfigAtomicFile.h>
+
+#define INICONFIGATOMICFILE_VALID       0x7a70f11e
+#define INICONFIGATOMICFILE_INVALID     0xb00db00f
+
+#define INICONFIGCOMMITGROUP_VALID      0x6c0aa17e
+#define INICONFIGCOMMITGROUP_INVALID    0xb00db00f
+
+#define INICONFIGATOMICFILE_MAXRETRIES  100
+
+
+/*
+ * Private functions
+ */
+
+static bool IniConfigAtomicFile_openNamed( IniConfigAtomicFile *self )
+{
+    self->fd = mkstemp( self->tempName );
+
+    return ( self->fd != -1 );
+}
+
+
+static bool IniConfigAtomicFile_openAnonymous( IniConfigAtomicFile *self )
+{
+#if defined(O_TMPFILE)
+    /* linkat() needs /proc to give the file a name later on */
+    if( access( "/proc/self/fd", X_OK ) != 0 )
+    {
+        return false;
+    }
+
+    self->fd = open( self->dirName, O_TMPFILE | O_WRONLY | O_CLOEXEC, 0600 );
+    self->anonymous = ( self->fd != -1 );
+
+    return self->anonymous ? true : false;
+#else
+    return false;
+#endif
+}
+
+
+/*
+ * Fills the trailing "XXXXXX" of the temporary name with a fresh suffix
+ */
+static void IniConfigAtomicFile_randomizeName( IniConfigAtomicFile *self, unsigned int attempt )
+{
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    char *suffix = self->tempName + strlen( self->tempName ) - 6;
+    struct timespec ts;
+    unsigned long long seed = 0;
+    int i = 0;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    seed = (unsigned long long)ts.tv_nsec ^ ( (unsigned long long)getpid() << 20 ) ^ ( attempt * 0x9e3779b97f4a7c15ULL );
+
+    for( i = 0; i < 6; i++ )
+    {
+        suffix[i] = letters[seed % ( sizeof( letters ) - 1 )];
+        seed /= ( sizeof( letters ) - 1 );
+    }
+}
+
+
+static bool IniConfigAtomicFile_link( IniConfigAtomicFile *self )
+{
+    char procPath[64];
+    unsigned int attempt = 0;
+
+    Any_snprintf( procPath, 64, "/proc/self/fd/%d", self->fd );
+
+    for( attempt = 0; attempt < INICONFIGATOMICFILE_MAXRETRIES; attempt++ )
+    {
+        IniConfigAtomicFile_randomizeName( self, attempt );
+
+        if( linkat( AT_FDCWD, procPath, AT_FDCWD, self->tempName, AT_SYMLINK_FOLLOW ) == 0 )
+        {
+            self->anonymous = 0;
+            return true;
+        }
+
+        if( errno != EEXIST )
+        {
+            break;
+        }
+    }
+
+    return false;
+}
+
+
+static bool IniConfigAtomicFile_flushData( IniConfigAtomicFile *self )
+{
+    while( fdatasync( self->fd ) != 0 )
+    {
+        if( errno != EINTR )
+        {
+            ANY_LOG( 0, "Unable to flush the data of '%s'", ANY_LOG_ERROR, self->fileName );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static bool IniConfigAtomicFile_flushDirectory( const char *dirName )
+{
+    bool retVal = true;
+    int fd = open( dirName, O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+
+    if( fd == -1 )
+    {
+        return false;
+    }
+
+    if( fsync( fd ) != 0 && errno != EINVAL )
+    {
+        ANY_LOG( 0, "Unable to flush the directory '%s'", ANY_LOG_ERROR, dirName );
+        retVal = false;
+    }
+
+    close( fd );
+
+    return retVal;
+}
+
+
+/*
+ * Gives the temporary file its name, closes it and renames it over the
+ * destination
+ */
+static bool IniConfigAtomicFile_replace( IniConfigAtomicFile *self )
+{
+    int status = 0;
+
+    if( self->anonymous && !IniConfigAtomicFile_link( self ) )
+    {
+        ANY_LOG( 0, "Unable to link the temporary file of '%s'", ANY_LOG_ERROR, self->fileName );
+        IniConfigAtomicFile_abort( self );
+        return false;
+    }
+
+    status = close( self->fd );
+    self->fd = -1;
+
+    if( status != 0 || rename( self->tempName, self->fileName ) != 0 )
+    {
+        ANY_LOG( 0, "Unable to replace '%s'", ANY_LOG_ERROR, self->fileName );
+        unlink( self->tempName );
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigAtomicFile *IniConfigAtomicFile_new( void )
+{
+    return ( ANY_TALLOC( IniConfigAtomicFile ) );
+}
+
+
+bool IniConfigAtomicFile_init( IniConfigAtomicFile *self, const char *fileName )
+{
+    const char *base = NULL;
+    size_t dirLength = 0;
+    struct stat st;
+    mode_t mask = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( fileName );
+
+    self->valid = INICONFIGATOMICFILE_INVALID;
+    self->fd = -1;
+    self->anonymous = 0;
+    self->durability = INICONFIGATOMICFILE_DURABILITY_NONE;
+    self->fileName = Any_strdup( (char*)fileName );
+
+    /* "dir/~name.XXXXXX" next to the destination, so rename() stays atomic */
+    base = strrchr( fileName, '/' );
+    base = ( base != NULL ) ? base + 1 : fileName;
+    dirLength = (size_t)( base - fileName );
+
+    self->tempName = (char *)ANY_BALLOC( strlen( fileName ) + 9 );
+    self->dirName = (char *)ANY_BALLOC( dirLength + 2 );
+
+    if( self->fileName == NULL || self->tempName == NULL || self->dirName == NULL )
+    {
+        goto out;
+    }
+
+    memcpy( self->tempName, fileName, dirLength );
+    self->tempName[dirLength] = '~';
+    strcpy( self->tempName + dirLength + 1, base );
+    strcat( self->tempName, ".XXXXXX" );
+
+    if( dirLength > 0 )
+    {
+        memcpy( self->dirName, fileName, dirLength );
+    }
+    else
+    {
+        self->dirName[0] = '.';
+    }
+
+    if( !IniConfigAtomicFile_openAnonymous( self ) && !IniConfigAtomicFile_openNamed( self ) )
+    {
+        ANY_LOG( 0, "Unable to create a temporary file for '%s'", ANY_LOG_ERROR, fileName );
+        goto out;
+    }
+
+    /* keep the permissions fopen() would give */
+    if( stat( fileName, &st ) == 0 )
+    {
+        fchmod( self->fd, st.st_mode & 07777 );
+    }
+    else
+    {
+        mask = umask( 0 );
+        umask( mask );
+        fchmod( self->fd, 0666 & ~mask );
+    }
+
+    self->valid = INICONFIGATOMICFILE_VALID;
+
+    return true;
+
+    out:
+
+    ANY_FREE( self->fileName );
+    ANY_FREE( self->tempName );
+    ANY_FREE( self->dirName );
+    self->fileName = NULL;
+    self->tempName = NULL;
+    self->dirName = NULL;
+
+    return false;
+}
+
+
+void IniConfigAtomicFile_setDurability( IniConfigAtomicFile *self, IniConfigAtomicFileDurability durability )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGATOMICFILE_VALID );
+
+    self->durability = durability;
+}
+
+
+int IniConfigAtomicFile_getFd( const IniConfigAtomicFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGATOMICFILE_VALID );
+
+    return self->fd;
+}
+
+
+bool IniConfigAtomicFile_commit( IniConfigAtomicFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGATOMICFILE_VALID );
+    ANY_REQUIRE( self->fd != -1 );
+
+    if( self->durability >= INICONFIGATOMICFILE_DURABILITY_DATA && !IniConfigAtomicFile_flushData( self ) )
+    {
+        IniConfigAtomicFile_abort( self );
+        return false;
+    }
+
+    if( !IniConfigAtomicFile_replace( self ) )
+    {
+        return false;
+    }
+
+    if( self->durability >= INICONFIGATOMICFILE_DURABILITY_FULL )
+    {
+        return IniConfigAtomicFile_flushDirectory( self->dirName );
+    }
+
+    return true;
+}
+
+
+void IniConfigAtomicFile_abort( IniConfigAtomicFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGATOMICFILE_VALID );
+
+    if( self->fd != -1 )
+    {
+        close( self->fd );
+        self->fd = -1;
+
+        /* an unlinked O_TMPFILE file simply vanishes */
+        if( !self->anonymous )
+        {
+            unlink( self->tempName );
+        }
+    }
+}
+
+
+bool IniConfigAtomicFile_writev( int fd, struct iovec *iov, int count )
+{
+    while( count > 0 )
+    {
+        ssize_t written = writev( fd, iov, count );
+
+        if( written < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        /* skip what has been written, a partial write resumes mid-vector */
+        while( count > 0 && (size_t)written >= iov->iov_len )
+        {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if( count > 0 )
+        {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return true;
+}
+
+
+int IniConfigAtomicFile_lock( const char *fileName )
+{
+    struct flock fl;
+    char *lockName = NULL;
+    size_t length = 0;
+    int fd = -1;
+    int cmd = F_SETLKW;
+
+    ANY_REQUIRE( fileName );
+
+    length = strlen( fileName ) + 6;
+    lockName = (char *)ANY_BALLOC( length );
+
+    if( lockName == NULL )
+    {
+        return -1;
+    }
+
+    Any_snprintf( lockName, length, "%s.lock", fileName );
+
+    fd = open( lockName, O_RDWR | O_CREAT | O_CLOEXEC, 0666 );
+
+    if( fd == -1 )
+    {
+        ANY_LOG( 0, "Unable to open the lock file '%s'", ANY_LOG_ERROR, lockName );
+        goto out;
+    }
+
+#if defined(F_OFD_SETLKW)
+    cmd = F_OFD_SETLKW;
+#endif
+
+    for( ;; )
+    {
+        memset( &fl, 0, sizeof( fl ) );
+        fl.l_type = F_WRLCK;
+        fl.l_whence = SEEK_SET;
+
+        if( fcntl( fd, cmd, &fl ) == 0 )
+        {
+            break;
+        }
+
+        if( errno == EINTR )
+        {
+            continue;
+        }
+
+        /* kernels before 3.15 do not know OFD locks */
+        if( errno == EINVAL && cmd != F_SETLKW )
+        {
+            cmd = F_SETLKW;
+            continue;
+        }
+
+        ANY_LOG( 0, "Unable to lock '%s'", ANY_LOG_ERROR, lockName );
+        close( fd );
+        fd = -1;
+        break;
+    }
+
+    out:
+
+    ANY_FREE( lockName );
+
+    return fd;
+}
+
+
+void IniConfigAtomicFile_unlock( int lockFd )
+{
+    /* closing the descriptor releases the lock */
+    if( lockFd != -1 )
+    {
+        close( lockFd );
+    }
+}
+
+
+void IniConfigAtomicFile_clear( IniConfigAtomicFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGATOMICFILE_VALID );
+
+    IniConfigAtomicFile_abort( self );
+
+    self->valid = INICONFIGATOMICFILE_INVALID;
+
+    ANY_FREE( self->fileName );
+    ANY_FREE( self->tempName );
+    ANY_FREE( self->dirName );
+    self->fileName = NULL;
+    self->tempName = NULL;
+    self->dirName = NULL;
+}
+
+
+void IniConfigAtomicFile_delete( IniConfigAtomicFile *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
+
+
+IniConfigCommitGroup *IniConfigCommitGroup_new( void )
+{
+    return ( ANY_TALLOC( IniConfigCommitGroup ) );
+}
+
+
+bool IniConfigCommitGroup_init( IniConfigCommitGroup *self, IniConfigAtomicFileDurability durability )
+{
+    ANY_REQUIRE( self );
+
+    self->files = NULL;
+    self->numFiles = 0;
+    self->maxFiles = 0;
+    self->durability = durability;
+    self->valid = INICONFIGCOMMITGROUP_VALID;
+
+    return true;
+}
+
+
+IniConfigAtomicFile *IniConfigCommitGroup_add( IniConfigCommitGroup *self, const char *fileName )
+{
+    IniConfigAtomicFile *file = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGCOMMITGROUP_VALID );
+    ANY_REQUIRE( fileName );
+
+    if( self->numFiles == self->maxFiles )
+    {
+        size_t maxFiles = ( self->maxFiles != 0 ) ? self->maxFiles * 2 : 8;
+        IniConfigAtomicFile **files = (IniConfigAtomicFile **)realloc( self->files,
+                                                                       maxFiles * sizeof( IniConfigAtomicFile * ) );
+
+        if( files == NULL )
+        {
+            return NULL;
+        }
+
+        self->files = files;
+        self->maxFiles = maxFiles;
+    }
+
+    file = IniConfigAtomicFile_new();
+
+    if( file == NULL )
+    {
+        return NULL;
+    }
+
+    if( !IniConfigAtomicFile_init( file, fileName ) )
+    {
+        IniConfigAtomicFile_delete( file );
+        return NULL;
+    }
+
+    self->files[self->numFiles++] = file;
+
+    return file;
+}
+
+
+bool IniConfigCommitGroup_commit( IniConfigCommitGroup *self )
+{
+    dev_t *devices = NULL;
+    bool retVal = true;
+    size_t numShared = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGCOMMITGROUP_VALID );
+
+    if( self->numFiles == 0 )
+    {
+        return true;
+    }
+
+    /* a file aborted after a failed write fails the whole group */
+    for( i = 0; i < self->numFiles; i++ )
+    {
+        if( self->files[i]->fd == -1 )
+        {
+            retVal = false;
+            goto out;
+        }
+    }
+
+    if( self->durability >= INICONFIGATOMICFILE_DURABILITY_DATA )
+    {
+        devices = ANY_NTALLOC( self->numFiles, dev_t );
+
+        if( devices == NULL )
+        {
+            retVal = false;
+            goto out;
+        }
+
+        /* start writeback of all files before waiting for any of them */
+        for( i = 0; i < self->numFiles; i++ )
+        {
+            struct stat st;
+
+#if defined(SYNC_FILE_RANGE_WRITE)
+            sync_file_range( self->files[i]->fd, 0, 0, SYNC_FILE_RANGE_WRITE );
+#endif
+
+            if( fstat( self->files[i]->fd, &st ) != 0 )
+            {
+                ANY_LOG( 0, "Unable to stat the temporary file of '%s'", ANY_LOG_ERROR, self->files[i]->fileName );
+                retVal = false;
+                goto out;
+            }
+
+            devices[i] = st.st_dev;
+        }
+
+        for( i = 0; i < self->numFiles && retVal; i++ )
+        {
+            for( j = 0; j < i && devices[j] != devices[i]; j++ )
+            {
+            }
+
+            if( j < i )
+            {
+                /* already flushed together with an earlier file */
+                continue;
+            }
+
+            numShared = 0;
+
+            for( j = i; j < self->numFiles; j++ )
+            {
+                numShared += ( devices[j] == devices[i] ) ? 1 : 0;
+            }
+
+#if defined(__linux__)
+            if( numShared >= INICONFIGCOMMITGROUP_SYNCFSFILES )
+            {
+                /* one file system flush covers every file of the group on it */
+                if( syncfs( self->files[i]->fd ) != 0 )
+                {
+                    ANY_LOG( 0, "Unable to flush the file system of '%s'", ANY_LOG_ERROR, self->files[i]->fileName );
+                    retVal = false;
+                }
+
+                continue;
+            }
+#endif
+
+            /* syncfs() would flush everything else on the file system as well */
+            for( j = i; j < self->numFiles && retVal; j++ )
+            {
+                if( devices[j] == devices[i] )
+                {
+                    retVal = IniConfigAtomicFile_flushData( self->files[j] );
+                }
+            }
+        }
+
+        if( !retVal )
+        {
+            goto out;
+        }
+    }
+
+    for( i = 0; i < self->numFiles; i++ )
+    {
+        if( !IniConfigAtomicFile_replace( self->files[i] ) )
+        {
+            retVal = false;
+        }
+    }
+
+    if( self->durability >= INICONFIGATOMICFILE_DURABILITY_FULL )
+    {
+        /* each directory is flushed once, after all renames */
+        for( i = 0; i < self->numFiles; i++ )
+        {
+            for( j = 0; j < i; j++ )
+            {
+                if( strcmp( self->files[j]->dirName, self->files[i]->dirName ) == 0 )
+                {
+                    break;
+                }
+            }
+
+            if( j == i && !IniConfigAtomicFile_flushDirectory( self->files[i]->dirName ) )
+            {
+                retVal = false;
+            }
+        }
+    }
+
+    out:
+
+    ANY_FREE( devices );
+
+    for( i = 0; i < self->numFiles; i++ )
+    {
+        IniConfigAtomicFile_clear( self->files[i] );
+        IniConfigAtomicFile_delete( self->files[i] );
+    }
+
+    self->numFiles = 0;
+
+    return retVal;
+}
+
+
+void IniConfigCommitGroup_clear( IniConfigCommitGroup *self )
+{
+    size_t i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGCOMMITGROUP_VALID );
+
+    for( i = 0; i < self->numFiles; i++ )
+    {
+        IniConfigAtomicFile_clear( self->files[i] );
+        IniConfigAtomicFile_delete( self->files[i] );
+    }
+
+    ANY_FREE( self->files );
+    self->files = NULL;
+    self->numFiles = 0;
+    self->maxFiles = 0;
+
+    self->valid = INICONFIGCOMMITGROUP_INVALID;
+}
+
+
+void IniConfigCommitGroup_delete( IniConfigCommitGroup *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
@@ -0,0 +1,345 @@
+/*
+ *  Atomic replacement of INI files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigAtomicFile Atomic replacement of INI files
+ *
+ * An IniConfigAtomicFile is a temporary file created next to a destination
+ * file. Everything is written to the temporary file, and
+ * IniConfigAtomicFile_commit() then renames it over the destination, so
+ * readers always see either the complete old or the complete new file.
+ *
+ * \code
+ *  IniConfigAtomicFile *file = IniConfigAtomicFile_new();
+ *
+ *  if( IniConfigAtomicFile_init( file, "myConfig.ini" ) )
+ *  {
+ *    write( IniConfigAtomicFile_getFd( file ), text, length );
+ *    IniConfigAtomicFile_commit( file );
+ *  }
+ *
+ *  IniConfigAtomicFile_clear( file );
+ *  IniConfigAtomicFile_delete( file );
+ * \endcode
+ *
+ * <h2>Durability</h2>
+ *
+ * Atomicity alone does not survive a power failure: the rename may reach
+ * the disk before the data of the new file, leaving an empty or truncated
+ * file behind. IniConfigAtomicFile_setDurability() selects how much is
+ * flushed on commit:
+ *
+ *  - INICONFIGATOMICFILE_DURABILITY_NONE: rename only, nothing is flushed
+ *  - INICONFIGATOMICFILE_DURABILITY_DATA: the file data is flushed with
+ *    fdatasync() before the rename, so after a crash the destination holds
+ *    either the complete old or the complete new contents
+ *  - INICONFIGATOMICFILE_DURABILITY_FULL: the directory is additionally
+ *    flushed after the rename, so the new contents are guaranteed to be
+ *    there once the commit returns
+ *
+ * Where available (Linux 3.11+), the temporary file is created with
+ * O_TMPFILE and only gets a name via linkat() at commit time, so a crash
+ * never leaves "~" files behind. Otherwise mkstemp() is used.
+ *
+ * <h2>Group commit</h2>
+ *
+ * Each flush costs at least one disk round trip. An IniConfigCommitGroup
+ * saves many files with a single set of flushes: writeback of all files is
+ * started together, and each directory is flushed once after all renames.
+ *
+ * On Linux, a file system holding at least
+ * INICONFIGCOMMITGROUP_SYNCFSFILES files of the group is flushed once with
+ * syncfs() instead of one fdatasync() per file. syncfs() writes back every
+ * dirty page of every process on that file system, which on a busy file
+ * system can take far longer than the flushes it replaces, so smaller
+ * groups flush each file on its own. Keep large groups on a file system
+ * of their own to profit from it, the SaveLatency example compares both.
+ *
+ * \code
+ *  IniConfigCommitGroup *group = IniConfigCommitGroup_new();
+ *
+ *  IniConfigCommitGroup_init( group, INICONFIGATOMICFILE_DURABILITY_FULL );
+ *
+ *  IniConfigFile_saveGroup( robotIni, group );
+ *  IniConfigFile_saveGroup( sensorIni, group );
+ *
+ *  IniConfigCommitGroup_commit( group );
+ *
+ *  IniConfigCommitGroup_clear( group );
+ *  IniConfigCommitGroup_delete( group );
+ * \endcode
+ *
+ * <h2>Locking</h2>
+ *
+ * Atomic replacement keeps readers consistent but does not stop two
+ * writers from overwriting each other's changes. Writers which read,
+ * modify and replace a file hold IniConfigAtomicFile_lock() around that
+ * sequence. The lock is taken on a "<name>.lock" file next to the
+ * destination, because the destination itself is replaced on every commit.
+ */
+
+#ifndef INICONFIGATOMICFILE_H
+#define INICONFIGATOMICFILE_H
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+struct iovec;
+
+/*!
+ * \brief Files of a commit group on one file system from which on it is
+ *        flushed with a single syncfs()
+ */
+#if !defined(INICONFIGCOMMITGROUP_SYNCFSFILES)
+#define INICONFIGCOMMITGROUP_SYNCFSFILES  16
+#endif
+
+/*!
+ * \brief How much of a commit is flushed to stable storage
+ */
+typedef enum IniConfigAtomicFileDurability
+{
+    INICONFIGATOMICFILE_DURABILITY_NONE = 0,  /**< Atomic rename only */
+    INICONFIGATOMICFILE_DURABILITY_DATA,      /**< Flush the file data before the rename */
+    INICONFIGATOMICFILE_DURABILITY_FULL       /**< Also flush the directory after the rename */
+}
+IniConfigAtomicFileDurability;
+
+/*!
+ * \brief IniConfigAtomicFile definition
+ */
+typedef struct IniConfigAtomicFile
+{
+    unsigned long valid;                      /**< Object validity */
+    char *fileName;                           /**< Destination file name */
+    char *dirName;                            /**< Directory of the destination */
+    char *tempName;                           /**< Temporary file name */
+    int fd;                                   /**< Descriptor of the temporary file, -1 once closed */
+    int anonymous;                            /**< Created with O_TMPFILE, not linked yet */
+    IniConfigAtomicFileDurability durability; /**< Flushes done on commit */
+}
+IniConfigAtomicFile;
+
+/*!
+ * \brief IniConfigCommitGroup definition
+ */
+typedef struct IniConfigCommitGroup
+{
+    unsigned long valid;                      /**< Object validity */
+    IniConfigAtomicFile **files;              /**< Files to commit together */
+    size_t numFiles;                          /**< Number of files */
+    size_t maxFiles;                          /**< Allocated file slots */
+    IniConfigAtomicFileDurability durability; /**< Flushes done on commit */
+}
+IniConfigCommitGroup;
+
+/*!
+ * \brief Allocate a new IniConfigAtomicFile instance
+ *
+ * \return A new IniConfigAtomicFile instance, NULL on error
+ *
+ * \see IniConfigAtomicFile_init()
+ */
+IniConfigAtomicFile *IniConfigAtomicFile_new( void );
+
+/*!
+ * \brief Create the temporary file for a destination
+ *
+ * \param self      Pointer to the IniConfigAtomicFile
+ * \param fileName  Destination file name
+ *
+ * The temporary file lives in the directory of the destination, either
+ * unnamed (O_TMPFILE) or named "~<name>.XXXXXX". It gets the permissions of
+ * an existing destination, or the ones fopen() would give a new file.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigAtomicFile_commit()
+ */
+bool IniConfigAtomicFile_init( IniConfigAtomicFile *self, const char *fileName );
+
+/*!
+ * \brief Select the flushes done on commit
+ *
+ * \param self        Pointer to the IniConfigAtomicFile
+ * \param durability  Durability level, INICONFIGATOMICFILE_DURABILITY_NONE by default
+ *
+ * \return Nothing
+ */
+void IniConfigAtomicFile_setDurability( IniConfigAtomicFile *self, IniConfigAtomicFileDurability durability );
+
+/*!
+ * \brief Return the descriptor of the temporary file
+ *
+ * \param self Pointer to the IniConfigAtomicFile
+ *
+ * \return The file descriptor to write to
+ */
+int IniConfigAtomicFile_getFd( const IniConfigAtomicFile *self );
+
+/*!
+ * \brief Replace the destination with the temporary file
+ *
+ * \param self Pointer to the IniConfigAtomicFile
+ *
+ * \return Returns true on success, false otherwise. On failure the
+ *         destination is left untouched.
+ *
+ * \see IniConfigAtomicFile_abort()
+ */
+bool IniConfigAtomicFile_commit( IniConfigAtomicFile *self );
+
+/*!
+ * \brief Discard the temporary file
+ *
+ * \param self Pointer to the IniConfigAtomicFile
+ *
+ * \return Nothing
+ *
+ * \see IniConfigAtomicFile_commit()
+ */
+void IniConfigAtomicFile_abort( IniConfigAtomicFile *self );
+
+/*!
+ * \brief Write a whole I/O vector to a descriptor
+ *
+ * \param fd     File descriptor to write to
+ * \param iov    Vector of buffers, modified while partial writes are resumed
+ * \param count  Number of buffers
+ *
+ * Calls writev() until every byte has been written, resuming after partial
+ * writes and interrupted calls.
+ *
+ * \return Returns true on success, false on a write error
+ */
+bool IniConfigAtomicFile_writev( int fd, struct iovec *iov, int count );
+
+/*!
+ * \brief Acquire the exclusive write lock of a file
+ *
+ * \param fileName  Destination file name
+ *
+ * Blocks until no other process or thread holds the lock. Open file
+ * description locks (F_OFD_SETLKW) are used where available, so the lock
+ * also excludes other threads and is not dropped when an unrelated
+ * descriptor of the same file is closed; otherwise classic POSIX record
+ * locks are used.
+ *
+ * \return A lock descriptor to pass to IniConfigAtomicFile_unlock(), -1 on error
+ */
+int IniConfigAtomicFile_lock( const char *fileName );
+
+/*!
+ * \brief Release a lock acquired with IniConfigAtomicFile_lock()
+ *
+ * \param lockFd  Lock descriptor
+ *
+ * \return Nothing
+ */
+void IniConfigAtomicFile_unlock( int lockFd );
+
+/*!
+ * \brief Clear an IniConfigAtomicFile instance
+ *
+ * A temporary file which has not been committed is discarded.
+ *
+ * \param self Pointer to the IniConfigAtomicFile
+ *
+ * \return Nothing
+ */
+void IniConfigAtomicFile_clear( IniConfigAtomicFile *self );
+
+/*!
+ * \brief Delete an IniConfigAtomicFile instance
+ *
+ * \param self Pointer to the IniConfigAtomicFile
+ *
+ * \return Nothing
+ */
+void IniConfigAtomicFile_delete( IniConfigAtomicFile *self );
+
+/*!
+ * \brief Allocate a new IniConfigCommitGroup instance
+ *
+ * \return A new IniConfigCommitGroup instance, NULL on error
+ *
+ * \see IniConfigCommitGroup_init()
+ */
+IniConfigCommitGroup *IniConfigCommitGroup_new( void );
+
+/*!
+ * \brief Initialize an empty commit group
+ *
+ * \param self        Pointer to the IniConfigCommitGroup
+ * \param durability  Flushes done on commit, shared by all files of the group
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigCommitGroup_init( IniConfigCommitGroup *self, IniConfigAtomicFileDurability durability );
+
+/*!
+ * \brief Add a file to the group
+ *
+ * \param self      Pointer to the IniConfigCommitGroup
+ * \param fileName  Destination file name
+ *
+ * \return A temporary file owned by the group to write the new contents
+ *         to, NULL on error
+ *
+ * \see IniConfigCommitGroup_commit()
+ */
+IniConfigAtomicFile *IniConfigCommitGroup_add( IniConfigCommitGroup *self, const char *fileName );
+
+/*!
+ * \brief Replace all destinations of the group
+ *
+ * \param self Pointer to the IniConfigCommitGroup
+ *
+ * No destination is replaced unless the data of all files has been
+ * flushed successfully. The group is empty afterwards.
+ *
+ * \return Returns true if all files have been committed, false otherwise
+ */
+bool IniConfigCommitGroup_commit( IniConfigCommitGroup *self );
+
+/*!
+ * \brief Clear an IniConfigCommitGroup instance
+ *
+ * Files which have not been committed are discarded.
+ *
+ * \param self Pointer to the IniConfigCommitGroup
+ *
+ * \return Nothing
+ */
+void IniConfigCommitGroup_clear( IniConfigCommitGroup *self );
+
+/*!
+ * \brief Delete an IniConfigCommitGroup instance
+ *
+ * \param self Pointer to the IniConfigCommitGroup
+ *
+ * \return Nothing
+ */
+void IniConfigCommitGroup_delete( IniConfigCommitGroup *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGATOMICFILE_H */
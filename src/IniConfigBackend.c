@@ -0,0 +1,1031 @@
+/*
+ *  Storage backends of INI files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <IniConfigBackend.h>
+#include <IniConfigDocument.h>
+
+#define INICONFIGMEMORYBACKEND_VALID    0x3e3b4c2d
+#define INICONFIGMEMORYBACKEND_INVALID  0xb00db00f
+
+/* size of the blocks read by the stdio backend */
+#define INICONFIGBACKEND_BLOCKSIZE      65536
+
+
+/*
+ * Handle of the POSIX and mmap backends
+ */
+typedef struct IniConfigBackendFile
+{
+    int fd;                             /* file read, -1 for replacements */
+    char *data;                         /* contents read or mapped */
+    size_t length;
+    int mapped;
+    int done;                           /* the only block has been returned */
+    IniConfigAtomicFile *replacement;
+}
+IniConfigBackendFile;
+
+/*
+ * Handle of the stdio backend
+ */
+typedef struct IniConfigBackendStream
+{
+    FILE *fp;
+    char *fileName;                     /* destination of a replacement */
+    char *tempName;                     /* NULL for files read */
+    IniConfigAtomicFileDurability durability;
+    char block[INICONFIGBACKEND_BLOCKSIZE];
+}
+IniConfigBackendStream;
+
+/*
+ * Contents of a memory file, kept by open handles after a replacement
+ */
+typedef struct IniConfigMemoryContents
+{
+    int refCount;
+    unsigned long long inode;
+    struct timespec mtime;
+    char *data;
+    size_t length;
+    size_t size;                        /* allocated while written */
+}
+IniConfigMemoryContents;
+
+/*
+ * Handle of a memory backend
+ */
+typedef struct IniConfigMemoryHandle
+{
+    IniConfigMemoryContents *contents;
+    char *fileName;                     /* destination of a replacement, NULL for files read */
+    int done;
+}
+IniConfigMemoryHandle;
+
+
+/*
+ * POSIX and mmap backends
+ */
+
+static void *IniConfigBackend_openFile( void *context, const char *fileName )
+{
+    IniConfigBackendFile *file = NULL;
+    int fd = open( fileName, O_RDONLY );
+
+    (void)context;
+
+    if( fd == -1 )
+    {
+        return NULL;
+    }
+
+    file = ANY_TALLOC( IniConfigBackendFile );
+
+    if( file == NULL )
+    {
+        close( fd );
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    file->fd = fd;
+
+    return file;
+}
+
+
+static long IniConfigBackend_readFile( void *context, void *handle, const char **block )
+{
+    IniConfigBackendFile *file = (IniConfigBackendFile *)handle;
+
+    (void)context;
+
+    if( file->done )
+    {
+        return 0;
+    }
+
+    file->data = IniConfigDocument_readFd( file->fd, &file->length );
+    file->done = 1;
+
+    *block = file->data;
+
+    return ( file->data != NULL ) ? (long)file->length : -1;
+}
+
+
+static long IniConfigBackend_mapFile( void *context, void *handle, const char **block )
+{
+    IniConfigBackendFile *file = (IniConfigBackendFile *)handle;
+    struct stat st;
+    void *data = NULL;
+
+    if( file->done )
+    {
+        return 0;
+    }
+
+    /* empty files cannot be mapped, pipes and the like are read */
+    if( fstat( file->fd, &st ) != 0 || !S_ISREG( st.st_mode ) || st.st_size == 0 )
+    {
+        return IniConfigBackend_readFile( context, handle, block );
+    }
+
+    data = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file->fd, 0 );
+
+    if( data == MAP_FAILED )
+    {
+        return IniConfigBackend_readFile( context, handle, block );
+    }
+
+    madvise( data, (size_t)st.st_size, MADV_SEQUENTIAL );
+
+    file->data = (char *)data;
+    file->length = (size_t)st.st_size;
+    file->mapped = 1;
+    file->done = 1;
+
+    *block = file->data;
+
+    return (long)file->length;
+}
+
+
+static void *IniConfigBackend_createFile( void *context, const char *fileName,
+                                          IniConfigAtomicFileDurability durability )
+{
+    IniConfigBackendFile *file = ANY_TALLOC( IniConfigBackendFile );
+
+    (void)context;
+
+    if( file == NULL )
+    {
+        return NULL;
+    }
+
+    file->fd = -1;
+    file->replacement = IniConfigAtomicFile_new();
+
+    if( file->replacement == NULL || !IniConfigAtomicFile_init( file->replacement, fileName ) )
+    {
+        ANY_FREE( file->replacement );
+        ANY_FREE( file );
+        return NULL;
+    }
+
+    IniConfigAtomicFile_setDurability( file->replacement, durability );
+
+    return file;
+}
+
+
+static bool IniConfigBackend_writeFile( void *context, void *handle, struct iovec *iov, int count )
+{
+    IniConfigBackendFile *file = (IniConfigBackendFile *)handle;
+
+    (void)context;
+
+    return IniConfigAtomicFile_writev( IniConfigAtomicFile_getFd( file->replacement ), iov, count );
+}
+
+
+static bool IniConfigBackend_statFile( void *context, void *handle, struct stat *st )
+{
+    IniConfigBackendFile *file = (IniConfigBackendFile *)handle;
+    int fd = ( file->replacement != NULL ) ? IniConfigAtomicFile_getFd( file->replacement ) : file->fd;
+
+    (void)context;
+
+    return ( fstat( fd, st ) == 0 );
+}
+
+
+static void IniConfigBackend_closeFile( void *context, void *handle )
+{
+    IniConfigBackendFile *file = (IniConfigBackendFile *)handle;
+
+    (void)context;
+
+    if( file->mapped )
+    {
+        munmap( file->data, file->length );
+    }
+    else
+    {
+        ANY_FREE( file->data );
+    }
+
+    if( file->fd != -1 )
+    {
+        close( file->fd );
+    }
+
+    if( file->replacement != NULL )
+    {
+        IniConfigAtomicFile_clear( file->replacement );
+        IniConfigAtomicFile_delete( file->replacement );
+    }
+
+    ANY_FREE( file );
+}
+
+
+static bool IniConfigBackend_replaceFile( void *context, void *handle )
+{
+    IniConfigBackendFile *file = (IniConfigBackendFile *)handle;
+    bool retVal = IniConfigAtomicFile_commit( file->replacement );
+
+    IniConfigBackend_closeFile( context, handle );
+
+    return retVal;
+}
+
+
+/*
+ * stdio backend
+ */
+
+static void IniConfigBackend_closeStream( void *context, void *handle )
+{
+    IniConfigBackendStream *stream = (IniConfigBackendStream *)handle;
+
+    (void)context;
+
+    if( stream->fp != NULL )
+    {
+        fclose( stream->fp );
+    }
+
+    if( stream->tempName != NULL )
+    {
+        remove( stream->tempName );
+    }
+
+    ANY_FREE( stream->tempName );
+    ANY_FREE( stream->fileName );
+    ANY_FREE( stream );
+}
+
+
+static void *IniConfigBackend_openStream( void *context, const char *fileName )
+{
+    IniConfigBackendStream *stream = ANY_TALLOC( IniConfigBackendStream );
+
+    (void)context;
+
+    if( stream == NULL )
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    stream->fp = fopen( fileName, "rb" );
+
+    if( stream->fp == NULL )
+    {
+        int error = errno;
+
+        ANY_FREE( stream );
+        errno = error;
+
+        return NULL;
+    }
+
+    return stream;
+}
+
+
+static long IniConfigBackend_readStream( void *context, void *handle, const char **block )
+{
+    IniConfigBackendStream *stream = (IniConfigBackendStream *)handle;
+    size_t got = fread( stream->block, 1, INICONFIGBACKEND_BLOCKSIZE, stream->fp );
+
+    (void)context;
+
+    *block = stream->block;
+
+    if( got == 0 && ferror( stream->fp ) )
+    {
+        return -1;
+    }
+
+    return (long)got;
+}
+
+
+static void *IniConfigBackend_createStream( void *context, const char *fileName,
+                                            IniConfigAtomicFileDurability durability )
+{
+    IniConfigBackendStream *stream = ANY_TALLOC( IniConfigBackendStream );
+    size_t length = strlen( fileName );
+
+    if( stream == NULL )
+    {
+        return NULL;
+    }
+
+    /* the temporary name minIni uses */
+    stream->fileName = Any_strdup( (char *)fileName );
+    stream->tempName = (char *)ANY_BALLOC( length + 2 );
+    stream->durability = durability;
+
+    if( stream->fileName == NULL || stream->tempName == NULL )
+    {
+        IniConfigBackend_closeStream( context, stream );
+        return NULL;
+    }
+
+    memcpy( stream->tempName, fileName, length );
+    stream->tempName[length] = '~';
+
+    stream->fp = fopen( stream->tempName, "wb" );
+
+    if( stream->fp == NULL )
+    {
+        ANY_LOG( 0, "Unable to create '%s'", ANY_LOG_ERROR, stream->tempName );
+        ANY_FREE( stream->tempName );
+        stream->tempName = NULL;
+        IniConfigBackend_closeStream( context, stream );
+        return NULL;
+    }
+
+    return stream;
+}
+
+
+static bool IniConfigBackend_writeStream( void *context, void *handle, struct iovec *iov, int count )
+{
+    IniConfigBackendStream *stream = (IniConfigBackendStream *)handle;
+    int i = 0;
+
+    (void)context;
+
+    for( i = 0; i < count; i++ )
+    {
+        if( fwrite( iov[i].iov_base, 1, iov[i].iov_len, stream->fp ) != iov[i].iov_len )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static bool IniConfigBackend_statStream( void *context, void *handle, struct stat *st )
+{
+    IniConfigBackendStream *stream = (IniConfigBackendStream *)handle;
+
+    (void)context;
+
+    return ( fstat( fileno( stream->fp ), st ) == 0 );
+}
+
+
+static bool IniConfigBackend_replaceStream( void *context, void *handle )
+{
+    IniConfigBackendStream *stream = (IniConfigBackendStream *)handle;
+    bool retVal = ( fflush( stream->fp ) == 0 );
+
+    if( retVal && stream->durability >= INICONFIGATOMICFILE_DURABILITY_DATA )
+    {
+        retVal = ( fdatasync( fileno( stream->fp ) ) == 0 );
+    }
+
+    retVal = ( fclose( stream->fp ) == 0 ) && retVal;
+    stream->fp = NULL;
+
+    if( retVal && rename( stream->tempName, stream->fileName ) == 0 )
+    {
+        ANY_FREE( stream->tempName );
+        stream->tempName = NULL;
+    }
+    else
+    {
+        ANY_LOG( 0, "Unable to replace '%s'", ANY_LOG_ERROR, stream->fileName );
+        retVal = false;
+    }
+
+    IniConfigBackend_closeStream( context, stream );
+
+    return retVal;
+}
+
+
+/*
+ * Memory backend
+ */
+
+static IniConfigMemoryContents *IniConfigMemoryBackend_newContents( IniConfigMemoryBackend *self )
+{
+    IniConfigMemoryContents *contents = ANY_TALLOC( IniConfigMemoryContents );
+
+    if( contents != NULL )
+    {
+        contents->refCount = 1;
+        contents->inode = self->nextInode++;
+        clock_gettime( CLOCK_REALTIME, &contents->mtime );
+    }
+
+    return contents;
+}
+
+
+static void IniConfigMemoryBackend_unref( IniConfigMemoryContents *contents )
+{
+    if( contents != NULL && --contents->refCount == 0 )
+    {
+        ANY_FREE( contents->data );
+        ANY_FREE( contents );
+    }
+}
+
+
+static IniConfigMemoryFile *IniConfigMemoryBackend_find( const IniConfigMemoryBackend *self, const char *fileName )
+{
+    IniConfigMemoryFile *file = NULL;
+
+    for( file = self->files; file != NULL; file = file->next )
+    {
+        if( strcmp( file->fileName, fileName ) == 0 )
+        {
+            break;
+        }
+    }
+
+    return file;
+}
+
+
+/*
+ * Makes contents the ones of a file, which is created if needed
+ */
+static bool IniConfigMemoryBackend_store( IniConfigMemoryBackend *self, const char *fileName,
+                                          IniConfigMemoryContents *contents )
+{
+    IniConfigMemoryFile *file = IniConfigMemoryBackend_find( self, fileName );
+
+    if( file == NULL )
+    {
+        file = ANY_TALLOC( IniConfigMemoryFile );
+
+        if( file == NULL )
+        {
+            return false;
+        }
+
+        file->fileName = Any_strdup( (char *)fileName );
+
+        if( file->fileName == NULL )
+        {
+            ANY_FREE( file );
+            return false;
+        }
+
+        file->next = self->files;
+        self->files = file;
+    }
+
+    IniConfigMemoryBackend_unref( file->contents );
+    file->contents = contents;
+
+    return true;
+}
+
+
+static void *IniConfigMemoryBackend_open( void *context, const char *fileName )
+{
+    IniConfigMemoryBackend *self = (IniConfigMemoryBackend *)context;
+    IniConfigMemoryHandle *handle = ANY_TALLOC( IniConfigMemoryHandle );
+    IniConfigMemoryFile *file = NULL;
+
+    if( handle == NULL )
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    pthread_mutex_lock( &self->lock );
+
+    file = IniConfigMemoryBackend_find( self, fileName );
+
+    if( file != NULL )
+    {
+        handle->contents = file->contents;
+        handle->contents->refCount++;
+    }
+
+    pthread_mutex_unlock( &self->lock );
+
+    if( file == NULL )
+    {
+        ANY_FREE( handle );
+        errno = ENOENT;
+        return NULL;
+    }
+
+    return handle;
+}
+
+
+static long IniConfigMemoryBackend_read( void *context, void *file, const char **block )
+{
+    IniConfigMemoryHandle *handle = (IniConfigMemoryHandle *)file;
+
+    (void)context;
+
+    if( handle->done )
+    {
+        return 0;
+    }
+
+    handle->done = 1;
+    *block = handle->contents->data;
+
+    return (long)handle->contents->length;
+}
+
+
+static void *IniConfigMemoryBackend_create( void *context, const char *fileName,
+                                            IniConfigAtomicFileDurability durability )
+{
+    IniConfigMemoryBackend *self = (IniConfigMemoryBackend *)context;
+    IniConfigMemoryHandle *handle = ANY_TALLOC( IniConfigMemoryHandle );
+
+    (void)durability;
+
+    if( handle == NULL )
+    {
+        return NULL;
+    }
+
+    handle->fileName = Any_strdup( (char *)fileName );
+
+    pthread_mutex_lock( &self->lock );
+    handle->contents = IniConfigMemoryBackend_newContents( self );
+    pthread_mutex_unlock( &self->lock );
+
+    if( handle->fileName == NULL || handle->contents == NULL )
+    {
+        ANY_FREE( handle->contents );
+        ANY_FREE( handle->fileName );
+        ANY_FREE( handle );
+        return NULL;
+    }
+
+    return handle;
+}
+
+
+static bool IniConfigMemoryBackend_write( void *context, void *file, struct iovec *iov, int count )
+{
+    IniConfigMemoryContents *contents = ( (IniConfigMemoryHandle *)file )->contents;
+    int i = 0;
+
+    (void)context;
+
+    for( i = 0; i < count; i++ )
+    {
+        if( contents->length + iov[i].iov_len > contents->size )
+        {
+            size_t size = ( contents->size != 0 ) ? contents->size * 2 : 4096;
+            char *data = NULL;
+
+            while( size < contents->length + iov[i].iov_len )
+            {
+                size *= 2;
+            }
+
+            data = (char *)realloc( contents->data, size );
+
+            if( data == NULL )
+            {
+                return false;
+            }
+
+            contents->data = data;
+            contents->size = size;
+        }
+
+        memcpy( contents->data + contents->length, iov[i].iov_base, iov[i].iov_len );
+        contents->length += iov[i].iov_len;
+    }
+
+    return true;
+}
+
+
+static bool IniConfigMemoryBackend_stat( void *context, void *file, struct stat *st )
+{
+    const IniConfigMemoryContents *contents = ( (IniConfigMemoryHandle *)file )->contents;
+
+    (void)context;
+
+    memset( st, 0, sizeof( struct stat ) );
+
+    st->st_ino = contents->inode;
+    st->st_mode = S_IFREG | 0644;
+    st->st_nlink = 1;
+    st->st_size = contents->length;
+    st->st_mtim = contents->mtime;
+
+    return true;
+}
+
+
+static void IniConfigMemoryBackend_close( void *context, void *file )
+{
+    IniConfigMemoryBackend *self = (IniConfigMemoryBackend *)context;
+    IniConfigMemoryHandle *handle = (IniConfigMemoryHandle *)file;
+
+    pthread_mutex_lock( &self->lock );
+    IniConfigMemoryBackend_unref( handle->contents );
+    pthread_mutex_unlock( &self->lock );
+
+    ANY_FREE( handle->fileName );
+    ANY_FREE( handle );
+}
+
+
+static bool IniConfigMemoryBackend_replace( void *context, void *file )
+{
+    IniConfigMemoryBackend *self = (IniConfigMemoryBackend *)context;
+    IniConfigMemoryHandle *handle = (IniConfigMemoryHandle *)file;
+    bool retVal = false;
+
+    pthread_mutex_lock( &self->lock );
+
+    /* the file takes over the reference of the handle */
+    retVal = IniConfigMemoryBackend_store( self, handle->fileName, handle->contents );
+
+    if( retVal )
+    {
+        handle->contents = NULL;
+    }
+
+    pthread_mutex_unlock( &self->lock );
+
+    IniConfigMemoryBackend_close( context, file );
+
+    return retVal;
+}
+
+
+static const IniConfigBackend IniConfigBackend_posix =
+{
+    "posix", 1, NULL,
+    IniConfigBackend_openFile,
+    IniConfigBackend_readFile,
+    IniConfigBackend_createFile,
+    IniConfigBackend_writeFile,
+    IniConfigBackend_statFile,
+    IniConfigBackend_replaceFile,
+    IniConfigBackend_closeFile
+};
+
+static const IniConfigBackend IniConfigBackend_stdio =
+{
+    "stdio", 1, NULL,
+    IniConfigBackend_openStream,
+    IniConfigBackend_readStream,
+    IniConfigBackend_createStream,
+    IniConfigBackend_writeStream,
+    IniConfigBackend_statStream,
+    IniConfigBackend_replaceStream,
+    IniConfigBackend_closeStream
+};
+
+static const IniConfigBackend IniConfigBackend_mmap =
+{
+    "mmap", 1, NULL,
+    IniConfigBackend_openFile,
+    IniConfigBackend_mapFile,
+    IniConfigBackend_createFile,
+    IniConfigBackend_writeFile,
+    IniConfigBackend_statFile,
+    IniConfigBackend_replaceFile,
+    IniConfigBackend_closeFile
+};
+
+
+/*
+ * Public functions
+ */
+
+const IniConfigBackend *IniConfigBackend_getPosix( void )
+{
+    return &IniConfigBackend_posix;
+}
+
+
+const IniConfigBackend *IniConfigBackend_getStdio( void )
+{
+    return &IniConfigBackend_stdio;
+}
+
+
+const IniConfigBackend *IniConfigBackend_getMmap( void )
+{
+    return &IniConfigBackend_mmap;
+}
+
+
+const char *IniConfigBackend_readAll( const IniConfigBackend *backend, void *file, const struct stat *st,
+                                      size_t *length, char **contents )
+{
+    const char *block = NULL;
+    char *buffer = NULL;
+    size_t size = 0;
+    size_t used = 0;
+    long got = 0;
+
+    ANY_REQUIRE( backend );
+    ANY_REQUIRE( file );
+    ANY_REQUIRE( length );
+    ANY_REQUIRE( contents );
+
+    *contents = NULL;
+
+    got = backend->readBlock( backend->context, file, &block );
+
+    if( got < 0 )
+    {
+        return NULL;
+    }
+
+    /* a block holding the whole file is used in place */
+    if( got == 0 || ( st != NULL && S_ISREG( st->st_mode ) && got == (long)st->st_size ) )
+    {
+        *length = (size_t)got;
+        return ( got > 0 ) ? block : "";
+    }
+
+    size = ( st != NULL && st->st_size > got ) ? (size_t)st->st_size : (size_t)got * 2;
+    buffer = (char *)ANY_BALLOC( size );
+
+    if( buffer == NULL )
+    {
+        return NULL;
+    }
+
+    while( got > 0 )
+    {
+        /* copied before the next block replaces it */
+        if( used + got > size )
+        {
+            char *grown = NULL;
+
+            while( used + got > size )
+            {
+                size *= 2;
+            }
+
+            grown = (char *)realloc( buffer, size );
+
+            if( grown == NULL )
+            {
+                goto fail;
+            }
+
+            buffer = grown;
+        }
+
+        memcpy( buffer + used, block, got );
+        used += got;
+
+        got = backend->readBlock( backend->context, file, &block );
+    }
+
+    if( got < 0 )
+    {
+        goto fail;
+    }
+
+    *length = used;
+    *contents = buffer;
+
+    return buffer;
+
+    fail:
+
+    ANY_FREE( buffer );
+
+    return NULL;
+}
+
+
+IniConfigMemoryBackend *IniConfigMemoryBackend_new( void )
+{
+    return ( ANY_TALLOC( IniConfigMemoryBackend ) );
+}
+
+
+bool IniConfigMemoryBackend_init( IniConfigMemoryBackend *self )
+{
+    ANY_REQUIRE( self );
+
+    if( pthread_mutex_init( &self->lock, NULL ) != 0 )
+    {
+        return false;
+    }
+
+    self->files = NULL;
+    self->nextInode = 1;
+
+    self->backend.name = "memory";
+    self->backend.onDisk = 0;
+    self->backend.context = self;
+    self->backend.open = IniConfigMemoryBackend_open;
+    self->backend.readBlock = IniConfigMemoryBackend_read;
+    self->backend.create = IniConfigMemoryBackend_create;
+    self->backend.write = IniConfigMemoryBackend_write;
+    self->backend.stat = IniConfigMemoryBackend_stat;
+    self->backend.replace = IniConfigMemoryBackend_replace;
+    self->backend.close = IniConfigMemoryBackend_close;
+
+    self->valid = INICONFIGMEMORYBACKEND_VALID;
+
+    return true;
+}
+
+
+const IniConfigBackend *IniConfigMemoryBackend_getBackend( IniConfigMemoryBackend *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGMEMORYBACKEND_VALID );
+
+    return &self->backend;
+}
+
+
+bool IniConfigMemoryBackend_putFile( IniConfigMemoryBackend *self, const char *fileName, const char *contents,
+                                     size_t length )
+{
+    IniConfigMemoryContents *fresh = NULL;
+    bool retVal = false;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGMEMORYBACKEND_VALID );
+    ANY_REQUIRE( fileName );
+    ANY_REQUIRE( contents || length == 0 );
+
+    pthread_mutex_lock( &self->lock );
+
+    fresh = IniConfigMemoryBackend_newContents( self );
+
+    if( fresh == NULL )
+    {
+        goto out;
+    }
+
+    fresh->data = (char *)ANY_BALLOC( length + 1 );
+
+    if( fresh->data == NULL )
+    {
+        IniConfigMemoryBackend_unref( fresh );
+        goto out;
+    }
+
+    if( length > 0 )
+    {
+        memcpy( fresh->data, contents, length );
+    }
+
+    fresh->length = length;
+    fresh->size = length + 1;
+
+    retVal = IniConfigMemoryBackend_store( self, fileName, fresh );
+
+    if( !retVal )
+    {
+        IniConfigMemoryBackend_unref( fresh );
+    }
+
+    out:
+
+    pthread_mutex_unlock( &self->lock );
+
+    return retVal;
+}
+
+
+char *IniConfigMemoryBackend_getFile( IniConfigMemoryBackend *self, const char *fileName, size_t *length )
+{
+    IniConfigMemoryFile *file = NULL;
+    char *copy = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGMEMORYBACKEND_VALID );
+    ANY_REQUIRE( fileName );
+    ANY_REQUIRE( length );
+
+    pthread_mutex_lock( &self->lock );
+
+    file = IniConfigMemoryBackend_find( self, fileName );
+
+    if( file != NULL )
+    {
+        copy = (char *)ANY_BALLOC( file->contents->length + 1 );
+
+        if( copy != NULL )
+        {
+            if( file->contents->length > 0 )
+            {
+                memcpy( copy, file->contents->data, file->contents->length );
+            }
+
+            *length = file->contents->length;
+        }
+    }
+
+    pthread_mutex_unlock( &self->lock );
+
+    return copy;
+}
+
+
+bool IniConfigMemoryBackend_removeFile( IniConfigMemoryBackend *self, const char *fileName )
+{
+    IniConfigMemoryFile **link = NULL;
+    IniConfigMemoryFile *file = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGMEMORYBACKEND_VALID );
+    ANY_REQUIRE( fileName );
+
+    pthread_mutex_lock( &self->lock );
+
+    for( link = &self->files; *link != NULL; link = &( *link )->next )
+    {
+        if( strcmp( ( *link )->fileName, fileName ) == 0 )
+        {
+            file = *link;
+            *link = file->next;
+
+            IniConfigMemoryBackend_unref( file->contents );
+            ANY_FREE( file->fileName );
+            ANY_FREE( file );
+            break;
+        }
+    }
+
+    pthread_mutex_unlock( &self->lock );
+
+    return ( file != NULL );
+}
+
+
+void IniConfigMemoryBackend_clear( IniConfigMemoryBackend *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGMEMORYBACKEND_VALID );
+
+    while( self->files != NULL )
+    {
+        IniConfigMemoryFile *file = self->files;
+
+        self->files = file->next;
+
+        IniConfigMemoryBackend_unref( file->contents );
+        ANY_FREE( file->fileName );
+        ANY_FREE( file );
+    }
+
+    pthread_mutex_destroy( &self->lock );
+
+    self->valid = INICONFIGMEMORYBACKEND_INVALID;
+}
+
+
+void IniConfigMemoryBackend_delete( IniConfigMemoryBackend *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
@@ -0,0 +1,251 @@
+/*
+ *  Storage backends of INI files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigBackend Storage backends
+ *
+ * An IniConfigBackend is the table of functions a document loads and
+ * saves its file with: open a file, read it block by block, stat it,
+ * create a replacement, write to it and atomically replace the file.
+ * IniConfigFile_initWithBackend() selects the backend of a file,
+ * IniConfigFile_init() uses IniConfigBackend_getPosix().
+ *
+ *  - IniConfigBackend_getPosix(): read() of the whole file, saves through
+ *    an IniConfigAtomicFile with writev(). This is the default.
+ *  - IniConfigBackend_getStdio(): buffered stdio streams, saved to a
+ *    "<name>~" file renamed over the original, the way minIni writes.
+ *    Durability levels above INICONFIGATOMICFILE_DURABILITY_NONE flush the
+ *    file data, not the directory.
+ *  - IniConfigBackend_getMmap(): maps the file instead of reading it, so a
+ *    load copies the contents once, straight from the page cache; saves
+ *    like the POSIX backend.
+ *  - IniConfigMemoryBackend: files which only exist in memory, for tests.
+ *
+ * \code
+ *  IniConfigMemoryBackend *memory = IniConfigMemoryBackend_new();
+ *  IniConfigFile *ini = IniConfigFile_new();
+ *
+ *  IniConfigMemoryBackend_init( memory );
+ *  IniConfigMemoryBackend_putFile( memory, "robot.ini", "[Arm]\njoints=7\n", 15 );
+ *
+ *  IniConfigFile_initWithBackend( ini, "robot.ini", IniConfigMemoryBackend_getBackend( memory ) );
+ *  IniConfigFile_putInt( ini, "Arm", "joints", 6 );
+ *  IniConfigFile_save( ini );
+ * \endcode
+ *
+ * The minIni functions used before IniConfigFile_load(), locked saves,
+ * group commits and shared files work on the file system and are only
+ * available with backends whose files are on disk.
+ */
+
+#ifndef INICONFIGBACKEND_H
+#define INICONFIGBACKEND_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include <IniConfigAtomicFile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Functions a document reads and writes its file with
+ *
+ * file is a handle returned by open() or create(), every handle is
+ * given to exactly one of close() or replace().
+ */
+typedef struct IniConfigBackend
+{
+    const char *name;                   /**< Name for messages and benchmarks */
+    int onDisk;                         /**< Files are regular files minIni and locks can use */
+    void *context;                      /**< First argument of all functions */
+
+    /*! Open a file for reading, NULL with errno set to ENOENT if it does not exist */
+    void *( *open )( void *context, const char *fileName );
+
+    /*! Return the next block of a file in block, valid until the next call, 0 at the end and -1 on error */
+    long ( *readBlock )( void *context, void *file, const char **block );
+
+    /*! Create the replacement of a file */
+    void *( *create )( void *context, const char *fileName, IniConfigAtomicFileDurability durability );
+
+    /*! Append to a replacement, iov may be modified */
+    bool ( *write )( void *context, void *file, struct iovec *iov, int count );
+
+    /*! Identity of an open file or replacement, as far as the backend knows it */
+    bool ( *stat )( void *context, void *file, struct stat *st );
+
+    /*! Atomically replace the file with its replacement and release the handle */
+    bool ( *replace )( void *context, void *file );
+
+    /*! Release a handle, a replacement is discarded */
+    void ( *close )( void *context, void *file );
+}
+IniConfigBackend;
+
+/*!
+ * \brief One file of an IniConfigMemoryBackend
+ */
+typedef struct IniConfigMemoryFile
+{
+    struct IniConfigMemoryFile *next;   /**< Next file of the backend */
+    char *fileName;                     /**< Name the file is found by */
+    struct IniConfigMemoryContents *contents; /**< Current contents, shared with open handles */
+}
+IniConfigMemoryFile;
+
+/*!
+ * \brief IniConfigMemoryBackend definition
+ */
+typedef struct IniConfigMemoryBackend
+{
+    unsigned long valid;                /**< Object validity */
+    pthread_mutex_t lock;               /**< Guards the files and reference counts */
+    IniConfigMemoryFile *files;         /**< All files */
+    unsigned long long nextInode;       /**< Identity of the next contents */
+    IniConfigBackend backend;           /**< Functions working on the files */
+}
+IniConfigMemoryBackend;
+
+/*!
+ * \brief Backend reading files with read() and saving them atomically
+ *
+ * \return The backend, valid for the lifetime of the process
+ */
+const IniConfigBackend *IniConfigBackend_getPosix( void );
+
+/*!
+ * \brief Backend using stdio streams like minIni
+ *
+ * \return The backend, valid for the lifetime of the process
+ */
+const IniConfigBackend *IniConfigBackend_getStdio( void );
+
+/*!
+ * \brief Backend mapping files into memory to load them
+ *
+ * \return The backend, valid for the lifetime of the process
+ */
+const IniConfigBackend *IniConfigBackend_getMmap( void );
+
+/*!
+ * \brief Read a whole file through a backend
+ *
+ * \param backend   Backend to read with
+ * \param file      Handle returned by the open function of backend
+ * \param st        Result of the stat function for file, NULL if unknown
+ * \param length    Receives the length of the contents
+ * \param contents  Receives a copy of the contents if they came in several
+ *                  blocks, to be freed with ANY_FREE(), NULL otherwise
+ *
+ * \return The contents, in the only block of the backend or in contents,
+ *         NULL on error
+ */
+const char *IniConfigBackend_readAll( const IniConfigBackend *backend, void *file, const struct stat *st,
+                                      size_t *length, char **contents );
+
+/*!
+ * \brief Allocate a new IniConfigMemoryBackend instance
+ *
+ * \return A new IniConfigMemoryBackend instance, NULL on error
+ *
+ * \see IniConfigMemoryBackend_init()
+ */
+IniConfigMemoryBackend *IniConfigMemoryBackend_new( void );
+
+/*!
+ * \brief Initialize a backend without any files
+ *
+ * \param self Pointer to the IniConfigMemoryBackend
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigMemoryBackend_init( IniConfigMemoryBackend *self );
+
+/*!
+ * \brief Return the functions working on the files of a memory backend
+ *
+ * \param self Pointer to the IniConfigMemoryBackend
+ *
+ * \return The backend, valid until IniConfigMemoryBackend_clear()
+ */
+const IniConfigBackend *IniConfigMemoryBackend_getBackend( IniConfigMemoryBackend *self );
+
+/*!
+ * \brief Create or replace a file
+ *
+ * \param self      Pointer to the IniConfigMemoryBackend
+ * \param fileName  Name of the file
+ * \param contents  New contents, copied
+ * \param length    Length of contents
+ *
+ * \return Returns true on success, false if memory ran out
+ */
+bool IniConfigMemoryBackend_putFile( IniConfigMemoryBackend *self, const char *fileName, const char *contents,
+                                     size_t length );
+
+/*!
+ * \brief Return a copy of the contents of a file
+ *
+ * \param self      Pointer to the IniConfigMemoryBackend
+ * \param fileName  Name of the file
+ * \param length    Receives the length of the contents
+ *
+ * \return The zero-terminated contents, to be freed with ANY_FREE(), NULL
+ *         if the file does not exist
+ */
+char *IniConfigMemoryBackend_getFile( IniConfigMemoryBackend *self, const char *fileName, size_t *length );
+
+/*!
+ * \brief Remove a file
+ *
+ * \param self      Pointer to the IniConfigMemoryBackend
+ * \param fileName  Name of the file
+ *
+ * Handles opened before keep reading the removed contents.
+ *
+ * \return Returns true if the file existed
+ */
+bool IniConfigMemoryBackend_removeFile( IniConfigMemoryBackend *self, const char *fileName );
+
+/*!
+ * \brief Clear an IniConfigMemoryBackend instance
+ *
+ * All handles of the backend must have been released.
+ *
+ * \param self Pointer to the IniConfigMemoryBackend
+ *
+ * \return Nothing
+ */
+void IniConfigMemoryBackend_clear( IniConfigMemoryBackend *self );
+
+/*!
+ * \brief Delete an IniConfigMemoryBackend instance
+ *
+ * \param self Pointer to the IniConfigMemoryBackend
+ *
+ * \return Nothing
+ */
+void IniConfigMemoryBackend_delete( IniConfigMemoryBackend *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGBACKEND_H */
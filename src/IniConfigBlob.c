@@ -0,0 +1,380 @@
+/*
+ *  Binary values encoded as base64 or hex
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <IniConfigBlob.h>
+
+/* the SSSE3 decoder is compiled in any case and only called if the processor has it */
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#define INICONFIGBLOB_SIMD
+#endif
+
+
+static const char IniConfigBlob_base64Digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const char IniConfigBlob_hexDigits[] = "0123456789abcdef";
+
+/* value of every character, 0xff outside the alphabet */
+static const unsigned char IniConfigBlob_base64Values[256] =
+{
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static const unsigned char IniConfigBlob_hexValues[256] =
+{
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+
+/*
+ * Private functions
+ */
+
+#if defined(INICONFIGBLOB_SIMD)
+
+/*
+ * Decodes blocks of 16 characters into 12 bytes each, but stores 16 bytes
+ * per block. Stops before the first block with an invalid character and
+ * returns the number of characters decoded.
+ */
+__attribute__(( target( "ssse3" ) ))
+static size_t IniConfigBlob_decodeBase64Ssse3( const unsigned char *text, size_t length, unsigned char *out,
+                                               size_t room )
+{
+    /* classification by nibbles, see W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2
+     * Instructions", ACM Transactions on the Web, 2018 */
+    const __m128i lutLo = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a );
+    const __m128i lutHi = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+    const __m128i lutRoll = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+    const __m128i pack = _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+    const __m128i nibble = _mm_set1_epi8( 0x0f );
+    const __m128i slash = _mm_set1_epi8( 0x2f );
+    size_t done = 0;
+
+    while( done + 16 <= length && ( done / 16 ) * 12 + 16 <= room )
+    {
+        __m128i in = _mm_loadu_si128( (const __m128i *)( text + done ) );
+        __m128i hi = _mm_and_si128( _mm_srli_epi32( in, 4 ), nibble );
+        __m128i lo = _mm_and_si128( in, nibble );
+        __m128i check = _mm_and_si128( _mm_shuffle_epi8( lutLo, lo ), _mm_shuffle_epi8( lutHi, hi ) );
+        __m128i values;
+
+        if( _mm_movemask_epi8( _mm_cmpeq_epi8( check, _mm_setzero_si128() ) ) != 0xffff )
+        {
+            break;
+        }
+
+        values = _mm_add_epi8( in, _mm_shuffle_epi8( lutRoll, _mm_add_epi8( _mm_cmpeq_epi8( in, slash ), hi ) ) );
+
+        /* 4 x 6 bits to 3 bytes per 32 bit lane, then drop the empty fourth bytes */
+        values = _mm_maddubs_epi16( values, _mm_set1_epi32( 0x01400140 ) );
+        values = _mm_madd_epi16( values, _mm_set1_epi32( 0x00011000 ) );
+        values = _mm_shuffle_epi8( values, pack );
+
+        _mm_storeu_si128( (__m128i *)( out + ( done / 16 ) * 12 ), values );
+
+        done += 16;
+    }
+
+    return done;
+}
+
+
+/*
+ * Decodes blocks of 16 digits into 8 bytes each, stops before the first
+ * block with an invalid digit and returns the number of digits decoded
+ */
+static size_t IniConfigBlob_decodeHexSse2( const unsigned char *text, size_t length, unsigned char *out )
+{
+    const __m128i zero = _mm_set1_epi8( '0' );
+    const __m128i a = _mm_set1_epi8( 'a' );
+    const __m128i lower = _mm_set1_epi8( 0x20 );
+    const __m128i nine = _mm_set1_epi8( 9 );
+    const __m128i five = _mm_set1_epi8( 5 );
+    const __m128i ten = _mm_set1_epi8( 10 );
+    size_t done = 0;
+
+    while( done + 16 <= length )
+    {
+        __m128i in = _mm_loadu_si128( (const __m128i *)( text + done ) );
+        __m128i digit = _mm_sub_epi8( in, zero );
+        __m128i letter = _mm_sub_epi8( _mm_or_si128( in, lower ), a );
+        /* unsigned x <= limit as min( x, limit ) == x */
+        __m128i isDigit = _mm_cmpeq_epi8( _mm_min_epu8( digit, nine ), digit );
+        __m128i isLetter = _mm_cmpeq_epi8( _mm_min_epu8( letter, five ), letter );
+        __m128i values;
+
+        if( _mm_movemask_epi8( _mm_or_si128( isDigit, isLetter ) ) != 0xffff )
+        {
+            break;
+        }
+
+        values = _mm_or_si128( _mm_and_si128( isDigit, digit ),
+                               _mm_and_si128( isLetter, _mm_add_epi8( letter, ten ) ) );
+
+        /* every 16 bit lane holds high and low nibble of one byte */
+        values = _mm_or_si128( _mm_and_si128( _mm_slli_epi16( values, 4 ), _mm_set1_epi16( 0x00f0 ) ),
+                               _mm_srli_epi16( values, 8 ) );
+
+        _mm_storel_epi64( (__m128i *)( out + done / 2 ), _mm_packus_epi16( values, values ) );
+
+        done += 16;
+    }
+
+    return done;
+}
+
+#endif
+
+
+static long IniConfigBlob_decodeBase64( const unsigned char *text, size_t length, unsigned char *out,
+                                        size_t size )
+{
+    const unsigned char *values = IniConfigBlob_base64Values;
+    size_t full = 0;
+    size_t i = 0;
+    size_t o = 0;
+    int padding = 0;
+
+    /* the padding has been checked by IniConfigBlob_getDecodedSize() */
+    while( padding < 2 && length > 0 && text[length - 1] == '=' )
+    {
+        length--;
+        padding++;
+    }
+
+    full = length & ~(size_t)3;
+
+#if defined(INICONFIGBLOB_SIMD)
+    if( full >= 16 && __builtin_cpu_supports( "ssse3" ) )
+    {
+        i = IniConfigBlob_decodeBase64Ssse3( text, full, out, size );
+        o = ( i / 4 ) * 3;
+    }
+#endif
+
+    for( ; i < full; i += 4, o += 3 )
+    {
+        unsigned int a = values[text[i]];
+        unsigned int b = values[text[i + 1]];
+        unsigned int c = values[text[i + 2]];
+        unsigned int d = values[text[i + 3]];
+        unsigned int bits = ( a << 18 ) | ( b << 12 ) | ( c << 6 ) | d;
+
+        if( ( ( a | b | c | d ) & 0x80 ) != 0 )
+        {
+            return -1;
+        }
+
+        out[o] = (unsigned char)( bits >> 16 );
+        out[o + 1] = (unsigned char)( bits >> 8 );
+        out[o + 2] = (unsigned char)bits;
+    }
+
+    if( length > full )
+    {
+        unsigned int a = values[text[i]];
+        unsigned int b = values[text[i + 1]];
+        unsigned int c = ( length - full == 3 ) ? values[text[i + 2]] : 0;
+
+        if( ( ( a | b | c ) & 0x80 ) != 0 )
+        {
+            return -1;
+        }
+
+        out[o++] = (unsigned char)( ( a << 2 ) | ( b >> 4 ) );
+
+        if( length - full == 3 )
+        {
+            out[o++] = (unsigned char)( ( b << 4 ) | ( c >> 2 ) );
+        }
+    }
+
+    return (long)o;
+}
+
+
+static long IniConfigBlob_decodeHex( const unsigned char *text, size_t length, unsigned char *out )
+{
+    const unsigned char *values = IniConfigBlob_hexValues;
+    size_t i = 0;
+
+#if defined(INICONFIGBLOB_SIMD)
+    i = IniConfigBlob_decodeHexSse2( text, length, out );
+#endif
+
+    for( ; i < length; i += 2 )
+    {
+        unsigned int hi = values[text[i]];
+        unsigned int lo = values[text[i + 1]];
+
+        if( ( ( hi | lo ) & 0x80 ) != 0 )
+        {
+            return -1;
+        }
+
+        out[i / 2] = (unsigned char)( ( hi << 4 ) | lo );
+    }
+
+    return (long)( length / 2 );
+}
+
+
+/*
+ * Public functions
+ */
+
+long IniConfigBlob_getDecodedSize( int encoding, const char *text, size_t length )
+{
+    size_t padding = 0;
+
+    ANY_REQUIRE( text || length == 0 );
+
+    if( encoding == INICONFIGBLOB_HEX )
+    {
+        return ( length % 2 == 0 ) ? (long)( length / 2 ) : -1;
+    }
+
+    ANY_REQUIRE( encoding == INICONFIGBLOB_BASE64 );
+
+    while( padding < 2 && padding < length && text[length - padding - 1] == '=' )
+    {
+        padding++;
+    }
+
+    /* padding must complete the last group of four */
+    if( ( padding > 0 && length % 4 != 0 ) || ( length - padding ) % 4 == 1 )
+    {
+        return -1;
+    }
+
+    return (long)( ( ( length - padding ) * 3 ) / 4 );
+}
+
+
+long IniConfigBlob_decode( int encoding, const char *text, size_t length, void *buffer, size_t bufferSize )
+{
+    long size = IniConfigBlob_getDecodedSize( encoding, text, length );
+
+    ANY_REQUIRE( buffer || bufferSize == 0 );
+
+    if( size < 0 || (size_t)size > bufferSize )
+    {
+        return -1;
+    }
+
+    if( encoding == INICONFIGBLOB_HEX )
+    {
+        return IniConfigBlob_decodeHex( (const unsigned char *)text, length, (unsigned char *)buffer );
+    }
+
+    return IniConfigBlob_decodeBase64( (const unsigned char *)text, length, (unsigned char *)buffer, bufferSize );
+}
+
+
+size_t IniConfigBlob_getEncodedLength( int encoding, size_t size )
+{
+    return ( encoding == INICONFIGBLOB_HEX ) ? size * 2 : ( ( size + 2 ) / 3 ) * 4;
+}
+
+
+size_t IniConfigBlob_encode( int encoding, const void *data, size_t size, char *text )
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    size_t i = 0;
+    size_t o = 0;
+
+    ANY_REQUIRE( data || size == 0 );
+    ANY_REQUIRE( text );
+
+    if( encoding == INICONFIGBLOB_HEX )
+    {
+        for( i = 0; i < size; i++ )
+        {
+            text[o++] = IniConfigBlob_hexDigits[bytes[i] >> 4];
+            text[o++] = IniConfigBlob_hexDigits[bytes[i] & 0x0f];
+        }
+    }
+    else
+    {
+        for( i = 0; i + 3 <= size; i += 3 )
+        {
+            unsigned int bits = ( (unsigned int)bytes[i] << 16 ) | ( (unsigned int)bytes[i + 1] << 8 ) | bytes[i + 2];
+
+            text[o++] = IniConfigBlob_base64Digits[bits >> 18];
+            text[o++] = IniConfigBlob_base64Digits[( bits >> 12 ) & 0x3f];
+            text[o++] = IniConfigBlob_base64Digits[( bits >> 6 ) & 0x3f];
+            text[o++] = IniConfigBlob_base64Digits[bits & 0x3f];
+        }
+
+        if( i < size )
+        {
+            unsigned int bits = (unsigned int)bytes[i] << 16;
+
+            if( i + 1 < size )
+            {
+                bits |= (unsigned int)bytes[i + 1] << 8;
+            }
+
+            text[o++] = IniConfigBlob_base64Digits[bits >> 18];
+            text[o++] = IniConfigBlob_base64Digits[( bits >> 12 ) & 0x3f];
+            text[o++] = ( i + 1 < size ) ? IniConfigBlob_base64Digits[( bits >> 6 ) & 0x3f] : '=';
+            text[o++] = '=';
+        }
+    }
+
+    text[o] = '\0';
+
+    return o;
+}
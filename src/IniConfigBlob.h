@@ -0,0 +1,119 @@
+/*
+ *  Binary values encoded as base64 or hex
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigBlob Binary values
+ *
+ * Lookup tables, keys or firmware parameters are stored as text in one of
+ * two encodings:
+ *
+ *  - INICONFIGBLOB_BASE64: the standard alphabet of RFC 4648 with "+" and
+ *    "/"; the "=" padding may be left out
+ *  - INICONFIGBLOB_HEX: two digits per byte, upper or lower case
+ *
+ * White space or line breaks inside a value are not allowed.
+ *
+ * IniConfigFile_getBlob() decodes a value of any length straight from the
+ * loaded file into the caller's buffer, IniConfigFile_putBlob() encodes
+ * one. On x86-64 the decoders work on 16 characters at a time with SSE2
+ * (hex) and SSSE3 (base64) if the processor has it, elsewhere and for the
+ * last few characters they use lookup tables.
+ *
+ * \code
+ *  long size = IniConfigFile_getBlob( myIniFile, "Firmware", "Table", INICONFIGBLOB_BASE64, NULL, 0 );
+ *  unsigned char *table = ANY_BALLOC( size );
+ *
+ *  IniConfigFile_getBlob( myIniFile, "Firmware", "Table", INICONFIGBLOB_BASE64, table, size );
+ * \endcode
+ */
+
+#ifndef INICONFIGBLOB_H
+#define INICONFIGBLOB_H
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Text encoding of a binary value
+ */
+typedef enum IniConfigBlobEncoding
+{
+    INICONFIGBLOB_BASE64 = 0,           /**< RFC 4648 base64, padding optional */
+    INICONFIGBLOB_HEX                   /**< Two hexadecimal digits per byte */
+}
+IniConfigBlobEncoding;
+
+/*!
+ * \brief Size of an encoded value once decoded
+ *
+ * \param encoding  IniConfigBlobEncoding of text
+ * \param text      Encoded value
+ * \param length    Length of text
+ *
+ * Only looks at the length and the padding, IniConfigBlob_decode() checks
+ * the characters.
+ *
+ * \return The number of bytes, -1 if no value of this encoding has the
+ *         length
+ */
+long IniConfigBlob_getDecodedSize( int encoding, const char *text, size_t length );
+
+/*!
+ * \brief Decode a value
+ *
+ * \param encoding    IniConfigBlobEncoding of text
+ * \param text        Encoded value
+ * \param length      Length of text
+ * \param buffer      Receives the bytes
+ * \param bufferSize  Size of buffer
+ *
+ * \return The number of bytes written, -1 if text is not valid or buffer
+ *         is too small
+ */
+long IniConfigBlob_decode( int encoding, const char *text, size_t length, void *buffer, size_t bufferSize );
+
+/*!
+ * \brief Length of the encoding of some bytes
+ *
+ * \param encoding  IniConfigBlobEncoding to use
+ * \param size      Number of bytes
+ *
+ * \return The number of characters, without the terminating zero
+ */
+size_t IniConfigBlob_getEncodedLength( int encoding, size_t size );
+
+/*!
+ * \brief Encode some bytes
+ *
+ * \param encoding  IniConfigBlobEncoding to use
+ * \param data      Bytes to encode
+ * \param size      Number of bytes
+ * \param text      Receives IniConfigBlob_getEncodedLength() characters
+ *                  and a terminating zero; base64 is padded, hex is lower
+ *                  case
+ *
+ * \return The number of characters written, without the terminating zero
+ */
+size_t IniConfigBlob_encode( int encoding, const void *data, size_t size, char *text );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGBLOB_H */
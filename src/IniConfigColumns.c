@@ -0,0 +1,419 @@
+/*
+ *  Numeric values of all sections as typed columns
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IniConfigColumns.h>
+#include <IniConfigHamt.h>
+
+#define INICONFIGCOLUMNS_VALID      0x5e1c83a4
+#define INICONFIGCOLUMNS_INVALID    0xb00db00f
+
+/* number of values filling INICONFIGCOLUMNS_ALIGN bytes of the double column */
+#define INICONFIGCOLUMNS_STRIDE     ( INICONFIGCOLUMNS_ALIGN / sizeof( double ) )
+
+
+typedef struct IniConfigColumnsBuilder
+{
+    IniConfigColumns *columns;          /* NULL while counting */
+    unsigned int numSections;
+    unsigned int numValues;
+    size_t stringSize;
+    size_t stringOffset;
+    char *lastName;                     /* section of the previous numeric key */
+    size_t lastSize;
+}
+IniConfigColumnsBuilder;
+
+
+/*
+ * Private functions
+ */
+
+static char IniConfigColumns_toLower( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? (char)( c + 'a' - 'A' ) : c;
+}
+
+
+static int IniConfigColumns_equalsNoCase( const char *a, const char *b )
+{
+    while( *a != '\0' && IniConfigColumns_toLower( *a ) == IniConfigColumns_toLower( *b ) )
+    {
+        a++;
+        b++;
+    }
+
+    return ( IniConfigColumns_toLower( *a ) == IniConfigColumns_toLower( *b ) );
+}
+
+
+/*
+ * Returns the type of a value, 0 for strings
+ */
+static int IniConfigColumns_infer( const char *value, int64_t *intValue, double *doubleValue )
+{
+    const char *digits = ( *value == '+' || *value == '-' ) ? value + 1 : value;
+    char *end = NULL;
+    long long number = 0;
+
+    /* rules out empty values, "inf" and "nan" */
+    if( !isdigit( (unsigned char)*digits ) && *digits != '.' )
+    {
+        return 0;
+    }
+
+    errno = 0;
+
+    /* the same bases as IniConfigFile_getLong() */
+    if( value[0] == '0' && toupper( (unsigned char)value[1] ) == 'X' )
+    {
+        number = strtoll( value, &end, 16 );
+    }
+    else
+    {
+        number = strtoll( value, &end, 10 );
+    }
+
+    if( *end == '\0' && end != value && errno == 0 )
+    {
+        *intValue = (int64_t)number;
+        *doubleValue = (double)number;
+
+        return INICONFIGCOLUMNS_INT;
+    }
+
+    *doubleValue = strtod( value, &end );
+
+    if( *end == '\0' && end != value )
+    {
+        *intValue = 0;
+
+        return INICONFIGCOLUMNS_DOUBLE;
+    }
+
+    return 0;
+}
+
+
+static const char *IniConfigColumns_addString( IniConfigColumnsBuilder *builder, const char *text )
+{
+    char *copy = builder->columns->strings + builder->stringOffset;
+    size_t length = strlen( text ) + 1;
+
+    memcpy( copy, text, length );
+    builder->stringOffset += length;
+
+    return copy;
+}
+
+
+/*
+ * Starts a new section when the key belongs to another one than the previous numeric key
+ */
+static bool IniConfigColumns_enter( IniConfigColumnsBuilder *builder, const char *section )
+{
+    size_t length = strlen( section ) + 1;
+
+    if( builder->lastName != NULL && strcmp( builder->lastName, section ) == 0 )
+    {
+        return true;
+    }
+
+    if( length > builder->lastSize )
+    {
+        char *lastName = (char *)realloc( builder->lastName, length );
+
+        if( lastName == NULL )
+        {
+            return false;
+        }
+
+        builder->lastName = lastName;
+        builder->lastSize = length;
+    }
+
+    memcpy( builder->lastName, section, length );
+
+    /* every section starts on a fresh INICONFIGCOLUMNS_ALIGN boundary */
+    builder->numValues = ( builder->numValues + INICONFIGCOLUMNS_STRIDE - 1 ) & ~( INICONFIGCOLUMNS_STRIDE - 1 );
+
+    if( builder->columns == NULL )
+    {
+        builder->stringSize += length;
+    }
+    else
+    {
+        IniConfigColumnsSection *entry = &builder->columns->sections[builder->numSections];
+
+        entry->name = IniConfigColumns_addString( builder, section );
+        entry->hash = IniConfigHamt_hashSection( section );
+        entry->first = builder->numValues;
+        entry->count = 0;
+    }
+
+    builder->numSections++;
+
+    return true;
+}
+
+
+static bool IniConfigColumns_visit( void *context, const char *section, const char *key, const char *value )
+{
+    IniConfigColumnsBuilder *builder = (IniConfigColumnsBuilder *)context;
+    IniConfigColumns *columns = builder->columns;
+    int64_t intValue = 0;
+    double doubleValue = 0.0;
+    int type = IniConfigColumns_infer( value, &intValue, &doubleValue );
+    unsigned int i = 0;
+
+    if( type == 0 )
+    {
+        return true;
+    }
+
+    /* the keys of a section arrive together, see IniConfigDocument_forEach() */
+    if( !IniConfigColumns_enter( builder, section ) )
+    {
+        return false;
+    }
+
+    i = builder->numValues++;
+
+    if( columns == NULL )
+    {
+        builder->stringSize += strlen( key ) + 1;
+        return true;
+    }
+
+    columns->names[i] = IniConfigColumns_addString( builder, key );
+    columns->types[i] = (unsigned char)type;
+    columns->ints[i] = intValue;
+    columns->doubles[i] = doubleValue;
+    columns->sections[builder->numSections - 1].count++;
+
+    return true;
+}
+
+
+static void *IniConfigColumns_alloc( size_t size )
+{
+    void *block = NULL;
+
+    if( posix_memalign( &block, INICONFIGCOLUMNS_ALIGN, size ) != 0 )
+    {
+        return NULL;
+    }
+
+    memset( block, 0, size );
+
+    return block;
+}
+
+
+static void IniConfigColumns_release( IniConfigColumns *self )
+{
+    if( self->sections != NULL )
+    {
+        ANY_FREE( self->sections );
+        self->sections = NULL;
+    }
+
+    if( self->names != NULL )
+    {
+        ANY_FREE( self->names );
+        self->names = NULL;
+    }
+
+    if( self->types != NULL )
+    {
+        ANY_FREE( self->types );
+        self->types = NULL;
+    }
+
+    if( self->strings != NULL )
+    {
+        ANY_FREE( self->strings );
+        self->strings = NULL;
+    }
+
+    /* posix_memalign() blocks go back through free() */
+    free( self->ints );
+    free( self->doubles );
+
+    self->ints = NULL;
+    self->doubles = NULL;
+    self->numSections = 0;
+    self->numValues = 0;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigColumns *IniConfigColumns_new( void )
+{
+    return ( ANY_TALLOC( IniConfigColumns ) );
+}
+
+
+bool IniConfigColumns_init( IniConfigColumns *self )
+{
+    ANY_REQUIRE( self );
+
+    self->sections = NULL;
+    self->numSections = 0;
+    self->numValues = 0;
+    self->names = NULL;
+    self->types = NULL;
+    self->ints = NULL;
+    self->doubles = NULL;
+    self->strings = NULL;
+
+    self->valid = INICONFIGCOLUMNS_VALID;
+
+    return true;
+}
+
+
+bool IniConfigColumns_build( IniConfigColumns *self, const IniConfigDocument *document )
+{
+    IniConfigColumnsBuilder builder;
+    unsigned int numValues = 0;
+    bool retVal = false;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGCOLUMNS_VALID );
+    ANY_REQUIRE( document );
+
+    IniConfigColumns_release( self );
+
+    memset( &builder, 0, sizeof( builder ) );
+
+    if( !IniConfigDocument_forEach( document, IniConfigColumns_visit, &builder ) )
+    {
+        goto out;
+    }
+
+    /* at least one element each, so that an empty document still succeeds */
+    numValues = ( builder.numValues > 0 ) ? builder.numValues : 1;
+
+    self->sections = ANY_NTALLOC( builder.numSections + 1, IniConfigColumnsSection );
+    self->names = ANY_NTALLOC( numValues, const char * );
+    self->types = ANY_NTALLOC( numValues, unsigned char );
+    self->strings = (char *)ANY_BALLOC( builder.stringSize + 1 );
+    self->ints = (int64_t *)IniConfigColumns_alloc( numValues * sizeof( int64_t ) );
+    self->doubles = (double *)IniConfigColumns_alloc( numValues * sizeof( double ) );
+
+    if( self->sections == NULL || self->names == NULL || self->types == NULL || self->strings == NULL ||
+        self->ints == NULL || self->doubles == NULL )
+    {
+        ANY_LOG( 0, "Unable to allocate the columns of %u values", ANY_LOG_ERROR, builder.numValues );
+        goto out;
+    }
+
+    builder.columns = self;
+    builder.numSections = 0;
+    builder.numValues = 0;
+
+    /* section detection starts over */
+    free( builder.lastName );
+    builder.lastName = NULL;
+    builder.lastSize = 0;
+
+    if( !IniConfigDocument_forEach( document, IniConfigColumns_visit, &builder ) )
+    {
+        goto out;
+    }
+
+    self->numSections = builder.numSections;
+    self->numValues = builder.numValues;
+
+    retVal = true;
+
+    out:
+
+    free( builder.lastName );
+
+    if( !retVal )
+    {
+        IniConfigColumns_release( self );
+    }
+
+    return retVal;
+}
+
+
+bool IniConfigColumns_getSpan( const IniConfigColumns *self, const char *section, IniConfigColumnsSpan *span )
+{
+    unsigned int hash = 0;
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGCOLUMNS_VALID );
+    ANY_REQUIRE( span );
+
+    memset( span, 0, sizeof( *span ) );
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    hash = IniConfigHamt_hashSection( section );
+
+    for( i = 0; i < self->numSections; i++ )
+    {
+        const IniConfigColumnsSection *entry = &self->sections[i];
+
+        if( entry->hash == hash && IniConfigColumns_equalsNoCase( entry->name, section ) )
+        {
+            span->count = entry->count;
+            span->names = self->names + entry->first;
+            span->types = self->types + entry->first;
+            span->ints = self->ints + entry->first;
+            span->doubles = self->doubles + entry->first;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void IniConfigColumns_clear( IniConfigColumns *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGCOLUMNS_VALID );
+
+    IniConfigColumns_release( self );
+
+    self->valid = INICONFIGCOLUMNS_INVALID;
+}
+
+
+void IniConfigColumns_delete( IniConfigColumns *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
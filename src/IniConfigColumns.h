@@ -0,0 +1,192 @@
+/*
+ *  Numeric values of all sections as typed columns
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigColumns Numeric columns
+ *
+ * Sections holding thousands of numbers, e.g. calibration tables, are
+ * better consumed as arrays than key by key. IniConfigColumns_build()
+ * infers the type of every value of a document and copies the numeric
+ * ones into contiguous columns:
+ *
+ *  - INICONFIGCOLUMNS_INT: decimal integers and "0x" prefixed hexadecimal
+ *    ones which fit into 64 bits
+ *  - INICONFIGCOLUMNS_DOUBLE: everything else strtod() reads completely,
+ *    apart from "inf" and "nan" spelled out
+ *
+ * Values with any other text are strings and are left out.
+ *
+ * IniConfigColumns_getSpan() then returns the numbers of one section in
+ * key order without copying them: the key names, the type of each value,
+ * all values as double and the integers as int64_t. The columns of every
+ * section start at a multiple of INICONFIGCOLUMNS_ALIGN bytes, so SIMD
+ * code may use aligned loads on them.
+ *
+ * \code
+ *  IniConfigColumnsSpan span;
+ *
+ *  if( IniConfigFile_getColumns( myIniFile, "Calibration", &span ) )
+ *  {
+ *    for( i = 0; i < span.count; i++ )
+ *    {
+ *      sum += span.doubles[i];
+ *    }
+ *  }
+ * \endcode
+ *
+ * The columns are a copy taken when they are built and do not follow
+ * later puts. Spans stay valid until the columns are built again or
+ * cleared.
+ */
+
+#ifndef INICONFIGCOLUMNS_H
+#define INICONFIGCOLUMNS_H
+
+#include <stdint.h>
+
+#include <IniConfigDocument.h>
+
+/*!
+ * \brief Alignment in bytes of the columns of every section
+ */
+#define INICONFIGCOLUMNS_ALIGN  64
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Type inferred for a numeric value
+ */
+typedef enum IniConfigColumnsType
+{
+    INICONFIGCOLUMNS_INT = 1,           /**< Integer, exact in ints */
+    INICONFIGCOLUMNS_DOUBLE = 2         /**< Floating point number */
+}
+IniConfigColumnsType;
+
+/*!
+ * \brief The numeric values of one section, in key order
+ *
+ * All arrays have count elements and belong to the columns.
+ */
+typedef struct IniConfigColumnsSpan
+{
+    unsigned int count;                 /**< Number of numeric keys */
+    const char *const *names;           /**< Key names */
+    const unsigned char *types;         /**< IniConfigColumnsType of every value */
+    const int64_t *ints;                /**< Integer values, 0 for INICONFIGCOLUMNS_DOUBLE ones */
+    const double *doubles;              /**< All values as double */
+}
+IniConfigColumnsSpan;
+
+/*!
+ * \brief Position of the values of one section in the columns
+ */
+typedef struct IniConfigColumnsSection
+{
+    const char *name;                   /**< Section name, "" for the global area */
+    unsigned int hash;                  /**< IniConfigHamt_hashSection() of the name */
+    unsigned int first;                 /**< Index of the first value */
+    unsigned int count;                 /**< Number of values */
+}
+IniConfigColumnsSection;
+
+/*!
+ * \brief IniConfigColumns definition
+ */
+typedef struct IniConfigColumns
+{
+    unsigned long valid;                /**< Object validity */
+    IniConfigColumnsSection *sections;  /**< Sections with numeric keys, in document order */
+    unsigned int numSections;           /**< Number of sections */
+    unsigned int numValues;             /**< Length of the columns, including alignment gaps */
+    const char **names;                 /**< Key name column */
+    unsigned char *types;               /**< Type column */
+    int64_t *ints;                      /**< Integer column */
+    double *doubles;                    /**< Double column */
+    char *strings;                      /**< Section and key names */
+}
+IniConfigColumns;
+
+/*!
+ * \brief Allocate a new IniConfigColumns instance
+ *
+ * \return A new IniConfigColumns instance, NULL on error
+ *
+ * \see IniConfigColumns_init()
+ */
+IniConfigColumns *IniConfigColumns_new( void );
+
+/*!
+ * \brief Initialize empty columns
+ *
+ * \param self Pointer to the IniConfigColumns
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigColumns_init( IniConfigColumns *self );
+
+/*!
+ * \brief Copy the numeric values of a document into the columns
+ *
+ * \param self      Pointer to the IniConfigColumns
+ * \param document  Document to copy
+ *
+ * Replaces the previous contents, so spans taken before become invalid.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigColumns_build( IniConfigColumns *self, const IniConfigDocument *document );
+
+/*!
+ * \brief Get the numeric values of a section
+ *
+ * \param self     Pointer to the IniConfigColumns
+ * \param section  Section name, NULL for the global area
+ * \param span     Receives the values, count is 0 if there are none
+ *
+ * Section names are compared without regard to case. Takes time linear
+ * in the number of sections with numeric keys, so look a span up once
+ * and keep it.
+ *
+ * \return Returns true if the section has numeric keys
+ */
+bool IniConfigColumns_getSpan( const IniConfigColumns *self, const char *section, IniConfigColumnsSpan *span );
+
+/*!
+ * \brief Clear an IniConfigColumns instance
+ *
+ * \param self Pointer to the IniConfigColumns
+ *
+ * \return Nothing
+ */
+void IniConfigColumns_clear( IniConfigColumns *self );
+
+/*!
+ * \brief Delete an IniConfigColumns instance
+ *
+ * \param self Pointer to the IniConfigColumns
+ *
+ * \return Nothing
+ */
+void IniConfigColumns_delete( IniConfigColumns *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGCOLUMNS_H */
@@ -0,0 +1,2795 @@
+/*
+ *  In-memory INI document
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <IniConfigAtomicFile.h>
+#include <IniConfigBackend.h>
+#include <IniConfigDocument.h>
+
+#define INICONFIGDOCUMENT_VALID     0x5e1d0c47
+#define INICONFIGDOCUMENT_INVALID   0xb00db00f
+
+#if !defined INICONFIGDOCUMENT_LINETERM
+#define INICONFIGDOCUMENT_LINETERM  "\n"
+#endif
+
+#if defined(IOV_MAX)
+#define INICONFIGDOCUMENT_IOVMAX    IOV_MAX
+#else
+#define INICONFIGDOCUMENT_IOVMAX    1024
+#endif
+
+#define INICONFIGDOCUMENT_MININDEX  64
+
+#define INICONFIGDOCUMENT_BOM       "\xef\xbb\xbf"
+
+/* initial buffer of IniConfigDocument_readFd() for pipes and sockets */
+#define INICONFIGDOCUMENT_READSIZE  4096
+
+/* stands in for the file name in messages about buffers */
+#define INICONFIGDOCUMENT_BUFFERNAME  "<buffer>"
+
+
+/* a section whose parents are being added to the chain */
+typedef struct IniConfigDocumentParents
+{
+    int section;
+    size_t pos;                         /* next parent name in the header */
+    int pattern;                        /* next pattern section to match */
+}
+IniConfigDocumentParents;
+
+/* resolves the inheritance of one section at a time for IniConfigDocument_forEach() */
+typedef struct IniConfigDocumentInheritance
+{
+    int *chain;                         /* sections to take keys from, in order */
+    int numChain;
+    char *visited;                      /* per section, already in the chain */
+    int *patterns;                      /* visible sections with '*' in their name */
+    int numPatterns;
+    IniConfigDocumentParents *stack;    /* one entry per section at most, instead of recursion */
+    int *emitted;                       /* key lines visited for the current section, by hash */
+    unsigned int *stamps;               /* an emitted slot is in use if its stamp is round */
+    unsigned int emittedMask;
+    unsigned int round;
+}
+IniConfigDocumentInheritance;
+
+
+/*
+ * Private functions
+ */
+
+static int IniConfigDocument_isSpace( char c )
+{
+    /* same definition as minIni's skipleading(): 0 < c <= ' ' */
+    return ( c > '\0' && c <= ' ' );
+}
+
+
+static char IniConfigDocument_toLower( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? (char)( c - 'A' + 'a' ) : c;
+}
+
+
+static int IniConfigDocument_equalsNoCase( const char *a, const char *b, size_t length )
+{
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        if( IniConfigDocument_toLower( a[i] ) != IniConfigDocument_toLower( b[i] ) )
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+static unsigned int IniConfigDocument_hash( const char *name, size_t length, unsigned int seed )
+{
+    unsigned int hash = 2166136261u ^ seed;
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        hash ^= (unsigned char)IniConfigDocument_toLower( name[i] );
+        hash *= 16777619u;
+    }
+
+    return ( hash != 0 ) ? hash : 1;
+}
+
+
+static const char *IniConfigDocument_lineText( const IniConfigDocument *self, const IniConfigDocumentLine *line )
+{
+    return ( line->text != NULL ) ? line->text : self->source + line->offset;
+}
+
+
+static int IniConfigDocument_startsWithBracket( const IniConfigDocument *self, const IniConfigDocumentLine *line )
+{
+    const char *text = IniConfigDocument_lineText( self, line );
+    size_t i = 0;
+
+    while( i < line->length && IniConfigDocument_isSpace( text[i] ) )
+    {
+        i++;
+    }
+
+    return ( i < line->length && text[i] == '[' );
+}
+
+
+/*
+ * Classifies a line and locates its name and value, following the rules of
+ * minIni's getkeystring() and cleanstring()
+ */
+static void IniConfigDocument_analyzeLine( const char *text, size_t length, IniConfigDocumentLine *line )
+{
+    size_t end = length;
+    size_t sp = 0;
+    size_t ep = 0;
+    size_t sep = 0;
+    int inString = 0;
+
+    line->type = INICONFIGDOCUMENT_LINE_OTHER;
+    line->nameOffset = 0;
+    line->nameLength = 0;
+    line->parentOffset = 0;
+    line->parentLength = 0;
+    line->valueOffset = 0;
+    line->valueLength = 0;
+    line->quoted = 0;
+
+    /* the terminator is not part of the content */
+    if( end > 0 && text[end - 1] == '\n' )
+    {
+        end--;
+
+        if( end > 0 && text[end - 1] == '\r' )
+        {
+            end--;
+        }
+    }
+
+    while( sp < end && IniConfigDocument_isSpace( text[sp] ) )
+    {
+        sp++;
+    }
+
+    if( sp == end )
+    {
+        line->type = INICONFIGDOCUMENT_LINE_BLANK;
+        return;
+    }
+
+    if( text[sp] == '[' )
+    {
+        /* minIni takes the last ']' on the line */
+        for( ep = end; ep > sp && text[ep - 1] != ']'; ep-- )
+        {
+        }
+
+        if( ep == sp )
+        {
+            return;
+        }
+
+        ep--;
+        sp++;
+
+        while( sp < ep && IniConfigDocument_isSpace( text[sp] ) )
+        {
+            sp++;
+        }
+
+        while( ep > sp && IniConfigDocument_isSpace( text[ep - 1] ) )
+        {
+            ep--;
+        }
+
+        line->type = INICONFIGDOCUMENT_LINE_SECTION;
+        line->nameOffset = sp;
+        line->nameLength = ep - sp;
+
+        /* "[name : parent, ...]" declares the sections to inherit from */
+        for( sep = sp; sep < ep && text[sep] != ':'; sep++ )
+        {
+        }
+
+        if( sep < ep )
+        {
+            for( line->nameLength = sep - sp; line->nameLength > 0; line->nameLength-- )
+            {
+                if( !IniConfigDocument_isSpace( text[sp + line->nameLength - 1] ) )
+                {
+                    break;
+                }
+            }
+
+            for( sep++; sep < ep && IniConfigDocument_isSpace( text[sep] ); sep++ )
+            {
+            }
+
+            line->parentOffset = sep;
+            line->parentLength = ep - sep;
+        }
+
+        return;
+    }
+
+    if( text[sp] == ';' || text[sp] == '#' )
+    {
+        line->type = INICONFIGDOCUMENT_LINE_COMMENT;
+        return;
+    }
+
+    /* the first '=' wins, ':' is only considered without any '=' */
+    for( sep = sp; sep < end && text[sep] != '='; sep++ )
+    {
+    }
+
+    if( sep == end )
+    {
+        for( sep = sp; sep < end && text[sep] != ':'; sep++ )
+        {
+        }
+
+        if( sep == end )
+        {
+            return;
+        }
+    }
+
+    line->type = INICONFIGDOCUMENT_LINE_KEY;
+    line->nameOffset = sp;
+
+    for( ep = sep; ep > sp && IniConfigDocument_isSpace( text[ep - 1] ); ep-- )
+    {
+    }
+
+    line->nameLength = ep - sp;
+
+    for( sp = sep + 1; sp < end && IniConfigDocument_isSpace( text[sp] ); sp++ )
+    {
+    }
+
+    /* cut a trailing comment which is not inside a string */
+    for( ep = sp; ep < end && ( ( text[ep] != ';' && text[ep] != '#' ) || inString ); ep++ )
+    {
+        if( text[ep] == '"' )
+        {
+            if( ep + 1 < end && text[ep + 1] == '"' )
+            {
+                ep++;
+            }
+            else
+            {
+                inString = !inString;
+            }
+        }
+        else if( text[ep] == '\\' && ep + 1 < end && text[ep + 1] == '"' )
+        {
+            ep++;
+        }
+    }
+
+    while( ep > sp && IniConfigDocument_isSpace( text[ep - 1] ) )
+    {
+        ep--;
+    }
+
+    line->valueOffset = sp;
+    line->valueLength = ep - sp;
+    line->quoted = ( ep > sp && text[sp] == '"' && text[ep - 1] == '"' );
+}
+
+
+/*
+ * Copies a name or value into a caller buffer like minIni's save_strncpy()
+ */
+static int IniConfigDocument_copyOut( const char *source, size_t length, int dequote, char *buffer, int bufferSize )
+{
+    size_t d = 0;
+    size_t s = 0;
+
+    if( dequote )
+    {
+        /* drop the surrounding quotes and unescape \" and "" */
+        source++;
+        length = ( length >= 2 ) ? length - 2 : 0;
+
+        for( s = 0; s < length && d < (size_t)bufferSize - 1; s++, d++ )
+        {
+            if( ( source[s] == '"' || source[s] == '\\' ) && s + 1 < length && source[s + 1] == '"' )
+            {
+                s++;
+            }
+
+            buffer[d] = source[s];
+        }
+    }
+    else
+    {
+        for( d = 0; d < length && d < (size_t)bufferSize - 1; d++ )
+        {
+            buffer[d] = source[d];
+        }
+    }
+
+    buffer[d] = '\0';
+
+    return (int)d;
+}
+
+
+static int IniConfigDocument_growIndex( IniConfigDocument *self );
+
+
+static IniConfigDocumentSlot *IniConfigDocument_findSlot( const IniConfigDocument *self, unsigned int hash,
+                                                          int section, const char *name, size_t length )
+{
+    unsigned int i = 0;
+
+    if( self->index == NULL )
+    {
+        return NULL;
+    }
+
+    for( i = hash & self->indexMask; self->index[i].hash != 0; i = ( i + 1 ) & self->indexMask )
+    {
+        IniConfigDocumentSlot *slot = &self->index[i];
+        const IniConfigDocumentLine *line = NULL;
+
+        if( slot->hash != hash )
+        {
+            continue;
+        }
+
+        if( section < 0 )
+        {
+            /* looking for a section entry */
+            if( slot->line != -1 )
+            {
+                continue;
+            }
+
+            line = &self->lines[self->sections[slot->section].line];
+        }
+        else
+        {
+            if( slot->line == -1 || slot->section != section )
+            {
+                continue;
+            }
+
+            line = &self->lines[slot->line];
+        }
+
+        if( line->nameLength == length &&
+            IniConfigDocument_equalsNoCase( IniConfigDocument_lineText( self, line ) + line->nameOffset,
+                                            name, length ) )
+        {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+
+static int IniConfigDocument_insertSlot( IniConfigDocument *self, unsigned int hash, int section, int line )
+{
+    unsigned int i = 0;
+
+    if( ( self->indexUsed + 1 ) * 2 > self->indexMask + 1 )
+    {
+        if( !IniConfigDocument_growIndex( self ) )
+        {
+            return 0;
+        }
+    }
+
+    for( i = hash & self->indexMask; self->index[i].hash != 0; i = ( i + 1 ) & self->indexMask )
+    {
+    }
+
+    self->index[i].hash = hash;
+    self->index[i].section = section;
+    self->index[i].line = line;
+    self->indexUsed++;
+
+    return 1;
+}
+
+
+static void IniConfigDocument_removeSlot( IniConfigDocument *self, IniConfigDocumentSlot *slot )
+{
+    unsigned int i = (unsigned int)( slot - self->index );
+    unsigned int j = i;
+
+    /* backward shift deletion keeps the probe sequences intact */
+    for( ;; )
+    {
+        unsigned int home = 0;
+
+        j = ( j + 1 ) & self->indexMask;
+
+        if( self->index[j].hash == 0 )
+        {
+            break;
+        }
+
+        home = self->index[j].hash & self->indexMask;
+
+        if( ( j > i && ( home <= i || home > j ) ) || ( j < i && ( home <= i && home > j ) ) )
+        {
+            self->index[i] = self->index[j];
+            i = j;
+        }
+    }
+
+    self->index[i].hash = 0;
+    self->indexUsed--;
+}
+
+
+static int IniConfigDocument_growIndex( IniConfigDocument *self )
+{
+    IniConfigDocumentSlot *old = self->index;
+    unsigned int oldSize = ( old != NULL ) ? self->indexMask + 1 : 0;
+    unsigned int size = ( oldSize != 0 ) ? oldSize * 2 : INICONFIGDOCUMENT_MININDEX;
+    unsigned int i = 0;
+
+    self->index = ANY_NTALLOC( size, IniConfigDocumentSlot );
+
+    if( self->index == NULL )
+    {
+        self->index = old;
+        return 0;
+    }
+
+    self->indexMask = size - 1;
+    self->indexUsed = 0;
+
+    for( i = 0; i < oldSize; i++ )
+    {
+        if( old[i].hash != 0 )
+        {
+            IniConfigDocument_insertSlot( self, old[i].hash, old[i].section, old[i].line );
+        }
+    }
+
+    ANY_FREE( old );
+
+    return 1;
+}
+
+
+static unsigned int IniConfigDocument_sectionHash( const char *name, size_t length )
+{
+    return IniConfigDocument_hash( name, length, 0x5bd1e995u );
+}
+
+
+static unsigned int IniConfigDocument_keyHash( int section, const char *name, size_t length )
+{
+    return IniConfigDocument_hash( name, length, (unsigned int)section * 0x9e3779b9u );
+}
+
+
+static int IniConfigDocument_findSection( const IniConfigDocument *self, const char *section )
+{
+    IniConfigDocumentSlot *slot = NULL;
+    size_t length = ( section != NULL ) ? strlen( section ) : 0;
+
+    if( length == 0 )
+    {
+        return 0;
+    }
+
+    slot = IniConfigDocument_findSlot( self, IniConfigDocument_sectionHash( section, length ), -1, section, length );
+
+    return ( slot != NULL ) ? slot->section : -1;
+}
+
+
+static int IniConfigDocument_findKey( const IniConfigDocument *self, int section, const char *key )
+{
+    IniConfigDocumentSlot *slot = NULL;
+    size_t length = strlen( key );
+
+    slot = IniConfigDocument_findSlot( self, IniConfigDocument_keyHash( section, key, length ), section, key, length );
+
+    return ( slot != NULL ) ? slot->line : -1;
+}
+
+
+static int IniConfigDocument_findSectionName( const IniConfigDocument *self, const char *name, size_t length )
+{
+    IniConfigDocumentSlot *slot = NULL;
+
+    if( length == 0 )
+    {
+        return -1;
+    }
+
+    slot = IniConfigDocument_findSlot( self, IniConfigDocument_sectionHash( name, length ), -1, name, length );
+
+    return ( slot != NULL ) ? slot->section : -1;
+}
+
+
+/*
+ * Matches a section name against a pattern where '*' stands for any text
+ */
+static int IniConfigDocument_matches( const char *pattern, size_t patternLength, const char *name, size_t length )
+{
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = patternLength;
+    size_t mark = 0;
+
+    while( n < length )
+    {
+        if( p < patternLength && pattern[p] == '*' )
+        {
+            star = p++;
+            mark = n;
+        }
+        else if( p < patternLength &&
+                 IniConfigDocument_toLower( pattern[p] ) == IniConfigDocument_toLower( name[n] ) )
+        {
+            p++;
+            n++;
+        }
+        else if( star != patternLength )
+        {
+            /* let the last '*' swallow one more character */
+            p = star + 1;
+            n = ++mark;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    while( p < patternLength && pattern[p] == '*' )
+    {
+        p++;
+    }
+
+    return ( p == patternLength );
+}
+
+
+/*
+ * Parses the parent name at pos of a header, returns its section or -1 if
+ * there is no such section
+ */
+static int IniConfigDocument_nextParent( const IniConfigDocument *self, const char *text, size_t *pos, size_t end )
+{
+    size_t start = *pos;
+    size_t stop = 0;
+
+    while( *pos < end && text[*pos] != ',' )
+    {
+        ( *pos )++;
+    }
+
+    for( stop = *pos; stop > start && IniConfigDocument_isSpace( text[stop - 1] ); stop-- )
+    {
+    }
+
+    for( ( *pos )++; *pos < end && IniConfigDocument_isSpace( text[*pos] ); ( *pos )++ )
+    {
+    }
+
+    return IniConfigDocument_findSectionName( self, text + start, stop - start );
+}
+
+
+static void IniConfigDocument_pushParents( const IniConfigDocument *self, int section,
+                                           IniConfigDocumentInheritance *inheritance, int depth )
+{
+    const IniConfigDocumentLine *header = &self->lines[self->sections[section].line];
+    const char *name = IniConfigDocument_lineText( self, header ) + header->nameOffset;
+
+    inheritance->stack[depth].section = section;
+    inheritance->stack[depth].pos = header->parentOffset;
+
+    /* pattern sections do not inherit from other patterns */
+    inheritance->stack[depth].pattern = ( memchr( name, '*', header->nameLength ) != NULL ) ?
+                                        inheritance->numPatterns : 0;
+}
+
+
+/*
+ * Appends the sections a section inherits from to the chain, depth first.
+ * Every section enters the stack once at most, so long chains of
+ * inheritance need no deep recursion.
+ */
+static void IniConfigDocument_addParents( const IniConfigDocument *self, int section,
+                                          IniConfigDocumentInheritance *inheritance )
+{
+    int depth = 0;
+
+    IniConfigDocument_pushParents( self, section, inheritance, depth++ );
+
+    while( depth > 0 )
+    {
+        IniConfigDocumentParents *top = &inheritance->stack[depth - 1];
+        const IniConfigDocumentLine *header = &self->lines[self->sections[top->section].line];
+        const char *text = IniConfigDocument_lineText( self, header );
+        size_t end = header->parentOffset + header->parentLength;
+        int next = 0;
+
+        /* unknown parents are ignored, cycles end at the first repetition */
+        while( top->pos < end && next == 0 )
+        {
+            next = IniConfigDocument_nextParent( self, text, &top->pos, end );
+
+            if( next <= 0 || inheritance->visited[next] )
+            {
+                next = 0;
+            }
+        }
+
+        while( top->pattern < inheritance->numPatterns && next == 0 )
+        {
+            int pattern = inheritance->patterns[top->pattern++];
+            const IniConfigDocumentLine *patternHeader = &self->lines[self->sections[pattern].line];
+
+            if( !inheritance->visited[pattern] &&
+                IniConfigDocument_matches( IniConfigDocument_lineText( self, patternHeader ) +
+                                           patternHeader->nameOffset, patternHeader->nameLength,
+                                           text + header->nameOffset, header->nameLength ) )
+            {
+                next = pattern;
+            }
+        }
+
+        if( next <= 0 )
+        {
+            depth--;
+            continue;
+        }
+
+        inheritance->visited[next] = 1;
+        inheritance->chain[inheritance->numChain++] = next;
+
+        IniConfigDocument_pushParents( self, next, inheritance, depth++ );
+    }
+}
+
+
+/*
+ * Adds a key to those visited for the current section, returns 0 if an
+ * earlier parent supplied it already
+ */
+static int IniConfigDocument_emit( const IniConfigDocument *self, IniConfigDocumentInheritance *inheritance,
+                                   const char *key, size_t length, int lineIdx )
+{
+    unsigned int i = 0;
+
+    for( i = IniConfigDocument_hash( key, length, 0 ) & inheritance->emittedMask;
+         inheritance->stamps[i] == inheritance->round; i = ( i + 1 ) & inheritance->emittedMask )
+    {
+        const IniConfigDocumentLine *line = &self->lines[inheritance->emitted[i]];
+
+        if( line->nameLength == length &&
+            IniConfigDocument_equalsNoCase( IniConfigDocument_lineText( self, line ) + line->nameOffset, key,
+                                            length ) )
+        {
+            return 0;
+        }
+    }
+
+    inheritance->emitted[i] = lineIdx;
+    inheritance->stamps[i] = inheritance->round;
+
+    return 1;
+}
+
+
+/*
+ * Visits the keys a section inherits and does not hold itself
+ */
+static bool IniConfigDocument_visitInherited( const IniConfigDocument *self, int section, const char *sectionName,
+                                              IniConfigDocumentInheritance *inheritance, char *key, char *value,
+                                              size_t maxLength, IniConfigDocumentVisitor visitor, void *context )
+{
+    bool retVal = true;
+    int i = 0;
+
+    inheritance->numChain = 0;
+    inheritance->visited[section] = 1;
+
+    /* a new round empties the keys visited for the previous section */
+    if( ++inheritance->round == 0 )
+    {
+        memset( inheritance->stamps, 0, ( inheritance->emittedMask + 1 ) * sizeof( unsigned int ) );
+        inheritance->round = 1;
+    }
+
+    IniConfigDocument_addParents( self, section, inheritance );
+
+    for( i = 0; i < inheritance->numChain && retVal; i++ )
+    {
+        int parent = inheritance->chain[i];
+        int lineIdx = self->lines[self->sections[parent].line].next;
+
+        for( ; lineIdx != -1 && retVal; lineIdx = self->lines[lineIdx].next )
+        {
+            const IniConfigDocumentLine *line = &self->lines[lineIdx];
+            const char *text = IniConfigDocument_lineText( self, line );
+
+            if( line->type == INICONFIGDOCUMENT_LINE_SECTION )
+            {
+                break;
+            }
+
+            if( line->type != INICONFIGDOCUMENT_LINE_KEY )
+            {
+                continue;
+            }
+
+            memcpy( key, text + line->nameOffset, line->nameLength );
+            key[line->nameLength] = '\0';
+
+            /* overridden by the section itself or by an earlier parent, whose keys come first */
+            if( IniConfigDocument_findKey( self, parent, key ) != lineIdx ||
+                IniConfigDocument_findKey( self, section, key ) != -1 ||
+                !IniConfigDocument_emit( self, inheritance, key, line->nameLength, lineIdx ) )
+            {
+                continue;
+            }
+
+            IniConfigDocument_copyOut( text + line->valueOffset, line->valueLength, line->quoted,
+                                       value, (int)maxLength + 1 );
+
+            retVal = visitor( context, sectionName, key, value );
+        }
+    }
+
+    inheritance->visited[section] = 0;
+
+    for( i = 0; i < inheritance->numChain; i++ )
+    {
+        inheritance->visited[inheritance->chain[i]] = 0;
+    }
+
+    return retVal;
+}
+
+
+/*
+ * Registers a key line in the index unless an earlier line of the same
+ * section already holds that key
+ */
+static int IniConfigDocument_indexKey( IniConfigDocument *self, int lineIdx )
+{
+    const IniConfigDocumentLine *line = &self->lines[lineIdx];
+    const char *name = IniConfigDocument_lineText( self, line ) + line->nameOffset;
+    unsigned int hash = IniConfigDocument_keyHash( line->section, name, line->nameLength );
+
+    if( IniConfigDocument_findSlot( self, hash, line->section, name, line->nameLength ) != NULL )
+    {
+        return 1;
+    }
+
+    return IniConfigDocument_insertSlot( self, hash, line->section, lineIdx );
+}
+
+
+static int IniConfigDocument_rebuildIndex( IniConfigDocument *self )
+{
+    char *visible = ANY_NTALLOC( self->numSections, char );
+    int retVal = 0;
+    int i = 0;
+
+    if( visible == NULL )
+    {
+        return 0;
+    }
+
+    if( self->index != NULL )
+    {
+        memset( self->index, 0, ( self->indexMask + 1 ) * sizeof( IniConfigDocumentSlot ) );
+        self->indexUsed = 0;
+    }
+
+    visible[0] = 1;
+
+    /* only the first section of a given name is visible, like in minIni */
+    for( i = 1; i < self->numSections; i++ )
+    {
+        const IniConfigDocumentLine *header = NULL;
+        const char *name = NULL;
+        unsigned int hash = 0;
+
+        if( self->sections[i].removed )
+        {
+            continue;
+        }
+
+        header = &self->lines[self->sections[i].line];
+        name = IniConfigDocument_lineText( self, header ) + header->nameOffset;
+        hash = IniConfigDocument_sectionHash( name, header->nameLength );
+
+        if( header->nameLength == 0 ||
+            IniConfigDocument_findSlot( self, hash, -1, name, header->nameLength ) != NULL )
+        {
+            continue;
+        }
+
+        if( !IniConfigDocument_insertSlot( self, hash, i, -1 ) )
+        {
+            goto out;
+        }
+
+        visible[i] = 1;
+    }
+
+    /* keys of hidden sections and of unnamed ones are never found */
+    for( i = self->head; i != -1; i = self->lines[i].next )
+    {
+        const IniConfigDocumentLine *line = &self->lines[i];
+
+        if( line->type != INICONFIGDOCUMENT_LINE_KEY || line->section < 0 || !visible[line->section] )
+        {
+            continue;
+        }
+
+        if( !IniConfigDocument_indexKey( self, i ) )
+        {
+            goto out;
+        }
+    }
+
+    retVal = 1;
+
+    out:
+
+    ANY_FREE( visible );
+
+    return retVal;
+}
+
+
+static int IniConfigDocument_newLine( IniConfigDocument *self )
+{
+    if( self->numLines == self->maxLines )
+    {
+        int maxLines = ( self->maxLines != 0 ) ? self->maxLines * 2 : 64;
+        IniConfigDocumentLine *lines = (IniConfigDocumentLine *)realloc( self->lines,
+                                                                         maxLines * sizeof( IniConfigDocumentLine ) );
+
+        if( lines == NULL )
+        {
+            return -1;
+        }
+
+        self->lines = lines;
+        self->maxLines = maxLines;
+    }
+
+    memset( &self->lines[self->numLines], 0, sizeof( IniConfigDocumentLine ) );
+    self->lines[self->numLines].prev = -1;
+    self->lines[self->numLines].next = -1;
+
+    return self->numLines++;
+}
+
+
+static int IniConfigDocument_newSection( IniConfigDocument *self, int line )
+{
+    if( self->numSections == self->maxSections )
+    {
+        int maxSections = ( self->maxSections != 0 ) ? self->maxSections * 2 : 16;
+        IniConfigDocumentSection *sections = (IniConfigDocumentSection *)realloc( self->sections,
+                                                                                  maxSections *
+                                                                                  sizeof( IniConfigDocumentSection ) );
+
+        if( sections == NULL )
+        {
+            return -1;
+        }
+
+        self->sections = sections;
+        self->maxSections = maxSections;
+    }
+
+    self->sections[self->numSections].line = line;
+    self->sections[self->numSections].lastLine = line;
+    self->sections[self->numSections].removed = 0;
+    self->sections[self->numSections].firstKey = 0;
+    self->sections[self->numSections].numKeys = 0;
+
+    return self->numSections++;
+}
+
+
+static void IniConfigDocument_link( IniConfigDocument *self, int idx, int after )
+{
+    IniConfigDocumentLine *line = &self->lines[idx];
+
+    line->prev = after;
+    line->next = ( after != -1 ) ? self->lines[after].next : self->head;
+
+    if( after != -1 )
+    {
+        self->lines[after].next = idx;
+    }
+    else
+    {
+        self->head = idx;
+    }
+
+    if( line->next != -1 )
+    {
+        self->lines[line->next].prev = idx;
+    }
+    else
+    {
+        self->tail = idx;
+    }
+}
+
+
+static void IniConfigDocument_unlink( IniConfigDocument *self, int idx )
+{
+    IniConfigDocumentLine *line = &self->lines[idx];
+
+    if( line->prev != -1 )
+    {
+        self->lines[line->prev].next = line->next;
+    }
+    else
+    {
+        self->head = line->next;
+    }
+
+    if( line->next != -1 )
+    {
+        self->lines[line->next].prev = line->prev;
+    }
+    else
+    {
+        self->tail = line->prev;
+    }
+
+    ANY_FREE( line->text );
+    line->text = NULL;
+    line->prev = -1;
+    line->next = -1;
+    line->type = INICONFIGDOCUMENT_LINE_BLANK;
+    line->section = -1;
+}
+
+
+/*
+ * Gives a line its own text and re-analyzes it
+ */
+static int IniConfigDocument_setText( IniConfigDocument *self, int idx, char *text, size_t length )
+{
+    IniConfigDocumentLine *line = &self->lines[idx];
+
+    ANY_FREE( line->text );
+
+    line->text = text;
+    line->length = length;
+
+    IniConfigDocument_analyzeLine( text, length, line );
+
+    self->modified = 1;
+
+    return 1;
+}
+
+
+/*
+ * Makes sure a line ends with a line terminator before another one is
+ * inserted after it
+ */
+static int IniConfigDocument_terminate( IniConfigDocument *self, int idx )
+{
+    IniConfigDocumentLine *line = &self->lines[idx];
+    const char *text = IniConfigDocument_lineText( self, line );
+    size_t termLength = strlen( self->lineTerm );
+    char *copy = NULL;
+
+    if( line->length > 0 && text[line->length - 1] == '\n' )
+    {
+        return 1;
+    }
+
+    copy = (char *)ANY_BALLOC( line->length + termLength + 1 );
+
+    if( copy == NULL )
+    {
+        return 0;
+    }
+
+    memcpy( copy, text, line->length );
+    memcpy( copy + line->length, self->lineTerm, termLength + 1 );
+
+    return IniConfigDocument_setText( self, idx, copy, line->length + termLength );
+}
+
+
+static int IniConfigDocument_insertText( IniConfigDocument *self, int after, const char *text, size_t length,
+                                         int section )
+{
+    int idx = 0;
+    char *copy = NULL;
+
+    if( after != -1 && !IniConfigDocument_terminate( self, after ) )
+    {
+        return -1;
+    }
+
+    copy = (char *)ANY_BALLOC( length + 1 );
+    idx = IniConfigDocument_newLine( self );
+
+    if( copy == NULL || idx == -1 )
+    {
+        ANY_FREE( copy );
+        return -1;
+    }
+
+    memcpy( copy, text, length );
+
+    IniConfigDocument_setText( self, idx, copy, length );
+    IniConfigDocument_link( self, idx, after );
+    self->lines[idx].section = section;
+
+    return idx;
+}
+
+
+/*
+ * Checks whether a value needs quotes, like minIni's check_enquote()
+ */
+static int IniConfigDocument_needsQuotes( const char *value )
+{
+    const char *p = value;
+
+    while( *p != '\0' && *p != '"' && *p != ';' && *p != '#' )
+    {
+        p++;
+    }
+
+    return ( *p != '\0' || ( p > value && *( p - 1 ) == ' ' ) );
+}
+
+
+/*
+ * Serializes "<prefix><value><suffix>" into a newly allocated string,
+ * quoting the value if required
+ */
+static char *IniConfigDocument_format( const char *prefix, size_t prefixLength, const char *value,
+                                       const char *suffix, size_t suffixLength, size_t *length )
+{
+    size_t valueLength = strlen( value );
+    int quote = IniConfigDocument_needsQuotes( value );
+    char *text = (char *)ANY_BALLOC( prefixLength + valueLength * 2 + 2 + suffixLength + 1 );
+    size_t d = 0;
+    size_t s = 0;
+
+    if( text == NULL )
+    {
+        return NULL;
+    }
+
+    memcpy( text, prefix, prefixLength );
+    d = prefixLength;
+
+    if( quote )
+    {
+        text[d++] = '"';
+    }
+
+    for( s = 0; s < valueLength; s++ )
+    {
+        if( quote && value[s] == '"' )
+        {
+            text[d++] = '\\';
+        }
+
+        text[d++] = value[s];
+    }
+
+    if( quote )
+    {
+        text[d++] = '"';
+    }
+
+    memcpy( text + d, suffix, suffixLength );
+    d += suffixLength;
+    text[d] = '\0';
+
+    *length = d;
+
+    return text;
+}
+
+
+static char *IniConfigDocument_formatKey( const IniConfigDocument *self, const char *key, const char *value,
+                                          size_t *length )
+{
+    size_t keyLength = strlen( key );
+    char *prefix = (char *)ANY_BALLOC( keyLength + 2 );
+    char *text = NULL;
+
+    if( prefix == NULL )
+    {
+        return NULL;
+    }
+
+    memcpy( prefix, key, keyLength );
+    prefix[keyLength] = '=';
+
+    text = IniConfigDocument_format( prefix, keyLength + 1, value, self->lineTerm, strlen( self->lineTerm ),
+                                     length );
+
+    ANY_FREE( prefix );
+
+    return text;
+}
+
+
+static int IniConfigDocument_replaceValue( IniConfigDocument *self, int idx, const char *key, const char *value )
+{
+    IniConfigDocumentLine *line = &self->lines[idx];
+    const char *old = IniConfigDocument_lineText( self, line );
+    size_t valueEnd = line->valueOffset + line->valueLength;
+    IniConfigDocumentLine check;
+    size_t length = 0;
+    char *text = NULL;
+
+    /* keep the key spelling, the delimiter spacing and a trailing comment */
+    text = IniConfigDocument_format( old, line->valueOffset, value, old + valueEnd, line->length - valueEnd,
+                                     &length );
+
+    if( text == NULL )
+    {
+        return 0;
+    }
+
+    IniConfigDocument_analyzeLine( text, length, &check );
+
+    if( check.type != INICONFIGDOCUMENT_LINE_KEY || check.nameLength != line->nameLength ||
+        memcmp( text + check.nameOffset, old + line->nameOffset, line->nameLength ) != 0 )
+    {
+        /* the new value would change how the line parses, write it afresh */
+        ANY_FREE( text );
+
+        text = IniConfigDocument_formatKey( self, key, value, &length );
+
+        if( text == NULL )
+        {
+            return 0;
+        }
+    }
+
+    return IniConfigDocument_setText( self, idx, text, length );
+}
+
+
+/*
+ * Finds the line after which a key of the given section is inserted once
+ * the line "removed" disappears
+ */
+static int IniConfigDocument_lastKeyBefore( const IniConfigDocument *self, int section, int removed )
+{
+    int i = 0;
+
+    for( i = self->lines[removed].prev; i != -1; i = self->lines[i].prev )
+    {
+        const IniConfigDocumentLine *line = &self->lines[i];
+
+        if( line->type == INICONFIGDOCUMENT_LINE_KEY && line->section == section )
+        {
+            return i;
+        }
+
+        if( line->type == INICONFIGDOCUMENT_LINE_SECTION )
+        {
+            break;
+        }
+    }
+
+    return ( section != 0 ) ? self->sections[section].line : -1;
+}
+
+
+static int IniConfigDocument_removeKey( IniConfigDocument *self, int section, const char *key )
+{
+    size_t length = strlen( key );
+    IniConfigDocumentSlot *slot = NULL;
+    int idx = 0;
+    int i = 0;
+
+    slot = IniConfigDocument_findSlot( self, IniConfigDocument_keyHash( section, key, length ), section, key, length );
+
+    if( slot == NULL )
+    {
+        return 1;
+    }
+
+    idx = slot->line;
+
+    IniConfigDocument_removeSlot( self, slot );
+
+    if( self->sections[section].lastLine == idx )
+    {
+        self->sections[section].lastLine = IniConfigDocument_lastKeyBefore( self, section, idx );
+    }
+
+    i = self->lines[idx].next;
+
+    IniConfigDocument_unlink( self, idx );
+    self->modified = 1;
+
+    /* a later duplicate of the key becomes visible */
+    for( ; i != -1 && !IniConfigDocument_startsWithBracket( self, &self->lines[i] ); i = self->lines[i].next )
+    {
+        const IniConfigDocumentLine *line = &self->lines[i];
+
+        if( line->type == INICONFIGDOCUMENT_LINE_KEY && line->nameLength == length &&
+            IniConfigDocument_equalsNoCase( IniConfigDocument_lineText( self, line ) + line->nameOffset,
+                                            key, length ) )
+        {
+            return IniConfigDocument_indexKey( self, i );
+        }
+    }
+
+    return 1;
+}
+
+
+static int IniConfigDocument_removeSection( IniConfigDocument *self, int section )
+{
+    int i = self->sections[section].line;
+
+    /* the header and everything up to the next line starting with '[' */
+    do
+    {
+        int next = self->lines[i].next;
+
+        IniConfigDocument_unlink( self, i );
+        i = next;
+    }
+    while( i != -1 && !IniConfigDocument_startsWithBracket( self, &self->lines[i] ) );
+
+    self->sections[section].removed = 1;
+    self->modified = 1;
+
+    return IniConfigDocument_rebuildIndex( self );
+}
+
+
+static int IniConfigDocument_addSection( IniConfigDocument *self, const char *section )
+{
+    size_t length = strlen( section );
+    size_t termLength = strlen( self->lineTerm );
+    char *text = NULL;
+    int header = 0;
+    int idx = 0;
+
+    if( self->tail != -1 && self->lines[self->tail].type != INICONFIGDOCUMENT_LINE_BLANK )
+    {
+        if( IniConfigDocument_insertText( self, self->tail, self->lineTerm, termLength, -1 ) == -1 )
+        {
+            return -1;
+        }
+    }
+
+    text = (char *)ANY_BALLOC( length + termLength + 3 );
+
+    if( text == NULL )
+    {
+        return -1;
+    }
+
+    text[0] = '[';
+    memcpy( text + 1, section, length );
+    text[length + 1] = ']';
+    memcpy( text + length + 2, self->lineTerm, termLength + 1 );
+
+    header = IniConfigDocument_insertText( self, self->tail, text, length + termLength + 2, -1 );
+
+    ANY_FREE( text );
+
+    if( header == -1 )
+    {
+        return -1;
+    }
+
+    idx = IniConfigDocument_newSection( self, header );
+
+    if( idx == -1 )
+    {
+        return -1;
+    }
+
+    self->lines[header].section = idx;
+
+    if( !IniConfigDocument_insertSlot( self, IniConfigDocument_sectionHash( section, length ), idx, -1 ) )
+    {
+        return -1;
+    }
+
+    return idx;
+}
+
+
+static void IniConfigDocument_reset( IniConfigDocument *self )
+{
+    int i = 0;
+
+    for( i = 0; i < self->numLines; i++ )
+    {
+        ANY_FREE( self->lines[i].text );
+    }
+
+    ANY_FREE( self->lines );
+    ANY_FREE( self->sections );
+    ANY_FREE( self->index );
+
+    if( !self->borrowed )
+    {
+        ANY_FREE( self->source );
+    }
+
+    self->source = NULL;
+    self->sourceLength = 0;
+    self->borrowed = 0;
+    self->lines = NULL;
+    self->numLines = 0;
+    self->maxLines = 0;
+    self->head = -1;
+    self->tail = -1;
+    self->sections = NULL;
+    self->numSections = 0;
+    self->maxSections = 0;
+    self->index = NULL;
+    self->indexMask = 0;
+    self->indexUsed = 0;
+    self->lineTerm = INICONFIGDOCUMENT_LINETERM;
+    self->modified = 0;
+    self->bom = 0;
+
+    ANY_FREE( self->sectionOrder );
+    ANY_FREE( self->keyOrder );
+
+    self->sectionOrder = NULL;
+    self->numOrdered = 0;
+    self->keyOrder = NULL;
+    self->orderDirty = 1;
+}
+
+
+static void IniConfigDocument_setStamp( IniConfigDocument *self, const struct stat *st )
+{
+    memset( &self->stamp, 0, sizeof( IniConfigDocumentStamp ) );
+
+    if( st != NULL )
+    {
+        self->stamp.device = st->st_dev;
+        self->stamp.inode = st->st_ino;
+        self->stamp.size = st->st_size;
+        self->stamp.mtimeSec = st->st_mtim.tv_sec;
+        self->stamp.mtimeNsec = st->st_mtim.tv_nsec;
+    }
+}
+
+
+static const IniConfigBackend *IniConfigDocument_getBackend( const IniConfigDocument *self )
+{
+    return ( self->backend != NULL ) ? self->backend : IniConfigBackend_getPosix();
+}
+
+
+/*
+ * Tells whether the file still is the version the document was loaded from
+ */
+static int IniConfigDocument_isCurrent( const IniConfigDocument *self, const char *fileName )
+{
+    const IniConfigBackend *backend = IniConfigDocument_getBackend( self );
+    struct stat st;
+    void *file = backend->open( backend->context, fileName );
+    bool known = false;
+
+    if( file == NULL )
+    {
+        return ( errno == ENOENT && self->stamp.inode == 0 );
+    }
+
+    known = backend->stat( backend->context, file, &st );
+    backend->close( backend->context, file );
+
+    if( !known )
+    {
+        return 0;
+    }
+
+    return ( self->stamp.device == (unsigned long long)st.st_dev &&
+             self->stamp.inode == (unsigned long long)st.st_ino &&
+             self->stamp.size == (long long)st.st_size &&
+             self->stamp.mtimeSec == (long long)st.st_mtim.tv_sec &&
+             self->stamp.mtimeNsec == (long)st.st_mtim.tv_nsec );
+}
+
+
+static void IniConfigDocument_dropChanges( IniConfigDocument *self )
+{
+    int i = 0;
+
+    for( i = 0; i < self->numChanges; i++ )
+    {
+        ANY_FREE( self->changes[i].section );
+        ANY_FREE( self->changes[i].key );
+        ANY_FREE( self->changes[i].value );
+    }
+
+    self->numChanges = 0;
+}
+
+
+static int IniConfigDocument_record( IniConfigDocument *self, const char *section, const char *key,
+                                     const char *value )
+{
+    IniConfigDocumentChange *change = NULL;
+
+    if( self->numChanges == self->maxChanges )
+    {
+        int maxChanges = ( self->maxChanges != 0 ) ? self->maxChanges * 2 : 16;
+        IniConfigDocumentChange *changes = (IniConfigDocumentChange *)realloc( self->changes,
+                                                                               maxChanges * sizeof( IniConfigDocumentChange ) );
+
+        if( changes == NULL )
+        {
+            return 0;
+        }
+
+        self->changes = changes;
+        self->maxChanges = maxChanges;
+    }
+
+    change = &self->changes[self->numChanges];
+    change->section = ( section != NULL ) ? Any_strdup( (char *)section ) : NULL;
+    change->key = ( key != NULL ) ? Any_strdup( (char *)key ) : NULL;
+    change->value = ( value != NULL ) ? Any_strdup( (char *)value ) : NULL;
+
+    if( ( section != NULL && change->section == NULL ) ||
+        ( key != NULL && change->key == NULL ) ||
+        ( value != NULL && change->value == NULL ) )
+    {
+        ANY_FREE( change->section );
+        ANY_FREE( change->key );
+        ANY_FREE( change->value );
+        return 0;
+    }
+
+    self->numChanges++;
+
+    return 1;
+}
+
+
+/*
+ * Re-reads the file and applies the journal on top of it
+ */
+static int IniConfigDocument_merge( IniConfigDocument *self, const char *fileName )
+{
+    IniConfigDocument fresh;
+    IniConfigDocument swap;
+    int retVal = 0;
+    int i = 0;
+
+    if( !IniConfigDocument_init( &fresh ) )
+    {
+        return 0;
+    }
+
+    fresh.textFlags = self->textFlags;
+    fresh.backend = self->backend;
+
+    if( !IniConfigDocument_load( &fresh, fileName ) )
+    {
+        self->invalidLine = fresh.invalidLine;
+        goto out;
+    }
+
+    for( i = 0; i < self->numChanges; i++ )
+    {
+        const IniConfigDocumentChange *change = &self->changes[i];
+
+        if( !IniConfigDocument_putString( &fresh, change->section, change->key, change->value ) )
+        {
+            goto out;
+        }
+    }
+
+    /* take over the contents, the journal stays with self */
+    swap = *self;
+    *self = fresh;
+    fresh = swap;
+
+    self->changes = fresh.changes;
+    self->numChanges = fresh.numChanges;
+    self->maxChanges = fresh.maxChanges;
+    self->journal = fresh.journal;
+
+    fresh.changes = NULL;
+    fresh.numChanges = 0;
+    fresh.maxChanges = 0;
+
+    retVal = 1;
+
+    out:
+
+    IniConfigDocument_clear( &fresh );
+
+    return retVal;
+}
+
+
+/*
+ * Writes to a descriptor, for IniConfigDocument_write()
+ */
+static bool IniConfigDocument_writeFd( void *context, void *file, struct iovec *iov, int count )
+{
+    (void)context;
+
+    return IniConfigAtomicFile_writev( *(int *)file, iov, count );
+}
+
+
+static bool IniConfigDocument_writeTo( const IniConfigDocument *self,
+                                       bool ( *sink )( void *context, void *file, struct iovec *iov, int count ),
+                                       void *context, void *file )
+{
+    struct iovec iov[INICONFIGDOCUMENT_IOVMAX];
+    const char *sourceEnd = NULL;
+    int count = 0;
+    int i = 0;
+
+    if( self->bom )
+    {
+        iov[0].iov_base = (void *)INICONFIGDOCUMENT_BOM;
+        iov[0].iov_len = sizeof( INICONFIGDOCUMENT_BOM ) - 1;
+        count = 1;
+    }
+
+    for( i = self->head; i != -1; i = self->lines[i].next )
+    {
+        const IniConfigDocumentLine *line = &self->lines[i];
+        const char *text = IniConfigDocument_lineText( self, line );
+
+        if( line->length == 0 )
+        {
+            continue;
+        }
+
+        /* untouched neighbours of the source are merged into one block */
+        if( line->text == NULL && count > 0 && text == sourceEnd )
+        {
+            iov[count - 1].iov_len += line->length;
+            sourceEnd += line->length;
+            continue;
+        }
+
+        if( count == INICONFIGDOCUMENT_IOVMAX )
+        {
+            if( !sink( context, file, iov, count ) )
+            {
+                return false;
+            }
+
+            count = 0;
+        }
+
+        iov[count].iov_base = (void *)text;
+        iov[count].iov_len = line->length;
+        count++;
+
+        sourceEnd = ( line->text == NULL ) ? text + line->length : NULL;
+    }
+
+    return sink( context, file, iov, count );
+}
+
+
+/*
+ * Sizes the lines and the index for the lines of source at once, instead
+ * of growing them while parsing
+ */
+static void IniConfigDocument_reserve( IniConfigDocument *self, const char *source, size_t length )
+{
+    const char *end = source + length;
+    const char *eol = source;
+    unsigned int size = INICONFIGDOCUMENT_MININDEX;
+    size_t numLines = 1;
+
+    while( ( eol = (const char *)memchr( eol, '\n', end - eol ) ) != NULL )
+    {
+        numLines++;
+        eol++;
+    }
+
+    if( numLines > INT_MAX / 2 )
+    {
+        return;
+    }
+
+    self->lines = (IniConfigDocumentLine *)ANY_BALLOC( numLines * sizeof( IniConfigDocumentLine ) );
+    self->maxLines = ( self->lines != NULL ) ? (int)numLines : 0;
+
+    /* every line takes at most one slot, the index stays at most half full */
+    while( size < ( numLines + 1 ) * 2 )
+    {
+        size *= 2;
+    }
+
+    self->index = ANY_NTALLOC( size, IniConfigDocumentSlot );
+    self->indexMask = ( self->index != NULL ) ? size - 1 : 0;
+}
+
+
+/*
+ * Parses source, which is either taken over or borrowed from the caller
+ */
+static bool IniConfigDocument_parseSource( IniConfigDocument *self, char *source, size_t length, int borrowed )
+{
+    size_t offset = 0;
+    int section = 0;
+
+    IniConfigDocument_reset( self );
+    IniConfigDocument_setStamp( self, NULL );
+
+    self->source = ( length > 0 ) ? source : NULL;
+    self->sourceLength = length;
+    self->borrowed = borrowed;
+
+    if( length == 0 && !borrowed )
+    {
+        ANY_FREE( source );
+    }
+
+    if( length > 0 )
+    {
+        IniConfigDocument_reserve( self, source, length );
+    }
+
+    if( IniConfigDocument_newSection( self, -1 ) == -1 )
+    {
+        return false;
+    }
+
+    self->sections[0].lastLine = -1;
+
+    while( offset < length )
+    {
+        const char *start = self->source + offset;
+        const char *eol = (const char *)memchr( start, '\n', length - offset );
+        size_t lineLength = ( eol != NULL ) ? (size_t)( eol - start ) + 1 : length - offset;
+        IniConfigDocumentLine *line = NULL;
+        int idx = IniConfigDocument_newLine( self );
+
+        if( idx == -1 )
+        {
+            return false;
+        }
+
+        if( eol != NULL && offset == 0 && eol > start && eol[-1] == '\r' )
+        {
+            self->lineTerm = "\r\n";
+        }
+
+        line = &self->lines[idx];
+        line->offset = offset;
+        line->length = lineLength;
+
+        IniConfigDocument_analyzeLine( start, lineLength, line );
+        IniConfigDocument_link( self, idx, self->tail );
+
+        if( line->type == INICONFIGDOCUMENT_LINE_SECTION )
+        {
+            section = IniConfigDocument_newSection( self, idx );
+
+            if( section == -1 )
+            {
+                return false;
+            }
+        }
+        else if( line->type == INICONFIGDOCUMENT_LINE_OTHER && IniConfigDocument_startsWithBracket( self, line ) )
+        {
+            /* minIni stops a key search at any line starting with '[' */
+            section = -1;
+        }
+
+        self->lines[idx].section = section;
+
+        if( line->type == INICONFIGDOCUMENT_LINE_KEY && section >= 0 )
+        {
+            self->sections[section].lastLine = idx;
+        }
+
+        offset += lineLength;
+    }
+
+    if( !IniConfigDocument_rebuildIndex( self ) )
+    {
+        return false;
+    }
+
+    /* without memory for the orders the listings keep scanning */
+    IniConfigDocument_updateOrder( self );
+
+    return true;
+}
+
+
+/*
+ * Parses the contents of a file after the stages enabled by the text flags
+ */
+static bool IniConfigDocument_parseFile( IniConfigDocument *self, const char *buffer, size_t length,
+                                         const char *fileName, bool borrow )
+{
+    char *converted = NULL;
+    size_t bomLength = 0;
+    size_t invalid = 0;
+    int encoding = INICONFIGTEXT_UTF8;
+    bool retVal = false;
+
+    self->invalidLine = 0;
+
+    if( self->textFlags & INICONFIGTEXT_TRANSCODE )
+    {
+        encoding = IniConfigText_detect( buffer, length, &bomLength );
+    }
+
+    if( encoding != INICONFIGTEXT_UTF8 )
+    {
+        size_t convertedLength = 0;
+
+        converted = IniConfigText_fromUtf16( buffer + bomLength, length - bomLength, encoding, &convertedLength,
+                                             &invalid );
+
+        if( converted == NULL )
+        {
+            self->invalidLine = IniConfigText_getLine( buffer + bomLength, invalid, encoding );
+            ANY_LOG( 0, "Invalid UTF-16 in line %d of '%s'", ANY_LOG_ERROR, self->invalidLine, fileName );
+            return false;
+        }
+
+        buffer = converted;
+        length = convertedLength;
+    }
+    else
+    {
+        buffer += bomLength;
+        length -= bomLength;
+    }
+
+    if( self->textFlags & INICONFIGTEXT_VALIDATE )
+    {
+        invalid = IniConfigText_validate( buffer, length );
+
+        if( invalid != length )
+        {
+            self->invalidLine = IniConfigText_getLine( buffer, invalid, INICONFIGTEXT_UTF8 );
+            ANY_LOG( 0, "Invalid UTF-8 in line %d of '%s'", ANY_LOG_ERROR, self->invalidLine, fileName );
+            goto out;
+        }
+    }
+
+    if( converted != NULL )
+    {
+        /* the converted text is ours already, no need for another copy */
+        retVal = IniConfigDocument_parseSource( self, converted, length, 0 );
+        converted = NULL;
+    }
+    else if( borrow )
+    {
+        retVal = IniConfigDocument_parseSource( self, (char *)buffer, length, 1 );
+    }
+    else
+    {
+        retVal = IniConfigDocument_parse( self, buffer, length );
+    }
+
+    /* UTF-16 files are saved as UTF-8, marked as Unicode like they were */
+    self->bom = ( bomLength > 0 );
+
+    out:
+
+    ANY_FREE( converted );
+
+    return retVal;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigDocument *IniConfigDocument_new( void )
+{
+    return ( ANY_TALLOC( IniConfigDocument ) );
+}
+
+
+bool IniConfigDocument_init( IniConfigDocument *self )
+{
+    ANY_REQUIRE( self );
+
+    memset( self, 0, sizeof( IniConfigDocument ) );
+
+    IniConfigDocument_reset( self );
+
+    if( IniConfigDocument_newSection( self, -1 ) == -1 )
+    {
+        return false;
+    }
+
+    self->sections[0].lastLine = -1;
+    self->valid = INICONFIGDOCUMENT_VALID;
+
+    return true;
+}
+
+
+bool IniConfigDocument_parse( IniConfigDocument *self, const char *buffer, size_t length )
+{
+    char *source = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( buffer || length == 0 );
+
+    if( length > 0 )
+    {
+        source = (char *)ANY_BALLOC( length );
+
+        if( source == NULL )
+        {
+            return false;
+        }
+
+        memcpy( source, buffer, length );
+    }
+
+    return IniConfigDocument_parseSource( self, source, length, 0 );
+}
+
+
+bool IniConfigDocument_load( IniConfigDocument *self, const char *fileName )
+{
+    const IniConfigBackend *backend = NULL;
+    const char *contents = NULL;
+    struct stat st;
+    char *buffer = NULL;
+    size_t length = 0;
+    bool retVal = false;
+    void *file = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( fileName );
+
+    IniConfigDocument_dropChanges( self );
+
+    backend = IniConfigDocument_getBackend( self );
+    file = backend->open( backend->context, fileName );
+
+    if( file == NULL )
+    {
+        /* like minIni, a missing file reads as an empty one */
+        return ( errno == ENOENT ) ? IniConfigDocument_parse( self, NULL, 0 ) : false;
+    }
+
+    if( !backend->stat( backend->context, file, &st ) )
+    {
+        goto out;
+    }
+
+    /* the block of the backend is parsed in place if it holds the whole file */
+    contents = IniConfigBackend_readAll( backend, file, &st, &length, &buffer );
+
+    if( contents == NULL )
+    {
+        goto out;
+    }
+
+    retVal = IniConfigDocument_parseFile( self, contents, length, fileName, false );
+
+    if( retVal )
+    {
+        IniConfigDocument_setStamp( self, &st );
+    }
+
+    out:
+
+    ANY_FREE( buffer );
+    backend->close( backend->context, file );
+
+    return retVal;
+}
+
+
+bool IniConfigDocument_loadBuffer( IniConfigDocument *self, const char *buffer, size_t length, bool borrow )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( buffer || length == 0 );
+
+    IniConfigDocument_dropChanges( self );
+
+    return IniConfigDocument_parseFile( self, buffer, length, INICONFIGDOCUMENT_BUFFERNAME, borrow );
+}
+
+
+char *IniConfigDocument_readFd( int fd, size_t *length )
+{
+    struct stat st;
+    char *buffer = NULL;
+    size_t size = INICONFIGDOCUMENT_READSIZE;
+    size_t used = 0;
+
+    ANY_REQUIRE( fd >= 0 );
+    ANY_REQUIRE( length );
+
+    /* a regular file fits in one allocation, pipes and sockets grow it */
+    if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 )
+    {
+        size = (size_t)st.st_size + 1;
+    }
+
+    buffer = (char *)ANY_BALLOC( size );
+
+    while( buffer != NULL )
+    {
+        ssize_t got = 0;
+
+        if( used == size )
+        {
+            char *grown = (char *)realloc( buffer, size * 2 );
+
+            if( grown == NULL )
+            {
+                break;
+            }
+
+            buffer = grown;
+            size *= 2;
+        }
+
+        got = read( fd, buffer + used, size - used );
+
+        if( got < 0 && errno == EINTR )
+        {
+            continue;
+        }
+
+        if( got < 0 )
+        {
+            break;
+        }
+
+        if( got == 0 )
+        {
+            *length = used;
+            return buffer;
+        }
+
+        used += got;
+    }
+
+    ANY_FREE( buffer );
+
+    return NULL;
+}
+
+
+int IniConfigDocument_getString( const IniConfigDocument *self, const char *section, const char *key,
+                                 const char *defValue, char *buffer, int bufferSize )
+{
+    const IniConfigDocumentLine *line = NULL;
+    int sectionIdx = 0;
+    int lineIdx = -1;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( buffer == NULL || bufferSize <= 0 || key == NULL )
+    {
+        return 0;
+    }
+
+    sectionIdx = IniConfigDocument_findSection( self, section );
+
+    if( sectionIdx >= 0 )
+    {
+        lineIdx = IniConfigDocument_findKey( self, sectionIdx, key );
+    }
+
+    if( lineIdx == -1 )
+    {
+        if( defValue == NULL )
+        {
+            defValue = "";
+        }
+
+        return IniConfigDocument_copyOut( defValue, strlen( defValue ), 0, buffer, bufferSize );
+    }
+
+    line = &self->lines[lineIdx];
+
+    return IniConfigDocument_copyOut( IniConfigDocument_lineText( self, line ) + line->valueOffset,
+                                      line->valueLength, line->quoted, buffer, bufferSize );
+}
+
+
+bool IniConfigDocument_hasKey( const IniConfigDocument *self, const char *section, const char *key )
+{
+    int sectionIdx = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( key );
+
+    sectionIdx = IniConfigDocument_findSection( self, section );
+
+    return ( sectionIdx >= 0 && IniConfigDocument_findKey( self, sectionIdx, key ) != -1 );
+}
+
+
+bool IniConfigDocument_forEach( const IniConfigDocument *self, IniConfigDocumentVisitor visitor, void *context )
+{
+    IniConfigDocumentInheritance inheritance;
+    int *sectionTable = NULL;
+    char *scratch = NULL;
+    char *section = NULL;
+    char *key = NULL;
+    char *value = NULL;
+    size_t maxLength = 0;
+    bool inheriting = false;
+    bool retVal = true;
+    int reachable = 1;
+    int current = 0;
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( visitor );
+
+    memset( &inheritance, 0, sizeof( inheritance ) );
+
+    for( i = self->head; i != -1; i = self->lines[i].next )
+    {
+        if( self->lines[i].length > maxLength )
+        {
+            maxLength = self->lines[i].length;
+        }
+    }
+
+    scratch = (char *)ANY_BALLOC( 3 * ( maxLength + 1 ) + (size_t)self->numSections );
+    sectionTable = ANY_NTALLOC( 2 * self->numSections + 1, int );
+
+    if( scratch == NULL || sectionTable == NULL )
+    {
+        retVal = false;
+        goto out;
+    }
+
+    section = scratch;
+    key = section + maxLength + 1;
+    value = key + maxLength + 1;
+    section[0] = '\0';
+
+    inheritance.chain = sectionTable;
+    inheritance.numChain = 0;
+    inheritance.visited = value + maxLength + 1;
+    inheritance.patterns = sectionTable + self->numSections;
+    inheritance.numPatterns = 0;
+
+    /* files without parents and patterns skip the inheritance entirely */
+    for( i = 1; i < self->numSections; i++ )
+    {
+        const IniConfigDocumentLine *header = NULL;
+        const char *name = NULL;
+
+        if( self->sections[i].removed )
+        {
+            continue;
+        }
+
+        header = &self->lines[self->sections[i].line];
+        name = IniConfigDocument_lineText( self, header ) + header->nameOffset;
+
+        if( IniConfigDocument_findSectionName( self, name, header->nameLength ) != i )
+        {
+            continue;
+        }
+
+        if( header->parentLength > 0 )
+        {
+            inheriting = true;
+        }
+
+        if( memchr( name, '*', header->nameLength ) != NULL )
+        {
+            inheritance.patterns[inheritance.numPatterns++] = i;
+            inheriting = true;
+        }
+    }
+
+    if( inheriting )
+    {
+        unsigned int capacity = 16;
+
+        /* at most half full, whatever keys one section inherits */
+        while( capacity < 2 * (unsigned int)self->numLines )
+        {
+            capacity *= 2;
+        }
+
+        inheritance.stack = ANY_NTALLOC( self->numSections + 1, IniConfigDocumentParents );
+        inheritance.emitted = ANY_NTALLOC( capacity, int );
+        inheritance.stamps = ANY_NTALLOC( capacity, unsigned int );
+        inheritance.emittedMask = capacity - 1;
+
+        if( inheritance.stack == NULL || inheritance.emitted == NULL || inheritance.stamps == NULL )
+        {
+            retVal = false;
+            goto out;
+        }
+    }
+
+    for( i = self->head; i != -1 && retVal; i = self->lines[i].next )
+    {
+        const IniConfigDocumentLine *line = &self->lines[i];
+        const char *text = IniConfigDocument_lineText( self, line );
+
+        if( line->type == INICONFIGDOCUMENT_LINE_SECTION )
+        {
+            /* the inherited keys follow the own keys of a section */
+            if( inheriting && current > 0 )
+            {
+                retVal = IniConfigDocument_visitInherited( self, current, section, &inheritance, key, value,
+                                                           maxLength, visitor, context );
+            }
+
+            memcpy( section, text + line->nameOffset, line->nameLength );
+            section[line->nameLength] = '\0';
+
+            /* keys of a repeated section are shadowed by the first one */
+            reachable = ( IniConfigDocument_findSection( self, section ) == line->section );
+            current = reachable ? line->section : -1;
+            continue;
+        }
+
+        if( line->type != INICONFIGDOCUMENT_LINE_KEY || line->section < 0 || !reachable )
+        {
+            continue;
+        }
+
+        memcpy( key, text + line->nameOffset, line->nameLength );
+        key[line->nameLength] = '\0';
+
+        /* so are repeated keys */
+        if( IniConfigDocument_findKey( self, line->section, key ) != i )
+        {
+            continue;
+        }
+
+        IniConfigDocument_copyOut( text + line->valueOffset, line->valueLength, line->quoted,
+                                   value, (int)maxLength + 1 );
+
+        retVal = visitor( context, section, key, value );
+    }
+
+    if( retVal && inheriting && current > 0 )
+    {
+        retVal = IniConfigDocument_visitInherited( self, current, section, &inheritance, key, value,
+                                                   maxLength, visitor, context );
+    }
+
+    out:
+
+    if( inheritance.stamps != NULL )
+    {
+        ANY_FREE( inheritance.stamps );
+    }
+
+    if( inheritance.emitted != NULL )
+    {
+        ANY_FREE( inheritance.emitted );
+    }
+
+    if( inheritance.stack != NULL )
+    {
+        ANY_FREE( inheritance.stack );
+    }
+
+    if( sectionTable != NULL )
+    {
+        ANY_FREE( sectionTable );
+    }
+
+    if( scratch != NULL )
+    {
+        ANY_FREE( scratch );
+    }
+
+    return retVal;
+}
+
+
+int IniConfigDocument_getSection( const IniConfigDocument *self, int idx, char *buffer, int bufferSize )
+{
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( buffer == NULL || bufferSize <= 0 || idx < 0 )
+    {
+        return 0;
+    }
+
+    if( !self->orderDirty )
+    {
+        const IniConfigDocumentLine *header = NULL;
+
+        if( idx >= self->numOrdered )
+        {
+            buffer[0] = '\0';
+            return 0;
+        }
+
+        header = &self->lines[self->sections[self->sectionOrder[idx]].line];
+
+        return IniConfigDocument_copyOut( IniConfigDocument_lineText( self, header ) + header->nameOffset,
+                                          header->nameLength, 0, buffer, bufferSize );
+    }
+
+    for( i = 1; i < self->numSections; i++ )
+    {
+        const IniConfigDocumentLine *header = NULL;
+
+        if( self->sections[i].removed )
+        {
+            continue;
+        }
+
+        header = &self->lines[self->sections[i].line];
+
+        /* minIni ends the enumeration at an empty "[]" header */
+        if( header->nameLength == 0 )
+        {
+            break;
+        }
+
+        if( idx-- > 0 )
+        {
+            continue;
+        }
+
+        return IniConfigDocument_copyOut( IniConfigDocument_lineText( self, header ) + header->nameOffset,
+                                          header->nameLength, 0, buffer, bufferSize );
+    }
+
+    buffer[0] = '\0';
+
+    return 0;
+}
+
+
+int IniConfigDocument_getKey( const IniConfigDocument *self, const char *section, int idx,
+                              char *buffer, int bufferSize )
+{
+    int sectionIdx = 0;
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( buffer == NULL || bufferSize <= 0 || idx < 0 )
+    {
+        return 0;
+    }
+
+    buffer[0] = '\0';
+
+    sectionIdx = IniConfigDocument_findSection( self, section );
+
+    if( sectionIdx < 0 )
+    {
+        return 0;
+    }
+
+    if( !self->orderDirty )
+    {
+        const IniConfigDocumentSection *entry = &self->sections[sectionIdx];
+        const IniConfigDocumentLine *line = NULL;
+
+        if( idx >= entry->numKeys )
+        {
+            return 0;
+        }
+
+        line = &self->lines[self->keyOrder[entry->firstKey + idx]];
+
+        return IniConfigDocument_copyOut( IniConfigDocument_lineText( self, line ) + line->nameOffset,
+                                          line->nameLength, 0, buffer, bufferSize );
+    }
+
+    i = ( sectionIdx == 0 ) ? self->head : self->lines[self->sections[sectionIdx].line].next;
+
+    for( ; i != -1 && !IniConfigDocument_startsWithBracket( self, &self->lines[i] ); i = self->lines[i].next )
+    {
+        const IniConfigDocumentLine *line = &self->lines[i];
+
+        if( line->type != INICONFIGDOCUMENT_LINE_KEY )
+        {
+            continue;
+        }
+
+        /* minIni ends the enumeration at a key with an empty name */
+        if( line->nameLength == 0 )
+        {
+            break;
+        }
+
+        if( idx-- > 0 )
+        {
+            continue;
+        }
+
+        return IniConfigDocument_copyOut( IniConfigDocument_lineText( self, line ) + line->nameOffset,
+                                          line->nameLength, 0, buffer, bufferSize );
+    }
+
+    return 0;
+}
+
+
+int IniConfigDocument_countSections( const IniConfigDocument *self )
+{
+    int count = 0;
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( !self->orderDirty )
+    {
+        return self->numOrdered;
+    }
+
+    for( i = 1; i < self->numSections; i++ )
+    {
+        if( self->sections[i].removed )
+        {
+            continue;
+        }
+
+        if( self->lines[self->sections[i].line].nameLength == 0 )
+        {
+            break;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+
+int IniConfigDocument_countKeys( const IniConfigDocument *self, const char *section )
+{
+    int sectionIdx = 0;
+    int count = 0;
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    sectionIdx = IniConfigDocument_findSection( self, section );
+
+    if( sectionIdx < 0 )
+    {
+        return 0;
+    }
+
+    if( !self->orderDirty )
+    {
+        return self->sections[sectionIdx].numKeys;
+    }
+
+    i = ( sectionIdx == 0 ) ? self->head : self->lines[self->sections[sectionIdx].line].next;
+
+    for( ; i != -1 && !IniConfigDocument_startsWithBracket( self, &self->lines[i] ); i = self->lines[i].next )
+    {
+        if( self->lines[i].type != INICONFIGDOCUMENT_LINE_KEY )
+        {
+            continue;
+        }
+
+        if( self->lines[i].nameLength == 0 )
+        {
+            break;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+
+bool IniConfigDocument_updateOrder( IniConfigDocument *self )
+{
+    int *sectionOrder = NULL;
+    int *keyOrder = NULL;
+    int numOrdered = 0;
+    int numKeys = 0;
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( !self->orderDirty )
+    {
+        return true;
+    }
+
+    sectionOrder = ANY_NTALLOC( self->numSections, int );
+    keyOrder = ANY_NTALLOC( self->numLines + 1, int );
+
+    if( sectionOrder == NULL || keyOrder == NULL )
+    {
+        ANY_FREE( sectionOrder );
+        ANY_FREE( keyOrder );
+        return false;
+    }
+
+    /* the same walks as the scans of IniConfigDocument_getSection() and IniConfigDocument_getKey() */
+    for( i = 1; i < self->numSections; i++ )
+    {
+        if( self->sections[i].removed )
+        {
+            continue;
+        }
+
+        if( self->lines[self->sections[i].line].nameLength == 0 )
+        {
+            break;
+        }
+
+        sectionOrder[numOrdered++] = i;
+    }
+
+    for( i = 0; i < self->numSections; i++ )
+    {
+        IniConfigDocumentSection *entry = &self->sections[i];
+        int j = 0;
+
+        entry->firstKey = numKeys;
+        entry->numKeys = 0;
+
+        if( entry->removed )
+        {
+            continue;
+        }
+
+        j = ( i == 0 ) ? self->head : self->lines[entry->line].next;
+
+        for( ; j != -1 && !IniConfigDocument_startsWithBracket( self, &self->lines[j] ); j = self->lines[j].next )
+        {
+            if( self->lines[j].type != INICONFIGDOCUMENT_LINE_KEY )
+            {
+                continue;
+            }
+
+            if( self->lines[j].nameLength == 0 )
+            {
+                break;
+            }
+
+            keyOrder[numKeys++] = j;
+        }
+
+        entry->numKeys = numKeys - entry->firstKey;
+    }
+
+    ANY_FREE( self->sectionOrder );
+    ANY_FREE( self->keyOrder );
+
+    self->sectionOrder = sectionOrder;
+    self->numOrdered = numOrdered;
+    self->keyOrder = keyOrder;
+    self->orderDirty = 0;
+
+    return true;
+}
+
+
+int IniConfigDocument_putString( IniConfigDocument *self, const char *section, const char *key,
+                                 const char *value )
+{
+    int sectionIdx = 0;
+    int lineIdx = 0;
+    size_t length = 0;
+    char *text = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( self->journal && !IniConfigDocument_record( self, section, key, value ) )
+    {
+        return 0;
+    }
+
+    sectionIdx = IniConfigDocument_findSection( self, section );
+
+    if( sectionIdx >= 0 && key != NULL && value != NULL )
+    {
+        lineIdx = IniConfigDocument_findKey( self, sectionIdx, key );
+
+        /* only a new value, the orders stay as they are */
+        if( lineIdx != -1 )
+        {
+            return IniConfigDocument_replaceValue( self, lineIdx, key, value );
+        }
+    }
+
+    self->orderDirty = 1;
+
+    if( key == NULL )
+    {
+        return ( sectionIdx > 0 ) ? IniConfigDocument_removeSection( self, sectionIdx ) : 1;
+    }
+
+    if( value == NULL )
+    {
+        return ( sectionIdx >= 0 ) ? IniConfigDocument_removeKey( self, sectionIdx, key ) : 1;
+    }
+
+    if( sectionIdx < 0 )
+    {
+        sectionIdx = IniConfigDocument_addSection( self, section );
+
+        if( sectionIdx == -1 )
+        {
+            return 0;
+        }
+    }
+
+    text = IniConfigDocument_formatKey( self, key, value, &length );
+
+    if( text == NULL )
+    {
+        return 0;
+    }
+
+    lineIdx = IniConfigDocument_insertText( self, self->sections[sectionIdx].lastLine, text, length, sectionIdx );
+
+    ANY_FREE( text );
+
+    if( lineIdx == -1 )
+    {
+        return 0;
+    }
+
+    self->sections[sectionIdx].lastLine = lineIdx;
+
+    return IniConfigDocument_indexKey( self, lineIdx );
+}
+
+
+bool IniConfigDocument_isModified( const IniConfigDocument *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    return self->modified ? true : false;
+}
+
+
+bool IniConfigDocument_write( const IniConfigDocument *self, int fd )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( fd >= 0 );
+
+    return IniConfigDocument_writeTo( self, IniConfigDocument_writeFd, NULL, &fd );
+}
+
+
+bool IniConfigDocument_save( IniConfigDocument *self, const char *fileName )
+{
+    return IniConfigDocument_saveDurable( self, fileName, INICONFIGATOMICFILE_DURABILITY_NONE );
+}
+
+
+bool IniConfigDocument_saveDurable( IniConfigDocument *self, const char *fileName,
+                                    IniConfigAtomicFileDurability durability )
+{
+    const IniConfigBackend *backend = NULL;
+    struct stat st;
+    void *file = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( fileName );
+
+    backend = IniConfigDocument_getBackend( self );
+    file = backend->create( backend->context, fileName, durability );
+
+    if( file == NULL )
+    {
+        return false;
+    }
+
+    if( !IniConfigDocument_writeTo( self, backend->write, backend->context, file ) )
+    {
+        ANY_LOG( 0, "Unable to write '%s'", ANY_LOG_ERROR, fileName );
+        backend->close( backend->context, file );
+        return false;
+    }
+
+    /* the replacement keeps its identity when it replaces the file */
+    if( !backend->stat( backend->context, file, &st ) )
+    {
+        backend->close( backend->context, file );
+        return false;
+    }
+
+    if( !backend->replace( backend->context, file ) )
+    {
+        return false;
+    }
+
+    IniConfigDocument_setStamp( self, &st );
+    IniConfigDocument_dropChanges( self );
+
+    self->modified = 0;
+
+    return true;
+}
+
+
+void IniConfigDocument_setTextFlags( IniConfigDocument *self, int flags )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    self->textFlags = flags;
+}
+
+
+void IniConfigDocument_setBackend( IniConfigDocument *self, const IniConfigBackend *backend )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    self->backend = backend;
+}
+
+
+int IniConfigDocument_getInvalidLine( const IniConfigDocument *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    return self->invalidLine;
+}
+
+
+void IniConfigDocument_setJournal( IniConfigDocument *self, bool enable )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    if( !enable )
+    {
+        IniConfigDocument_dropChanges( self );
+    }
+
+    self->journal = enable ? 1 : 0;
+}
+
+
+bool IniConfigDocument_saveLocked( IniConfigDocument *self, const char *fileName,
+                                   IniConfigAtomicFileDurability durability )
+{
+    bool retVal = false;
+    int lockFd = -1;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+    ANY_REQUIRE( fileName );
+    ANY_REQUIRE_MSG( self->journal, "IniConfigDocument_saveLocked() requires IniConfigDocument_setJournal()" );
+    ANY_REQUIRE_MSG( IniConfigDocument_getBackend( self )->onDisk,
+                     "IniConfigDocument_saveLocked() requires a backend with files on disk" );
+
+    lockFd = IniConfigAtomicFile_lock( fileName );
+
+    if( lockFd == -1 )
+    {
+        return false;
+    }
+
+    if( !IniConfigDocument_isCurrent( self, fileName ) && !IniConfigDocument_merge( self, fileName ) )
+    {
+        ANY_LOG( 0, "Unable to merge the changes into '%s'", ANY_LOG_ERROR, fileName );
+        goto out;
+    }
+
+    retVal = IniConfigDocument_saveDurable( self, fileName, durability );
+
+    out:
+
+    IniConfigAtomicFile_unlock( lockFd );
+
+    return retVal;
+}
+
+
+void IniConfigDocument_clear( IniConfigDocument *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGDOCUMENT_VALID );
+
+    IniConfigDocument_reset( self );
+    IniConfigDocument_dropChanges( self );
+
+    ANY_FREE( self->changes );
+    self->changes = NULL;
+    self->maxChanges = 0;
+
+    self->valid = INICONFIGDOCUMENT_INVALID;
+}
+
+
+void IniConfigDocument_delete( IniConfigDocument *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
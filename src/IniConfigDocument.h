@@ -0,0 +1,566 @@
+/*
+ *  In-memory INI document
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigDocument In-memory INI document
+ *
+ * An IniConfigDocument holds a whole INI file in memory as a lossless
+ * concrete syntax tree: every line of the file (comments, blank lines,
+ * section headers, key/value pairs and anything unparseable) is kept as a
+ * span into the original source buffer, so the original spacing, comments
+ * and key order survive any number of edits.
+ *
+ * Lookups follow exactly the rules of the minIni library (case-insensitive
+ * section and key names, first match wins, trailing comments and
+ * surrounding double quotes are stripped from values), but they are served
+ * from a hash index instead of a file scan.
+ *
+ * Edits only re-serialize the lines they touch: changing a value keeps the
+ * key spelling, the spacing around the delimiter and a trailing comment of
+ * the original line. IniConfigDocument_save() writes all untouched regions
+ * as large contiguous blocks of the original bytes with writev(), so saving
+ * a large file with a few modifications costs little more than a copy.
+ *
+ * \code
+ *  IniConfigDocument *doc = IniConfigDocument_new();
+ *
+ *  IniConfigDocument_init( doc );
+ *  IniConfigDocument_load( doc, "myConfig.ini" );
+ *
+ *  IniConfigDocument_putString( doc, "Network", "address", "10.0.0.5" );
+ *  IniConfigDocument_save( doc, "myConfig.ini" );
+ *
+ *  IniConfigDocument_clear( doc );
+ *  IniConfigDocument_delete( doc );
+ * \endcode
+ *
+ * A section header may name the sections it inherits from after a colon,
+ * "[robot_A : robot_defaults, global]", and a section whose name contains
+ * '*' supplies defaults to all sections matching it, e.g. "[sensor.*]".
+ * IniConfigDocument_forEach() visits inherited keys as if the inheriting
+ * section held them; a section takes its own keys first, then those of
+ * each parent with everything the parent inherits, in the order listed,
+ * and then those of matching pattern sections in document order. The
+ * other functions of the document only see the keys a section holds
+ * itself.
+ *
+ * The document is not thread-safe.
+ */
+
+#ifndef INICONFIGDOCUMENT_H
+#define INICONFIGDOCUMENT_H
+
+#include <stddef.h>
+
+#include <IniConfigAtomicFile.h>
+#include <IniConfigBackend.h>
+#include <IniConfigText.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Kind of a line of an IniConfigDocument
+ */
+typedef enum IniConfigDocumentLineType
+{
+    INICONFIGDOCUMENT_LINE_BLANK = 0,   /**< Empty or white space only */
+    INICONFIGDOCUMENT_LINE_COMMENT,     /**< Starts with ';' or '#' */
+    INICONFIGDOCUMENT_LINE_SECTION,     /**< "[name]" section header */
+    INICONFIGDOCUMENT_LINE_KEY,         /**< "key=value" or "key:value" */
+    INICONFIGDOCUMENT_LINE_OTHER        /**< Anything else, kept verbatim */
+}
+IniConfigDocumentLineType;
+
+/*!
+ * \brief A single line of the document
+ *
+ * Offsets of name and value are relative to the start of the line text,
+ * which is either the original source (text == NULL) or a re-serialized
+ * copy owned by the document.
+ */
+typedef struct IniConfigDocumentLine
+{
+    IniConfigDocumentLineType type;     /**< Line kind */
+    int prev;                           /**< Index of the previous line, -1 at the start */
+    int next;                           /**< Index of the next line, -1 at the end */
+    int section;                        /**< Owning section, 0 before the first header, -1 if unreachable */
+    size_t offset;                      /**< Offset of the line in the source buffer */
+    size_t length;                      /**< Length of the line including its terminator */
+    char *text;                         /**< Re-serialized text, NULL if untouched */
+    size_t nameOffset;                  /**< Start of the section or key name */
+    size_t nameLength;                  /**< Length of the section or key name */
+    size_t parentOffset;                /**< Start of the parent list of a section header */
+    size_t parentLength;                /**< Length of the parent list, 0 without parents */
+    size_t valueOffset;                 /**< Start of the raw (still quoted) value */
+    size_t valueLength;                 /**< Length of the raw value */
+    int quoted;                         /**< Value is enclosed in double quotes */
+}
+IniConfigDocumentLine;
+
+/*!
+ * \brief A section of the document
+ *
+ * Section 0 is the implicit area before the first section header.
+ */
+typedef struct IniConfigDocumentSection
+{
+    int line;                           /**< Header line, -1 for the implicit section */
+    int lastLine;                       /**< Line after which new keys are inserted */
+    int removed;                        /**< Section has been removed */
+    int firstKey;                       /**< Start of the key lines in keyOrder */
+    int numKeys;                        /**< Number of keys IniConfigDocument_getKey() lists */
+}
+IniConfigDocumentSection;
+
+/*!
+ * \brief Open-addressing hash table entry used by the document indices
+ */
+typedef struct IniConfigDocumentSlot
+{
+    unsigned int hash;                  /**< Hash of the name, 0 marks a free slot */
+    int section;                        /**< Section index */
+    int line;                           /**< Line index, -1 for section entries */
+}
+IniConfigDocumentSlot;
+
+/*!
+ * \brief A put recorded in the journal of a document
+ */
+typedef struct IniConfigDocumentChange
+{
+    char *section;                      /**< Section name, NULL for the global area */
+    char *key;                          /**< Key name, NULL to remove the section */
+    char *value;                        /**< New value, NULL to remove the key */
+}
+IniConfigDocumentChange;
+
+/*!
+ * \brief Identity of the file version a document was loaded from
+ *
+ * A zero inode stands for a file which did not exist.
+ */
+typedef struct IniConfigDocumentStamp
+{
+    unsigned long long device;          /**< Device of the file */
+    unsigned long long inode;           /**< Inode of the file */
+    long long size;                     /**< Size in bytes */
+    long long mtimeSec;                 /**< Modification time, seconds */
+    long mtimeNsec;                     /**< Modification time, nanoseconds */
+}
+IniConfigDocumentStamp;
+
+/*!
+ * \brief Called for every key by IniConfigDocument_forEach()
+ *
+ * Returning false stops the enumeration.
+ */
+typedef bool ( *IniConfigDocumentVisitor )( void *context, const char *section, const char *key,
+                                            const char *value );
+
+/*!
+ * \brief IniConfigDocument definition
+ */
+typedef struct IniConfigDocument
+{
+    unsigned long valid;                /**< Object validity */
+    char *source;                       /**< Original file contents */
+    size_t sourceLength;                /**< Size of the original contents */
+    int borrowed;                       /**< source belongs to the caller of IniConfigDocument_loadBuffer() */
+    IniConfigDocumentLine *lines;       /**< All lines, in allocation order */
+    int numLines;                       /**< Number of used line slots */
+    int maxLines;                       /**< Allocated line slots */
+    int head;                           /**< First line in document order */
+    int tail;                           /**< Last line in document order */
+    IniConfigDocumentSection *sections; /**< Section table, in document order */
+    int numSections;                    /**< Number of sections including section 0 */
+    int maxSections;                    /**< Allocated section slots */
+    IniConfigDocumentSlot *index;       /**< Section and key index */
+    unsigned int indexMask;             /**< Index size minus one */
+    unsigned int indexUsed;             /**< Used index slots */
+    const char *lineTerm;               /**< Line terminator used for new lines */
+    int modified;                       /**< Document differs from its source */
+    IniConfigDocumentStamp stamp;       /**< File version last loaded or saved */
+    IniConfigDocumentChange *changes;   /**< Puts since the last load or save */
+    int numChanges;                     /**< Number of recorded puts */
+    int maxChanges;                     /**< Allocated change slots */
+    int journal;                        /**< Puts are recorded in changes */
+    int textFlags;                      /**< IniConfigTextFlags applied by loads */
+    int bom;                            /**< Saves write a UTF-8 byte order mark */
+    int invalidLine;                    /**< Line which failed the last load, 0 if none */
+    int *sectionOrder;                  /**< Sections IniConfigDocument_getSection() lists */
+    int numOrdered;                     /**< Number of listed sections */
+    int *keyOrder;                      /**< Key lines of all sections, grouped by section */
+    int orderDirty;                     /**< Keys or sections changed since the orders were built */
+    const IniConfigBackend *backend;    /**< Loads and saves files, NULL for IniConfigBackend_getPosix() */
+}
+IniConfigDocument;
+
+/*!
+ * \brief Allocate a new IniConfigDocument instance
+ *
+ * \return A new IniConfigDocument instance, NULL on error
+ *
+ * \see IniConfigDocument_init()
+ */
+IniConfigDocument *IniConfigDocument_new( void );
+
+/*!
+ * \brief Initialize an empty document
+ *
+ * \param self Pointer to the IniConfigDocument
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigDocument_load()
+ * \see IniConfigDocument_parse()
+ */
+bool IniConfigDocument_init( IniConfigDocument *self );
+
+/*!
+ * \brief Replace the document contents with the parsed contents of a buffer
+ *
+ * \param self    Pointer to the IniConfigDocument
+ * \param buffer  INI file contents, copied into the document
+ * \param length  Number of bytes in buffer
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigDocument_load()
+ */
+bool IniConfigDocument_parse( IniConfigDocument *self, const char *buffer, size_t length );
+
+/*!
+ * \brief Replace the document contents with the parsed contents of a file
+ *
+ * A file which does not exist yields an empty document, like minIni does.
+ *
+ * \param self      Pointer to the IniConfigDocument
+ * \param fileName  Name of the INI file
+ *
+ * \return Returns true on success, false if the file cannot be read
+ *
+ * \see IniConfigDocument_parse()
+ * \see IniConfigDocument_save()
+ */
+bool IniConfigDocument_load( IniConfigDocument *self, const char *fileName );
+
+/*!
+ * \brief Replace the document contents with the parsed contents of a buffer
+ *
+ * Like IniConfigDocument_load(), including the stages enabled by
+ * IniConfigDocument_setTextFlags(), for contents which are not in a file.
+ *
+ * \param self    Pointer to the IniConfigDocument
+ * \param buffer  INI file contents
+ * \param length  Number of bytes in buffer
+ * \param borrow  Lines point into buffer instead of a copy of it; buffer
+ *                must then stay unchanged until the next load or
+ *                IniConfigDocument_clear()
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigDocument_readFd()
+ */
+bool IniConfigDocument_loadBuffer( IniConfigDocument *self, const char *buffer, size_t length, bool borrow );
+
+/*!
+ * \brief Read everything up to the end of a file descriptor
+ *
+ * \param fd      File descriptor, a file, pipe or socket
+ * \param length  Receives the number of bytes read
+ *
+ * Regular files are read from the current offset in one go, other
+ * descriptors until they report the end of their data.
+ *
+ * \return The contents allocated with ANY_BALLOC(), NULL on error
+ */
+char *IniConfigDocument_readFd( int fd, size_t *length );
+
+/*!
+ * \brief Get a string
+ *
+ * \param self        Pointer to the IniConfigDocument
+ * \param section     the name of the section to search for, NULL or "" for keys outside any section
+ * \param key         the name of the entry to find the value of
+ * \param defValue    default string in the event of a failed read
+ * \param buffer      a pointer to the buffer to copy into
+ * \param bufferSize  the maximum number of characters to copy
+ *
+ * \return The number of characters copied into the supplied buffer
+ *
+ * \see IniConfigFile_getString()
+ */
+int IniConfigDocument_getString( const IniConfigDocument *self, const char *section, const char *key,
+                                 const char *defValue, char *buffer, int bufferSize );
+
+/*!
+ * \brief Tell whether a key exists
+ *
+ * \param self     Pointer to the IniConfigDocument
+ * \param section  Section name, NULL or "" for the area before the first section
+ * \param key      Key name
+ *
+ * \return true if IniConfigDocument_getString() would find the key
+ */
+bool IniConfigDocument_hasKey( const IniConfigDocument *self, const char *section, const char *key );
+
+/*!
+ * \brief Visit every key a lookup can reach, in document order
+ *
+ * \param self     Pointer to the IniConfigDocument
+ * \param visitor  Called with section name ("" for the global area), key
+ *                 name and value as IniConfigDocument_getString() returns it
+ * \param context  Passed to visitor
+ *
+ * Keys hidden by an earlier key or section of the same name are skipped.
+ * The keys of a section arrive together, followed by the keys it
+ * inherits and does not override.
+ *
+ * \return Returns false if visitor stopped the enumeration or on error
+ */
+bool IniConfigDocument_forEach( const IniConfigDocument *self, IniConfigDocumentVisitor visitor, void *context );
+
+/*!
+ * \brief Get a requested section name
+ *
+ * \param self        Pointer to the IniConfigDocument
+ * \param idx         the zero-based sequence number of the section to return
+ * \param buffer      a pointer to the buffer to copy into
+ * \param bufferSize  the maximum number of characters to copy
+ *
+ * \return The number of characters copied into the supplied buffer
+ *
+ * \see IniConfigFile_getSection()
+ */
+int IniConfigDocument_getSection( const IniConfigDocument *self, int idx, char *buffer, int bufferSize );
+
+/*!
+ * \brief Return a requested key name from a section
+ *
+ * \param self        Pointer to the IniConfigDocument
+ * \param section     the name of the section to browse through, NULL or "" for keys outside any section
+ * \param idx         the zero-based sequence number of the key to return
+ * \param buffer      a pointer to the buffer to copy into
+ * \param bufferSize  the maximum number of characters to copy
+ *
+ * \return The number of characters copied into the supplied buffer
+ *
+ * \see IniConfigFile_getKey()
+ */
+int IniConfigDocument_getKey( const IniConfigDocument *self, const char *section, int idx,
+                              char *buffer, int bufferSize );
+
+/*!
+ * \brief Number of sections IniConfigDocument_getSection() lists
+ *
+ * \param self  Pointer to the IniConfigDocument
+ *
+ * \return The number of sections
+ */
+int IniConfigDocument_countSections( const IniConfigDocument *self );
+
+/*!
+ * \brief Number of keys IniConfigDocument_getKey() lists for a section
+ *
+ * \param self     Pointer to the IniConfigDocument
+ * \param section  Section name, NULL or "" for keys outside any section
+ *
+ * \return The number of keys, 0 if the section does not exist
+ */
+int IniConfigDocument_countKeys( const IniConfigDocument *self, const char *section );
+
+/*!
+ * \brief Bring the section and key orders up to date
+ *
+ * \param self  Pointer to the IniConfigDocument
+ *
+ * Loads build the orders, puts which add or remove keys or sections
+ * outdate them. While they are up to date IniConfigDocument_getSection(),
+ * IniConfigDocument_getKey() and the count functions take constant time,
+ * otherwise they scan the document. Costs one pass over the lines if the
+ * orders are outdated, nothing otherwise.
+ *
+ * \return Returns false if memory ran out, the functions then keep scanning
+ */
+bool IniConfigDocument_updateOrder( IniConfigDocument *self );
+
+/*!
+ * \brief Write, add or remove a key
+ *
+ * \param self        Pointer to the IniConfigDocument
+ * \param section     the name of the section, NULL or "" for keys outside any section
+ * \param key         the name of the entry to write, or NULL to erase the whole section
+ * \param value       the value to write, or NULL to erase the key
+ *
+ * An existing key keeps its line, only the value part is re-serialized.
+ * New keys are inserted after the last key of their section, new sections
+ * are appended at the end of the document.
+ *
+ * \return 1 if successful, otherwise 0
+ *
+ * \see IniConfigFile_putString()
+ */
+int IniConfigDocument_putString( IniConfigDocument *self, const char *section, const char *key,
+                                 const char *value );
+
+/*!
+ * \brief Tell whether the document has been changed since it was loaded or saved
+ *
+ * \param self Pointer to the IniConfigDocument
+ *
+ * \return true if there are unsaved modifications
+ */
+bool IniConfigDocument_isModified( const IniConfigDocument *self );
+
+/*!
+ * \brief Write the document to a file
+ *
+ * The file is written to a temporary file in the same directory which then
+ * replaces the destination. Untouched regions are written straight from
+ * the source buffer.
+ *
+ * \param self      Pointer to the IniConfigDocument
+ * \param fileName  Destination file name
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigDocument_load()
+ */
+bool IniConfigDocument_save( IniConfigDocument *self, const char *fileName );
+
+/*!
+ * \brief Write the document to a file, flushing it to stable storage
+ *
+ * \param self        Pointer to the IniConfigDocument
+ * \param fileName    Destination file name
+ * \param durability  Flushes done before IniConfigDocument_saveDurable() returns
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigDocument_save()
+ * \see IniConfigAtomicFile_setDurability()
+ */
+bool IniConfigDocument_saveDurable( IniConfigDocument *self, const char *fileName,
+                                    IniConfigAtomicFileDurability durability );
+
+/*!
+ * \brief Record puts so they can be merged into a newer file version
+ *
+ * \param self    Pointer to the IniConfigDocument
+ * \param enable  true to record puts, false to stop and drop the journal
+ *
+ * The journal is emptied by every load and successful save.
+ *
+ * \return Nothing
+ *
+ * \see IniConfigDocument_saveLocked()
+ */
+void IniConfigDocument_setJournal( IniConfigDocument *self, bool enable );
+
+/*!
+ * \brief Check and convert the encoding of files before parsing them
+ *
+ * \param self   Pointer to the IniConfigDocument
+ * \param flags  Or-ed IniConfigTextFlags
+ *
+ * Applies to the following loads (see \ref IniConfigText).
+ *
+ * \return Nothing
+ */
+void IniConfigDocument_setTextFlags( IniConfigDocument *self, int flags );
+
+/*!
+ * \brief Select the backend files are loaded and saved with
+ *
+ * \param self     Pointer to the IniConfigDocument
+ * \param backend  Backend to use, NULL for IniConfigBackend_getPosix()
+ *
+ * Applies to the following loads and saves (see \ref IniConfigBackend).
+ *
+ * \return Nothing
+ */
+void IniConfigDocument_setBackend( IniConfigDocument *self, const IniConfigBackend *backend );
+
+/*!
+ * \brief Line which made the last load fail the checks of IniConfigDocument_setTextFlags()
+ *
+ * \param self  Pointer to the IniConfigDocument
+ *
+ * \return The line number starting at 1, 0 if the last load passed them
+ */
+int IniConfigDocument_getInvalidLine( const IniConfigDocument *self );
+
+/*!
+ * \brief Write the document to a file shared with other writers
+ *
+ * \param self        Pointer to the IniConfigDocument
+ * \param fileName    Destination file name
+ * \param durability  Flushes done before the lock is released
+ *
+ * Takes the write lock of the file (see IniConfigAtomicFile_lock()). If
+ * another writer replaced the file since this document was loaded or
+ * saved, the file is re-read and the journalled puts are applied on top of
+ * it, so changes of other writers to other keys are kept. Then the file is
+ * written once and the lock is released. Without a concurrent change the
+ * lock is only held for the write itself.
+ *
+ * Requires the journal to be enabled with IniConfigDocument_setJournal()
+ * and a backend whose files are on disk.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigDocument_saveDurable()
+ */
+bool IniConfigDocument_saveLocked( IniConfigDocument *self, const char *fileName,
+                                   IniConfigAtomicFileDurability durability );
+
+/*!
+ * \brief Write the document to an open file descriptor
+ *
+ * \param self  Pointer to the IniConfigDocument
+ * \param fd    Output descriptor
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigCommitGroup_add()
+ */
+bool IniConfigDocument_write( const IniConfigDocument *self, int fd );
+
+/*!
+ * \brief Clear an IniConfigDocument instance
+ *
+ * \param self Pointer to the IniConfigDocument
+ *
+ * \return Nothing
+ */
+void IniConfigDocument_clear( IniConfigDocument *self );
+
+/*!
+ * \brief Delete an IniConfigDocument instance
+ *
+ * \param self Pointer to the IniConfigDocument
+ *
+ * \return Nothing
+ */
+void IniConfigDocument_delete( IniConfigDocument *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGDOCUMENT_H */
@@ -0,0 +1,177 @@
+/*
+ *  Hand-over of index versions from a writer to a consumer thread
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <IniConfigExchange.h>
+
+#define INICONFIGEXCHANGE_VALID     0x6e3f2c19
+#define INICONFIGEXCHANGE_INVALID   0xb00db00f
+
+
+/*
+ * Private functions
+ */
+
+static void IniConfigExchange_free( IniConfigIndex *index )
+{
+    if( index != NULL )
+    {
+        IniConfigIndex_clear( index );
+        IniConfigIndex_delete( index );
+    }
+}
+
+
+static void IniConfigExchange_drain( IniConfigExchange *self )
+{
+    unsigned int head = __atomic_load_n( &self->retiredHead, __ATOMIC_ACQUIRE );
+    unsigned int tail = self->retiredTail;
+
+    while( tail != head )
+    {
+        IniConfigExchange_free( self->retired[tail % INICONFIGEXCHANGE_RETIRED] );
+        tail++;
+    }
+
+    __atomic_store_n( &self->retiredTail, tail, __ATOMIC_RELEASE );
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigExchange *IniConfigExchange_new( void )
+{
+    return ( ANY_TALLOC( IniConfigExchange ) );
+}
+
+
+bool IniConfigExchange_init( IniConfigExchange *self )
+{
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+
+    self->pending = NULL;
+    self->current = NULL;
+    self->retiredHead = 0;
+    self->retiredTail = 0;
+    self->published = 0;
+
+    for( i = 0; i < INICONFIGEXCHANGE_RETIRED; i++ )
+    {
+        self->retired[i] = NULL;
+    }
+
+    self->valid = INICONFIGEXCHANGE_VALID;
+
+    return true;
+}
+
+
+void IniConfigExchange_publish( IniConfigExchange *self, IniConfigIndex *index )
+{
+    IniConfigIndex *replaced = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGEXCHANGE_VALID );
+    ANY_REQUIRE( index );
+
+    IniConfigExchange_drain( self );
+
+    self->published++;
+
+    /* the release makes the whole index visible before its pointer */
+    replaced = __atomic_exchange_n( &self->pending, index, __ATOMIC_ACQ_REL );
+
+    /* never seen by the consumer, which only takes versions out of pending */
+    IniConfigExchange_free( replaced );
+}
+
+
+bool IniConfigExchange_sync( IniConfigExchange *self )
+{
+    unsigned int head = 0;
+    IniConfigIndex *next = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGEXCHANGE_VALID );
+
+    if( __atomic_load_n( &self->pending, __ATOMIC_RELAXED ) == NULL )
+    {
+        return false;
+    }
+
+    head = self->retiredHead;
+
+    /* cannot happen while publishers drain the ring, but never block on it */
+    if( self->current != NULL &&
+        head - __atomic_load_n( &self->retiredTail, __ATOMIC_ACQUIRE ) == INICONFIGEXCHANGE_RETIRED )
+    {
+        return false;
+    }
+
+    next = __atomic_exchange_n( &self->pending, NULL, __ATOMIC_ACQ_REL );
+
+    if( next == NULL )
+    {
+        return false;
+    }
+
+    if( self->current != NULL )
+    {
+        self->retired[head % INICONFIGEXCHANGE_RETIRED] = self->current;
+        __atomic_store_n( &self->retiredHead, head + 1, __ATOMIC_RELEASE );
+    }
+
+    self->current = next;
+
+    return true;
+}
+
+
+const IniConfigIndex *IniConfigExchange_getCurrent( const IniConfigExchange *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGEXCHANGE_VALID );
+
+    return self->current;
+}
+
+
+void IniConfigExchange_clear( IniConfigExchange *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGEXCHANGE_VALID );
+
+    IniConfigExchange_drain( self );
+    IniConfigExchange_free( self->pending );
+    IniConfigExchange_free( self->current );
+
+    self->pending = NULL;
+    self->current = NULL;
+
+    self->valid = INICONFIGEXCHANGE_INVALID;
+}
+
+
+void IniConfigExchange_delete( IniConfigExchange *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
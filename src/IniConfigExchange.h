@@ -0,0 +1,144 @@
+/*
+ *  Hand-over of index versions from a writer to a consumer thread
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigExchange Double buffering
+ *
+ * An IniConfigExchange passes immutable IniConfigIndex versions from the
+ * threads changing a file to one consumer thread, typically a control
+ * loop. The consumer reads its current version until it calls
+ * IniConfigExchange_sync() at a safe point, e.g. at the start of a cycle,
+ * which switches to the latest published version.
+ *
+ * The consumer side is wait-free: IniConfigExchange_sync() is one atomic
+ * exchange plus, when it switches, one store into a single-producer
+ * single-consumer ring of retired versions. Retired versions are freed by
+ * the next IniConfigExchange_publish(), so the consumer never calls
+ * munmap() or free(). A published version the consumer never picked up is
+ * freed as soon as a newer one replaces it.
+ */
+
+#ifndef INICONFIGEXCHANGE_H
+#define INICONFIGEXCHANGE_H
+
+#include <IniConfigIndex.h>
+
+/*!
+ * \brief Capacity of the ring of retired versions
+ *
+ * Every publish empties the ring, so it never holds more than two.
+ */
+#define INICONFIGEXCHANGE_RETIRED  4
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief IniConfigExchange definition
+ */
+typedef struct IniConfigExchange
+{
+    unsigned long valid;                /**< Object validity */
+    IniConfigIndex *pending;            /**< Published, not yet synced version, exchanged atomically */
+    IniConfigIndex *current;            /**< Version read by the consumer */
+    IniConfigIndex *retired[INICONFIGEXCHANGE_RETIRED]; /**< Versions the consumer is done with */
+    unsigned int retiredHead;           /**< Next slot the consumer fills, updated atomically */
+    unsigned int retiredTail;           /**< Next slot the publisher frees, updated atomically */
+    unsigned long published;            /**< Number of versions published, publisher side only */
+}
+IniConfigExchange;
+
+/*!
+ * \brief Allocate a new IniConfigExchange instance
+ *
+ * \return A new IniConfigExchange instance, NULL on error
+ *
+ * \see IniConfigExchange_init()
+ */
+IniConfigExchange *IniConfigExchange_new( void );
+
+/*!
+ * \brief Initialize an exchange without any version
+ *
+ * \param self Pointer to the IniConfigExchange
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigExchange_init( IniConfigExchange *self );
+
+/*!
+ * \brief Hand a new version to the consumer
+ *
+ * \param self   Pointer to the IniConfigExchange
+ * \param index  Built index allocated with IniConfigIndex_new(), the
+ *               exchange takes ownership
+ *
+ * Also frees the versions retired by the consumer. Publishers must be
+ * serialized among themselves.
+ *
+ * \return Nothing
+ */
+void IniConfigExchange_publish( IniConfigExchange *self, IniConfigIndex *index );
+
+/*!
+ * \brief Switch the consumer to the latest published version
+ *
+ * \param self Pointer to the IniConfigExchange
+ *
+ * Wait-free, does not allocate and makes no system calls. Must only be
+ * called by the consumer thread.
+ *
+ * \return true if a newer version has been installed, false otherwise
+ */
+bool IniConfigExchange_sync( IniConfigExchange *self );
+
+/*!
+ * \brief Return the version of the consumer
+ *
+ * \param self Pointer to the IniConfigExchange
+ *
+ * Must only be called by the consumer thread.
+ *
+ * \return The current version, NULL before the first sync
+ */
+const IniConfigIndex *IniConfigExchange_getCurrent( const IniConfigExchange *self );
+
+/*!
+ * \brief Clear an IniConfigExchange instance
+ *
+ * \param self Pointer to the IniConfigExchange
+ *
+ * Frees all versions. Neither side may use the exchange any more.
+ *
+ * \return Nothing
+ */
+void IniConfigExchange_clear( IniConfigExchange *self );
+
+/*!
+ * \brief Delete an IniConfigExchange instance
+ *
+ * \param self Pointer to the IniConfigExchange
+ *
+ * \return Nothing
+ */
+void IniConfigExchange_delete( IniConfigExchange *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGEXCHANGE_H */
@@ -16,8 +16,12 @@
 #include <Any.h>
 
 #include <minIni.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if !defined(__windows__)
 
@@ -25,166 +29,1656 @@
 
 #endif
 
-#define IniConfigFile_openRead( filename, file )   ((*(file) = fopen((filename),"rt")) != NULL)
-#define IniConfigFile_openWrite( filename, file )  ((*(file) = fopen((filename),"wt")) != NULL)
-#define IniConfigFile_close( file )                fclose(*(file))
-#define IniConfigFile_read( buffer, size, file )   fgets((buffer),(size),*(file))
-#define IniConfigFile_write( buffer, file )        fputs((buffer),*(file))
-#define IniConfigFile_rename( source, dest )       rename((source),(dest))
-#define IniConfigFile_remove( filename )           remove(filename)
-#define IniConfigFile_rewind( file )               rewind(*(file))
+#include <IniConfigFile.h>
+#include <IniConfigUnits.h>
+
+#define INICONFIGFILE_VALID     0x26aec137
+#define INICONFIGFILE_INVALID   0xb00db00f
+
+/* stands in for the file name in messages about files read from memory */
+#define INICONFIGFILE_BUFFERNAME  "<buffer>"
+
+
+typedef struct IniConfigFileBatch
+{
+    IniConfigFileValueVisitor visitor;
+    void *context;
+    unsigned int found;
+}
+IniConfigFileBatch;
+
+typedef struct IniConfigFileBlob
+{
+    int encoding;
+    void *buffer;
+    size_t bufferSize;
+    long size;
+}
+IniConfigFileBlob;
+
+
+/*
+ * Private functions
+ */
+
+static int IniConfigFile_copy( const char *value, char *buffer, int bufferSize )
+{
+    size_t length = strlen( value );
+
+    if( length > (size_t)bufferSize - 1 )
+    {
+        length = (size_t)bufferSize - 1;
+    }
+
+    memcpy( buffer, value, length );
+    buffer[length] = '\0';
+
+    return (int)length;
+}
+
+
+/*
+ * IniConfigFile_refreeze() swaps the document and the frozen version under
+ * the gets, which never see either of them turn NULL
+ */
+static bool IniConfigFile_isLoaded( const IniConfigFile *self )
+{
+    return ( __atomic_load_n( &self->document, __ATOMIC_RELAXED ) != NULL );
+}
+
+
+static bool IniConfigFile_isFrozen( const IniConfigFile *self )
+{
+    return ( __atomic_load_n( &self->frozen, __ATOMIC_RELAXED ) != NULL );
+}
+
+
+/*
+ * Local copy of the frozen version, only to be read between
+ * IniConfigReaders_enter() and IniConfigReaders_leave()
+ */
+static const IniConfigIndex *IniConfigFile_getFrozen( const IniConfigFile *self )
+{
+    return IniConfigReplicas_getLocal( __atomic_load_n( &self->frozen, __ATOMIC_SEQ_CST ) );
+}
+
+
+/*
+ * Counts the keys found on their way to the caller's visitor
+ */
+static void IniConfigFile_visitBatch( void *context, unsigned int i, const char *value )
+{
+    IniConfigFileBatch *batch = (IniConfigFileBatch *)context;
+
+    if( value != NULL )
+    {
+        batch->found++;
+    }
+
+    batch->visitor( batch->context, i, value );
+}
+
+
+/*
+ * Decodes a value in place, while the store or index still holds it
+ */
+static void IniConfigFile_visitBlob( void *context, unsigned int i, const char *value )
+{
+    IniConfigFileBlob *blob = (IniConfigFileBlob *)context;
+    size_t length = 0;
+
+    (void)i;
+
+    if( value == NULL )
+    {
+        return;
+    }
+
+    length = strlen( value );
+    blob->size = IniConfigBlob_getDecodedSize( blob->encoding, value, length );
+
+    if( blob->size >= 0 && (size_t)blob->size <= blob->bufferSize )
+    {
+        blob->size = IniConfigBlob_decode( blob->encoding, value, length, blob->buffer, blob->bufferSize );
+    }
+}
+
+
+static int IniConfigFile_getValue( const IniConfigFile *self, const char *section, const char *key,
+                                   const char *defValue, char *buffer, int bufferSize )
+{
+    int len = 0;
+
+    /* the consumer never touches the document, which a reload may replace */
+    if( self->exchange != NULL )
+    {
+        const IniConfigIndex *current = IniConfigExchange_getCurrent( self->exchange );
+
+        if( current != NULL )
+        {
+            return IniConfigIndex_getString( current, section, key, defValue, buffer, bufferSize );
+        }
+
+        return IniConfigFile_copy( ( defValue != NULL ) ? defValue : "", buffer, bufferSize );
+    }
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+
+        len = IniConfigIndex_getString( IniConfigFile_getFrozen( self ), section, key, defValue, buffer, bufferSize );
+
+        IniConfigReaders_leave( self->readers, reader );
+
+        return len;
+    }
+
+    if( self->document == NULL )
+    {
+        return ini_gets( section, key, defValue, buffer, bufferSize, self->fileName );
+    }
+
+    len = IniConfigStore_get( self->store, section, key, buffer, bufferSize, NULL );
+
+    if( len != INICONFIGSTORE_ABSENT )
+    {
+        return len;
+    }
+
+    return IniConfigFile_copy( ( defValue != NULL ) ? defValue : "", buffer, bufferSize );
+}
+
+
+/*
+ * Looks a key up and expresses its value in the canonical unit of wanted
+ */
+static bool IniConfigFile_getQuantity( const IniConfigFile *self, const char *section, const char *key, int wanted,
+                                       double *value )
+{
+    double quantity = 0.0;
+    int kind = 0;
+    bool found = false;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( key );
+
+    if( self->exchange != NULL )
+    {
+        const IniConfigIndex *current = IniConfigExchange_getCurrent( self->exchange );
+
+        found = ( current != NULL && IniConfigIndex_getQuantity( current, section, key, &kind, &quantity ) );
+    }
+    else if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+
+        found = IniConfigIndex_getQuantity( IniConfigFile_getFrozen( self ), section, key, &kind, &quantity );
+
+        IniConfigReaders_leave( self->readers, reader );
+    }
+    else if( self->document != NULL )
+    {
+        found = IniConfigStore_getQuantity( self->store, section, key, &kind, &quantity );
+    }
+    else
+    {
+        char buff[64];
+
+        /* without a loaded document there is nowhere to keep the result */
+        if( ini_gets( section, key, "", buff, sizeof( buff ), self->fileName ) > 0 )
+        {
+            kind = IniConfigUnits_parse( buff, &quantity );
+            found = true;
+        }
+    }
+
+    return found && IniConfigUnits_convert( kind, quantity, wanted, value );
+}
+
+
+/*
+ * Name of the file in messages, files read from memory have none
+ */
+static const char *IniConfigFile_getName( const IniConfigFile *self )
+{
+    return ( self->fileName != NULL ) ? self->fileName : INICONFIGFILE_BUFFERNAME;
+}
+
+
+static int IniConfigFile_putValue( const IniConfigFile *self, const char *section, const char *key,
+                                   const char *value, IniConfigStoreCondition condition, unsigned long generation )
+{
+    IniConfigFile *file = (IniConfigFile *)self;
+    int retVal = 0;
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        ANY_LOG( 0, "Put to the frozen file '%s' ignored", ANY_LOG_WARNING, IniConfigFile_getName( self ) );
+        return 0;
+    }
+
+    if( key != NULL )
+    {
+        return IniConfigStore_put( self->store, section, key, value, condition, generation ) != 0;
+    }
+
+    /* removing a section changes the structure, pending puts go first */
+    pthread_rwlock_wrlock( &file->lock );
+
+    if( IniConfigStore_flush( self->store, self->document ) )
+    {
+        retVal = IniConfigDocument_putString( self->document, section, NULL, NULL );
+        IniConfigStore_removeSection( self->store, section );
+    }
+
+    pthread_rwlock_unlock( &file->lock );
+
+    return retVal;
+}
+
+
+/*
+ * Locks the document for reading its sections and keys in order. Only
+ * pending puts or changed orders need the write lock, to bring the
+ * document up to date first. Released with pthread_rwlock_unlock().
+ */
+static void IniConfigFile_lockOrdered( IniConfigFile *self )
+{
+    pthread_rwlock_rdlock( &self->lock );
+
+    if( IniConfigStore_isFlushed( self->store ) && !self->document->orderDirty )
+    {
+        return;
+    }
+
+    pthread_rwlock_unlock( &self->lock );
+    pthread_rwlock_wrlock( &self->lock );
+
+    IniConfigStore_flush( self->store, self->document );
+    IniConfigDocument_updateOrder( self->document );
+}
+
+
+static bool IniConfigFile_writeBack( IniConfigFile *self, bool always )
+{
+    bool retVal = false;
+
+    pthread_rwlock_wrlock( &self->lock );
+
+    if( !IniConfigStore_flush( self->store, self->document ) )
+    {
+        goto out;
+    }
+
+    /* puts keep going while the file is written, they only need the shards */
+    if( !always && !IniConfigDocument_isModified( self->document ) )
+    {
+        retVal = true;
+    }
+    else if( self->locking )
+    {
+        retVal = IniConfigDocument_saveLocked( self->document, self->fileName, self->durability );
+
+        /* the document may now contain the changes of other writers */
+        if( !IniConfigStore_reload( self->store, self->document, true ) )
+        {
+            retVal = false;
+        }
+    }
+    else
+    {
+        retVal = IniConfigDocument_saveDurable( self->document, self->fileName, self->durability );
+    }
+
+    out:
+
+    pthread_rwlock_unlock( &self->lock );
+
+    return retVal;
+}
+
+
+static void IniConfigFile_thaw( IniConfigFile *self )
+{
+    IniConfigReplicas *frozen = self->frozen;
+
+    if( frozen != NULL )
+    {
+        __atomic_store_n( &self->frozen, NULL, __ATOMIC_SEQ_CST );
+
+        /* gets which found the file frozen finish on the old copies */
+        IniConfigReaders_synchronize( self->readers );
+
+        IniConfigReplicas_clear( frozen );
+        IniConfigReplicas_delete( frozen );
+    }
+}
+
+
+/*
+ * Gets of frozen files count themselves, so that IniConfigFile_refreeze()
+ * knows when nobody reads the old version any more
+ */
+static bool IniConfigFile_trackReaders( IniConfigFile *self )
+{
+    if( self->readers != NULL )
+    {
+        return true;
+    }
+
+    self->readers = IniConfigReaders_new();
+
+    if( self->readers == NULL || !IniConfigReaders_init( self->readers ) )
+    {
+        ANY_FREE( self->readers );
+        self->readers = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Lets go of the version of a shared file, the document and index are the registry's
+ */
+static void IniConfigFile_unshare( IniConfigFile *self )
+{
+    if( self->shared != NULL )
+    {
+        IniConfigRegistry_setListener( self->shared, self, NULL, NULL );
+        IniConfigRegistry_release( self->shared );
+
+        self->shared = NULL;
+        self->document = NULL;
+        self->frozen = NULL;
+    }
+}
+
+
+static void IniConfigFile_dropColumns( IniConfigFile *self )
+{
+    if( self->columns != NULL )
+    {
+        IniConfigColumns_clear( self->columns );
+        IniConfigColumns_delete( self->columns );
+        self->columns = NULL;
+    }
+}
+
+
+static IniConfigColumns *IniConfigFile_newColumns( const IniConfigFile *self, const IniConfigDocument *document )
+{
+    IniConfigColumns *columns = IniConfigColumns_new();
+
+    if( columns == NULL || !IniConfigColumns_init( columns ) )
+    {
+        ANY_FREE( columns );
+        return NULL;
+    }
+
+    if( !IniConfigColumns_build( columns, document ) )
+    {
+        ANY_LOG( 0, "Unable to build the numeric columns of '%s'", ANY_LOG_ERROR, IniConfigFile_getName( self ) );
+        IniConfigColumns_clear( columns );
+        IniConfigColumns_delete( columns );
+        return NULL;
+    }
+
+    return columns;
+}
+
+
+static bool IniConfigFile_buildColumns( IniConfigFile *self )
+{
+    IniConfigFile_dropColumns( self );
+
+    if( !self->columnar )
+    {
+        return true;
+    }
+
+    self->columns = IniConfigFile_newColumns( self, self->document );
+
+    return ( self->columns != NULL );
+}
+
+
+static bool IniConfigFile_publishFirst( IniConfigFile *self )
+{
+    if( !IniConfigFile_publish( self ) )
+    {
+        return false;
+    }
+
+    /* before the first version exists there is no consumer to wait for */
+    if( self->exchange->published == 1 )
+    {
+        IniConfigExchange_sync( self->exchange );
+    }
+
+    return true;
+}
+
+
+static bool IniConfigFile_setup( IniConfigFile *self )
+{
+    self->valid = INICONFIGFILE_INVALID;
+    self->fileName = NULL;
+    self->document = NULL;
+    self->durability = INICONFIGATOMICFILE_DURABILITY_NONE;
+    self->locking = 0;
+    self->store = NULL;
+    self->exchange = NULL;
+    self->indexFlags = INICONFIGINDEX_NONE;
+    self->frozen = NULL;
+    self->readers = NULL;
+    self->numaReplicas = 0;
+    self->columnar = 0;
+    self->columns = NULL;
+    self->textFlags = INICONFIGTEXT_NONE;
+    self->invalidLine = 0;
+    self->buffer = NULL;
+    self->bufferLength = 0;
+    self->ownsBuffer = 0;
+    self->shared = NULL;
+    self->listener = NULL;
+    self->listenerContext = NULL;
+    self->backend = IniConfigBackend_getPosix();
+
+    return ( pthread_rwlock_init( &self->lock, NULL ) == 0 );
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigFile *IniConfigFile_new( void )
+{
+    return ( ANY_TALLOC( IniConfigFile ) );
+}
+
+
+bool IniConfigFile_init( IniConfigFile *self, const char *fileName )
+{
+    return IniConfigFile_initWithBackend( self, fileName, IniConfigBackend_getPosix() );
+}
+
+
+bool IniConfigFile_initWithBackend( IniConfigFile *self, const char *fileName, const IniConfigBackend *backend )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( fileName );
+    ANY_REQUIRE( backend );
+
+    if( !IniConfigFile_setup( self ) )
+    {
+        return false;
+    }
+
+    self->fileName = Any_strdup( (char*)fileName );
+
+    if( !self->fileName )
+    {
+        pthread_rwlock_destroy( &self->lock );
+        return false;
+    }
+
+    self->backend = backend;
+    self->valid = INICONFIGFILE_VALID;
+
+    /* minIni only reads files on disk */
+    if( !backend->onDisk && !IniConfigFile_load( self ) )
+    {
+        IniConfigFile_clear( self );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool IniConfigFile_initFromBuffer( IniConfigFile *self, const char *buffer, size_t length, bool borrow )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( buffer || length == 0 );
+
+    if( !IniConfigFile_setup( self ) )
+    {
+        return false;
+    }
+
+    if( borrow )
+    {
+        self->buffer = (char*)buffer;
+    }
+    else
+    {
+        /* one copy here, the document borrows it from then on */
+        self->buffer = (char*)ANY_BALLOC( length + 1 );
+        self->ownsBuffer = 1;
+
+        if( self->buffer == NULL )
+        {
+            pthread_rwlock_destroy( &self->lock );
+            return false;
+        }
+
+        if( length > 0 )
+        {
+            memcpy( self->buffer, buffer, length );
+        }
+    }
+
+    self->bufferLength = length;
+    self->valid = INICONFIGFILE_VALID;
+
+    if( !IniConfigFile_load( self ) )
+    {
+        IniConfigFile_clear( self );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool IniConfigFile_initFromFd( IniConfigFile *self, int fd )
+{
+    char *buffer = NULL;
+    size_t length = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( fd >= 0 );
+
+    buffer = IniConfigDocument_readFd( fd, &length );
+
+    if( buffer == NULL )
+    {
+        ANY_LOG( 0, "Unable to read file descriptor %d", ANY_LOG_ERROR, fd );
+        return false;
+    }
+
+    if( !IniConfigFile_initFromBuffer( self, buffer, length, true ) )
+    {
+        ANY_FREE( buffer );
+        return false;
+    }
+
+    self->ownsBuffer = 1;
+
+    return true;
+}
+
+
+bool IniConfigFile_load( IniConfigFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    IniConfigFile_unshare( self );
+
+    if( self->document == NULL )
+    {
+        IniConfigDocument *document = IniConfigDocument_new();
+        IniConfigStore *store = IniConfigStore_new();
+
+        if( document == NULL || store == NULL || !IniConfigStore_init( store, 0 ) )
+        {
+            ANY_FREE( document );
+            ANY_FREE( store );
+            return false;
+        }
+
+        if( !IniConfigDocument_init( document ) )
+        {
+            IniConfigStore_clear( store );
+            ANY_FREE( store );
+            ANY_FREE( document );
+            return false;
+        }
+
+        self->document = document;
+        self->store = store;
+    }
+
+    IniConfigFile_thaw( self );
+    IniConfigDocument_setJournal( self->document, self->locking ? true : false );
+    IniConfigDocument_setTextFlags( self->document, self->textFlags );
+    IniConfigDocument_setBackend( self->document, self->backend );
+
+    /* files read from memory borrow their contents, which stay with self */
+    if( !( ( self->fileName != NULL ) ? IniConfigDocument_load( self->document, self->fileName ) :
+           IniConfigDocument_loadBuffer( self->document, self->buffer, self->bufferLength, true ) ) ||
+        !IniConfigStore_reload( self->store, self->document, false ) )
+    {
+        ANY_LOG( 0, "Unable to load '%s'", ANY_LOG_ERROR, IniConfigFile_getName( self ) );
+
+        self->invalidLine = IniConfigDocument_getInvalidLine( self->document );
+
+        goto failed;
+    }
+
+    /* without its columns the file is not loaded, no gets see the new contents */
+    if( !IniConfigFile_buildColumns( self ) )
+    {
+        goto failed;
+    }
+
+    if( self->exchange != NULL )
+    {
+        return IniConfigFile_publishFirst( self );
+    }
+
+    return true;
+
+    failed:
+
+    IniConfigFile_dropColumns( self );
+
+    IniConfigStore_clear( self->store );
+    IniConfigStore_delete( self->store );
+    IniConfigDocument_clear( self->document );
+    IniConfigDocument_delete( self->document );
+    self->store = NULL;
+    self->document = NULL;
+
+    return false;
+}
+
+
+bool IniConfigFile_save( IniConfigFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( self->fileName, "IniConfigFile_save() requires a file name" );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_save() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_save() is not available for shared files" );
+
+    return IniConfigFile_writeBack( self, true );
+}
+
+
+bool IniConfigFile_persist( IniConfigFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( self->fileName, "IniConfigFile_persist() requires a file name" );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_persist() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_persist() is not available for shared files" );
+
+    return IniConfigFile_writeBack( self, false );
+}
+
+
+void IniConfigFile_setDurability( IniConfigFile *self, IniConfigAtomicFileDurability durability )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    self->durability = durability;
+}
+
+
+void IniConfigFile_setLocking( IniConfigFile *self, bool locking )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( !locking || self->backend->onDisk, "IniConfigFile_setLocking() requires a backend on disk" );
+
+    self->locking = locking ? 1 : 0;
+
+    if( self->document != NULL )
+    {
+        IniConfigDocument_setJournal( self->document, locking );
+    }
+}
+
+
+void IniConfigFile_setTextFlags( IniConfigFile *self, int flags )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    self->textFlags = flags;
+
+    if( self->document != NULL )
+    {
+        IniConfigDocument_setTextFlags( self->document, flags );
+    }
+}
+
+
+int IniConfigFile_getInvalidLine( const IniConfigFile *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    /* a failed load drops the document, a failed merge keeps it */
+    return ( self->document != NULL ) ? IniConfigDocument_getInvalidLine( self->document ) : self->invalidLine;
+}
+
+
+bool IniConfigFile_saveGroup( IniConfigFile *self, IniConfigCommitGroup *group )
+{
+    IniConfigAtomicFile *file = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( group );
+    ANY_REQUIRE_MSG( self->fileName, "IniConfigFile_saveGroup() requires a file name" );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_saveGroup() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_saveGroup() is not available for shared files" );
+    ANY_REQUIRE_MSG( self->backend->onDisk, "IniConfigFile_saveGroup() requires a backend on disk" );
+
+    file = IniConfigCommitGroup_add( group, self->fileName );
+
+    if( file == NULL )
+    {
+        return false;
+    }
+
+    pthread_rwlock_wrlock( &self->lock );
+
+    if( !IniConfigStore_flush( self->store, self->document ) ||
+        !IniConfigDocument_write( self->document, IniConfigAtomicFile_getFd( file ) ) )
+    {
+        pthread_rwlock_unlock( &self->lock );
+
+        ANY_LOG( 0, "Unable to write '%s'", ANY_LOG_ERROR, self->fileName );
+        IniConfigAtomicFile_abort( file );
+        return false;
+    }
+
+    pthread_rwlock_unlock( &self->lock );
+
+    return true;
+}
+
+
+int IniConfigFile_getString( const IniConfigFile *self, const char *section, const char *key,
+                             const char *defValue, char *buffer, int bufferSize )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
+
+    return IniConfigFile_getValue( self, section, key, defValue, buffer, bufferSize );
+}
+
+
+unsigned int IniConfigFile_getBatch( const IniConfigFile *self, unsigned int count, const char *const *sections,
+                                     const char *const *keys, IniConfigFileValueVisitor visitor, void *context )
+{
+    IniConfigFileBatch batch;
+    const IniConfigIndex *index = NULL;
+    unsigned int reader = 0;
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( sections );
+    ANY_REQUIRE( keys );
+    ANY_REQUIRE( visitor );
+    ANY_REQUIRE_MSG( IniConfigFile_isLoaded( self ) || self->exchange != NULL,
+                     "IniConfigFile_getBatch() requires IniConfigFile_load()" );
+
+    batch.visitor = visitor;
+    batch.context = context;
+    batch.found = 0;
+
+    if( self->exchange == NULL && !IniConfigFile_isFrozen( self ) )
+    {
+        IniConfigStore_getBatch( self->store, count, sections, keys, IniConfigFile_visitBatch, &batch );
+
+        return batch.found;
+    }
+
+    if( self->exchange != NULL )
+    {
+        index = IniConfigExchange_getCurrent( self->exchange );
+    }
+    else
+    {
+        reader = IniConfigReaders_enter( self->readers );
+        index = IniConfigFile_getFrozen( self );
+    }
+
+    for( i = 0; i < count; i += INICONFIGHAMT_BATCH )
+    {
+        const char *values[INICONFIGHAMT_BATCH];
+        unsigned int n = ( count - i < INICONFIGHAMT_BATCH ) ? count - i : INICONFIGHAMT_BATCH;
+        unsigned int j = 0;
+
+        if( index != NULL )
+        {
+            IniConfigIndex_findBatch( index, n, sections + i, keys + i, values );
+        }
+
+        for( j = 0; j < n; j++ )
+        {
+            IniConfigFile_visitBatch( &batch, i + j, ( index != NULL ) ? values[j] : NULL );
+        }
+    }
+
+    if( self->exchange == NULL )
+    {
+        IniConfigReaders_leave( self->readers, reader );
+    }
+
+    return batch.found;
+}
+
+
+long IniConfigFile_getLong( const IniConfigFile *self, const char *section, const char *key, long defValue )
+{
+    char buff[64];
+    int len = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    if( !IniConfigFile_isLoaded( self ) && self->exchange == NULL )
+    {
+        return ini_getl( section, key, defValue, self->fileName );
+    }
+
+    len = IniConfigFile_getValue( self, section, key, "", buff, 64 );
+
+    /* same conversion as ini_getl(), including "0x" prefixes */
+    if( len == 0 )
+    {
+        return defValue;
+    }
+
+    return ( len >= 2 && toupper( (int)buff[1] ) == 'X' ) ? strtol( buff, NULL, 16 ) : strtol( buff, NULL, 10 );
+}
+
+
+int IniConfigFile_getInt( const IniConfigFile *self, const char *section, const char *key, int defValue )
+{
+    char buff[64];
+    int len = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    len = IniConfigFile_getValue( self,
+                                  section,
+                                  key,
+                                  "",
+                                  buff,
+                                  64 );
+
+    return ( len == 0 ? defValue : atoi( buff ) );
+}
+
+
+double IniConfigFile_getDouble( const IniConfigFile *self, const char *section, const char *key, double defValue )
+{
+    char buff[64];
+    int len = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    len = IniConfigFile_getValue( self,
+                                  section,
+                                  key,
+                                  "",
+                                  buff,
+                                  64 );
+
+    return ( len == 0 ? defValue : strtod( buff, NULL ) );
+}
+
+
+long IniConfigFile_getBlob( const IniConfigFile *self, const char *section, const char *key, int encoding,
+                           void *buffer, size_t bufferSize )
+{
+    IniConfigFileBlob blob;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( buffer || bufferSize == 0 );
+    ANY_REQUIRE_MSG( IniConfigFile_isLoaded( self ) || self->exchange != NULL,
+                     "IniConfigFile_getBlob() requires IniConfigFile_load()" );
+
+    blob.encoding = encoding;
+    blob.buffer = buffer;
+    blob.bufferSize = bufferSize;
+    blob.size = -1;
+
+    IniConfigFile_getBatch( self, 1, &section, &key, IniConfigFile_visitBlob, &blob );
+
+    return blob.size;
+}
+
+
+int IniConfigFile_putBlob( const IniConfigFile *self, const char *section, const char *key, int encoding,
+                           const void *data, size_t size )
+{
+    char *text = NULL;
+    int retVal = 0;
+
+    ANY_REQUIRE( data || size == 0 );
+
+    text = ANY_BALLOC( IniConfigBlob_getEncodedLength( encoding, size ) + 1 );
+
+    if( text == NULL )
+    {
+        return 0;
+    }
+
+    IniConfigBlob_encode( encoding, data, size, text );
+
+    retVal = IniConfigFile_putString( self, section, key, text );
+
+    ANY_FREE( text );
+
+    return retVal;
+}
+
+
+long long IniConfigFile_getDuration( const IniConfigFile *self, const char *section, const char *key,
+                                     long long defValue )
+{
+    double value = 0.0;
+
+    if( !IniConfigFile_getQuantity( self, section, key, INICONFIGUNITS_DURATION, &value ) ||
+        value >= 9.2e18 || value <= -9.2e18 )
+    {
+        return defValue;
+    }
+
+    return llround( value );
+}
+
+
+long long IniConfigFile_getByteSize( const IniConfigFile *self, const char *section, const char *key,
+                                     long long defValue )
+{
+    double value = 0.0;
+
+    if( !IniConfigFile_getQuantity( self, section, key, INICONFIGUNITS_BYTESIZE, &value ) ||
+        value >= 9.2e18 || value <= -9.2e18 )
+    {
+        return defValue;
+    }
+
+    return llround( value );
+}
+
+
+double IniConfigFile_getFrequency( const IniConfigFile *self, const char *section, const char *key,
+                                   double defValue )
+{
+    double value = 0.0;
+
+    return IniConfigFile_getQuantity( self, section, key, INICONFIGUNITS_FREQUENCY, &value ) ? value : defValue;
+}
+
+
+int IniConfigFile_getSection( const IniConfigFile *self, int idx, char *buffer, int bufferSize )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+    ANY_REQUIRE( idx >= 0 );
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+        int len = 0;
+
+        /* a frozen document does not change, reading it needs no lock */
+        len = IniConfigDocument_getSection( __atomic_load_n( &self->document, __ATOMIC_SEQ_CST ), idx,
+                                            buffer, bufferSize );
+
+        IniConfigReaders_leave( self->readers, reader );
+
+        return len;
+    }
+
+    if( self->document != NULL )
+    {
+        IniConfigFile *file = (IniConfigFile *)self;
+        int len = 0;
+
+        /* keys added since the last flush have to be in the document */
+        IniConfigFile_lockOrdered( file );
+
+        len = IniConfigDocument_getSection( self->document, idx, buffer, bufferSize );
+
+        pthread_rwlock_unlock( &file->lock );
+
+        return len;
+    }
+
+    return ini_getsection( idx, buffer, bufferSize, self->fileName );
+}
+
+
+int IniConfigFile_getKey( const IniConfigFile *self, const char *section, int idx, char *buffer, int bufferSize )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+    ANY_REQUIRE( idx >= 0 );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+        int len = 0;
+
+        /* a frozen document does not change, reading it needs no lock */
+        len = IniConfigDocument_getKey( __atomic_load_n( &self->document, __ATOMIC_SEQ_CST ), section, idx,
+                                        buffer, bufferSize );
+
+        IniConfigReaders_leave( self->readers, reader );
+
+        return len;
+    }
+
+    if( self->document != NULL )
+    {
+        IniConfigFile *file = (IniConfigFile *)self;
+        int len = 0;
+
+        /* keys added since the last flush have to be in the document */
+        IniConfigFile_lockOrdered( file );
+
+        len = IniConfigDocument_getKey( self->document, section, idx, buffer, bufferSize );
+
+        pthread_rwlock_unlock( &file->lock );
+
+        return len;
+    }
+
+    return ini_getkey( section, idx, buffer, bufferSize, self->fileName );
+}
+
+
+int IniConfigFile_countSections( const IniConfigFile *self )
+{
+    char buffer[2];
+    int count = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+
+        count = IniConfigDocument_countSections( __atomic_load_n( &self->document, __ATOMIC_SEQ_CST ) );
+
+        IniConfigReaders_leave( self->readers, reader );
+
+        return count;
+    }
+
+    if( self->document != NULL )
+    {
+        IniConfigFile *file = (IniConfigFile *)self;
+
+        IniConfigFile_lockOrdered( file );
+
+        count = IniConfigDocument_countSections( self->document );
+
+        pthread_rwlock_unlock( &file->lock );
+
+        return count;
+    }
+
+    /* minIni has no count, every probe reads the file up to the section */
+    while( ini_getsection( count, buffer, sizeof( buffer ), self->fileName ) > 0 )
+    {
+        count++;
+    }
+
+    return count;
+}
+
+
+int IniConfigFile_countKeys( const IniConfigFile *self, const char *section )
+{
+    char buffer[2];
+    int count = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+
+        count = IniConfigDocument_countKeys( __atomic_load_n( &self->document, __ATOMIC_SEQ_CST ), section );
+
+        IniConfigReaders_leave( self->readers, reader );
+
+        return count;
+    }
+
+    if( self->document != NULL )
+    {
+        IniConfigFile *file = (IniConfigFile *)self;
+
+        IniConfigFile_lockOrdered( file );
+
+        count = IniConfigDocument_countKeys( self->document, section );
+
+        pthread_rwlock_unlock( &file->lock );
+
+        return count;
+    }
+
+    while( ini_getkey( section, count, buffer, sizeof( buffer ), self->fileName ) > 0 )
+    {
+        count++;
+    }
+
+    return count;
+}
+
 
+int IniConfigFile_putString( const IniConfigFile *self, const char *section, const char *key, const char *value )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
 
-#include <IniConfigFile.h>
+    if( self->document != NULL )
+    {
+        return IniConfigFile_putValue( self, section, key, value, INICONFIGSTORE_ALWAYS, 0 );
+    }
 
-#if !defined INICONFIGFILE_LINETERM
-#define INICONFIGFILE_LINETERM    "\n"
-#endif
-#if !defined INICONFIGFILE_FILETYPE
-#define INICONFIGFILE_FILETYPE    FILE*
-#endif
+    if( self->locking )
+    {
+        int lockFd = IniConfigAtomicFile_lock( self->fileName );
+        int retVal = 0;
 
-#define INICONFIGFILE_VALID     0x26aec137
-#define INICONFIGFILE_INVALID   0xb00db00f
+        if( lockFd == -1 )
+        {
+            return 0;
+        }
 
+        retVal = ini_puts( section, key, value, self->fileName );
 
-/*
- * Public functions
- */
+        IniConfigAtomicFile_unlock( lockFd );
 
-IniConfigFile *IniConfigFile_new( void )
+        return retVal;
+    }
+
+    return ini_puts( section, key, value, self->fileName );
+}
+
+
+unsigned long IniConfigFile_getGeneration( const IniConfigFile *self, const char *section, const char *key )
 {
-    return ( ANY_TALLOC( IniConfigFile ) );
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_getGeneration() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_getGeneration() is not available for shared files" );
+
+    return IniConfigStore_getGeneration( self->store, section, key );
 }
 
 
-bool IniConfigFile_init( IniConfigFile *self, const char *fileName )
+int IniConfigFile_putIfUnchanged( const IniConfigFile *self, const char *section, const char *key,
+                                  const char *value, unsigned long generation )
 {
-    bool retVal = false;
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_putIfUnchanged() requires IniConfigFile_load()" );
+
+    return IniConfigFile_putValue( self, section, key, value, INICONFIGSTORE_IFKEY, generation );
+}
+
 
+int IniConfigFile_putIfDocumentUnchanged( const IniConfigFile *self, const char *section, const char *key,
+                                          const char *value, unsigned long generation )
+{
     ANY_REQUIRE( self );
-    ANY_REQUIRE( fileName );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_putIfDocumentUnchanged() requires IniConfigFile_load()" );
 
-    self->valid = INICONFIGFILE_INVALID;
-    self->fileName = Any_strdup( (char*)fileName );
+    return IniConfigFile_putValue( self, section, key, value, INICONFIGSTORE_IFDOCUMENT, generation );
+}
 
-    if( !self->fileName )
+
+bool IniConfigFile_snapshot( const IniConfigFile *self, IniConfigSnapshot *snapshot )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( snapshot );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_snapshot() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_snapshot() is not available for shared files" );
+
+    return IniConfigStore_snapshot( self->store, snapshot );
+}
+
+
+bool IniConfigFile_rollback( IniConfigFile *self, const IniConfigSnapshot *snapshot )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( snapshot );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_rollback() requires IniConfigFile_load()" );
+
+    if( IniConfigFile_isFrozen( self ) )
     {
-        goto out;
+        return false;
     }
 
-    retVal = true;
+    return IniConfigStore_rollback( self->store, snapshot );
+}
 
-    self->valid = INICONFIGFILE_VALID;
 
-    out:
+bool IniConfigFile_buildIndex( IniConfigFile *self, IniConfigIndex *index, int flags )
+{
+    bool retVal = false;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( index );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_buildIndex() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_buildIndex() is not available for shared files" );
+
+    pthread_rwlock_wrlock( &self->lock );
+
+    if( IniConfigStore_flush( self->store, self->document ) )
+    {
+        retVal = IniConfigIndex_build( index, self->document, flags );
+    }
+
+    pthread_rwlock_unlock( &self->lock );
 
     return retVal;
 }
 
 
-int IniConfigFile_getString( const IniConfigFile *self, const char *section, const char *key,
-                             const char *defValue, char *buffer, int bufferSize )
+void IniConfigFile_setIndexFlags( IniConfigFile *self, int flags )
 {
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( buffer );
-    ANY_REQUIRE( bufferSize > 0 );
-    ANY_REQUIRE( key );
-    ANY_REQUIRE( self->fileName );
 
-    return ini_gets( section, key, defValue, buffer, bufferSize, self->fileName );
+    self->indexFlags = flags;
 }
 
 
-long IniConfigFile_getLong( const IniConfigFile *self, const char *section, const char *key, long defValue )
+bool IniConfigFile_setDoubleBuffering( IniConfigFile *self, bool enable, int indexFlags )
 {
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
 
-    return ini_getl( section, key, defValue, self->fileName );
+    if( !enable )
+    {
+        if( self->exchange != NULL )
+        {
+            IniConfigExchange_clear( self->exchange );
+            IniConfigExchange_delete( self->exchange );
+            self->exchange = NULL;
+        }
+
+        return true;
+    }
+
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_setDoubleBuffering() is not available for shared files" );
+
+    self->indexFlags = indexFlags;
+
+    if( self->exchange == NULL )
+    {
+        self->exchange = IniConfigExchange_new();
+
+        if( self->exchange == NULL || !IniConfigExchange_init( self->exchange ) )
+        {
+            ANY_FREE( self->exchange );
+            self->exchange = NULL;
+            return false;
+        }
+    }
+
+    return ( self->document != NULL ) ? IniConfigFile_publishFirst( self ) : true;
 }
 
 
-int IniConfigFile_getInt( const IniConfigFile *self, const char *section, const char *key, int defValue )
+bool IniConfigFile_publish( IniConfigFile *self )
 {
-    char buff[64];
-    int len = 0;
+    IniConfigIndex *index = NULL;
 
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( self->exchange, "IniConfigFile_publish() requires IniConfigFile_setDoubleBuffering()" );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_publish() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_publish() is not available for shared files" );
 
-    len = ini_gets( section,
-                    key,
-                    "",
-                    buff,
-                    64,
-                    self->fileName );
+    index = IniConfigIndex_new();
 
-    return ( len == 0 ? defValue : atoi( buff ) );
+    if( index == NULL || !IniConfigIndex_init( index ) )
+    {
+        ANY_FREE( index );
+        return false;
+    }
+
+    if( !IniConfigFile_buildIndex( self, index, self->indexFlags ) )
+    {
+        IniConfigIndex_clear( index );
+        IniConfigIndex_delete( index );
+        return false;
+    }
+
+    IniConfigExchange_publish( self->exchange, index );
+
+    return true;
 }
 
 
-double IniConfigFile_getDouble( const IniConfigFile *self, const char *section, const char *key, double defValue )
+bool IniConfigFile_sync( IniConfigFile *self )
 {
-    char buff[64];
-    int len = 0;
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( self->exchange, "IniConfigFile_sync() requires IniConfigFile_setDoubleBuffering()" );
+
+    return IniConfigExchange_sync( self->exchange );
+}
+
+
+bool IniConfigFile_freeze( IniConfigFile *self )
+{
+    IniConfigReplicas *replicas = NULL;
+    bool retVal = false;
 
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE_MSG( self->document, "IniConfigFile_freeze() requires IniConfigFile_load()" );
+    ANY_REQUIRE_MSG( self->exchange == NULL, "IniConfigFile_freeze() is not available with double buffering" );
 
-    len = ini_gets( section,
-                    key,
-                    "",
-                    buff,
-                    64,
-                    self->fileName );
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        return true;
+    }
 
-    return ( len == 0 ? defValue : strtod( buff, NULL ) );
+    if( !IniConfigFile_trackReaders( self ) )
+    {
+        return false;
+    }
+
+    replicas = IniConfigReplicas_new();
+
+    if( replicas == NULL || !IniConfigReplicas_init( replicas, self->numaReplicas ) )
+    {
+        ANY_FREE( replicas );
+        return false;
+    }
+
+    pthread_rwlock_wrlock( &self->lock );
+
+    if( IniConfigStore_flush( self->store, self->document ) && IniConfigDocument_updateOrder( self->document ) )
+    {
+        retVal = IniConfigReplicas_build( replicas, self->document, self->indexFlags );
+    }
+
+    pthread_rwlock_unlock( &self->lock );
+
+    if( !retVal )
+    {
+        IniConfigReplicas_clear( replicas );
+        IniConfigReplicas_delete( replicas );
+        return false;
+    }
+
+    /* every node's copy is complete before any get can see one of them */
+    __atomic_store_n( &self->frozen, replicas, __ATOMIC_SEQ_CST );
+
+    return true;
 }
 
 
-int IniConfigFile_getSection( const IniConfigFile *self, int idx, char *buffer, int bufferSize )
+bool IniConfigFile_refreeze( IniConfigFile *self )
 {
+    IniConfigDocument *document = NULL;
+    IniConfigReplicas *replicas = NULL;
+    IniConfigColumns *columns = NULL;
+    bool retVal = false;
+
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( buffer );
-    ANY_REQUIRE( bufferSize > 0 );
-    ANY_REQUIRE( idx >= 0 );
+    ANY_REQUIRE_MSG( self->frozen, "IniConfigFile_refreeze() requires IniConfigFile_freeze()" );
+    ANY_REQUIRE_MSG( self->shared == NULL, "IniConfigFile_refreeze() is not available for shared files" );
 
-    return ini_getsection( idx, buffer, bufferSize, self->fileName );
+    document = IniConfigDocument_new();
+
+    if( document == NULL || !IniConfigDocument_init( document ) )
+    {
+        ANY_FREE( document );
+        return false;
+    }
+
+    replicas = IniConfigReplicas_new();
+
+    if( replicas == NULL || !IniConfigReplicas_init( replicas, self->numaReplicas ) )
+    {
+        ANY_FREE( replicas );
+        replicas = NULL;
+        goto out;
+    }
+
+    IniConfigDocument_setJournal( document, self->locking ? true : false );
+    IniConfigDocument_setTextFlags( document, self->textFlags );
+    IniConfigDocument_setBackend( document, self->backend );
+
+    /* the version being read stays untouched until the new one is complete */
+    if( !( ( self->fileName != NULL ) ? IniConfigDocument_load( document, self->fileName ) :
+           IniConfigDocument_loadBuffer( document, self->buffer, self->bufferLength, true ) ) )
+    {
+        ANY_LOG( 0, "Unable to load '%s'", ANY_LOG_ERROR, IniConfigFile_getName( self ) );
+
+        self->invalidLine = IniConfigDocument_getInvalidLine( document );
+
+        goto out;
+    }
+
+    if( !IniConfigDocument_updateOrder( document ) ||
+        !IniConfigReplicas_build( replicas, document, self->indexFlags ) )
+    {
+        goto out;
+    }
+
+    if( self->columnar )
+    {
+        columns = IniConfigFile_newColumns( self, document );
+
+        if( columns == NULL )
+        {
+            goto out;
+        }
+    }
+
+    pthread_rwlock_wrlock( &self->lock );
+
+    /* generations and snapshots come from the store, which changes in place */
+    if( !IniConfigStore_reload( self->store, document, false ) )
+    {
+        pthread_rwlock_unlock( &self->lock );
+        goto out;
+    }
+
+    document = __atomic_exchange_n( &self->document, document, __ATOMIC_SEQ_CST );
+    columns = __atomic_exchange_n( &self->columns, columns, __ATOMIC_SEQ_CST );
+    replicas = __atomic_exchange_n( &self->frozen, replicas, __ATOMIC_SEQ_CST );
+
+    /* only gets which started before the swap may still read the old version */
+    IniConfigReaders_synchronize( self->readers );
+
+    pthread_rwlock_unlock( &self->lock );
+
+    retVal = true;
+
+    out:
+
+    /* the old version after a swap, the new one otherwise */
+    if( columns != NULL )
+    {
+        IniConfigColumns_clear( columns );
+        IniConfigColumns_delete( columns );
+    }
+
+    if( replicas != NULL )
+    {
+        IniConfigReplicas_clear( replicas );
+        IniConfigReplicas_delete( replicas );
+    }
+
+    IniConfigDocument_clear( document );
+    IniConfigDocument_delete( document );
+
+    return retVal;
 }
 
 
-int IniConfigFile_getKey( const IniConfigFile *self, const char *section, int idx, char *buffer, int bufferSize )
+bool IniConfigFile_loadShared( IniConfigFile *self )
 {
+    IniConfigRegistryVersion *version = NULL;
+
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( buffer );
-    ANY_REQUIRE( bufferSize > 0 );
-    ANY_REQUIRE( idx >= 0 );
-    ANY_REQUIRE( self->fileName );
+    ANY_REQUIRE_MSG( self->fileName, "IniConfigFile_loadShared() requires a file name" );
+    ANY_REQUIRE_MSG( self->exchange == NULL, "IniConfigFile_loadShared() is not available with double buffering" );
+    ANY_REQUIRE_MSG( self->backend->onDisk, "IniConfigFile_loadShared() requires a backend on disk" );
 
-    return ini_getkey( section, idx, buffer, bufferSize, self->fileName );
+    if( !IniConfigFile_trackReaders( self ) )
+    {
+        return false;
+    }
+
+    version = IniConfigRegistry_acquire( self->fileName, self->textFlags, self->indexFlags,
+                                         self->numaReplicas ? true : false );
+
+    if( version == NULL )
+    {
+        return false;
+    }
+
+    /* the new reference keeps the file registered while the old one goes */
+    IniConfigFile_unshare( self );
+    IniConfigFile_thaw( self );
+    IniConfigFile_dropColumns( self );
+
+    if( self->document != NULL )
+    {
+        IniConfigStore_clear( self->store );
+        IniConfigStore_delete( self->store );
+        IniConfigDocument_clear( self->document );
+        IniConfigDocument_delete( self->document );
+        self->store = NULL;
+    }
+
+    if( self->listener != NULL && !IniConfigRegistry_setListener( version, self, self->listener,
+                                                                  self->listenerContext ) )
+    {
+        ANY_LOG( 0, "Unable to listen to changes of '%s'", ANY_LOG_WARNING, self->fileName );
+    }
+
+    self->shared = version;
+    self->document = version->document;
+    self->frozen = version->replicas;
+
+    return true;
 }
 
 
-int IniConfigFile_putString( const IniConfigFile *self, const char *section, const char *key, const char *value )
+bool IniConfigFile_setListener( IniConfigFile *self, IniConfigRegistryListener listener, void *context )
 {
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( self->fileName );
 
-    return ini_puts( section, key, value, self->fileName );
+    self->listener = listener;
+    self->listenerContext = context;
+
+    if( self->shared != NULL )
+    {
+        return IniConfigRegistry_setListener( self->shared, self, listener, context );
+    }
+
+    return true;
+}
+
+
+void IniConfigFile_setNumaReplicas( IniConfigFile *self, bool enable )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    self->numaReplicas = enable ? 1 : 0;
+}
+
+
+void IniConfigFile_setColumnar( IniConfigFile *self, bool enable )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+
+    self->columnar = enable ? 1 : 0;
+
+    if( !enable )
+    {
+        IniConfigFile_dropColumns( self );
+    }
+}
+
+
+bool IniConfigFile_getColumns( const IniConfigFile *self, const char *section, IniConfigColumnsSpan *span )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
+    ANY_REQUIRE( span );
+    ANY_REQUIRE_MSG( __atomic_load_n( &self->columns, __ATOMIC_RELAXED ),
+                     "IniConfigFile_getColumns() requires IniConfigFile_setColumnar() and IniConfigFile_load()" );
+
+    if( IniConfigFile_isFrozen( self ) )
+    {
+        unsigned int reader = IniConfigReaders_enter( self->readers );
+        bool found = IniConfigColumns_getSpan( __atomic_load_n( &self->columns, __ATOMIC_SEQ_CST ), section, span );
+
+        IniConfigReaders_leave( self->readers, reader );
+
+        return found;
+    }
+
+    return IniConfigColumns_getSpan( self->columns, section, span );
 }
 
+
 int IniConfigFile_putLong( const IniConfigFile *self, const char *section, const char *key, long value )
 {
+    char str[32];
+
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( self->fileName );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
+
+    if( self->document == NULL && !self->locking )
+    {
+        return ini_putl( section, key, value, self->fileName );
+    }
+
+    Any_snprintf( str, 32, "%ld", value );
 
-    return ini_putl( section, key, value, self->fileName );
+    return IniConfigFile_putString( self, section, key, str );
 }
 
 
@@ -194,7 +1688,7 @@ int IniConfigFile_putInt( const IniConfigFile *self, const char *section, const
 
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( self->fileName );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
 
     Any_snprintf( str, 32, "%d", value );
 
@@ -208,7 +1702,7 @@ int IniConfigFile_putDouble( const IniConfigFile *self, const char *section, con
 
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( self->fileName );
+    ANY_REQUIRE( self->fileName || IniConfigFile_isLoaded( self ) );
 
     Any_snprintf( str, 32, "%e", value );
 
@@ -226,10 +1720,50 @@ void IniConfigFile_clear( IniConfigFile *self )
 {
     ANY_REQUIRE( self );
     ANY_REQUIRE( self->valid == INICONFIGFILE_VALID );
-    ANY_REQUIRE( self->fileName );
 
     self->valid = INICONFIGFILE_INVALID;
 
+    IniConfigFile_unshare( self );
+
+    if( self->document != NULL )
+    {
+        IniConfigStore_clear( self->store );
+        IniConfigStore_delete( self->store );
+        self->store = NULL;
+
+        IniConfigDocument_clear( self->document );
+        IniConfigDocument_delete( self->document );
+        self->document = NULL;
+    }
+
+    IniConfigFile_thaw( self );
+    IniConfigFile_dropColumns( self );
+
+    if( self->readers != NULL )
+    {
+        IniConfigReaders_clear( self->readers );
+        IniConfigReaders_delete( self->readers );
+        self->readers = NULL;
+    }
+
+    if( self->exchange != NULL )
+    {
+        IniConfigExchange_clear( self->exchange );
+        IniConfigExchange_delete( self->exchange );
+        self->exchange = NULL;
+    }
+
+    pthread_rwlock_destroy( &self->lock );
+
+    if( self->ownsBuffer )
+    {
+        ANY_FREE( self->buffer );
+    }
+
+    self->buffer = NULL;
+    self->bufferLength = 0;
+    self->ownsBuffer = 0;
+
     ANY_FREE( (char*)self->fileName );
     self->fileName = NULL;
 }
@@ -94,6 +94,105 @@
  * tasks writes to the INI file), you need to write wrappers around the
  * functions of the minIni library that block on a mutex or binary semaphore.
  *
+ * <h2>In-memory documents</h2>
+ *
+ * By default every get and put function re-reads or rewrites the file.
+ * After IniConfigFile_load() the whole file is held in memory as an
+ * IniConfigDocument (see \ref IniConfigDocument): gets are answered from a
+ * hash index, puts only change the in-memory document, and
+ * IniConfigFile_save() writes all modifications back at once while keeping
+ * comments, blank lines and the original layout of untouched lines.
+ *
+ * Loaded files resolve section inheritance: "[robot_A : robot_defaults]"
+ * takes every key it does not hold itself from robot_defaults, and a
+ * section like "[sensor.*]" supplies defaults to all sections matching
+ * it. The inherited keys are copied into the hash index at load time, so
+ * they cost a single lookup like own keys. They follow puts to the
+ * section they come from at the next IniConfigFile_load(),
+ * IniConfigFile_freeze() or IniConfigFile_publish(). The unloaded mode
+ * reads the file with minIni and knows no inheritance.
+ *
+ * Saves are atomic. IniConfigFile_setDurability() additionally makes them
+ * survive power failures, and IniConfigFile_saveGroup() saves several files
+ * with a single set of disk flushes (see \ref IniConfigAtomicFile).
+ *
+ * <h2>Threads</h2>
+ *
+ * In loaded mode the get and put functions may be called from many threads
+ * at once. Values live in a sharded store (see \ref IniConfigStore) in
+ * front of the document, so threads updating different keys do not block
+ * each other. IniConfigFile_putIfUnchanged() provides optimistic
+ * read-modify-write cycles:
+ *
+ * \code
+ *  do
+ *  {
+ *    generation = IniConfigFile_getGeneration( myIniFile, "Stats", "count" );
+ *    count = IniConfigFile_getLong( myIniFile, "Stats", "count", 0 );
+ *    Any_snprintf( value, 32, "%ld", count + 1 );
+ *  }
+ *  while( !IniConfigFile_putIfUnchanged( myIniFile, "Stats", "count", value, generation ) );
+ * \endcode
+ *
+ * Puts only mark their key dirty; a thread calling IniConfigFile_persist()
+ * periodically writes the collected changes to the file without stopping
+ * the other threads.
+ *
+ * IniConfigFile_load(), IniConfigFile_clear() and IniConfigFile_setLocking()
+ * must not run concurrently with other calls.
+ *
+ * IniConfigFile_setTextFlags() makes IniConfigFile_load() accept byte
+ * order marks and UTF-16 files, and reject files which are not valid UTF-8
+ * (see \ref IniConfigText).
+ *
+ * IniConfigFile_snapshot() captures all values at once without copying
+ * them, and IniConfigFile_rollback() restores them (see
+ * \ref IniConfigSnapshot).
+ *
+ * An IniConfigSection reads and writes the keys of one section without
+ * hashing its name again for every key (see \ref IniConfigSection).
+ *
+ * IniConfigFile_getBlob() and IniConfigFile_putBlob() read and write
+ * binary values encoded as base64 or hex (see \ref IniConfigBlob).
+ *
+ * IniConfigFile_getDuration(), IniConfigFile_getByteSize() and
+ * IniConfigFile_getFrequency() read values with units like "250ms" or
+ * "4 MiB" (see \ref IniConfigUnits).
+ *
+ * After IniConfigFile_setColumnar() IniConfigFile_getColumns() returns all
+ * numbers of a section as contiguous arrays (see \ref IniConfigColumns).
+ *
+ * Threads which must not block, allocate or make system calls read from
+ * an index built by IniConfigFile_buildIndex() instead (see
+ * \ref IniConfigIndex).
+ *
+ * IniConfigFile_freeze() turns a loaded file read-only before forking
+ * worker processes: the get functions then only read memory, so the
+ * workers keep sharing the parent's pages. On machines with several NUMA
+ * nodes IniConfigFile_setNumaReplicas() gives every node its own copy of
+ * a frozen file (see \ref IniConfigReplicas). IniConfigFile_refreeze()
+ * reloads a frozen file while other threads read it.
+ *
+ * After IniConfigFile_setDoubleBuffering() a control loop reads one
+ * consistent version and switches to the next one only when it calls
+ * IniConfigFile_sync() (see \ref IniConfigExchange).
+ *
+ * <h2>Several writers</h2>
+ *
+ * When several processes update the same file, a write may overwrite the
+ * changes another process made in the meantime. After
+ * IniConfigFile_setLocking() all writes take an advisory file lock; in
+ * loaded mode IniConfigFile_save() additionally merges the changes of
+ * other writers before replacing the file, so only concurrent writes to
+ * the same key override each other.
+ *
+ * <h2>Platforms</h2>
+ *
+ * The loaded mode guards its store with POSIX threads and reads and
+ * writes files with POSIX I/O, so the library builds on Linux and other
+ * POSIX systems only. Windows, which the plain minIni wrapper used to
+ * support, is no longer a target.
+ *
  * \note The library uses temporary files when writing/removing keys.
  *       All the temporary filenames start with a tilde (~).
  */
@@ -106,17 +205,67 @@
  */
 #define INICONFIGFILE_BUFFERSIZE  4096
 
+#if defined(__windows__)
+#error "IniConfigFile requires POSIX threads and I/O, see the Platforms section of its main page"
+#endif
+
+#include <pthread.h>
+
+#include <IniConfigBackend.h>
+#include <IniConfigBlob.h>
+#include <IniConfigColumns.h>
+#include <IniConfigDocument.h>
+#include <IniConfigExchange.h>
+#include <IniConfigIndex.h>
+#include <IniConfigReaders.h>
+#include <IniConfigRegistry.h>
+#include <IniConfigReplicas.h>
+#include <IniConfigSnapshot.h>
+#include <IniConfigStore.h>
+#include <IniConfigUnits.h>
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
+/*!
+ * \brief Receives the values of IniConfigFile_getBatch()
+ *
+ * \param context  Context passed to IniConfigFile_getBatch()
+ * \param i        Number of the key in the batch
+ * \param value    Value of the key, NULL if it does not exist. Only valid
+ *                 during the call.
+ */
+typedef void ( *IniConfigFileValueVisitor )( void *context, unsigned int i, const char *value );
+
 /*!
  * \brief IniConfigFile definition
  */
 typedef struct IniConfigFile
 {
-    unsigned long valid;   /**< Object validity */
-    const char *fileName;  /**< Pointer to the ini filename */
+    unsigned long valid;           /**< Object validity */
+    const char *fileName;          /**< Pointer to the ini filename */
+    IniConfigDocument *document;   /**< In-memory document, NULL if not loaded */
+    IniConfigAtomicFileDurability durability; /**< Flushes done by IniConfigFile_save() */
+    int locking;                   /**< Writes are serialized with other processes */
+    IniConfigStore *store;         /**< Concurrent view of the document, NULL if not loaded */
+    pthread_rwlock_t lock;         /**< Guards the document against concurrent flushes */
+    IniConfigExchange *exchange;   /**< Versions read by the consumer thread, NULL unless double buffered */
+    int indexFlags;                /**< IniConfigIndexFlags of the frozen and published indexes */
+    IniConfigReplicas *frozen;     /**< Answers all gets once frozen, NULL otherwise, swapped atomically */
+    IniConfigReaders *readers;     /**< Lookups under way in the frozen version, NULL until frozen */
+    int numaReplicas;              /**< Freezing keeps a copy on every NUMA node */
+    int columnar;                  /**< Loading builds numeric columns */
+    IniConfigColumns *columns;     /**< Numeric columns of the last load, NULL if not built */
+    int textFlags;                 /**< IniConfigTextFlags applied by loads */
+    int invalidLine;               /**< Line which made the last load fail, 0 if none */
+    char *buffer;                  /**< Contents of a file read from memory, NULL for files with a name */
+    size_t bufferLength;           /**< Size of buffer */
+    int ownsBuffer;                /**< buffer is freed by IniConfigFile_clear() */
+    IniConfigRegistryVersion *shared; /**< Version of a shared file in use, NULL unless shared */
+    IniConfigRegistryListener listener; /**< Called when a shared file changed */
+    void *listenerContext;         /**< Passed to listener */
+    const IniConfigBackend *backend; /**< Loads and saves the file */
 }
 IniConfigFile;
 
@@ -165,6 +314,599 @@ IniConfigFile *IniConfigFile_new( void );
  */
 bool IniConfigFile_init( IniConfigFile *self, const char *fileName );
 
+/*!
+ * \brief Initialize a IniConfigFile instance loaded and saved through a backend
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param fileName    Name of the file within the backend
+ * \param backend     Backend to use (see \ref IniConfigBackend), it must
+ *                    stay valid until IniConfigFile_clear()
+ *
+ * IniConfigFile_init() is the same as passing IniConfigBackend_getPosix().
+ * Files of backends which are not on disk are loaded right away, since
+ * minIni cannot read them; locking, group commits and shared files are not
+ * available for them.
+ *
+ * \code
+ *  IniConfigFile_initWithBackend( myIniFile, "myConfig.ini", IniConfigBackend_getMmap() );
+ *  IniConfigFile_load( myIniFile );
+ * \endcode
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_init()
+ */
+bool IniConfigFile_initWithBackend( IniConfigFile *self, const char *fileName, const IniConfigBackend *backend );
+
+/*!
+ * \brief Initialize a IniConfigFile instance from INI contents in memory
+ *
+ * \param self    Pointer to the IniConfigFile
+ * \param buffer  INI file contents, e.g. received over IPC or embedded in
+ *                the program
+ * \param length  Number of bytes in buffer
+ * \param borrow  Use buffer in place instead of copying it; it must then
+ *                stay unchanged until IniConfigFile_clear()
+ *
+ * The contents are parsed right away, as if IniConfigFile_load() had been
+ * called on a file holding them, without writing such a file. All gets and
+ * puts work on the in-memory document. IniConfigFile_load() parses the
+ * contents again and drops the puts, for example after
+ * IniConfigFile_setTextFlags() or IniConfigFile_setColumnar(). There is no
+ * file to save to, IniConfigFile_save() and the functions writing files are
+ * not available.
+ *
+ * \code
+ *  static const char defaults[] = "[Network]\naddress=dhcp\n";
+ *
+ *  IniConfigFile_initFromBuffer( myIniFile, defaults, sizeof( defaults ) - 1, true );
+ * \endcode
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_initFromFd()
+ */
+bool IniConfigFile_initFromBuffer( IniConfigFile *self, const char *buffer, size_t length, bool borrow );
+
+/*!
+ * \brief Initialize a IniConfigFile instance from a file descriptor
+ *
+ * \param self  Pointer to the IniConfigFile
+ * \param fd    File descriptor of a file, pipe or socket
+ *
+ * Reads fd up to its end and parses what it read like
+ * IniConfigFile_initFromBuffer() does. The descriptor is not closed and
+ * not needed afterwards.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_initFromBuffer()
+ */
+bool IniConfigFile_initFromFd( IniConfigFile *self, int fd );
+
+/*!
+ * \brief Load the whole file into memory
+ *
+ * \param self        Pointer to the IniConfigFile
+ *
+ * After this call all get and put functions work on an in-memory copy of
+ * the file. Changes are written back with IniConfigFile_save(). Calling it
+ * again discards unsaved changes and re-reads the file.
+ *
+ * \code
+ *  IniConfigFile_init( myIniFile, "myConfig.ini" );
+ *  IniConfigFile_load( myIniFile );
+ *
+ *  for( i = 0; i < 1000; i++ )
+ *  {
+ *    Any_snprintf( key, 64, "Value%d", i );
+ *    IniConfigFile_putInt( myIniFile, "MySection", key, i );
+ *  }
+ *
+ *  IniConfigFile_save( myIniFile );
+ * \endcode
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_save()
+ */
+bool IniConfigFile_load( IniConfigFile *self );
+
+/*!
+ * \brief Write the in-memory document back to the file
+ *
+ * \param self        Pointer to the IniConfigFile
+ *
+ * Only the modified lines are re-serialized, everything else is copied
+ * verbatim from the loaded file.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_load()
+ */
+bool IniConfigFile_save( IniConfigFile *self );
+
+/*!
+ * \brief Write pending puts to the file if there are any
+ *
+ * \param self        Pointer to the IniConfigFile
+ *
+ * Like IniConfigFile_save(), but does not touch the file if nothing has
+ * changed since the last save. Meant to be called periodically while other
+ * threads keep putting values; their puts are not blocked by the write.
+ *
+ * \code
+ *  while( running )
+ *  {
+ *    sleep( 1 );
+ *    IniConfigFile_persist( myIniFile );
+ *  }
+ * \endcode
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_save()
+ */
+bool IniConfigFile_persist( IniConfigFile *self );
+
+/*!
+ * \brief Select how IniConfigFile_save() flushes the file to disk
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param durability  INICONFIGATOMICFILE_DURABILITY_NONE (default), _DATA or _FULL
+ *
+ * \return Nothing
+ *
+ * \see IniConfigAtomicFile_setDurability()
+ */
+void IniConfigFile_setDurability( IniConfigFile *self, IniConfigAtomicFileDurability durability );
+
+/*!
+ * \brief Serialize writes with other processes updating the same file
+ *
+ * \param self     Pointer to the IniConfigFile
+ * \param locking  true to lock the file around every write
+ *
+ * Without a loaded document each put holds the lock while the file is
+ * rewritten. With a loaded document the puts are recorded and
+ * IniConfigFile_save() merges them into the current file under the lock
+ * (see IniConfigDocument_saveLocked()), so the lock is held once per save
+ * instead of once per put.
+ *
+ * \code
+ *  IniConfigFile_init( myIniFile, "shared.ini" );
+ *  IniConfigFile_setLocking( myIniFile, true );
+ *  IniConfigFile_load( myIniFile );
+ *
+ *  IniConfigFile_putInt( myIniFile, "Worker", "progress", 42 );
+ *
+ *  IniConfigFile_save( myIniFile );
+ * \endcode
+ *
+ * \return Nothing
+ */
+void IniConfigFile_setLocking( IniConfigFile *self, bool locking );
+
+/*!
+ * \brief Check and convert the encoding of the file when loading it
+ *
+ * \param self   Pointer to the IniConfigFile
+ * \param flags  Or-ed IniConfigTextFlags, INICONFIGTEXT_NONE by default
+ *
+ * With INICONFIGTEXT_TRANSCODE files with a byte order mark and UTF-16
+ * files load like UTF-8 ones. With INICONFIGTEXT_VALIDATE
+ * IniConfigFile_load() fails for files which are not valid UTF-8 (see
+ * \ref IniConfigText).
+ *
+ * \code
+ *  IniConfigFile_setTextFlags( myIniFile, INICONFIGTEXT_TRANSCODE | INICONFIGTEXT_VALIDATE );
+ *
+ *  if( !IniConfigFile_load( myIniFile ) && IniConfigFile_getInvalidLine( myIniFile ) > 0 )
+ *  {
+ *    ANY_LOG( 0, "Fix line %d", ANY_LOG_ERROR, IniConfigFile_getInvalidLine( myIniFile ) );
+ *  }
+ * \endcode
+ *
+ * \return Nothing
+ */
+void IniConfigFile_setTextFlags( IniConfigFile *self, int flags );
+
+/*!
+ * \brief Line which made the last load fail the checks of IniConfigFile_setTextFlags()
+ *
+ * \param self  Pointer to the IniConfigFile
+ *
+ * \return The line number starting at 1, 0 if the last load passed them
+ */
+int IniConfigFile_getInvalidLine( const IniConfigFile *self );
+
+/*!
+ * \brief Queue the in-memory document for a group commit
+ *
+ * \param self   Pointer to the IniConfigFile
+ * \param group  Commit group the file is added to
+ *
+ * The file is replaced by IniConfigCommitGroup_commit(), using the
+ * durability of the group.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigCommitGroup_commit()
+ */
+bool IniConfigFile_saveGroup( IniConfigFile *self, IniConfigCommitGroup *group );
+
+
+/*!
+ * \brief Return the generation of a key or of the whole document
+ *
+ * \param self     Pointer to the IniConfigFile
+ * \param section  Section name
+ * \param key      Key name, NULL for the generation of the whole document
+ *
+ * Every put in loaded mode gets a new, increasing generation number. Read
+ * the generation before the value it guards.
+ *
+ * \return The generation of the last put, 0 if the key has not been put
+ *         since IniConfigFile_load()
+ *
+ * \see IniConfigFile_putIfUnchanged()
+ */
+unsigned long IniConfigFile_getGeneration( const IniConfigFile *self, const char *section, const char *key );
+
+/*!
+ * \brief Write a string only if the key has not changed
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     Section name
+ * \param key         Key name
+ * \param value       Value to write, NULL to remove the key
+ * \param generation  Key generation the caller has observed
+ *
+ * Requires a loaded document. The put takes place only if no other put to
+ * the key happened since IniConfigFile_getGeneration() returned generation.
+ *
+ * \return 1 if the value has been written, 0 if the key has changed
+ *
+ * \see IniConfigFile_putIfDocumentUnchanged()
+ */
+int IniConfigFile_putIfUnchanged( const IniConfigFile *self, const char *section, const char *key,
+                                  const char *value, unsigned long generation );
+
+/*!
+ * \brief Write a string only if the document has not changed
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     Section name
+ * \param key         Key name
+ * \param value       Value to write, NULL to remove the key
+ * \param generation  Document generation the caller has observed
+ *
+ * Like IniConfigFile_putIfUnchanged(), but fails after a put to any key.
+ *
+ * \return 1 if the value has been written, 0 if the document has changed
+ */
+int IniConfigFile_putIfDocumentUnchanged( const IniConfigFile *self, const char *section, const char *key,
+                                          const char *value, unsigned long generation );
+
+/*!
+ * \brief Capture all values of the loaded document
+ *
+ * \param self      Pointer to the IniConfigFile
+ * \param snapshot  Initialized IniConfigSnapshot, a previous capture is dropped
+ *
+ * Takes time proportional to the number of store shards only, the snapshot
+ * shares all values with the file.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_rollback()
+ */
+bool IniConfigFile_snapshot( const IniConfigFile *self, IniConfigSnapshot *snapshot );
+
+/*!
+ * \brief Put back the values of a snapshot
+ *
+ * \param self      Pointer to the IniConfigFile
+ * \param snapshot  Snapshot taken from this file
+ *
+ * Only the keys whose value differs from the snapshot are written, with
+ * new generations, so the cost depends on the number of changes and not on
+ * the size of the file. Keys added after the snapshot are removed.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigFile_rollback( IniConfigFile *self, const IniConfigSnapshot *snapshot );
+
+/*!
+ * \brief Copy all values into an index for real-time readers
+ *
+ * \param self   Pointer to the IniConfigFile
+ * \param index  Initialized IniConfigIndex, a previous build is dropped
+ * \param flags  Or-ed IniConfigIndexFlags
+ *
+ * Requires a loaded document. The index reflects the puts made so far;
+ * its getters never allocate, lock or enter the kernel (see
+ * \ref IniConfigIndex).
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigFile_buildIndex( IniConfigFile *self, IniConfigIndex *index, int flags );
+
+/*!
+ * \brief Choose how the indexes of frozen and double-buffered files are mapped
+ *
+ * \param self   Pointer to the IniConfigFile
+ * \param flags  Or-ed IniConfigIndexFlags
+ *
+ * Applies to the index of the next IniConfigFile_freeze() and to every
+ * version published afterwards, including those published by loads. Large
+ * files benefit from INICONFIGINDEX_HUGEPAGES, which cuts the TLB misses of
+ * random lookups; INICONFIGINDEX_LOCKED keeps the pages from being swapped
+ * out. IniConfigFile_setDoubleBuffering() sets the same flags.
+ *
+ * \code
+ *  IniConfigFile_setIndexFlags( myIniFile, INICONFIGINDEX_HUGEPAGES | INICONFIGINDEX_LOCKED );
+ *  IniConfigFile_load( myIniFile );
+ *  IniConfigFile_freeze( myIniFile );
+ * \endcode
+ *
+ * \return Nothing
+ *
+ * \see \ref IniConfigIndex
+ */
+void IniConfigFile_setIndexFlags( IniConfigFile *self, int flags );
+
+/*!
+ * \brief Make the loaded file read-only, with a read path that never writes memory
+ *
+ * \param self Pointer to the IniConfigFile
+ *
+ * All values are copied into an IniConfigIndex, mapped as chosen by
+ * IniConfigFile_setIndexFlags(), which answers the get
+ * functions from then on; IniConfigFile_getSection() and
+ * IniConfigFile_getKey() read the document without locking. No get writes
+ * to the index, the document, the store or the IniConfigFile itself, so
+ * processes forked after freezing keep sharing all their pages with the
+ * parent, except for the page counting the lookups under way (see
+ * \ref IniConfigReaders). Puts fail until the next IniConfigFile_load().
+ *
+ * \code
+ *  IniConfigFile_load( myIniFile );
+ *  IniConfigFile_freeze( myIniFile );
+ *
+ *  for( i = 0; i < numWorkers; i++ )
+ *  {
+ *    if( fork() == 0 )
+ *    {
+ *      runWorker( myIniFile );
+ *    }
+ *  }
+ * \endcode
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_refreeze()
+ */
+bool IniConfigFile_freeze( IniConfigFile *self );
+
+/*!
+ * \brief Reload a frozen file while other threads read it
+ *
+ * \param self Pointer to the IniConfigFile
+ *
+ * Loads the file into a new document and builds its index, on every NUMA
+ * node if IniConfigFile_setNumaReplicas() asks for it, without touching
+ * the version being read. A single atomic swap then installs the new
+ * version, so every get answers either entirely from the old one or
+ * entirely from the new one, on all nodes alike. The old version is freed
+ * once the gets which may still read it have returned; gets never wait.
+ *
+ * If the file cannot be loaded, the old version stays in place.
+ *
+ * Unlike IniConfigFile_load(), which thaws the file and must not run
+ * while other threads use it, the file stays frozen. Spans returned by
+ * IniConfigFile_getColumns() before belong to the old version and must
+ * not be used any more once it returns. It must not be called from an
+ * IniConfigFileValueVisitor of the same file.
+ *
+ * \code
+ *  IniConfigFile_load( myIniFile );
+ *  IniConfigFile_freeze( myIniFile );
+ *
+ *  // start the reader threads
+ *
+ *  while( running )
+ *  {
+ *    waitForChange();
+ *    IniConfigFile_refreeze( myIniFile );
+ *  }
+ * \endcode
+ *
+ * \return Returns true on success, false if the file cannot be loaded
+ *
+ * \see IniConfigFile_freeze()
+ */
+bool IniConfigFile_refreeze( IniConfigFile *self );
+
+/*!
+ * \brief Load the file as a frozen copy shared within the process
+ *
+ * \param self  Pointer to the IniConfigFile
+ *
+ * Like IniConfigFile_load() followed by IniConfigFile_freeze(), except
+ * that all files of the process sharing the same file on disk, with the
+ * same text, index and NUMA settings, use one copy of it, see
+ * \ref IniConfigRegistry. A private document loaded before is dropped.
+ *
+ * Calling it again switches to the latest version: if the file changed on
+ * disk, the first caller loads it for everybody and the listeners of all
+ * sharing files are called. IniConfigFile_load() turns the file back into
+ * a private one.
+ *
+ * Puts are ignored like on any frozen file, saving, snapshots and double
+ * buffering are not available.
+ *
+ * \return Returns true on success, false if the file does not exist or
+ *         cannot be loaded
+ *
+ * \see IniConfigFile_setListener()
+ */
+bool IniConfigFile_loadShared( IniConfigFile *self );
+
+/*!
+ * \brief Get notified of new versions of a shared file
+ *
+ * \param self      Pointer to the IniConfigFile
+ * \param listener  Called after a new version of the file has been loaded,
+ *                  NULL for no notifications
+ * \param context   Passed to listener
+ *
+ * Applies from the next IniConfigFile_loadShared() on, or right away if
+ * the file is shared already. The listener typically arranges for
+ * IniConfigFile_loadShared() to be called, which then only takes a
+ * reference to the new version.
+ *
+ * Once the listener has been removed, by setting it to NULL or by
+ * IniConfigFile_clear(), it is not running and is not called anymore, so
+ * its context may be freed. This does not hold if it was removed from
+ * within a listener while another thread notified this file.
+ *
+ * \return Returns false if memory ran out
+ */
+bool IniConfigFile_setListener( IniConfigFile *self, IniConfigRegistryListener listener, void *context );
+
+/*!
+ * \brief Keep a copy of a frozen file in the memory of every NUMA node
+ *
+ * \param self    Pointer to the IniConfigFile
+ * \param enable  true for one copy per node, false for a single copy
+ *
+ * Takes effect at the next IniConfigFile_freeze(). The get functions of
+ * a frozen file then read the copy of the node the calling thread runs
+ * on. Machines with a single node keep a single copy.
+ *
+ * IniConfigFile_refreeze() reloads a replicated file while other threads
+ * read it: it builds the copies of all nodes before installing them
+ * together, so no thread ever reads old values on one node and new ones
+ * on another.
+ *
+ * \code
+ *  IniConfigFile_setNumaReplicas( myIniFile, true );
+ *  IniConfigFile_load( myIniFile );
+ *  IniConfigFile_freeze( myIniFile );
+ *
+ *  // start the worker threads on all nodes
+ * \endcode
+ *
+ * \return Nothing
+ *
+ * \see \ref IniConfigReplicas
+ */
+void IniConfigFile_setNumaReplicas( IniConfigFile *self, bool enable );
+
+/*!
+ * \brief Keep the numbers of every section in contiguous columns
+ *
+ * \param self    Pointer to the IniConfigFile
+ * \param enable  true to build the columns at every load
+ *
+ * Takes effect at the next IniConfigFile_load(), which then infers the
+ * type of every value and copies the numeric ones into typed columns
+ * for IniConfigFile_getColumns(). Disabling frees the columns.
+ *
+ * \return Nothing
+ *
+ * \see \ref IniConfigColumns
+ */
+void IniConfigFile_setColumnar( IniConfigFile *self, bool enable );
+
+/*!
+ * \brief Get all numeric values of a section without copying them
+ *
+ * \param self     Pointer to the IniConfigFile
+ * \param section  Section name, NULL for the global area
+ * \param span     Receives the key names and values in key order
+ *
+ * Requires IniConfigFile_setColumnar() before IniConfigFile_load(). The
+ * values are those of the load and do not follow later puts. The span
+ * points into memory of the file and stays valid until the next
+ * IniConfigFile_load(), IniConfigFile_setColumnar() or IniConfigFile_clear().
+ *
+ * \code
+ *  IniConfigColumnsSpan span;
+ *
+ *  IniConfigFile_setColumnar( myIniFile, true );
+ *  IniConfigFile_load( myIniFile );
+ *
+ *  if( IniConfigFile_getColumns( myIniFile, "Calibration", &span ) )
+ *  {
+ *    applyOffsets( span.doubles, span.count );
+ *  }
+ * \endcode
+ *
+ * \return Returns true if the section has numeric keys
+ */
+bool IniConfigFile_getColumns( const IniConfigFile *self, const char *section, IniConfigColumnsSpan *span );
+
+/*!
+ * \brief Let one consumer thread read a version that changes only at its safe points
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param enable      true to switch double buffering on, false to switch it off
+ * \param indexFlags  Or-ed IniConfigIndexFlags of the published versions
+ *
+ * While enabled, the get functions answer from the version the consumer
+ * installed with its last IniConfigFile_sync(). Puts and
+ * IniConfigFile_load() change the pending state, which
+ * IniConfigFile_publish() turns into the next version; loads publish
+ * automatically. Must not run concurrently with other calls. If the file
+ * is loaded, its current state becomes the first version.
+ *
+ * \code
+ *  IniConfigFile_setDoubleBuffering( myIniFile, true, INICONFIGINDEX_LOCKED );
+ *  IniConfigFile_load( myIniFile );
+ *
+ *  // control loop
+ *  for( ;; )
+ *  {
+ *    IniConfigFile_sync( myIniFile );
+ *    kp = IniConfigFile_getDouble( myIniFile, "Pid", "kp", 1.0 );
+ *    ki = IniConfigFile_getDouble( myIniFile, "Pid", "ki", 0.0 );
+ *    ...
+ *  }
+ * \endcode
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see \ref IniConfigExchange
+ */
+bool IniConfigFile_setDoubleBuffering( IniConfigFile *self, bool enable, int indexFlags );
+
+/*!
+ * \brief Turn the puts made so far into the version the next sync installs
+ *
+ * \param self Pointer to the IniConfigFile
+ *
+ * Called by the writing side. Replaces a published version the consumer
+ * has not synced to yet.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigFile_publish( IniConfigFile *self );
+
+/*!
+ * \brief Switch the consumer thread to the latest published version
+ *
+ * \param self Pointer to the IniConfigFile
+ *
+ * Wait-free: takes no locks, does not allocate and makes no system calls.
+ * All gets between two syncs see the same version. Only the consumer
+ * thread may call it and the get functions.
+ *
+ * \return true if a newer version has been installed, false otherwise
+ */
+bool IniConfigFile_sync( IniConfigFile *self );
+
 
 /*!
  * \brief Get a int
@@ -268,6 +1010,144 @@ long IniConfigFile_getLong( const IniConfigFile *self, const char *section, cons
  */
 double IniConfigFile_getDouble( const IniConfigFile *self, const char *section, const char *key, double defValue );
 
+/*!
+ * \brief Decode a binary value
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     the section name
+ * \param key         the key name
+ * \param encoding    INICONFIGBLOB_BASE64 or INICONFIGBLOB_HEX
+ * \param buffer      Receives the bytes, may be NULL if bufferSize is 0
+ * \param bufferSize  Size of buffer
+ *
+ * Requires IniConfigFile_load() or double buffering. The value is decoded
+ * where the file keeps it, so it is not limited to
+ * INICONFIGFILE_BUFFERSIZE characters. If buffer is too small nothing is
+ * written and only the length of the value is checked, the return value
+ * then tells the size needed (see \ref IniConfigBlob).
+ *
+ * \code
+ *  unsigned char key[32];
+ *
+ *  if( IniConfigFile_getBlob( myIniFile, "Crypto", "Key", INICONFIGBLOB_HEX, key, sizeof( key ) ) != sizeof( key ) )
+ *  {
+ *    ANY_LOG( 0, "No valid key configured", ANY_LOG_ERROR );
+ *  }
+ * \endcode
+ *
+ * \return The size of the decoded value, -1 if the key does not exist or
+ *         its value is not valid in the encoding
+ *
+ * \see IniConfigFile_putBlob()
+ */
+long IniConfigFile_getBlob( const IniConfigFile *self, const char *section, const char *key, int encoding,
+                           void *buffer, size_t bufferSize );
+
+/*!
+ * \brief Encode and write a binary value
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     the section name
+ * \param key         the key name
+ * \param encoding    INICONFIGBLOB_BASE64 or INICONFIGBLOB_HEX
+ * \param data        Bytes to write
+ * \param size        Number of bytes
+ *
+ * \return 1 if successful, otherwise 0
+ *
+ * \see IniConfigFile_getBlob()
+ */
+int IniConfigFile_putBlob( const IniConfigFile *self, const char *section, const char *key, int encoding,
+                           const void *data, size_t size );
+
+/*!
+ * \brief Get a duration
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     the section name
+ * \param key         the key name
+ * \param defValue    the default value in nanoseconds
+ *
+ * Reads values like "250ms" or "1.5 min" (see \ref IniConfigUnits). A
+ * number without suffix counts in seconds.
+ *
+ * \code
+ *  timeout = IniConfigFile_getDuration( myIniFile, "Network", "Timeout", 500000000LL );
+ * \endcode
+ *
+ * \return The duration in nanoseconds, or defValue if the key is missing
+ *         or holds no duration
+ */
+long long IniConfigFile_getDuration( const IniConfigFile *self, const char *section, const char *key,
+                                     long long defValue );
+
+/*!
+ * \brief Get a size in bytes
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     the section name
+ * \param key         the key name
+ * \param defValue    the default value in bytes
+ *
+ * Reads values like "64 KiB" or "2GB" (see \ref IniConfigUnits). A number
+ * without suffix counts in bytes.
+ *
+ * \return The size in bytes, or defValue if the key is missing or holds
+ *         no size
+ */
+long long IniConfigFile_getByteSize( const IniConfigFile *self, const char *section, const char *key,
+                                     long long defValue );
+
+/*!
+ * \brief Get a frequency
+ *
+ * \param self        Pointer to the IniConfigFile
+ * \param section     the section name
+ * \param key         the key name
+ * \param defValue    the default value in hertz
+ *
+ * Reads values like "100Hz" or "2.4 GHz" (see \ref IniConfigUnits). A
+ * number without suffix counts in hertz.
+ *
+ * \return The frequency in hertz, or defValue if the key is missing or
+ *         holds no frequency
+ */
+double IniConfigFile_getFrequency( const IniConfigFile *self, const char *section, const char *key,
+                                   double defValue );
+
+/*!
+ * \brief Get the values of many keys at once
+ *
+ * \param self      Pointer to the IniConfigFile
+ * \param count     Number of keys
+ * \param sections  Section names, NULL entries for the global area
+ * \param keys      Key names
+ * \param visitor   Called once per key, in order
+ * \param context   Passed to the visitor
+ *
+ * Requires IniConfigFile_load() or double buffering. Gives the same values
+ * as one IniConfigFile_getString() per key, but hashes a group of keys
+ * first and prefetches the memory of all their lookups before resolving
+ * any, so the cache misses of the group overlap instead of adding up.
+ * Worth it from a few dozen keys on.
+ *
+ * The visitor may run while locks of the file are held; it must copy the
+ * value it needs and must not call other functions of the file.
+ *
+ * \code
+ *  static void store( void *context, unsigned int i, const char *value )
+ *  {
+ *    ((double *)context)[i] = ( value != NULL ) ? atof( value ) : 0.0;
+ *  }
+ *
+ *  IniConfigFile_getBatch( myIniFile, numJoints, sections, keys, store, gains );
+ * \endcode
+ *
+ * \return The number of keys found
+ */
+unsigned int IniConfigFile_getBatch( const IniConfigFile *self, unsigned int count, const char *const *sections,
+                                     const char *const *keys, IniConfigFileValueVisitor visitor, void *context );
+
 /*!
  * \brief Get a string
  *
@@ -544,6 +1424,39 @@ int IniConfigFile_getSection( const IniConfigFile *self, int idx, char *buffer,
  */
 int IniConfigFile_getKey( const IniConfigFile *self, const char *section, int idx, char *buffer, int bufferSize );
 
+/*!
+ * \brief Return the number of sections
+ *
+ * \param self  Pointer to the IniConfigFile
+ *
+ * Counts the sections IniConfigFile_getSection() returns. Loaded files
+ * keep the sections and keys in arrays, so that this and the functions
+ * above take constant time; the arrays are rebuilt by the next call after a
+ * put added or removed a key or a section. Threads calling them share a
+ * read lock, only the first call after a put locks out the others while
+ * it applies the pending puts. Without IniConfigFile_load() every section
+ * costs a pass over the file.
+ *
+ * \return The number of sections
+ *
+ * \see IniConfigFile_countKeys()
+ */
+int IniConfigFile_countSections( const IniConfigFile *self );
+
+/*!
+ * \brief Return the number of keys in a section
+ *
+ * \param self     Pointer to the IniConfigFile
+ * \param section  the name of the section, or NULL for the keys outside any section
+ *
+ * Counts the keys IniConfigFile_getKey() returns for the section.
+ *
+ * \return The number of keys, 0 if the section does not exist
+ *
+ * \see IniConfigFile_countSections()
+ */
+int IniConfigFile_countKeys( const IniConfigFile *self, const char *section );
+
 /*!
  * \brief Clear a IniConfigFile instance
  *
@@ -0,0 +1,849 @@
+/*
+ *  Persistent hash array mapped trie of INI keys
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <IniConfigHamt.h>
+
+#define INICONFIGHAMT_BITS      5
+#define INICONFIGHAMT_MASK      ( ( 1u << INICONFIGHAMT_BITS ) - 1 )
+
+/* 7 levels of 5 bits consume all 32 hash bits */
+#define INICONFIGHAMT_MAXDEPTH  7
+
+
+/*
+ * Private functions
+ */
+
+static char IniConfigHamt_toLower( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? (char)( c + 'a' - 'A' ) : c;
+}
+
+
+static int IniConfigHamt_equalsNoCase( const char *a, const char *b )
+{
+    while( *a != '\0' && IniConfigHamt_toLower( *a ) == IniConfigHamt_toLower( *b ) )
+    {
+        a++;
+        b++;
+    }
+
+    return ( IniConfigHamt_toLower( *a ) == IniConfigHamt_toLower( *b ) );
+}
+
+
+static int IniConfigHamt_matches( const IniConfigHamtNode *leaf, unsigned int hash, const char *section,
+                                  const char *key )
+{
+    return ( leaf->hash == hash &&
+             IniConfigHamt_equalsNoCase( leaf->key, key ) &&
+             IniConfigHamt_equalsNoCase( leaf->section, section ) );
+}
+
+
+static unsigned int IniConfigHamt_slot( unsigned int hash, unsigned int depth )
+{
+    return ( hash >> ( depth * INICONFIGHAMT_BITS ) ) & INICONFIGHAMT_MASK;
+}
+
+
+static unsigned int IniConfigHamt_popcount( unsigned int bits )
+{
+    return (unsigned int)__builtin_popcount( bits );
+}
+
+
+static IniConfigHamtNode *IniConfigHamt_newNode( IniConfigHamtType type, unsigned int count )
+{
+    IniConfigHamtNode *node = NULL;
+    size_t size = sizeof( IniConfigHamtNode );
+
+    if( count > 1 )
+    {
+        size += ( count - 1 ) * sizeof( IniConfigHamtNode * );
+    }
+
+    node = (IniConfigHamtNode *)ANY_BALLOC( size );
+
+    if( node != NULL )
+    {
+        node->refs = 1;
+        node->type = type;
+        node->count = count;
+    }
+
+    return node;
+}
+
+
+/*
+ * Builds the smallest subtree holding two leaves with different keys
+ */
+static IniConfigHamtNode *IniConfigHamt_pair( IniConfigHamtNode *a, IniConfigHamtNode *b, unsigned int depth )
+{
+    IniConfigHamtNode *node = NULL;
+    unsigned int slotA = 0;
+    unsigned int slotB = 0;
+
+    if( depth >= INICONFIGHAMT_MAXDEPTH )
+    {
+        node = IniConfigHamt_newNode( INICONFIGHAMT_COLLISION, 2 );
+
+        if( node != NULL )
+        {
+            node->hash = a->hash;
+            node->children[0] = IniConfigHamt_retain( a );
+            node->children[1] = IniConfigHamt_retain( b );
+        }
+
+        return node;
+    }
+
+    slotA = IniConfigHamt_slot( a->hash, depth );
+    slotB = IniConfigHamt_slot( b->hash, depth );
+
+    if( slotA == slotB )
+    {
+        IniConfigHamtNode *child = IniConfigHamt_pair( a, b, depth + 1 );
+
+        if( child == NULL )
+        {
+            return NULL;
+        }
+
+        node = IniConfigHamt_newNode( INICONFIGHAMT_BRANCH, 1 );
+
+        if( node == NULL )
+        {
+            IniConfigHamt_release( child );
+            return NULL;
+        }
+
+        node->bitmap = 1u << slotA;
+        node->children[0] = child;
+
+        return node;
+    }
+
+    node = IniConfigHamt_newNode( INICONFIGHAMT_BRANCH, 2 );
+
+    if( node != NULL )
+    {
+        node->bitmap = ( 1u << slotA ) | ( 1u << slotB );
+        node->children[slotA < slotB ? 0 : 1] = IniConfigHamt_retain( a );
+        node->children[slotA < slotB ? 1 : 0] = IniConfigHamt_retain( b );
+    }
+
+    return node;
+}
+
+
+/*
+ * Copies a branch or collision node, replacing, inserting or dropping the
+ * child at pos; all other children gain a reference
+ */
+static IniConfigHamtNode *IniConfigHamt_copy( const IniConfigHamtNode *node, unsigned int pos,
+                                              IniConfigHamtNode *child, int delta )
+{
+    IniConfigHamtNode *copy = IniConfigHamt_newNode( (IniConfigHamtType)node->type, node->count + delta );
+    unsigned int from = 0;
+    unsigned int to = 0;
+
+    if( copy == NULL )
+    {
+        return NULL;
+    }
+
+    copy->hash = node->hash;
+    copy->bitmap = node->bitmap;
+
+    for( from = 0; from < node->count; from++ )
+    {
+        if( from == pos && delta >= 0 )
+        {
+            if( delta > 0 )
+            {
+                copy->children[to++] = child;
+                copy->children[to++] = IniConfigHamt_retain( node->children[from] );
+            }
+            else
+            {
+                copy->children[to++] = child;
+            }
+        }
+        else if( from != pos )
+        {
+            copy->children[to++] = IniConfigHamt_retain( node->children[from] );
+        }
+    }
+
+    /* appending after the last child */
+    if( delta > 0 && pos == node->count )
+    {
+        copy->children[to++] = child;
+    }
+
+    return copy;
+}
+
+
+static IniConfigHamtNode *IniConfigHamt_insertAt( IniConfigHamtNode *node, IniConfigHamtNode *leaf,
+                                                  unsigned int depth )
+{
+    IniConfigHamtNode *child = NULL;
+    IniConfigHamtNode *copy = NULL;
+    unsigned int bit = 0;
+    unsigned int pos = 0;
+
+    if( node == NULL )
+    {
+        return IniConfigHamt_retain( leaf );
+    }
+
+    switch( node->type )
+    {
+        case INICONFIGHAMT_LEAF:
+
+            if( IniConfigHamt_matches( node, leaf->hash, leaf->section, leaf->key ) )
+            {
+                return IniConfigHamt_retain( leaf );
+            }
+
+            return IniConfigHamt_pair( node, leaf, depth );
+
+        case INICONFIGHAMT_COLLISION:
+
+            for( pos = 0; pos < node->count; pos++ )
+            {
+                if( IniConfigHamt_matches( node->children[pos], leaf->hash, leaf->section, leaf->key ) )
+                {
+                    return IniConfigHamt_copy( node, pos, IniConfigHamt_retain( leaf ), 0 );
+                }
+            }
+
+            return IniConfigHamt_copy( node, node->count, IniConfigHamt_retain( leaf ), 1 );
+
+        default:
+            break;
+    }
+
+    bit = 1u << IniConfigHamt_slot( leaf->hash, depth );
+    pos = IniConfigHamt_popcount( node->bitmap & ( bit - 1 ) );
+
+    if( node->bitmap & bit )
+    {
+        child = IniConfigHamt_insertAt( node->children[pos], leaf, depth + 1 );
+
+        if( child == NULL )
+        {
+            return NULL;
+        }
+
+        copy = IniConfigHamt_copy( node, pos, child, 0 );
+    }
+    else
+    {
+        child = IniConfigHamt_retain( leaf );
+        copy = IniConfigHamt_copy( node, pos, child, 1 );
+
+        if( copy != NULL )
+        {
+            copy->bitmap |= bit;
+        }
+    }
+
+    if( copy == NULL )
+    {
+        IniConfigHamt_release( child );
+    }
+
+    return copy;
+}
+
+
+/*
+ * Like IniConfigHamt_insertAt(), but changes branches with a single
+ * reference in place; consumes the reference of node on success
+ */
+static IniConfigHamtNode *IniConfigHamt_insertOwnedAt( IniConfigHamtNode *node, IniConfigHamtNode *leaf,
+                                                       unsigned int depth )
+{
+    IniConfigHamtNode *result = NULL;
+    IniConfigHamtNode *child = NULL;
+    unsigned int bit = 0;
+    unsigned int pos = 0;
+
+    if( node == NULL || node->type != INICONFIGHAMT_BRANCH ||
+        __atomic_load_n( &node->refs, __ATOMIC_ACQUIRE ) != 1 )
+    {
+        result = IniConfigHamt_insertAt( node, leaf, depth );
+
+        if( result != NULL )
+        {
+            IniConfigHamt_release( node );
+        }
+
+        return result;
+    }
+
+    bit = 1u << IniConfigHamt_slot( leaf->hash, depth );
+    pos = IniConfigHamt_popcount( node->bitmap & ( bit - 1 ) );
+
+    if( node->bitmap & bit )
+    {
+        child = IniConfigHamt_insertOwnedAt( node->children[pos], leaf, depth + 1 );
+
+        if( child == NULL )
+        {
+            return NULL;
+        }
+
+        node->children[pos] = child;
+
+        return node;
+    }
+
+    /* the children move to a larger node, their references with them */
+    result = IniConfigHamt_newNode( INICONFIGHAMT_BRANCH, node->count + 1 );
+
+    if( result == NULL )
+    {
+        return NULL;
+    }
+
+    result->hash = node->hash;
+    result->bitmap = node->bitmap | bit;
+    memcpy( result->children, node->children, pos * sizeof( IniConfigHamtNode * ) );
+    memcpy( result->children + pos + 1, node->children + pos, ( node->count - pos ) * sizeof( IniConfigHamtNode * ) );
+    result->children[pos] = IniConfigHamt_retain( leaf );
+
+    ANY_FREE( node );
+
+    return result;
+}
+
+
+static IniConfigHamtNode *IniConfigHamt_removeAt( IniConfigHamtNode *node, unsigned int hash, const char *section,
+                                                  const char *key, unsigned int depth, int *failed )
+{
+    IniConfigHamtNode *child = NULL;
+    IniConfigHamtNode *copy = NULL;
+    unsigned int bit = 0;
+    unsigned int pos = 0;
+
+    switch( node->type )
+    {
+        case INICONFIGHAMT_LEAF:
+
+            return IniConfigHamt_matches( node, hash, section, key ) ? NULL : IniConfigHamt_retain( node );
+
+        case INICONFIGHAMT_COLLISION:
+
+            for( pos = 0; pos < node->count; pos++ )
+            {
+                if( IniConfigHamt_matches( node->children[pos], hash, section, key ) )
+                {
+                    if( node->count == 2 )
+                    {
+                        return IniConfigHamt_retain( node->children[1 - pos] );
+                    }
+
+                    copy = IniConfigHamt_copy( node, pos, NULL, -1 );
+                    *failed = ( copy == NULL );
+
+                    return copy;
+                }
+            }
+
+            return IniConfigHamt_retain( node );
+
+        default:
+            break;
+    }
+
+    bit = 1u << IniConfigHamt_slot( hash, depth );
+
+    if( !( node->bitmap & bit ) )
+    {
+        return IniConfigHamt_retain( node );
+    }
+
+    pos = IniConfigHamt_popcount( node->bitmap & ( bit - 1 ) );
+    child = IniConfigHamt_removeAt( node->children[pos], hash, section, key, depth + 1, failed );
+
+    if( *failed )
+    {
+        return NULL;
+    }
+
+    if( child == node->children[pos] )
+    {
+        /* key not found below, keep sharing this node */
+        IniConfigHamt_release( child );
+        return IniConfigHamt_retain( node );
+    }
+
+    if( child != NULL )
+    {
+        copy = IniConfigHamt_copy( node, pos, child, 0 );
+    }
+    else if( node->count == 1 )
+    {
+        return NULL;
+    }
+    else
+    {
+        copy = IniConfigHamt_copy( node, pos, NULL, -1 );
+
+        if( copy != NULL )
+        {
+            copy->bitmap &= ~bit;
+        }
+    }
+
+    if( copy == NULL )
+    {
+        IniConfigHamt_release( child );
+        *failed = 1;
+    }
+
+    return copy;
+}
+
+
+static IniConfigHamtNode *IniConfigHamt_findAt( const IniConfigHamtNode *node, unsigned int hash,
+                                                const char *section, const char *key, unsigned int depth )
+{
+    unsigned int i = 0;
+
+    while( node != NULL )
+    {
+        unsigned int bit = 0;
+
+        switch( node->type )
+        {
+            case INICONFIGHAMT_LEAF:
+
+                return IniConfigHamt_matches( node, hash, section, key ) ? (IniConfigHamtNode *)node : NULL;
+
+            case INICONFIGHAMT_COLLISION:
+
+                for( i = 0; i < node->count; i++ )
+                {
+                    if( IniConfigHamt_matches( node->children[i], hash, section, key ) )
+                    {
+                        return node->children[i];
+                    }
+                }
+
+                return NULL;
+
+            default:
+                break;
+        }
+
+        bit = 1u << IniConfigHamt_slot( hash, depth );
+
+        if( !( node->bitmap & bit ) )
+        {
+            return NULL;
+        }
+
+        node = node->children[IniConfigHamt_popcount( node->bitmap & ( bit - 1 ) )];
+        depth++;
+    }
+
+    return NULL;
+}
+
+
+typedef struct IniConfigHamtDiff
+{
+    IniConfigHamtNode *other;
+    unsigned int depth;
+    int reverse;
+    IniConfigHamtDiffVisitor visitor;
+    void *context;
+}
+IniConfigHamtDiff;
+
+
+/*
+ * Reports a leaf of one side which differs from the other side
+ */
+static void IniConfigHamt_diffLeaf( void *context, IniConfigHamtNode *leaf )
+{
+    IniConfigHamtDiff *diff = (IniConfigHamtDiff *)context;
+    IniConfigHamtNode *other = IniConfigHamt_findAt( diff->other, leaf->hash, leaf->section, leaf->key,
+                                                     diff->depth );
+
+    if( diff->reverse )
+    {
+        /* keys of both sides have already been reported by the forward pass */
+        if( other == NULL )
+        {
+            diff->visitor( diff->context, NULL, leaf );
+        }
+    }
+    else if( other != leaf )
+    {
+        diff->visitor( diff->context, leaf, other );
+    }
+}
+
+
+static void IniConfigHamt_diffAt( IniConfigHamtNode *before, IniConfigHamtNode *after, unsigned int depth,
+                                  IniConfigHamtDiffVisitor visitor, void *context )
+{
+    IniConfigHamtDiff diff;
+    unsigned int slot = 0;
+
+    if( before == after )
+    {
+        return;
+    }
+
+    if( before != NULL && after != NULL &&
+        before->type == INICONFIGHAMT_BRANCH && after->type == INICONFIGHAMT_BRANCH )
+    {
+        for( slot = 0; slot <= INICONFIGHAMT_MASK; slot++ )
+        {
+            unsigned int bit = 1u << slot;
+            IniConfigHamtNode *childBefore = NULL;
+            IniConfigHamtNode *childAfter = NULL;
+
+            if( before->bitmap & bit )
+            {
+                childBefore = before->children[IniConfigHamt_popcount( before->bitmap & ( bit - 1 ) )];
+            }
+
+            if( after->bitmap & bit )
+            {
+                childAfter = after->children[IniConfigHamt_popcount( after->bitmap & ( bit - 1 ) )];
+            }
+
+            IniConfigHamt_diffAt( childBefore, childAfter, depth + 1, visitor, context );
+        }
+
+        return;
+    }
+
+    /* differently shaped subtrees are compared key by key */
+    diff.visitor = visitor;
+    diff.context = context;
+    diff.depth = depth;
+
+    diff.other = after;
+    diff.reverse = 0;
+    IniConfigHamt_forEach( before, IniConfigHamt_diffLeaf, &diff );
+
+    diff.other = before;
+    diff.reverse = 1;
+    IniConfigHamt_forEach( after, IniConfigHamt_diffLeaf, &diff );
+}
+
+
+/*
+ * Public functions
+ */
+
+unsigned int IniConfigHamt_hash( const char *section, const char *key )
+{
+    return IniConfigHamt_hashKey( IniConfigHamt_hashSection( section ), key );
+}
+
+
+unsigned int IniConfigHamt_hashSection( const char *section )
+{
+    unsigned int hash = 2166136261u;
+
+    ANY_REQUIRE( section );
+
+    /* FNV-1a over the lower-cased names */
+    while( *section != '\0' )
+    {
+        hash = ( hash ^ (unsigned char)IniConfigHamt_toLower( *section++ ) ) * 16777619u;
+    }
+
+    return ( hash ^ 0xff ) * 16777619u;
+}
+
+
+unsigned int IniConfigHamt_hashKey( unsigned int sectionHash, const char *key )
+{
+    unsigned int hash = sectionHash;
+
+    ANY_REQUIRE( key );
+
+    while( *key != '\0' )
+    {
+        hash = ( hash ^ (unsigned char)IniConfigHamt_toLower( *key++ ) ) * 16777619u;
+    }
+
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+
+    return hash;
+}
+
+
+IniConfigHamtNode *IniConfigHamt_newLeaf( unsigned int hash, const char *section, const char *key,
+                                          const char *value, unsigned long generation )
+{
+    size_t sectionLength = 0;
+    size_t keyLength = 0;
+    size_t valueLength = 0;
+    IniConfigHamtNode *leaf = NULL;
+    char *text = NULL;
+
+    ANY_REQUIRE( section );
+    ANY_REQUIRE( key );
+
+    sectionLength = strlen( section ) + 1;
+    keyLength = strlen( key ) + 1;
+    valueLength = ( value != NULL ) ? strlen( value ) + 1 : 0;
+
+    /* the names and the value live right behind the node */
+    leaf = (IniConfigHamtNode *)ANY_BALLOC( sizeof( IniConfigHamtNode ) + sectionLength + keyLength + valueLength );
+
+    if( leaf == NULL )
+    {
+        return NULL;
+    }
+
+    text = (char *)( leaf + 1 );
+
+    leaf->refs = 1;
+    leaf->type = INICONFIGHAMT_LEAF;
+    leaf->hash = hash;
+    leaf->mark = 0;
+    leaf->generation = generation;
+    leaf->unit = 0;
+    leaf->quantity = 0.0;
+
+    memcpy( text, section, sectionLength );
+    leaf->section = text;
+    text += sectionLength;
+
+    memcpy( text, key, keyLength );
+    leaf->key = text;
+    text += keyLength;
+
+    if( value != NULL )
+    {
+        memcpy( text, value, valueLength );
+        leaf->value = text;
+    }
+
+    return leaf;
+}
+
+
+IniConfigHamtNode *IniConfigHamt_retain( IniConfigHamtNode *node )
+{
+    if( node != NULL )
+    {
+        __atomic_add_fetch( &node->refs, 1, __ATOMIC_RELAXED );
+    }
+
+    return node;
+}
+
+
+void IniConfigHamt_release( IniConfigHamtNode *node )
+{
+    unsigned int i = 0;
+
+    if( node == NULL || __atomic_sub_fetch( &node->refs, 1, __ATOMIC_ACQ_REL ) != 0 )
+    {
+        return;
+    }
+
+    if( node->type != INICONFIGHAMT_LEAF )
+    {
+        for( i = 0; i < node->count; i++ )
+        {
+            IniConfigHamt_release( node->children[i] );
+        }
+    }
+
+    ANY_FREE( node );
+}
+
+
+IniConfigHamtNode *IniConfigHamt_find( const IniConfigHamtNode *root, unsigned int hash,
+                                       const char *section, const char *key )
+{
+    ANY_REQUIRE( section );
+    ANY_REQUIRE( key );
+
+    return IniConfigHamt_findAt( root, hash, section, key, 0 );
+}
+
+
+void IniConfigHamt_findBatch( IniConfigHamtNode *const *roots, const unsigned int *hashes,
+                              const char *const *sections, const char *const *keys, unsigned int count,
+                              IniConfigHamtNode **leaves )
+{
+    unsigned int first = 0;
+
+    ANY_REQUIRE( roots );
+    ANY_REQUIRE( hashes );
+    ANY_REQUIRE( sections );
+    ANY_REQUIRE( keys );
+    ANY_REQUIRE( leaves );
+
+    for( first = 0; first < count; first += INICONFIGHAMT_BATCH )
+    {
+        unsigned int n = ( count - first < INICONFIGHAMT_BATCH ) ? count - first : INICONFIGHAMT_BATCH;
+        unsigned int pending = 0;
+        unsigned int reached = 0;
+        unsigned int depth = 0;
+        unsigned int i = 0;
+
+        for( i = 0; i < n; i++ )
+        {
+            leaves[first + i] = roots[first + i];
+
+            if( roots[first + i] != NULL )
+            {
+                __builtin_prefetch( roots[first + i] );
+                pending |= 1u << i;
+            }
+        }
+
+        /* one level per round, the nodes of the next one are in flight meanwhile */
+        for( depth = 0; pending != 0; depth++ )
+        {
+            for( i = 0; i < n; i++ )
+            {
+                IniConfigHamtNode *node = leaves[first + i];
+                unsigned int bit = 0;
+
+                if( !( pending & ( 1u << i ) ) )
+                {
+                    continue;
+                }
+
+                /* the key of a leaf is compared one round later, once it is cached */
+                if( node->type == INICONFIGHAMT_LEAF && !( reached & ( 1u << i ) ) )
+                {
+                    __builtin_prefetch( node->key );
+                    reached |= 1u << i;
+                    continue;
+                }
+
+                if( node->type != INICONFIGHAMT_BRANCH )
+                {
+                    leaves[first + i] = IniConfigHamt_findAt( node, hashes[first + i], sections[first + i],
+                                                              keys[first + i], depth );
+                    pending &= ~( 1u << i );
+                    continue;
+                }
+
+                bit = 1u << IniConfigHamt_slot( hashes[first + i], depth );
+
+                if( !( node->bitmap & bit ) )
+                {
+                    leaves[first + i] = NULL;
+                    pending &= ~( 1u << i );
+                    continue;
+                }
+
+                node = node->children[IniConfigHamt_popcount( node->bitmap & ( bit - 1 ) )];
+                __builtin_prefetch( node );
+                leaves[first + i] = node;
+            }
+        }
+    }
+}
+
+
+IniConfigHamtNode *IniConfigHamt_insert( IniConfigHamtNode *root, IniConfigHamtNode *leaf )
+{
+    ANY_REQUIRE( leaf );
+    ANY_REQUIRE( leaf->type == INICONFIGHAMT_LEAF );
+
+    return IniConfigHamt_insertAt( root, leaf, 0 );
+}
+
+
+IniConfigHamtNode *IniConfigHamt_insertOwned( IniConfigHamtNode *root, IniConfigHamtNode *leaf )
+{
+    ANY_REQUIRE( leaf );
+    ANY_REQUIRE( leaf->type == INICONFIGHAMT_LEAF );
+
+    return IniConfigHamt_insertOwnedAt( root, leaf, 0 );
+}
+
+
+IniConfigHamtNode *IniConfigHamt_remove( IniConfigHamtNode *root, unsigned int hash,
+                                         const char *section, const char *key )
+{
+    IniConfigHamtNode *result = NULL;
+    int failed = 0;
+
+    ANY_REQUIRE( section );
+    ANY_REQUIRE( key );
+
+    if( root == NULL )
+    {
+        return NULL;
+    }
+
+    result = IniConfigHamt_removeAt( root, hash, section, key, 0, &failed );
+
+    /* without memory for the copy the key simply stays */
+    return failed ? IniConfigHamt_retain( root ) : result;
+}
+
+
+void IniConfigHamt_forEach( IniConfigHamtNode *root, IniConfigHamtVisitor visitor, void *context )
+{
+    unsigned int i = 0;
+
+    ANY_REQUIRE( visitor );
+
+    if( root == NULL )
+    {
+        return;
+    }
+
+    if( root->type == INICONFIGHAMT_LEAF )
+    {
+        visitor( context, root );
+        return;
+    }
+
+    for( i = 0; i < root->count; i++ )
+    {
+        IniConfigHamt_forEach( root->children[i], visitor, context );
+    }
+}
+
+
+void IniConfigHamt_diff( IniConfigHamtNode *before, IniConfigHamtNode *after,
+                         IniConfigHamtDiffVisitor visitor, void *context )
+{
+    ANY_REQUIRE( visitor );
+
+    IniConfigHamt_diffAt( before, after, 0, visitor, context );
+}
@@ -0,0 +1,259 @@
+/*
+ *  Persistent hash array mapped trie of INI keys
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigHamt Persistent key map
+ *
+ * An IniConfigHamt maps a (section, key) pair to a value. It is a hash
+ * array mapped trie whose nodes are never modified once built: an insert
+ * or remove copies the nodes on the path from the root to the key and
+ * shares everything else with the previous version. Keeping an old
+ * version therefore costs one reference, and two versions can be compared
+ * in time proportional to their differences.
+ *
+ * Nodes are reference counted with atomic operations, so versions may be
+ * shared and released by different threads.
+ *
+ * Names are compared case-insensitively, like minIni does.
+ */
+
+#ifndef INICONFIGHAMT_H
+#define INICONFIGHAMT_H
+
+/*!
+ * \brief Number of keys IniConfigHamt_findBatch() walks in lock step
+ */
+#define INICONFIGHAMT_BATCH  32
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Kind of a trie node
+ */
+typedef enum IniConfigHamtType
+{
+    INICONFIGHAMT_LEAF = 0,             /**< A single key */
+    INICONFIGHAMT_BRANCH,               /**< Up to 32 children selected by 5 hash bits */
+    INICONFIGHAMT_COLLISION             /**< Keys whose hashes are identical */
+}
+IniConfigHamtType;
+
+/*!
+ * \brief A trie node
+ *
+ * Leaves carry the key and its value, branch and collision nodes carry
+ * their children.
+ */
+typedef struct IniConfigHamtNode
+{
+    unsigned int refs;                  /**< Reference count, updated atomically */
+    unsigned int type;                  /**< IniConfigHamtType */
+    unsigned int hash;                  /**< Leaf and collision: hash of the key */
+    unsigned int bitmap;                /**< Branch: occupied child slots */
+    unsigned int count;                 /**< Branch and collision: number of children */
+    unsigned int mark;                  /**< Leaf: free for use by the owner of the map, 0 when created */
+    unsigned long generation;           /**< Leaf: generation of the put */
+    int unit;                           /**< Leaf: IniConfigUnitsKind of the value, 0 until parsed */
+    double quantity;                    /**< Leaf: value in its canonical unit, see \ref IniConfigUnits */
+    const char *section;                /**< Leaf: section name, "" for the global area */
+    const char *key;                    /**< Leaf: key name */
+    const char *value;                  /**< Leaf: value, NULL if the key has been removed */
+    struct IniConfigHamtNode *children[1]; /**< Branch and collision: children */
+}
+IniConfigHamtNode;
+
+/*!
+ * \brief Called for every leaf by IniConfigHamt_forEach()
+ */
+typedef void ( *IniConfigHamtVisitor )( void *context, IniConfigHamtNode *leaf );
+
+/*!
+ * \brief Called for every differing key by IniConfigHamt_diff()
+ *
+ * Either leaf is NULL if the key exists in one version only.
+ */
+typedef void ( *IniConfigHamtDiffVisitor )( void *context, IniConfigHamtNode *before, IniConfigHamtNode *after );
+
+/*!
+ * \brief Hash of a section and key name
+ *
+ * \param section  Section name, "" for the global area
+ * \param key      Key name
+ *
+ * \return Hash value, identical for names differing in case only
+ */
+unsigned int IniConfigHamt_hash( const char *section, const char *key );
+
+/*!
+ * \brief First half of IniConfigHamt_hash(), covering the section name
+ *
+ * \param section  Section name, "" for the global area
+ *
+ * Lets callers reading many keys of one section hash its name only once.
+ *
+ * \return Intermediate value for IniConfigHamt_hashKey()
+ */
+unsigned int IniConfigHamt_hashSection( const char *section );
+
+/*!
+ * \brief Second half of IniConfigHamt_hash(), covering the key name
+ *
+ * \param sectionHash  Result of IniConfigHamt_hashSection()
+ * \param key          Key name
+ *
+ * \return The same value as IniConfigHamt_hash() for section and key
+ */
+unsigned int IniConfigHamt_hashKey( unsigned int sectionHash, const char *key );
+
+/*!
+ * \brief Create a leaf
+ *
+ * \param hash        Hash of section and key, see IniConfigHamt_hash()
+ * \param section     Section name, "" for the global area
+ * \param key         Key name
+ * \param value       Value, NULL for a removed key
+ * \param generation  Generation of the put
+ *
+ * \return A leaf with one reference, NULL on error
+ */
+IniConfigHamtNode *IniConfigHamt_newLeaf( unsigned int hash, const char *section, const char *key,
+                                          const char *value, unsigned long generation );
+
+/*!
+ * \brief Add a reference to a node
+ *
+ * \param node Node, may be NULL
+ *
+ * \return node
+ */
+IniConfigHamtNode *IniConfigHamt_retain( IniConfigHamtNode *node );
+
+/*!
+ * \brief Drop a reference to a node, freeing it with the last one
+ *
+ * \param node Node, may be NULL
+ *
+ * \return Nothing
+ */
+void IniConfigHamt_release( IniConfigHamtNode *node );
+
+/*!
+ * \brief Look up a key
+ *
+ * \param root     Root of the version, NULL for an empty map
+ * \param hash     Hash of section and key
+ * \param section  Section name
+ * \param key      Key name
+ *
+ * \return The leaf of the key, NULL if the map has no such key
+ */
+IniConfigHamtNode *IniConfigHamt_find( const IniConfigHamtNode *root, unsigned int hash,
+                                       const char *section, const char *key );
+
+/*!
+ * \brief Look up several keys at once
+ *
+ * \param roots     Root of the version to search, one per key
+ * \param hashes    Hash of section and key, one per key
+ * \param sections  Section names
+ * \param keys      Key names
+ * \param count     Number of keys
+ * \param leaves    Receives the leaf of every key, NULL if it does not exist
+ *
+ * Walks down the tries of up to INICONFIGHAMT_BATCH keys in lock step
+ * and prefetches the nodes of the next level for all of them before
+ * visiting any, so their cache misses overlap instead of adding up.
+ *
+ * \return Nothing
+ */
+void IniConfigHamt_findBatch( IniConfigHamtNode *const *roots, const unsigned int *hashes,
+                              const char *const *sections, const char *const *keys, unsigned int count,
+                              IniConfigHamtNode **leaves );
+
+/*!
+ * \brief Insert or replace a key
+ *
+ * \param root  Root of the version, NULL for an empty map, not modified
+ * \param leaf  Leaf to insert, the new version takes its own reference
+ *
+ * \return Root of the new version with one reference, NULL on error
+ */
+IniConfigHamtNode *IniConfigHamt_insert( IniConfigHamtNode *root, IniConfigHamtNode *leaf );
+
+/*!
+ * \brief Insert or replace a key in a version nobody else sees yet
+ *
+ * \param root  Root of a version under construction, NULL for an empty
+ *              map; its reference is taken over on success
+ * \param leaf  Leaf to insert, the new version takes its own reference
+ *
+ * Nodes only reachable through root are changed in place instead of
+ * copied, so building a map of n keys costs n inserts without copying
+ * and re-referencing whole paths. Subtrees shared with other versions are
+ * copied like IniConfigHamt_insert() does.
+ *
+ * \return Root of the new version with one reference, NULL on error with
+ *         root unchanged
+ */
+IniConfigHamtNode *IniConfigHamt_insertOwned( IniConfigHamtNode *root, IniConfigHamtNode *leaf );
+
+/*!
+ * \brief Remove a key
+ *
+ * \param root     Root of the version, not modified
+ * \param hash     Hash of section and key
+ * \param section  Section name
+ * \param key      Key name
+ *
+ * \return Root of the new version with one reference, NULL for an empty
+ *         map. The new version may be root itself if the key was missing.
+ */
+IniConfigHamtNode *IniConfigHamt_remove( IniConfigHamtNode *root, unsigned int hash,
+                                         const char *section, const char *key );
+
+/*!
+ * \brief Visit all leaves of a version
+ *
+ * \param root     Root of the version
+ * \param visitor  Function called for every leaf
+ * \param context  Passed to visitor
+ *
+ * \return Nothing
+ */
+void IniConfigHamt_forEach( IniConfigHamtNode *root, IniConfigHamtVisitor visitor, void *context );
+
+/*!
+ * \brief Visit all keys in which two versions differ
+ *
+ * \param before   Root of the first version
+ * \param after    Root of the second version
+ * \param visitor  Function called for every key whose leaves differ
+ * \param context  Passed to visitor
+ *
+ * Subtrees shared by both versions are skipped without being visited.
+ *
+ * \return Nothing
+ */
+void IniConfigHamt_diff( IniConfigHamtNode *before, IniConfigHamtNode *after,
+                         IniConfigHamtDiffVisitor visitor, void *context );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGHAMT_H */
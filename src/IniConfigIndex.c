@@ -0,0 +1,757 @@
+/*
+ *  Immutable lookup index for real-time readers
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <IniConfigHamt.h>
+#include <IniConfigIndex.h>
+#include <IniConfigUnits.h>
+
+#define INICONFIGINDEX_VALID        0x1d3e8b40
+#define INICONFIGINDEX_INVALID      0xb00db00f
+
+/* memory policy constants of mbind(), which <numaif.h> only ships with libnuma */
+#define INICONFIGINDEX_MPOL_BIND    2
+#define INICONFIGINDEX_MPOL_MF_MOVE ( 1 << 1 )
+#define INICONFIGINDEX_MAXNODES     1024
+
+/* numbers are converted from the same prefix IniConfigFile_getLong() sees */
+#define INICONFIGINDEX_NUMBERSIZE   64
+
+
+/*
+ * Layout of the block: header, slots, entries, strings. All references
+ * are offsets from the start of the block.
+ */
+typedef struct IniConfigIndexHeader
+{
+    unsigned int numEntries;            /* number of keys */
+    unsigned int numSlots;              /* hash table size, a power of two */
+    unsigned int maxProbe;              /* longest probe sequence */
+    unsigned int entriesOffset;         /* offset of the entries */
+}
+IniConfigIndexHeader;
+
+typedef struct IniConfigIndexEntry
+{
+    unsigned int hash;                  /* IniConfigHamt_hash() of the names */
+    unsigned int section;               /* offset of the section name */
+    unsigned int key;                   /* offset of the key name */
+    unsigned int value;                 /* offset of the value */
+    unsigned int length;                /* length of the value */
+    int intValue;                       /* value as IniConfigFile_getInt() converts it */
+    long longValue;                     /* value as IniConfigFile_getLong() converts it */
+    double doubleValue;                 /* value as IniConfigFile_getDouble() converts it */
+    double quantity;                    /* value in its canonical unit, see IniConfigUnits_parse() */
+    int unit;                           /* IniConfigUnitsKind of the value */
+}
+IniConfigIndexEntry;
+
+typedef struct IniConfigIndexBuilder
+{
+    char *base;                         /* block, NULL while counting */
+    unsigned int numEntries;
+    size_t stringSize;
+    size_t stringOffset;
+    unsigned int lastSection;           /* offset of the previous section name */
+    const char *lastSectionName;
+}
+IniConfigIndexBuilder;
+
+
+/*
+ * Private functions
+ */
+
+static char IniConfigIndex_toLower( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? (char)( c + 'a' - 'A' ) : c;
+}
+
+
+static int IniConfigIndex_equalsNoCase( const char *a, const char *b )
+{
+    while( *a != '\0' && IniConfigIndex_toLower( *a ) == IniConfigIndex_toLower( *b ) )
+    {
+        a++;
+        b++;
+    }
+
+    return ( IniConfigIndex_toLower( *a ) == IniConfigIndex_toLower( *b ) );
+}
+
+
+static const IniConfigIndexHeader *IniConfigIndex_header( const IniConfigIndex *self )
+{
+    return (const IniConfigIndexHeader *)self->base;
+}
+
+
+static const unsigned int *IniConfigIndex_slots( const IniConfigIndex *self )
+{
+    return (const unsigned int *)( self->base + sizeof( IniConfigIndexHeader ) );
+}
+
+
+static const IniConfigIndexEntry *IniConfigIndex_probe( const IniConfigIndex *self, unsigned int hash,
+                                                        const char *section, const char *key )
+{
+    const IniConfigIndexHeader *header = IniConfigIndex_header( self );
+    const unsigned int *slots = IniConfigIndex_slots( self );
+    const IniConfigIndexEntry *entries = (const IniConfigIndexEntry *)( self->base + header->entriesOffset );
+    unsigned int i = 0;
+
+    for( i = 0; i <= header->maxProbe; i++ )
+    {
+        unsigned int slot = slots[( hash + i ) & ( header->numSlots - 1 )];
+        const IniConfigIndexEntry *entry = NULL;
+
+        if( slot == 0 )
+        {
+            break;
+        }
+
+        entry = &entries[slot - 1];
+
+        if( entry->hash == hash &&
+            IniConfigIndex_equalsNoCase( self->base + entry->key, key ) &&
+            IniConfigIndex_equalsNoCase( self->base + entry->section, section ) )
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+static const IniConfigIndexEntry *IniConfigIndex_lookup( const IniConfigIndex *self, const char *section,
+                                                         const char *key )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+    ANY_REQUIRE( key );
+
+    if( self->base == NULL )
+    {
+        return NULL;
+    }
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    return IniConfigIndex_probe( self, IniConfigHamt_hash( section, key ), section, key );
+}
+
+
+static size_t IniConfigIndex_addString( IniConfigIndexBuilder *builder, const char *text )
+{
+    size_t offset = builder->stringOffset;
+    size_t length = strlen( text ) + 1;
+
+    memcpy( builder->base + offset, text, length );
+    builder->stringOffset += length;
+
+    return offset;
+}
+
+
+static void IniConfigIndex_convert( IniConfigIndexEntry *entry, const char *value )
+{
+    char buff[INICONFIGINDEX_NUMBERSIZE];
+    size_t length = strlen( value );
+
+    if( length > sizeof( buff ) - 1 )
+    {
+        length = sizeof( buff ) - 1;
+    }
+
+    memcpy( buff, value, length );
+    buff[length] = '\0';
+
+    if( length >= 2 && toupper( (int)buff[1] ) == 'X' )
+    {
+        entry->longValue = strtol( buff, NULL, 16 );
+    }
+    else
+    {
+        entry->longValue = strtol( buff, NULL, 10 );
+    }
+
+    entry->intValue = atoi( buff );
+    entry->doubleValue = strtod( buff, NULL );
+    entry->unit = IniConfigUnits_parse( value, &entry->quantity );
+}
+
+
+static bool IniConfigIndex_visit( void *context, const char *section, const char *key, const char *value )
+{
+    IniConfigIndexBuilder *builder = (IniConfigIndexBuilder *)context;
+    IniConfigIndexEntry *entry = NULL;
+    const IniConfigIndexHeader *header = NULL;
+
+    if( builder->base == NULL )
+    {
+        /* counting pass, reserves room for one section name per key */
+        builder->numEntries++;
+        builder->stringSize += strlen( section ) + strlen( key ) + strlen( value ) + 3;
+
+        return true;
+    }
+
+    header = (const IniConfigIndexHeader *)builder->base;
+    entry = (IniConfigIndexEntry *)( builder->base + header->entriesOffset ) + builder->numEntries++;
+
+    /* the keys of a section arrive together, so they share its name */
+    if( builder->lastSectionName == NULL || strcmp( builder->lastSectionName, section ) != 0 )
+    {
+        builder->lastSection = (unsigned int)IniConfigIndex_addString( builder, section );
+        builder->lastSectionName = builder->base + builder->lastSection;
+    }
+
+    entry->hash = IniConfigHamt_hash( section, key );
+    entry->section = builder->lastSection;
+    entry->key = (unsigned int)IniConfigIndex_addString( builder, key );
+    entry->length = (unsigned int)strlen( value );
+    entry->value = (unsigned int)IniConfigIndex_addString( builder, value );
+
+    IniConfigIndex_convert( entry, value );
+
+    return true;
+}
+
+
+/*
+ * Maps a zeroed, writable and resident block of at least *size bytes and
+ * returns the size of the mapping in *size
+ */
+static char *IniConfigIndex_map( size_t *size, int flags )
+{
+    size_t hugeSize = ( *size + INICONFIGINDEX_HUGEPAGESIZE - 1 ) & ~( INICONFIGINDEX_HUGEPAGESIZE - 1 );
+    size_t pageSize = (size_t)sysconf( _SC_PAGESIZE );
+    char *area = NULL;
+    char *base = NULL;
+    size_t i = 0;
+
+    if( flags & INICONFIGINDEX_HUGETLB )
+    {
+#if defined(MAP_HUGETLB)
+        base = (char *)mmap( NULL, hugeSize, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0 );
+#else
+        base = (char *)MAP_FAILED;
+#endif
+        if( base == MAP_FAILED )
+        {
+            ANY_LOG( 0, "Unable to map %lu bytes of huge pages: %s", ANY_LOG_ERROR,
+                     (unsigned long)hugeSize, strerror( errno ) );
+            return NULL;
+        }
+
+        *size = hugeSize;
+
+        return base;
+    }
+
+    /* a block smaller than a huge page would only waste the rest of it */
+    if( !( flags & INICONFIGINDEX_HUGEPAGES ) || *size < INICONFIGINDEX_HUGEPAGESIZE )
+    {
+        /* prefaulted, so no reader ever takes a page fault into the kernel */
+        base = (char *)mmap( NULL, *size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0 );
+
+        return ( base != MAP_FAILED ) ? base : NULL;
+    }
+
+    /* transparent huge pages need an aligned range, advised before the first touch */
+    area = (char *)mmap( NULL, hugeSize + INICONFIGINDEX_HUGEPAGESIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if( area == MAP_FAILED )
+    {
+        return NULL;
+    }
+
+    base = (char *)( ( (uintptr_t)area + INICONFIGINDEX_HUGEPAGESIZE - 1 ) & ~( INICONFIGINDEX_HUGEPAGESIZE - 1 ) );
+
+    if( base > area )
+    {
+        munmap( area, (size_t)( base - area ) );
+    }
+
+    munmap( base + hugeSize, (size_t)( area + INICONFIGINDEX_HUGEPAGESIZE - base ) );
+
+#if defined(MADV_HUGEPAGE)
+    /* only a hint, the block works the same on small pages */
+    madvise( base, hugeSize, MADV_HUGEPAGE );
+#endif
+
+    for( i = 0; i < hugeSize; i += pageSize )
+    {
+        ( (volatile char *)base )[i] = 0;
+    }
+
+    *size = hugeSize;
+
+    return base;
+}
+
+
+/*
+ * Makes a filled block read-only, locked if requested, and unmaps it on failure
+ */
+static bool IniConfigIndex_seal( char *base, size_t size, int flags )
+{
+    if( mprotect( base, size, PROT_READ ) != 0 ||
+        ( ( flags & INICONFIGINDEX_LOCKED ) && mlock( base, size ) != 0 ) )
+    {
+        ANY_LOG( 0, "Unable to lock the index into memory: %s", ANY_LOG_ERROR, strerror( errno ) );
+        munmap( base, size );
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Moves the pages of a block to a NUMA node, leaves them where they are
+ * if the kernel cannot
+ */
+static void IniConfigIndex_bind( char *base, size_t size, int node )
+{
+#if defined(SYS_mbind)
+    unsigned long nodeMask[INICONFIGINDEX_MAXNODES / ( 8 * sizeof( unsigned long ) )];
+    const int bits = (int)( 8 * sizeof( unsigned long ) );
+
+    if( node < 0 || node >= INICONFIGINDEX_MAXNODES )
+    {
+        return;
+    }
+
+    memset( nodeMask, 0, sizeof( nodeMask ) );
+    nodeMask[node / bits] |= 1UL << ( node % bits );
+
+    syscall( SYS_mbind, base, size, INICONFIGINDEX_MPOL_BIND, nodeMask, (unsigned long)INICONFIGINDEX_MAXNODES,
+             INICONFIGINDEX_MPOL_MF_MOVE );
+#endif
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigIndex *IniConfigIndex_new( void )
+{
+    return ( ANY_TALLOC( IniConfigIndex ) );
+}
+
+
+bool IniConfigIndex_init( IniConfigIndex *self )
+{
+    ANY_REQUIRE( self );
+
+    self->base = NULL;
+    self->size = 0;
+    self->flags = INICONFIGINDEX_NONE;
+
+    self->valid = INICONFIGINDEX_VALID;
+
+    return true;
+}
+
+
+bool IniConfigIndex_build( IniConfigIndex *self, const IniConfigDocument *document, int flags )
+{
+    IniConfigIndexBuilder builder;
+    IniConfigIndexHeader *header = NULL;
+    IniConfigIndexEntry *entries = NULL;
+    unsigned int *slots = NULL;
+    unsigned int numSlots = 8;
+    size_t entriesOffset = 0;
+    size_t size = 0;
+    char *base = NULL;
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+    ANY_REQUIRE( document );
+
+    IniConfigIndex_clear( self );
+    IniConfigIndex_init( self );
+
+    memset( &builder, 0, sizeof( builder ) );
+
+    if( !IniConfigDocument_forEach( document, IniConfigIndex_visit, &builder ) )
+    {
+        return false;
+    }
+
+    /* at most half full keeps the probe sequences short */
+    while( numSlots < builder.numEntries * 2 )
+    {
+        numSlots *= 2;
+    }
+
+    entriesOffset = sizeof( IniConfigIndexHeader ) + numSlots * sizeof( unsigned int );
+    entriesOffset = ( entriesOffset + sizeof( double ) - 1 ) & ~( sizeof( double ) - 1 );
+    size = entriesOffset + builder.numEntries * sizeof( IniConfigIndexEntry ) + builder.stringSize;
+
+    if( size > 0xffffffffUL )
+    {
+        ANY_LOG( 0, "Document too large for an index", ANY_LOG_ERROR );
+        return false;
+    }
+
+    base = IniConfigIndex_map( &size, flags );
+
+    if( base == NULL )
+    {
+        return false;
+    }
+
+    header = (IniConfigIndexHeader *)base;
+    header->numSlots = numSlots;
+    header->entriesOffset = (unsigned int)entriesOffset;
+
+    builder.base = base;
+    builder.stringOffset = entriesOffset + builder.numEntries * sizeof( IniConfigIndexEntry );
+    builder.numEntries = 0;
+    builder.lastSectionName = NULL;
+
+    if( !IniConfigDocument_forEach( document, IniConfigIndex_visit, &builder ) )
+    {
+        munmap( base, size );
+        return false;
+    }
+
+    header->numEntries = builder.numEntries;
+    slots = (unsigned int *)( base + sizeof( IniConfigIndexHeader ) );
+    entries = (IniConfigIndexEntry *)( base + entriesOffset );
+
+    for( i = 0; i < builder.numEntries; i++ )
+    {
+        unsigned int probe = 0;
+
+        while( slots[( entries[i].hash + probe ) & ( numSlots - 1 )] != 0 )
+        {
+            probe++;
+        }
+
+        slots[( entries[i].hash + probe ) & ( numSlots - 1 )] = i + 1;
+
+        if( probe > header->maxProbe )
+        {
+            header->maxProbe = probe;
+        }
+    }
+
+    if( !IniConfigIndex_seal( base, size, flags ) )
+    {
+        return false;
+    }
+
+    self->base = base;
+    self->size = size;
+    self->flags = flags;
+
+    return true;
+}
+
+
+bool IniConfigIndex_copy( IniConfigIndex *self, const IniConfigIndex *source, int node )
+{
+    size_t size = 0;
+    char *base = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+    ANY_REQUIRE( source );
+    ANY_REQUIRE( source->valid == INICONFIGINDEX_VALID );
+    ANY_REQUIRE( self != source );
+
+    IniConfigIndex_clear( self );
+    IniConfigIndex_init( self );
+
+    if( source->base == NULL )
+    {
+        return true;
+    }
+
+    size = source->size;
+    base = IniConfigIndex_map( &size, source->flags );
+
+    if( base == NULL )
+    {
+        return false;
+    }
+
+    if( node >= 0 )
+    {
+        IniConfigIndex_bind( base, size, node );
+    }
+
+    /* offsets are relative to the block, so a plain copy is a working index */
+    memcpy( base, source->base, source->size );
+
+    if( !IniConfigIndex_seal( base, size, source->flags ) )
+    {
+        return false;
+    }
+
+    self->base = base;
+    self->size = size;
+    self->flags = source->flags;
+
+    return true;
+}
+
+
+const char *IniConfigIndex_find( const IniConfigIndex *self, const char *section, const char *key )
+{
+    const IniConfigIndexEntry *entry = IniConfigIndex_lookup( self, section, key );
+
+    return ( entry != NULL ) ? self->base + entry->value : NULL;
+}
+
+
+const char *IniConfigIndex_findHashed( const IniConfigIndex *self, unsigned int hash, const char *section,
+                                       const char *key )
+{
+    const IniConfigIndexEntry *entry = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+    ANY_REQUIRE( section );
+    ANY_REQUIRE( key );
+
+    if( self->base == NULL )
+    {
+        return NULL;
+    }
+
+    entry = IniConfigIndex_probe( self, hash, section, key );
+
+    return ( entry != NULL ) ? self->base + entry->value : NULL;
+}
+
+
+int IniConfigIndex_getString( const IniConfigIndex *self, const char *section, const char *key,
+                              const char *defValue, char *buffer, int bufferSize )
+{
+    const IniConfigIndexEntry *entry = IniConfigIndex_lookup( self, section, key );
+    const char *value = ( defValue != NULL ) ? defValue : "";
+    size_t length = 0;
+
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+
+    if( entry != NULL )
+    {
+        value = self->base + entry->value;
+        length = entry->length;
+    }
+    else
+    {
+        length = strlen( value );
+    }
+
+    if( length > (size_t)bufferSize - 1 )
+    {
+        length = (size_t)bufferSize - 1;
+    }
+
+    memcpy( buffer, value, length );
+    buffer[length] = '\0';
+
+    return (int)length;
+}
+
+
+long IniConfigIndex_getLong( const IniConfigIndex *self, const char *section, const char *key, long defValue )
+{
+    const IniConfigIndexEntry *entry = IniConfigIndex_lookup( self, section, key );
+
+    return ( entry != NULL && entry->length != 0 ) ? entry->longValue : defValue;
+}
+
+
+int IniConfigIndex_getInt( const IniConfigIndex *self, const char *section, const char *key, int defValue )
+{
+    const IniConfigIndexEntry *entry = IniConfigIndex_lookup( self, section, key );
+
+    return ( entry != NULL && entry->length != 0 ) ? entry->intValue : defValue;
+}
+
+
+double IniConfigIndex_getDouble( const IniConfigIndex *self, const char *section, const char *key,
+                                 double defValue )
+{
+    const IniConfigIndexEntry *entry = IniConfigIndex_lookup( self, section, key );
+
+    return ( entry != NULL && entry->length != 0 ) ? entry->doubleValue : defValue;
+}
+
+
+bool IniConfigIndex_getQuantity( const IniConfigIndex *self, const char *section, const char *key, int *kind,
+                                 double *quantity )
+{
+    const IniConfigIndexEntry *entry = IniConfigIndex_lookup( self, section, key );
+
+    ANY_REQUIRE( kind );
+    ANY_REQUIRE( quantity );
+
+    if( entry == NULL )
+    {
+        return false;
+    }
+
+    *kind = entry->unit;
+    *quantity = entry->quantity;
+
+    return true;
+}
+
+
+void IniConfigIndex_findBatch( const IniConfigIndex *self, unsigned int count, const char *const *sections,
+                               const char *const *keys, const char **values )
+{
+    unsigned int hashes[INICONFIGHAMT_BATCH];
+    const IniConfigIndexHeader *header = NULL;
+    const IniConfigIndexEntry *entries = NULL;
+    const unsigned int *slots = NULL;
+    unsigned int first = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+    ANY_REQUIRE( sections );
+    ANY_REQUIRE( keys );
+    ANY_REQUIRE( values );
+
+    if( self->base == NULL )
+    {
+        for( first = 0; first < count; first++ )
+        {
+            values[first] = NULL;
+        }
+
+        return;
+    }
+
+    header = IniConfigIndex_header( self );
+    slots = IniConfigIndex_slots( self );
+    entries = (const IniConfigIndexEntry *)( self->base + header->entriesOffset );
+
+    for( first = 0; first < count; first += INICONFIGHAMT_BATCH )
+    {
+        unsigned int n = ( count - first < INICONFIGHAMT_BATCH ) ? count - first : INICONFIGHAMT_BATCH;
+        unsigned int i = 0;
+
+        /* every pass only touches memory the previous one has prefetched */
+        for( i = 0; i < n; i++ )
+        {
+            const char *section = ( sections[first + i] != NULL ) ? sections[first + i] : "";
+
+            ANY_REQUIRE( keys[first + i] );
+
+            hashes[i] = IniConfigHamt_hash( section, keys[first + i] );
+            __builtin_prefetch( &slots[hashes[i] & ( header->numSlots - 1 )] );
+        }
+
+        for( i = 0; i < n; i++ )
+        {
+            unsigned int slot = slots[hashes[i] & ( header->numSlots - 1 )];
+
+            if( slot != 0 )
+            {
+                __builtin_prefetch( &entries[slot - 1] );
+            }
+        }
+
+        for( i = 0; i < n; i++ )
+        {
+            unsigned int slot = slots[hashes[i] & ( header->numSlots - 1 )];
+
+            if( slot != 0 )
+            {
+                __builtin_prefetch( self->base + entries[slot - 1].key );
+            }
+        }
+
+        for( i = 0; i < n; i++ )
+        {
+            const char *section = ( sections[first + i] != NULL ) ? sections[first + i] : "";
+            const IniConfigIndexEntry *entry = IniConfigIndex_probe( self, hashes[i], section, keys[first + i] );
+
+            values[first + i] = ( entry != NULL ) ? self->base + entry->value : NULL;
+        }
+    }
+}
+
+
+unsigned int IniConfigIndex_getSize( const IniConfigIndex *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+
+    return ( self->base != NULL ) ? IniConfigIndex_header( self )->numEntries : 0;
+}
+
+
+unsigned int IniConfigIndex_getMaxProbe( const IniConfigIndex *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+
+    return ( self->base != NULL ) ? IniConfigIndex_header( self )->maxProbe : 0;
+}
+
+
+void IniConfigIndex_clear( IniConfigIndex *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGINDEX_VALID );
+
+    if( self->base != NULL )
+    {
+        /* munmap() also drops an mlock() */
+        munmap( (void *)self->base, self->size );
+    }
+
+    self->base = NULL;
+    self->size = 0;
+
+    self->valid = INICONFIGINDEX_INVALID;
+}
+
+
+void IniConfigIndex_delete( IniConfigIndex *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
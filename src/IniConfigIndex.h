@@ -0,0 +1,323 @@
+/*
+ *  Immutable lookup index for real-time readers
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigIndex Real-time reads
+ *
+ * An IniConfigIndex is a read-only copy of all keys of a loaded file,
+ * meant for threads which must not allocate memory, take locks or enter
+ * the kernel, e.g. control loops running under SCHED_FIFO.
+ *
+ * IniConfigFile_buildIndex() copies the keys into a single block of
+ * memory: an open-addressing hash table followed by the entries and all
+ * names and values, linked by offsets. Numbers are converted while the
+ * index is built. All pages of the block are faulted in up front and
+ * then made read-only; with INICONFIGINDEX_LOCKED the block is also locked
+ * into RAM.
+ *
+ * Afterwards the getters of this module
+ *
+ *  - do not allocate memory
+ *  - do not take locks and do not write to shared memory
+ *  - do not make system calls
+ *  - finish after at most IniConfigIndex_getMaxProbe() + 1 comparisons
+ *
+ * and may be called from any number of threads.
+ *
+ * \code
+ *  IniConfigIndex *index = IniConfigIndex_new();
+ *
+ *  IniConfigIndex_init( index );
+ *  IniConfigFile_load( myIniFile );
+ *  IniConfigFile_buildIndex( myIniFile, index, INICONFIGINDEX_LOCKED );
+ *
+ *  // in the control loop
+ *  gain = IniConfigIndex_getDouble( index, "Arm", "gain", 1.0 );
+ * \endcode
+ *
+ * Large indexes spread random lookups over many pages, so that TLB misses
+ * dominate the lookup time. INICONFIGINDEX_HUGEPAGES places an index of
+ * at least INICONFIGINDEX_HUGEPAGESIZE on transparent huge pages where
+ * the kernel has them enabled (madvise mode suffices). INICONFIGINDEX_HUGETLB
+ * takes explicit huge pages, which the administrator must have reserved
+ * in /proc/sys/vm/nr_hugepages; the block is then rounded up to whole
+ * huge pages. Either way the pages are faulted in during the build.
+ *
+ * The index does not follow later puts; build it again to pick them up.
+ * Building, like clearing, allocates and must happen outside of the
+ * real-time thread. Locking the code and stack of the real-time thread
+ * (e.g. with mlockall()) remains the task of the application.
+ */
+
+#ifndef INICONFIGINDEX_H
+#define INICONFIGINDEX_H
+
+#include <stddef.h>
+
+#include <IniConfigDocument.h>
+
+/*!
+ * \brief Size of the huge pages used by INICONFIGINDEX_HUGEPAGES and INICONFIGINDEX_HUGETLB
+ */
+#define INICONFIGINDEX_HUGEPAGESIZE  ( 2UL * 1024UL * 1024UL )
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Options of IniConfigIndex_build()
+ */
+typedef enum IniConfigIndexFlags
+{
+    INICONFIGINDEX_NONE      = 0,       /**< Resident after the build, may be swapped out later */
+    INICONFIGINDEX_LOCKED    = 1,       /**< Lock the index into RAM, the build fails if this is not possible */
+    INICONFIGINDEX_HUGEPAGES = 2,       /**< Ask for transparent huge pages, ignored where they are not available */
+    INICONFIGINDEX_HUGETLB   = 4        /**< Use reserved huge pages, the build fails if there are not enough */
+}
+IniConfigIndexFlags;
+
+/*!
+ * \brief IniConfigIndex definition
+ */
+typedef struct IniConfigIndex
+{
+    unsigned long valid;                /**< Object validity */
+    const char *base;                   /**< Read-only block holding the index, NULL if not built */
+    size_t size;                        /**< Size of the mapping holding the block */
+    int flags;                          /**< IniConfigIndexFlags of the build */
+}
+IniConfigIndex;
+
+/*!
+ * \brief Allocate a new IniConfigIndex instance
+ *
+ * \return A new IniConfigIndex instance, NULL on error
+ *
+ * \see IniConfigIndex_init()
+ */
+IniConfigIndex *IniConfigIndex_new( void );
+
+/*!
+ * \brief Initialize an empty index
+ *
+ * \param self Pointer to the IniConfigIndex
+ *
+ * All lookups on an empty index return the default value.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_buildIndex()
+ */
+bool IniConfigIndex_init( IniConfigIndex *self );
+
+/*!
+ * \brief Replace the contents of the index with the keys of a document
+ *
+ * \param self      Pointer to the IniConfigIndex
+ * \param document  Document to copy the keys from
+ * \param flags     Or-ed IniConfigIndexFlags
+ *
+ * Not real-time safe. No reader may use the index while it is rebuilt.
+ *
+ * \return Returns true on success, false otherwise. The index is empty
+ *         after a failure.
+ */
+bool IniConfigIndex_build( IniConfigIndex *self, const IniConfigDocument *document, int flags );
+
+/*!
+ * \brief Replace the contents of the index with a copy of another index
+ *
+ * \param self    Pointer to the IniConfigIndex
+ * \param source  Index to copy, mapped with the same IniConfigIndexFlags
+ * \param node    NUMA node to place the copy on, -1 for no preference
+ *
+ * Pages which cannot be moved to the node, e.g. on kernels without NUMA
+ * support, stay where the kernel put them. Not real-time safe.
+ *
+ * \return Returns true on success, false otherwise. The index is empty
+ *         after a failure.
+ */
+bool IniConfigIndex_copy( IniConfigIndex *self, const IniConfigIndex *source, int node );
+
+/*!
+ * \brief Look up the value of a key
+ *
+ * \param self     Pointer to the IniConfigIndex
+ * \param section  Section name, NULL for the global area
+ * \param key      Key name
+ *
+ * Real-time safe.
+ *
+ * \return Pointer to the value inside the index, valid until the index is
+ *         rebuilt or cleared, NULL if the key does not exist
+ */
+const char *IniConfigIndex_find( const IniConfigIndex *self, const char *section, const char *key );
+
+/*!
+ * \brief Look up the value of a key whose hash is already known
+ *
+ * \param self     Pointer to the IniConfigIndex
+ * \param hash     IniConfigHamt_hash() of section and key
+ * \param section  Section name, "" for the global area
+ * \param key      Key name
+ *
+ * Real-time safe.
+ *
+ * \return Pointer to the value inside the index, NULL if the key does not exist
+ */
+const char *IniConfigIndex_findHashed( const IniConfigIndex *self, unsigned int hash, const char *section,
+                                       const char *key );
+
+/*!
+ * \brief Look up several keys at once
+ *
+ * \param self      Pointer to the IniConfigIndex
+ * \param count     Number of keys
+ * \param sections  Section names, NULL entries for the global area
+ * \param keys      Key names
+ * \param values    Receives a pointer to every value, NULL if the key does not exist
+ *
+ * Hashes a group of INICONFIGHAMT_BATCH keys first and prefetches their
+ * slots, then their entries and key names, before comparing any of them,
+ * so the cache misses of the group overlap. Real-time safe.
+ *
+ * \return Nothing
+ */
+void IniConfigIndex_findBatch( const IniConfigIndex *self, unsigned int count, const char *const *sections,
+                               const char *const *keys, const char **values );
+
+/*!
+ * \brief Get a string
+ *
+ * \param self        Pointer to the IniConfigIndex
+ * \param section     Section name, NULL for the global area
+ * \param key         Key name
+ * \param defValue    Returned if the key does not exist
+ * \param buffer      Receives the value, truncated to bufferSize - 1 characters
+ * \param bufferSize  Size of buffer
+ *
+ * Real-time safe.
+ *
+ * \return The number of characters copied into buffer
+ */
+int IniConfigIndex_getString( const IniConfigIndex *self, const char *section, const char *key,
+                              const char *defValue, char *buffer, int bufferSize );
+
+/*!
+ * \brief Get a long
+ *
+ * \param self      Pointer to the IniConfigIndex
+ * \param section   Section name, NULL for the global area
+ * \param key       Key name
+ * \param defValue  Returned if the key does not exist or is empty
+ *
+ * Real-time safe, converts like IniConfigFile_getLong().
+ *
+ * \return The value
+ */
+long IniConfigIndex_getLong( const IniConfigIndex *self, const char *section, const char *key, long defValue );
+
+/*!
+ * \brief Get an int
+ *
+ * \param self      Pointer to the IniConfigIndex
+ * \param section   Section name, NULL for the global area
+ * \param key       Key name
+ * \param defValue  Returned if the key does not exist or is empty
+ *
+ * Real-time safe, converts like IniConfigFile_getInt().
+ *
+ * \return The value
+ */
+int IniConfigIndex_getInt( const IniConfigIndex *self, const char *section, const char *key, int defValue );
+
+/*!
+ * \brief Get a double
+ *
+ * \param self      Pointer to the IniConfigIndex
+ * \param section   Section name, NULL for the global area
+ * \param key       Key name
+ * \param defValue  Returned if the key does not exist or is empty
+ *
+ * Real-time safe, converts like IniConfigFile_getDouble().
+ *
+ * \return The value
+ */
+double IniConfigIndex_getDouble( const IniConfigIndex *self, const char *section, const char *key,
+                                 double defValue );
+
+/*!
+ * \brief Get a value with a unit
+ *
+ * \param self      Pointer to the IniConfigIndex
+ * \param section   Section name, NULL for the global area
+ * \param key       Key name
+ * \param kind      Receives the IniConfigUnitsKind of the value
+ * \param quantity  Receives the value in its canonical unit
+ *
+ * Real-time safe, the values are parsed while the index is built (see
+ * \ref IniConfigUnits).
+ *
+ * \return Returns false if the key does not exist
+ */
+bool IniConfigIndex_getQuantity( const IniConfigIndex *self, const char *section, const char *key, int *kind,
+                                 double *quantity );
+
+/*!
+ * \brief Return the number of keys in the index
+ *
+ * \param self Pointer to the IniConfigIndex
+ *
+ * \return Number of keys
+ */
+unsigned int IniConfigIndex_getSize( const IniConfigIndex *self );
+
+/*!
+ * \brief Return the longest probe sequence of the hash table
+ *
+ * \param self Pointer to the IniConfigIndex
+ *
+ * Every lookup compares at most this many entries plus one, which bounds
+ * its execution time.
+ *
+ * \return Number of extra slots the worst lookup visits
+ */
+unsigned int IniConfigIndex_getMaxProbe( const IniConfigIndex *self );
+
+/*!
+ * \brief Clear an IniConfigIndex instance
+ *
+ * \param self Pointer to the IniConfigIndex
+ *
+ * \return Nothing
+ */
+void IniConfigIndex_clear( IniConfigIndex *self );
+
+/*!
+ * \brief Delete an IniConfigIndex instance
+ *
+ * \param self Pointer to the IniConfigIndex
+ *
+ * \return Nothing
+ */
+void IniConfigIndex_delete( IniConfigIndex *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGINDEX_H */
@@ -0,0 +1,154 @@
+/*
+ *  Lookups under way on versions replaced while they are read
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <Any.h>
+
+#include <sched.h>
+
+#include <IniConfigReaders.h>
+
+#define INICONFIGREADERS_VALID      0x4a91c3d7
+#define INICONFIGREADERS_INVALID    0xb00db00f
+
+
+/*
+ * Private functions
+ */
+
+/*
+ * Lets the lookups of an epoch which started before the flip leave
+ */
+static void IniConfigReaders_drain( IniConfigReaders *self )
+{
+    unsigned int epoch = __atomic_load_n( &self->epoch, __ATOMIC_SEQ_CST );
+    unsigned long count = 0;
+    int i = 0;
+
+    __atomic_store_n( &self->epoch, epoch ^ 1, __ATOMIC_SEQ_CST );
+
+    do
+    {
+        /* a lookup may leave in another slot than it entered, only the sum counts */
+        for( count = 0, i = 0; i < INICONFIGREADERS_SLOTS; i++ )
+        {
+            count += __atomic_load_n( &self->slots[i].count[epoch], __ATOMIC_SEQ_CST );
+        }
+
+        if( count != 0 )
+        {
+            sched_yield();
+        }
+    }
+    while( count != 0 );
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigReaders *IniConfigReaders_new( void )
+{
+    return ( ANY_TALLOC( IniConfigReaders ) );
+}
+
+
+bool IniConfigReaders_init( IniConfigReaders *self )
+{
+    ANY_REQUIRE( self );
+
+    self->epoch = 0;
+    self->slots = ANY_NTALLOC( INICONFIGREADERS_SLOTS, IniConfigReadersSlot );
+
+    if( self->slots == NULL )
+    {
+        return false;
+    }
+
+    self->valid = INICONFIGREADERS_VALID;
+
+    return true;
+}
+
+
+unsigned int IniConfigReaders_enter( IniConfigReaders *self )
+{
+    unsigned int epoch = 0;
+    int cpu = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREADERS_VALID );
+
+    epoch = __atomic_load_n( &self->epoch, __ATOMIC_SEQ_CST );
+    cpu = sched_getcpu();
+    cpu = ( cpu >= 0 ) ? cpu % INICONFIGREADERS_SLOTS : 0;
+
+    /*
+     * Ordered before the caller loads the version: either the writer sees
+     * this count, or the caller sees the version the writer installed
+     */
+    __atomic_fetch_add( &self->slots[cpu].count[epoch], 1, __ATOMIC_SEQ_CST );
+
+    return (unsigned int)cpu * 2 + epoch;
+}
+
+
+void IniConfigReaders_leave( IniConfigReaders *self, unsigned int reader )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREADERS_VALID );
+    ANY_REQUIRE( reader < 2 * INICONFIGREADERS_SLOTS );
+
+    __atomic_fetch_sub( &self->slots[reader / 2].count[reader % 2], 1, __ATOMIC_RELEASE );
+}
+
+
+void IniConfigReaders_synchronize( IniConfigReaders *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREADERS_VALID );
+
+    /*
+     * A lookup which read the epoch before the last writer flipped it may
+     * count in the epoch this writer does not retire, so both drain, each
+     * while new lookups count in the other one
+     */
+    IniConfigReaders_drain( self );
+    IniConfigReaders_drain( self );
+}
+
+
+void IniConfigReaders_clear( IniConfigReaders *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREADERS_VALID );
+
+    ANY_FREE( self->slots );
+    self->slots = NULL;
+
+    self->valid = INICONFIGREADERS_INVALID;
+}
+
+
+void IniConfigReaders_delete( IniConfigReaders *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
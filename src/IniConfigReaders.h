@@ -0,0 +1,151 @@
+/*
+ *  Lookups under way on versions replaced while they are read
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigReaders Reader tracking
+ *
+ * IniConfigFile_refreeze() swaps the version of a frozen file while other
+ * threads look keys up in it. IniConfigReaders tells it when the old
+ * version is not read any more, so that it can be freed.
+ *
+ * Every lookup runs between IniConfigReaders_enter() and
+ * IniConfigReaders_leave(), which count it in a slot of the CPU it runs
+ * on, so readers on different CPUs do not share cache lines. The counts
+ * live apart from the index and the document, which thus stay unwritten
+ * by the readers. A writer installs the new version first and then calls
+ * IniConfigReaders_synchronize(), which waits until the lookups that may
+ * still see the old version have left.
+ *
+ * Readers are split into two epochs, and the writer only waits for the
+ * one it retires: lookups starting after the new version was installed
+ * count in the other epoch, so a steady stream of them never keeps a
+ * writer waiting.
+ */
+
+#ifndef INICONFIGREADERS_H
+#define INICONFIGREADERS_H
+
+#include <stddef.h>
+
+/*!
+ * \brief Number of slots readers count themselves in
+ */
+#define INICONFIGREADERS_SLOTS  64
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Reader counts of one slot, in a cache line of its own
+ */
+typedef struct IniConfigReadersSlot
+{
+    unsigned long count[2];             /**< Lookups under way per epoch, updated atomically */
+    char padding[64 - 2 * sizeof( unsigned long )];
+}
+IniConfigReadersSlot;
+
+/*!
+ * \brief IniConfigReaders definition
+ */
+typedef struct IniConfigReaders
+{
+    unsigned long valid;                /**< Object validity */
+    IniConfigReadersSlot *slots;        /**< INICONFIGREADERS_SLOTS counts */
+    unsigned int epoch;                 /**< Epoch new lookups count in, updated atomically */
+}
+IniConfigReaders;
+
+/*!
+ * \brief Allocate a new IniConfigReaders instance
+ *
+ * \return A new IniConfigReaders instance, NULL on error
+ *
+ * \see IniConfigReaders_init()
+ */
+IniConfigReaders *IniConfigReaders_new( void );
+
+/*!
+ * \brief Initialize without any lookups under way
+ *
+ * \param self Pointer to the IniConfigReaders
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigReaders_init( IniConfigReaders *self );
+
+/*!
+ * \brief Start a lookup
+ *
+ * \param self Pointer to the IniConfigReaders
+ *
+ * Versions loaded after this call are not freed before the matching
+ * IniConfigReaders_leave(). Lock-free, does not allocate and makes no
+ * system calls.
+ *
+ * \return Token to pass to IniConfigReaders_leave()
+ */
+unsigned int IniConfigReaders_enter( IniConfigReaders *self );
+
+/*!
+ * \brief End a lookup
+ *
+ * \param self    Pointer to the IniConfigReaders
+ * \param reader  Token returned by IniConfigReaders_enter()
+ *
+ * \return Nothing
+ */
+void IniConfigReaders_leave( IniConfigReaders *self, unsigned int reader );
+
+/*!
+ * \brief Wait until no lookup sees a replaced version any more
+ *
+ * \param self Pointer to the IniConfigReaders
+ *
+ * To be called after the new version has been stored with
+ * __ATOMIC_SEQ_CST ordering. Writers must be serialized among themselves
+ * and must not call it from within a lookup.
+ *
+ * \return Nothing
+ */
+void IniConfigReaders_synchronize( IniConfigReaders *self );
+
+/*!
+ * \brief Clear an IniConfigReaders instance
+ *
+ * \param self Pointer to the IniConfigReaders
+ *
+ * No lookup may be under way.
+ *
+ * \return Nothing
+ */
+void IniConfigReaders_clear( IniConfigReaders *self );
+
+/*!
+ * \brief Delete an IniConfigReaders instance
+ *
+ * \param self Pointer to the IniConfigReaders
+ *
+ * \return Nothing
+ */
+void IniConfigReaders_delete( IniConfigReaders *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGREADERS_H */
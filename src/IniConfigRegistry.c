@@ -0,0 +1,499 @@
+/*
+ *  Process-wide sharing of frozen files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <IniConfigRegistry.h>
+
+
+typedef struct IniConfigRegistrySlot
+{
+    const void *owner;
+    IniConfigRegistryListener listener;
+    void *context;
+}
+IniConfigRegistrySlot;
+
+typedef struct IniConfigRegistryEntry
+{
+    struct IniConfigRegistryEntry *next;
+    char *fileName;                     /* path of the first load, for reloads and listeners */
+    int textFlags;
+    int indexFlags;
+    int perNode;
+    IniConfigRegistryVersion *current;
+    int numVersions;                    /* current and older versions still in use */
+    unsigned long generation;
+    IniConfigRegistrySlot *listeners;
+    int numListeners;
+    int maxListeners;
+    int numNotifying;                   /* threads calling copies of the listeners */
+}
+IniConfigRegistryEntry;
+
+
+/* guards the entries, their listeners and all reference counts */
+static pthread_mutex_t IniConfigRegistry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t IniConfigRegistry_notified = PTHREAD_COND_INITIALIZER;
+static IniConfigRegistryEntry *IniConfigRegistry_entries = NULL;
+
+/* non-zero while the thread calls listeners, which must not wait for themselves */
+static __thread int IniConfigRegistry_inListener = 0;
+
+
+/*
+ * Private functions
+ */
+
+static void IniConfigRegistry_freeVersion( IniConfigRegistryVersion *version )
+{
+    if( version->replicas != NULL )
+    {
+        IniConfigReplicas_clear( version->replicas );
+        IniConfigReplicas_delete( version->replicas );
+    }
+
+    if( version->document != NULL )
+    {
+        IniConfigDocument_clear( version->document );
+        IniConfigDocument_delete( version->document );
+    }
+
+    ANY_FREE( version );
+}
+
+
+/*
+ * Loads a version without the lock, it belongs to no entry yet
+ */
+static IniConfigRegistryVersion *IniConfigRegistry_loadVersion( const char *fileName, int textFlags, int indexFlags,
+                                                                int perNode )
+{
+    IniConfigRegistryVersion *version = ANY_TALLOC( IniConfigRegistryVersion );
+    IniConfigReplicas *replicas = NULL;
+    IniConfigDocument *document = NULL;
+
+    if( version == NULL )
+    {
+        return NULL;
+    }
+
+    document = IniConfigDocument_new();
+
+    if( document == NULL || !IniConfigDocument_init( document ) )
+    {
+        ANY_FREE( document );
+        goto fail;
+    }
+
+    version->document = document;
+
+    IniConfigDocument_setTextFlags( document, textFlags );
+
+    if( !IniConfigDocument_load( document, fileName ) || !IniConfigDocument_updateOrder( document ) )
+    {
+        goto fail;
+    }
+
+    replicas = IniConfigReplicas_new();
+
+    if( replicas == NULL || !IniConfigReplicas_init( replicas, perNode ? true : false ) )
+    {
+        ANY_FREE( replicas );
+        goto fail;
+    }
+
+    version->replicas = replicas;
+
+    if( !IniConfigReplicas_build( replicas, document, indexFlags ) )
+    {
+        goto fail;
+    }
+
+    return version;
+
+    fail:
+
+    ANY_LOG( 0, "Unable to load the shared file '%s'", ANY_LOG_ERROR, fileName );
+    IniConfigRegistry_freeVersion( version );
+
+    return NULL;
+}
+
+
+/*
+ * Makes a loaded version the current one of an entry, which holds a
+ * reference to it
+ */
+static void IniConfigRegistry_install( IniConfigRegistryEntry *entry, IniConfigRegistryVersion *version )
+{
+    version->generation = ++entry->generation;
+    version->refCount = 1;
+    version->entry = entry;
+
+    entry->current = version;
+    entry->numVersions++;
+}
+
+
+static bool IniConfigRegistry_isCurrent( const IniConfigRegistryVersion *version, const struct stat *st )
+{
+    const IniConfigDocumentStamp *stamp = &version->document->stamp;
+
+    return ( stamp->device == (unsigned long long)st->st_dev &&
+             stamp->inode == (unsigned long long)st->st_ino &&
+             stamp->size == (long long)st->st_size &&
+             stamp->mtimeSec == (long long)st->st_mtim.tv_sec &&
+             stamp->mtimeNsec == (long)st->st_mtim.tv_nsec );
+}
+
+
+/*
+ * Finds the entry of a file by its inode, or by its path if it has been
+ * replaced, e.g. by an atomic save
+ */
+static IniConfigRegistryEntry *IniConfigRegistry_find( const char *fileName, unsigned long long device,
+                                                      unsigned long long inode, int textFlags, int indexFlags,
+                                                      int perNode )
+{
+    IniConfigRegistryEntry *entry = NULL;
+    IniConfigRegistryEntry *byName = NULL;
+
+    for( entry = IniConfigRegistry_entries; entry != NULL; entry = entry->next )
+    {
+        const IniConfigDocumentStamp *stamp = &entry->current->document->stamp;
+
+        if( entry->textFlags != textFlags || entry->indexFlags != indexFlags || entry->perNode != perNode )
+        {
+            continue;
+        }
+
+        if( stamp->device == device && stamp->inode == inode )
+        {
+            return entry;
+        }
+
+        if( byName == NULL && strcmp( entry->fileName, fileName ) == 0 )
+        {
+            byName = entry;
+        }
+    }
+
+    return byName;
+}
+
+
+static void IniConfigRegistry_unlink( IniConfigRegistryEntry *entry )
+{
+    IniConfigRegistryEntry **link = &IniConfigRegistry_entries;
+
+    while( *link != entry )
+    {
+        link = &( *link )->next;
+    }
+
+    *link = entry->next;
+
+    ANY_FREE( entry->listeners );
+    ANY_FREE( entry->fileName );
+    ANY_FREE( entry );
+}
+
+
+/*
+ * Drops one reference, the entry goes with the last reference to its
+ * last version
+ */
+static void IniConfigRegistry_unref( IniConfigRegistryVersion *version )
+{
+    IniConfigRegistryEntry *entry = version->entry;
+
+    if( --version->refCount == 0 )
+    {
+        entry->numVersions--;
+        IniConfigRegistry_freeVersion( version );
+    }
+
+    if( entry->numVersions == 1 && entry->current->refCount == 1 )
+    {
+        IniConfigRegistry_freeVersion( entry->current );
+        IniConfigRegistry_unlink( entry );
+    }
+}
+
+
+/*
+ * Copies the listeners of an entry, to call them without the lock
+ */
+static IniConfigRegistrySlot *IniConfigRegistry_copyListeners( const IniConfigRegistryEntry *entry, int *count )
+{
+    IniConfigRegistrySlot *slots = NULL;
+
+    *count = 0;
+
+    if( entry->numListeners == 0 )
+    {
+        return NULL;
+    }
+
+    slots = ANY_NTALLOC( entry->numListeners, IniConfigRegistrySlot );
+
+    if( slots != NULL )
+    {
+        memcpy( slots, entry->listeners, entry->numListeners * sizeof( IniConfigRegistrySlot ) );
+        *count = entry->numListeners;
+    }
+
+    return slots;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigRegistryVersion *IniConfigRegistry_acquire( const char *fileName, int textFlags, int indexFlags,
+                                                     bool perNode )
+{
+    IniConfigRegistryVersion *version = NULL;
+    IniConfigRegistryVersion *fresh = NULL;
+    IniConfigRegistryEntry *entry = NULL;
+    IniConfigRegistryEntry *seen = NULL;
+    IniConfigRegistrySlot *notify = NULL;
+    unsigned long seenGeneration = 0;
+    unsigned long generation = 0;
+    char *loadName = NULL;
+    char *changed = NULL;
+    int numNotify = 0;
+    struct stat st;
+    int i = 0;
+
+    ANY_REQUIRE( fileName );
+
+    if( stat( fileName, &st ) != 0 )
+    {
+        ANY_LOG( 0, "Unable to share '%s', it does not exist", ANY_LOG_ERROR, fileName );
+        return NULL;
+    }
+
+    pthread_mutex_lock( &IniConfigRegistry_lock );
+
+    entry = IniConfigRegistry_find( fileName, (unsigned long long)st.st_dev, (unsigned long long)st.st_ino,
+                                    textFlags, indexFlags, perNode ? 1 : 0 );
+
+    if( entry != NULL && IniConfigRegistry_isCurrent( entry->current, &st ) )
+    {
+        version = entry->current;
+        version->refCount++;
+
+        pthread_mutex_unlock( &IniConfigRegistry_lock );
+
+        return version;
+    }
+
+    /* whoever notices a change loads the file without the lock, the others keep acquiring */
+    seen = entry;
+    seenGeneration = ( entry != NULL ) ? entry->generation : 0;
+    loadName = Any_strdup( (char *)( ( entry != NULL ) ? entry->fileName : fileName ) );
+
+    pthread_mutex_unlock( &IniConfigRegistry_lock );
+
+    fresh = ( loadName != NULL ) ? IniConfigRegistry_loadVersion( loadName, textFlags, indexFlags, perNode ) : NULL;
+
+    if( fresh == NULL )
+    {
+        ANY_FREE( loadName );
+        return NULL;
+    }
+
+    pthread_mutex_lock( &IniConfigRegistry_lock );
+
+    entry = IniConfigRegistry_find( loadName, fresh->document->stamp.device, fresh->document->stamp.inode,
+                                    textFlags, indexFlags, perNode ? 1 : 0 );
+
+    if( entry == NULL )
+    {
+        entry = ANY_TALLOC( IniConfigRegistryEntry );
+
+        if( entry == NULL )
+        {
+            goto out;
+        }
+
+        entry->fileName = loadName;
+        entry->textFlags = textFlags;
+        entry->indexFlags = indexFlags;
+        entry->perNode = perNode ? 1 : 0;
+
+        loadName = NULL;
+
+        IniConfigRegistry_install( entry, fresh );
+
+        entry->next = IniConfigRegistry_entries;
+        IniConfigRegistry_entries = entry;
+
+        version = fresh;
+        version->refCount++;
+        fresh = NULL;
+    }
+    else if( entry != seen || entry->generation != seenGeneration )
+    {
+        /* another thread got there first, its version is the one to share */
+        version = entry->current;
+        version->refCount++;
+    }
+    else
+    {
+        notify = IniConfigRegistry_copyListeners( entry, &numNotify );
+        changed = Any_strdup( entry->fileName );
+
+        /* the caller's reference keeps the entry while the old version goes */
+        version = entry->current;
+        IniConfigRegistry_install( entry, fresh );
+        fresh->refCount++;
+        IniConfigRegistry_unref( version );
+
+        version = fresh;
+        generation = version->generation;
+        fresh = NULL;
+
+        if( numNotify > 0 && changed != NULL )
+        {
+            entry->numNotifying++;
+        }
+    }
+
+    out:
+
+    pthread_mutex_unlock( &IniConfigRegistry_lock );
+
+    if( fresh != NULL )
+    {
+        IniConfigRegistry_freeVersion( fresh );
+    }
+
+    if( numNotify > 0 && changed != NULL )
+    {
+        IniConfigRegistry_inListener++;
+
+        for( i = 0; i < numNotify; i++ )
+        {
+            notify[i].listener( notify[i].context, changed, generation );
+        }
+
+        IniConfigRegistry_inListener--;
+
+        /* removals of listeners wait for this */
+        pthread_mutex_lock( &IniConfigRegistry_lock );
+
+        if( --version->entry->numNotifying == 0 )
+        {
+            pthread_cond_broadcast( &IniConfigRegistry_notified );
+        }
+
+        pthread_mutex_unlock( &IniConfigRegistry_lock );
+    }
+
+    ANY_FREE( notify );
+    ANY_FREE( changed );
+    ANY_FREE( loadName );
+
+    return version;
+}
+
+
+void IniConfigRegistry_release( IniConfigRegistryVersion *version )
+{
+    ANY_REQUIRE( version );
+
+    pthread_mutex_lock( &IniConfigRegistry_lock );
+
+    IniConfigRegistry_unref( version );
+
+    pthread_mutex_unlock( &IniConfigRegistry_lock );
+}
+
+
+bool IniConfigRegistry_setListener( IniConfigRegistryVersion *version, const void *owner,
+                                    IniConfigRegistryListener listener, void *context )
+{
+    IniConfigRegistryEntry *entry = NULL;
+    bool retVal = true;
+    int i = 0;
+
+    ANY_REQUIRE( version );
+    ANY_REQUIRE( owner );
+
+    pthread_mutex_lock( &IniConfigRegistry_lock );
+
+    entry = version->entry;
+
+    for( i = 0; i < entry->numListeners && entry->listeners[i].owner != owner; i++ )
+    {
+    }
+
+    if( listener == NULL )
+    {
+        if( i < entry->numListeners )
+        {
+            entry->listeners[i] = entry->listeners[--entry->numListeners];
+
+            /* copies taken before may still be called, a listener cannot wait for itself */
+            while( entry->numNotifying > 0 && IniConfigRegistry_inListener == 0 )
+            {
+                pthread_cond_wait( &IniConfigRegistry_notified, &IniConfigRegistry_lock );
+            }
+        }
+
+        goto out;
+    }
+
+    if( i == entry->maxListeners )
+    {
+        int maxListeners = ( entry->maxListeners != 0 ) ? entry->maxListeners * 2 : 4;
+        IniConfigRegistrySlot *listeners = NULL;
+
+        listeners = (IniConfigRegistrySlot *)realloc( entry->listeners, maxListeners * sizeof( IniConfigRegistrySlot ) );
+
+        if( listeners == NULL )
+        {
+            retVal = false;
+            goto out;
+        }
+
+        entry->listeners = listeners;
+        entry->maxListeners = maxListeners;
+    }
+
+    if( i == entry->numListeners )
+    {
+        entry->numListeners++;
+    }
+
+    entry->listeners[i].owner = owner;
+    entry->listeners[i].listener = listener;
+    entry->listeners[i].context = context;
+
+    out:
+
+    pthread_mutex_unlock( &IniConfigRegistry_lock );
+
+    return retVal;
+}
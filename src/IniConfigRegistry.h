@@ -0,0 +1,122 @@
+/*
+ *  Process-wide sharing of frozen files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigRegistry Shared files
+ *
+ * Libraries of one process often read the same configuration file, each
+ * through its own IniConfigFile. IniConfigFile_loadShared() lets them
+ * share one frozen copy: the registry keeps every such file once,
+ * identified by device and inode, so that different paths to the same
+ * file share as well.
+ *
+ * A shared copy is a version: an immutable document with the index
+ * answering the gets, counted by the files using it. The first
+ * IniConfigFile_loadShared() of a file loads a version, further ones just
+ * take a reference. A call which finds that the file changed on disk
+ * loads a new version once for everybody and calls the listeners set with
+ * IniConfigFile_setListener(); files stay on their version until they
+ * call IniConfigFile_loadShared() again, which costs no parsing as long
+ * as the file did not change once more. A version is freed when its last
+ * file lets go of it.
+ *
+ * Files loaded with different IniConfigTextFlags, index flags or NUMA
+ * replica settings get versions of their own.
+ */
+
+#ifndef INICONFIGREGISTRY_H
+#define INICONFIGREGISTRY_H
+
+#include <IniConfigDocument.h>
+#include <IniConfigReplicas.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Called after a new version of a shared file has been loaded
+ *
+ * Runs in the thread which found the change, without any lock held, so it
+ * may call IniConfigFile_loadShared().
+ */
+typedef void ( *IniConfigRegistryListener )( void *context, const char *fileName, unsigned long generation );
+
+struct IniConfigRegistryEntry;
+
+/*!
+ * \brief One loaded version of a shared file
+ */
+typedef struct IniConfigRegistryVersion
+{
+    IniConfigDocument *document;        /**< Frozen document, for listings */
+    IniConfigReplicas *replicas;        /**< Index answering the gets */
+    unsigned long generation;           /**< Number of the version, starting at 1 */
+    int refCount;                       /**< Users, including the entry while current */
+    struct IniConfigRegistryEntry *entry; /**< File the version belongs to */
+}
+IniConfigRegistryVersion;
+
+/*!
+ * \brief Get the current version of a file, loading it if needed
+ *
+ * \param fileName    Name of the INI file
+ * \param textFlags   IniConfigTextFlags of the load
+ * \param indexFlags  IniConfigIndexFlags of the index
+ * \param perNode     Keep a copy of the index on every NUMA node
+ *
+ * Loads a new version if the file changed since the current one was
+ * loaded, and calls the listeners of the file after that.
+ *
+ * \return The version with a reference for the caller, NULL if the file
+ *         does not exist or cannot be loaded
+ */
+IniConfigRegistryVersion *IniConfigRegistry_acquire( const char *fileName, int textFlags, int indexFlags,
+                                                     bool perNode );
+
+/*!
+ * \brief Give up a reference to a version
+ *
+ * \param version  Version returned by IniConfigRegistry_acquire()
+ *
+ * \return Nothing
+ */
+void IniConfigRegistry_release( IniConfigRegistryVersion *version );
+
+/*!
+ * \brief Set the listener of a user of a file
+ *
+ * \param version   Version of the file, held by the caller
+ * \param owner     Identifies the user, one listener per user and file
+ * \param listener  Function to call, NULL to remove the listener
+ * \param context   Passed to listener
+ *
+ * Listeners are called without the lock of the registry. Removing one
+ * waits until the calls of listeners of the file already under way have
+ * returned, so that the context may be freed afterwards. Removals from
+ * within a listener do not wait, a listener running in another thread at
+ * the same time may still be called with the old context.
+ *
+ * \return Returns false if memory ran out
+ */
+bool IniConfigRegistry_setListener( IniConfigRegistryVersion *version, const void *owner,
+                                    IniConfigRegistryListener listener, void *context );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGREGISTRY_H */
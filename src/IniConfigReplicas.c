@@ -0,0 +1,267 @@
+/*
+ *  Per NUMA node copies of an index
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <Any.h>
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <IniConfigReplicas.h>
+
+#define INICONFIGREPLICAS_VALID     0x2b7d51e6
+#define INICONFIGREPLICAS_INVALID   0xb00db00f
+
+
+/*
+ * Private functions
+ */
+
+/*
+ * Assigns the CPUs of a list like "0-3,8-11" to a node, returns false if
+ * the node does not exist
+ */
+static bool IniConfigReplicas_readNode( IniConfigReplicas *self, int node )
+{
+    char path[64];
+    char line[1024];
+    char *pos = line;
+    FILE *fp = NULL;
+
+    Any_snprintf( path, sizeof( path ), "/sys/devices/system/node/node%d/cpulist", node );
+
+    fp = fopen( path, "r" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    if( fgets( line, sizeof( line ), fp ) == NULL )
+    {
+        line[0] = '\0';
+    }
+
+    fclose( fp );
+
+    while( *pos >= '0' && *pos <= '9' )
+    {
+        long first = strtol( pos, &pos, 10 );
+        long last = first;
+        long cpu = 0;
+
+        if( *pos == '-' )
+        {
+            last = strtol( pos + 1, &pos, 10 );
+        }
+
+        for( cpu = first; cpu <= last && cpu < self->numCpus; cpu++ )
+        {
+            self->nodeOfCpu[cpu] = node;
+        }
+
+        if( *pos == ',' )
+        {
+            pos++;
+        }
+    }
+
+    return true;
+}
+
+
+static void IniConfigReplicas_readTopology( IniConfigReplicas *self )
+{
+    int node = 0;
+
+    self->numCpus = (int)sysconf( _SC_NPROCESSORS_CONF );
+
+    if( self->numCpus < 1 )
+    {
+        self->numCpus = 1;
+    }
+
+    self->nodeOfCpu = ANY_NTALLOC( self->numCpus, int );
+
+    /* node numbers may have gaps, a missing node just gets an unused copy */
+    for( node = 0; node < INICONFIGREPLICAS_MAXNODES; node++ )
+    {
+        if( IniConfigReplicas_readNode( self, node ) )
+        {
+            self->numNodes = node + 1;
+        }
+    }
+}
+
+
+static void IniConfigReplicas_empty( IniConfigReplicas *self )
+{
+    int i = 0;
+
+    for( i = 0; i < self->numNodes; i++ )
+    {
+        IniConfigIndex_clear( &self->replicas[i] );
+        IniConfigIndex_init( &self->replicas[i] );
+    }
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigReplicas *IniConfigReplicas_new( void )
+{
+    return ( ANY_TALLOC( IniConfigReplicas ) );
+}
+
+
+bool IniConfigReplicas_init( IniConfigReplicas *self, bool perNode )
+{
+    int i = 0;
+
+    ANY_REQUIRE( self );
+
+    self->numNodes = 1;
+    self->nodeOfCpu = NULL;
+    self->numCpus = 0;
+
+    if( perNode )
+    {
+        IniConfigReplicas_readTopology( self );
+    }
+
+    self->replicas = ANY_NTALLOC( self->numNodes, IniConfigIndex );
+
+    for( i = 0; i < self->numNodes; i++ )
+    {
+        IniConfigIndex_init( &self->replicas[i] );
+    }
+
+    self->valid = INICONFIGREPLICAS_VALID;
+
+    return true;
+}
+
+
+bool IniConfigReplicas_build( IniConfigReplicas *self, const IniConfigDocument *document, int flags )
+{
+    IniConfigIndex master;
+    bool retVal = true;
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREPLICAS_VALID );
+    ANY_REQUIRE( document );
+
+    if( self->numNodes == 1 )
+    {
+        return IniConfigIndex_build( &self->replicas[0], document, flags );
+    }
+
+    IniConfigIndex_init( &master );
+
+    retVal = IniConfigIndex_build( &master, document, flags );
+
+    for( i = 0; i < self->numNodes && retVal; i++ )
+    {
+        retVal = IniConfigIndex_copy( &self->replicas[i], &master, i );
+    }
+
+    IniConfigIndex_clear( &master );
+
+    if( !retVal )
+    {
+        IniConfigReplicas_empty( self );
+    }
+
+    return retVal;
+}
+
+
+const IniConfigIndex *IniConfigReplicas_getLocal( const IniConfigReplicas *self )
+{
+    int cpu = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREPLICAS_VALID );
+
+    if( self->numNodes == 1 )
+    {
+        return &self->replicas[0];
+    }
+
+    cpu = sched_getcpu();
+
+    return ( cpu >= 0 && cpu < self->numCpus ) ? &self->replicas[self->nodeOfCpu[cpu]] : &self->replicas[0];
+}
+
+
+const IniConfigIndex *IniConfigReplicas_getReplica( const IniConfigReplicas *self, int node )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREPLICAS_VALID );
+    ANY_REQUIRE( node >= 0 && node < self->numNodes );
+
+    return &self->replicas[node];
+}
+
+
+int IniConfigReplicas_getNumNodes( const IniConfigReplicas *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREPLICAS_VALID );
+
+    return self->numNodes;
+}
+
+
+void IniConfigReplicas_clear( IniConfigReplicas *self )
+{
+    int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGREPLICAS_VALID );
+
+    for( i = 0; i < self->numNodes; i++ )
+    {
+        IniConfigIndex_clear( &self->replicas[i] );
+    }
+
+    ANY_FREE( self->replicas );
+
+    if( self->nodeOfCpu != NULL )
+    {
+        ANY_FREE( self->nodeOfCpu );
+    }
+
+    self->replicas = NULL;
+    self->nodeOfCpu = NULL;
+
+    self->valid = INICONFIGREPLICAS_INVALID;
+}
+
+
+void IniConfigReplicas_delete( IniConfigReplicas *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
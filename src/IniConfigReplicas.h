@@ -0,0 +1,151 @@
+/*
+ *  Per NUMA node copies of an index
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigReplicas NUMA replicas
+ *
+ * On machines with several NUMA nodes every lookup in memory of a remote
+ * node pays the cross-socket latency. IniConfigReplicas keeps one copy of
+ * an IniConfigIndex in the memory of every node, and
+ * IniConfigReplicas_getLocal() returns the copy of the node the calling
+ * thread runs on.
+ *
+ * The node layout is read from /sys/devices/system/node when the replicas
+ * are initialized. Machines with a single node, or without that
+ * directory, get a single copy and no per-lookup node check. Copies are
+ * placed with mbind(), so no NUMA library is needed at build or run time.
+ *
+ * IniConfigFile_setNumaReplicas() makes IniConfigFile_freeze() use
+ * replicas, so the get functions of a frozen file answer from the local
+ * copy.
+ */
+
+#ifndef INICONFIGREPLICAS_H
+#define INICONFIGREPLICAS_H
+
+#include <IniConfigIndex.h>
+
+/*!
+ * \brief Highest number of NUMA nodes looked for
+ */
+#define INICONFIGREPLICAS_MAXNODES  64
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief IniConfigReplicas definition
+ */
+typedef struct IniConfigReplicas
+{
+    unsigned long valid;                /**< Object validity */
+    IniConfigIndex *replicas;           /**< One index per node */
+    int numNodes;                       /**< Number of replicas */
+    int *nodeOfCpu;                     /**< NUMA node of every CPU */
+    int numCpus;                        /**< Number of entries in nodeOfCpu */
+}
+IniConfigReplicas;
+
+/*!
+ * \brief Allocate a new IniConfigReplicas instance
+ *
+ * \return A new IniConfigReplicas instance, NULL on error
+ *
+ * \see IniConfigReplicas_init()
+ */
+IniConfigReplicas *IniConfigReplicas_new( void );
+
+/*!
+ * \brief Initialize empty replicas
+ *
+ * \param self     Pointer to the IniConfigReplicas
+ * \param perNode  true for one copy per NUMA node, false for a single copy
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigReplicas_init( IniConfigReplicas *self, bool perNode );
+
+/*!
+ * \brief Replace the contents of all replicas with the keys of a document
+ *
+ * \param self      Pointer to the IniConfigReplicas
+ * \param document  Document to copy the keys from
+ * \param flags     Or-ed IniConfigIndexFlags
+ *
+ * No reader may use the replicas while they are rebuilt.
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigIndex_build()
+ */
+bool IniConfigReplicas_build( IniConfigReplicas *self, const IniConfigDocument *document, int flags );
+
+/*!
+ * \brief Return the copy in the memory of the calling thread's node
+ *
+ * \param self Pointer to the IniConfigReplicas
+ *
+ * Uses sched_getcpu(), which glibc answers without entering the kernel on
+ * current systems. A thread migrating to another node right afterwards
+ * still reads a valid copy, only a remote one.
+ *
+ * \return The local replica
+ */
+const IniConfigIndex *IniConfigReplicas_getLocal( const IniConfigReplicas *self );
+
+/*!
+ * \brief Return the copy of a given node
+ *
+ * \param self  Pointer to the IniConfigReplicas
+ * \param node  Node number, less than IniConfigReplicas_getNumNodes()
+ *
+ * \return The replica of the node
+ */
+const IniConfigIndex *IniConfigReplicas_getReplica( const IniConfigReplicas *self, int node );
+
+/*!
+ * \brief Return the number of copies
+ *
+ * \param self Pointer to the IniConfigReplicas
+ *
+ * \return Number of replicas, 1 on single-node machines
+ */
+int IniConfigReplicas_getNumNodes( const IniConfigReplicas *self );
+
+/*!
+ * \brief Clear an IniConfigReplicas instance
+ *
+ * \param self Pointer to the IniConfigReplicas
+ *
+ * \return Nothing
+ */
+void IniConfigReplicas_clear( IniConfigReplicas *self );
+
+/*!
+ * \brief Delete an IniConfigReplicas instance
+ *
+ * \param self Pointer to the IniConfigReplicas
+ *
+ * \return Nothing
+ */
+void IniConfigReplicas_delete( IniConfigReplicas *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGREPLICAS_H */
@@ -0,0 +1,273 @@
+/*
+ *  View on the keys of one section
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IniConfigHamt.h>
+#include <IniConfigSection.h>
+
+#define INICONFIGSECTION_VALID      0x47c2a9d3
+#define INICONFIGSECTION_INVALID    0xb00db00f
+
+
+/*
+ * Private functions
+ */
+
+static int IniConfigSection_copy( const char *value, char *buffer, int bufferSize )
+{
+    size_t length = strlen( value );
+
+    if( length > (size_t)bufferSize - 1 )
+    {
+        length = (size_t)bufferSize - 1;
+    }
+
+    memcpy( buffer, value, length );
+    buffer[length] = '\0';
+
+    return (int)length;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigSection *IniConfigSection_new( void )
+{
+    return ( ANY_TALLOC( IniConfigSection ) );
+}
+
+
+bool IniConfigSection_init( IniConfigSection *self, const IniConfigFile *file, const char *section )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( file );
+
+    self->valid = INICONFIGSECTION_INVALID;
+    self->file = file;
+    self->name = NULL;
+    self->hash = IniConfigHamt_hashSection( ( section != NULL ) ? section : "" );
+
+    if( section != NULL )
+    {
+        self->name = Any_strdup( (char *)section );
+
+        if( self->name == NULL )
+        {
+            return false;
+        }
+    }
+
+    self->valid = INICONFIGSECTION_VALID;
+
+    return true;
+}
+
+
+const char *IniConfigSection_getName( const IniConfigSection *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+
+    return self->name;
+}
+
+
+int IniConfigSection_getString( const IniConfigSection *self, const char *key, const char *defValue,
+                                char *buffer, int bufferSize )
+{
+    const IniConfigFile *file = NULL;
+    const IniConfigIndex *index = NULL;
+    const char *section = NULL;
+    const char *value = NULL;
+    unsigned int hash = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+
+    file = self->file;
+
+    /* without a loaded document there is no hash to save, IniConfigFile_refreeze() never unloads it */
+    if( __atomic_load_n( &file->document, __ATOMIC_RELAXED ) == NULL && file->exchange == NULL )
+    {
+        return IniConfigFile_getString( file, self->name, key, defValue, buffer, bufferSize );
+    }
+
+    section = ( self->name != NULL ) ? self->name : "";
+    hash = IniConfigHamt_hashKey( self->hash, key );
+
+    if( file->exchange != NULL )
+    {
+        index = IniConfigExchange_getCurrent( file->exchange );
+        value = ( index != NULL ) ? IniConfigIndex_findHashed( index, hash, section, key ) : NULL;
+    }
+    else if( __atomic_load_n( &file->frozen, __ATOMIC_RELAXED ) != NULL )
+    {
+        /* the value is copied out before IniConfigFile_refreeze() may free it */
+        unsigned int reader = IniConfigReaders_enter( file->readers );
+        int len = 0;
+
+        index = IniConfigReplicas_getLocal( __atomic_load_n( &file->frozen, __ATOMIC_SEQ_CST ) );
+        value = IniConfigIndex_findHashed( index, hash, section, key );
+        len = IniConfigSection_copy( ( value != NULL ) ? value : ( defValue != NULL ) ? defValue : "",
+                                     buffer, bufferSize );
+
+        IniConfigReaders_leave( file->readers, reader );
+
+        return len;
+    }
+    else
+    {
+        int len = IniConfigStore_getHashed( file->store, hash, section, key, buffer, bufferSize, NULL );
+
+        if( len != INICONFIGSTORE_ABSENT )
+        {
+            return len;
+        }
+    }
+
+    if( value == NULL )
+    {
+        value = ( defValue != NULL ) ? defValue : "";
+    }
+
+    return IniConfigSection_copy( value, buffer, bufferSize );
+}
+
+
+long IniConfigSection_getLong( const IniConfigSection *self, const char *key, long defValue )
+{
+    char buff[64];
+    int len = IniConfigSection_getString( self, key, "", buff, 64 );
+
+    /* same conversion as IniConfigFile_getLong() */
+    if( len == 0 )
+    {
+        return defValue;
+    }
+
+    return ( len >= 2 && toupper( (int)buff[1] ) == 'X' ) ? strtol( buff, NULL, 16 ) : strtol( buff, NULL, 10 );
+}
+
+
+int IniConfigSection_getInt( const IniConfigSection *self, const char *key, int defValue )
+{
+    char buff[64];
+    int len = IniConfigSection_getString( self, key, "", buff, 64 );
+
+    return ( len == 0 ? defValue : atoi( buff ) );
+}
+
+
+double IniConfigSection_getDouble( const IniConfigSection *self, const char *key, double defValue )
+{
+    char buff[64];
+    int len = IniConfigSection_getString( self, key, "", buff, 64 );
+
+    return ( len == 0 ? defValue : strtod( buff, NULL ) );
+}
+
+
+int IniConfigSection_getKey( const IniConfigSection *self, int idx, char *buffer, int bufferSize )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+
+    return IniConfigFile_getKey( self->file, self->name, idx, buffer, bufferSize );
+}
+
+
+int IniConfigSection_putString( const IniConfigSection *self, const char *key, const char *value )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+    ANY_REQUIRE( key );
+
+    return IniConfigFile_putString( self->file, self->name, key, value );
+}
+
+
+int IniConfigSection_putLong( const IniConfigSection *self, const char *key, long value )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+    ANY_REQUIRE( key );
+
+    return IniConfigFile_putLong( self->file, self->name, key, value );
+}
+
+
+int IniConfigSection_putInt( const IniConfigSection *self, const char *key, int value )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+    ANY_REQUIRE( key );
+
+    return IniConfigFile_putInt( self->file, self->name, key, value );
+}
+
+
+int IniConfigSection_putDouble( const IniConfigSection *self, const char *key, double value )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+    ANY_REQUIRE( key );
+
+    return IniConfigFile_putDouble( self->file, self->name, key, value );
+}
+
+
+void IniConfigSection_removeKey( const IniConfigSection *self, const char *key )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+    ANY_REQUIRE( key );
+
+    IniConfigFile_removeKey( self->file, self->name, key );
+}
+
+
+void IniConfigSection_clear( IniConfigSection *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSECTION_VALID );
+
+    if( self->name != NULL )
+    {
+        ANY_FREE( self->name );
+        self->name = NULL;
+    }
+
+    self->file = NULL;
+
+    self->valid = INICONFIGSECTION_INVALID;
+}
+
+
+void IniConfigSection_delete( IniConfigSection *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
@@ -0,0 +1,240 @@
+/*
+ *  View on the keys of one section
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigSection Section views
+ *
+ * Code usually reads many keys of the same section. An IniConfigSection
+ * is obtained once per section and offers the get and put functions of
+ * IniConfigFile without the section argument:
+ *
+ * \code
+ *  IniConfigSection *arm = IniConfigSection_new();
+ *
+ *  IniConfigSection_init( arm, myIniFile, "Arm" );
+ *
+ *  kp = IniConfigSection_getDouble( arm, "kp", 1.0 );
+ *  ki = IniConfigSection_getDouble( arm, "ki", 0.0 );
+ *  IniConfigSection_putLong( arm, "cycles", cycles );
+ * \endcode
+ *
+ * Keys of loaded, frozen and double-buffered files are found by one hash
+ * over section and key name. The view hashes the lower-cased section name
+ * once when it is created, so each lookup only hashes the key. Views only
+ * keep the section name, so they stay valid across
+ * IniConfigFile_load(); a view must be cleared before its file.
+ */
+
+#ifndef INICONFIGSECTION_H
+#define INICONFIGSECTION_H
+
+#include <IniConfigFile.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief IniConfigSection definition
+ */
+typedef struct IniConfigSection
+{
+    unsigned long valid;                /**< Object validity */
+    const IniConfigFile *file;          /**< File the section belongs to */
+    char *name;                         /**< Section name, NULL for the global area */
+    unsigned int hash;                  /**< IniConfigHamt_hashSection() of the name */
+}
+IniConfigSection;
+
+/*!
+ * \brief Allocate a new IniConfigSection instance
+ *
+ * \return A new IniConfigSection instance, NULL on error
+ *
+ * \see IniConfigSection_init()
+ */
+IniConfigSection *IniConfigSection_new( void );
+
+/*!
+ * \brief Initialize a view on a section
+ *
+ * \param self     Pointer to the IniConfigSection
+ * \param file     File holding the section
+ * \param section  Section name, NULL for the global area. The section
+ *                 need not exist yet.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigSection_init( IniConfigSection *self, const IniConfigFile *file, const char *section );
+
+/*!
+ * \brief Return the name of the section
+ *
+ * \param self Pointer to the IniConfigSection
+ *
+ * \return The name given to IniConfigSection_init(), NULL for the global area
+ */
+const char *IniConfigSection_getName( const IniConfigSection *self );
+
+/*!
+ * \brief Get a string
+ *
+ * \param self        Pointer to the IniConfigSection
+ * \param key         Key name
+ * \param defValue    Returned if the key does not exist
+ * \param buffer      Receives the value, truncated to bufferSize - 1 characters
+ * \param bufferSize  Size of buffer
+ *
+ * \return The number of characters copied into buffer
+ *
+ * \see IniConfigFile_getString()
+ */
+int IniConfigSection_getString( const IniConfigSection *self, const char *key, const char *defValue,
+                                char *buffer, int bufferSize );
+
+/*!
+ * \brief Get a long, "0x" prefixed values are read as hexadecimal
+ *
+ * \param self      Pointer to the IniConfigSection
+ * \param key       Key name
+ * \param defValue  Returned if the key does not exist
+ *
+ * \return The value of the key
+ *
+ * \see IniConfigFile_getLong()
+ */
+long IniConfigSection_getLong( const IniConfigSection *self, const char *key, long defValue );
+
+/*!
+ * \brief Get an int
+ *
+ * \param self      Pointer to the IniConfigSection
+ * \param key       Key name
+ * \param defValue  Returned if the key does not exist
+ *
+ * \return The value of the key
+ *
+ * \see IniConfigFile_getInt()
+ */
+int IniConfigSection_getInt( const IniConfigSection *self, const char *key, int defValue );
+
+/*!
+ * \brief Get a double
+ *
+ * \param self      Pointer to the IniConfigSection
+ * \param key       Key name
+ * \param defValue  Returned if the key does not exist
+ *
+ * \return The value of the key
+ *
+ * \see IniConfigFile_getDouble()
+ */
+double IniConfigSection_getDouble( const IniConfigSection *self, const char *key, double defValue );
+
+/*!
+ * \brief Return the name of a key of the section
+ *
+ * \param self        Pointer to the IniConfigSection
+ * \param idx         Zero-based number of the key
+ * \param buffer      Receives the key name
+ * \param bufferSize  Size of buffer
+ *
+ * Together with an increasing idx this iterates over the keys of the
+ * section, like IniConfigFile_getKey().
+ *
+ * \return The number of characters copied into buffer, 0 after the last key
+ */
+int IniConfigSection_getKey( const IniConfigSection *self, int idx, char *buffer, int bufferSize );
+
+/*!
+ * \brief Write a string
+ *
+ * \param self   Pointer to the IniConfigSection
+ * \param key    Key name
+ * \param value  Value to write
+ *
+ * \return 1 on success, 0 otherwise
+ *
+ * \see IniConfigFile_putString()
+ */
+int IniConfigSection_putString( const IniConfigSection *self, const char *key, const char *value );
+
+/*!
+ * \brief Write a long
+ *
+ * \param self   Pointer to the IniConfigSection
+ * \param key    Key name
+ * \param value  Value to write
+ *
+ * \return 1 on success, 0 otherwise
+ */
+int IniConfigSection_putLong( const IniConfigSection *self, const char *key, long value );
+
+/*!
+ * \brief Write an int
+ *
+ * \param self   Pointer to the IniConfigSection
+ * \param key    Key name
+ * \param value  Value to write
+ *
+ * \return 1 on success, 0 otherwise
+ */
+int IniConfigSection_putInt( const IniConfigSection *self, const char *key, int value );
+
+/*!
+ * \brief Write a double
+ *
+ * \param self   Pointer to the IniConfigSection
+ * \param key    Key name
+ * \param value  Value to write
+ *
+ * \return 1 on success, 0 otherwise
+ */
+int IniConfigSection_putDouble( const IniConfigSection *self, const char *key, double value );
+
+/*!
+ * \brief Remove a key
+ *
+ * \param self  Pointer to the IniConfigSection
+ * \param key   Key name
+ *
+ * \return Nothing
+ */
+void IniConfigSection_removeKey( const IniConfigSection *self, const char *key );
+
+/*!
+ * \brief Clear an IniConfigSection instance
+ *
+ * \param self Pointer to the IniConfigSection
+ *
+ * \return Nothing
+ */
+void IniConfigSection_clear( IniConfigSection *self );
+
+/*!
+ * \brief Delete an IniConfigSection instance
+ *
+ * \param self Pointer to the IniConfigSection
+ *
+ * \return Nothing
+ */
+void IniConfigSection_delete( IniConfigSection *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGSECTION_H */
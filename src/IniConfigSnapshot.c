@@ -0,0 +1,174 @@
+/*
+ *  Immutable versions of a loaded INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <string.h>
+
+#include <IniConfigSnapshot.h>
+#include <IniConfigStore.h>
+
+#define INICONFIGSNAPSHOT_VALID     0x5a9c0d27
+#define INICONFIGSNAPSHOT_INVALID   0xb00db00f
+
+
+IniConfigSnapshot *IniConfigSnapshot_new( void )
+{
+    return ( ANY_TALLOC( IniConfigSnapshot ) );
+}
+
+
+bool IniConfigSnapshot_init( IniConfigSnapshot *self )
+{
+    ANY_REQUIRE( self );
+
+    self->roots = NULL;
+    self->shardMask = 0;
+    self->generation = 0;
+
+    self->valid = INICONFIGSNAPSHOT_VALID;
+
+    return true;
+}
+
+
+int IniConfigSnapshot_getString( const IniConfigSnapshot *self, const char *section, const char *key,
+                                 const char *defValue, char *buffer, int bufferSize )
+{
+    const IniConfigHamtNode *leaf = NULL;
+    const char *value = defValue;
+    unsigned int hash = 0;
+    size_t length = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSNAPSHOT_VALID );
+    ANY_REQUIRE_MSG( self->roots, "IniConfigSnapshot_getString() requires a captured snapshot" );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    hash = IniConfigHamt_hash( section, key );
+    leaf = IniConfigHamt_find( self->roots[INICONFIGSTORE_SHARD( hash, self->shardMask )], hash, section, key );
+
+    if( leaf != NULL && leaf->value != NULL )
+    {
+        value = leaf->value;
+    }
+
+    if( value == NULL )
+    {
+        value = "";
+    }
+
+    length = strlen( value );
+
+    if( length > (size_t)bufferSize - 1 )
+    {
+        length = (size_t)bufferSize - 1;
+    }
+
+    memcpy( buffer, value, length );
+    buffer[length] = '\0';
+
+    return (int)length;
+}
+
+
+bool IniConfigSnapshot_putString( IniConfigSnapshot *self, const char *section, const char *key,
+                                  const char *value )
+{
+    IniConfigHamtNode *leaf = NULL;
+    IniConfigHamtNode *root = NULL;
+    unsigned int shard = 0;
+    unsigned int hash = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSNAPSHOT_VALID );
+    ANY_REQUIRE_MSG( self->roots, "IniConfigSnapshot_putString() requires a captured snapshot" );
+    ANY_REQUIRE( key );
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    hash = IniConfigHamt_hash( section, key );
+    shard = INICONFIGSTORE_SHARD( hash, self->shardMask );
+
+    /* the generation is only assigned once the value is rolled back */
+    leaf = IniConfigHamt_newLeaf( hash, section, key, value, 0 );
+
+    if( leaf == NULL )
+    {
+        return false;
+    }
+
+    root = IniConfigHamt_insert( self->roots[shard], leaf );
+    IniConfigHamt_release( leaf );
+
+    if( root == NULL )
+    {
+        return false;
+    }
+
+    IniConfigHamt_release( self->roots[shard] );
+    self->roots[shard] = root;
+
+    return true;
+}
+
+
+unsigned long IniConfigSnapshot_getGeneration( const IniConfigSnapshot *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSNAPSHOT_VALID );
+
+    return self->generation;
+}
+
+
+void IniConfigSnapshot_clear( IniConfigSnapshot *self )
+{
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSNAPSHOT_VALID );
+
+    if( self->roots != NULL )
+    {
+        for( i = 0; i <= self->shardMask; i++ )
+        {
+            IniConfigHamt_release( self->roots[i] );
+        }
+
+        ANY_FREE( self->roots );
+        self->roots = NULL;
+    }
+
+    self->valid = INICONFIGSNAPSHOT_INVALID;
+}
+
+
+void IniConfigSnapshot_delete( IniConfigSnapshot *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
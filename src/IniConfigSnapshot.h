@@ -0,0 +1,154 @@
+/*
+ *  Immutable versions of a loaded INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigSnapshot Snapshots
+ *
+ * An IniConfigSnapshot captures all values of a loaded IniConfigFile at
+ * one point in time. The values are kept in persistent maps (see
+ * \ref IniConfigHamt) which the snapshot shares with the live file, so
+ * taking a snapshot costs a few reference counts no matter how large the
+ * file is, and later puts only copy the few nodes they touch.
+ *
+ * A snapshot can be read like a file, modified on its own without
+ * affecting the live file (a cheap clone for A/B comparisons), and be
+ * rolled back into the live file, which only applies the keys that differ.
+ *
+ * \code
+ *  IniConfigSnapshot *before = IniConfigSnapshot_new();
+ *
+ *  IniConfigSnapshot_init( before );
+ *  IniConfigFile_snapshot( robotIni, before );
+ *
+ *  IniConfigFile_putDouble( robotIni, "Arm", "gain", 2.5 );
+ *
+ *  if( !experimentSucceeded )
+ *  {
+ *    IniConfigFile_rollback( robotIni, before );
+ *  }
+ *
+ *  IniConfigSnapshot_clear( before );
+ *  IniConfigSnapshot_delete( before );
+ * \endcode
+ *
+ * Snapshots cover key values only: the layout and comments of the file
+ * stay with its document, and a rolled back key which no longer has a
+ * section is added to a new one.
+ */
+
+#ifndef INICONFIGSNAPSHOT_H
+#define INICONFIGSNAPSHOT_H
+
+#include <IniConfigHamt.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief IniConfigSnapshot definition
+ */
+typedef struct IniConfigSnapshot
+{
+    unsigned long valid;                /**< Object validity */
+    IniConfigHamtNode **roots;          /**< One map root per store shard, NULL until captured */
+    unsigned int shardMask;             /**< Number of shards minus one */
+    unsigned long generation;           /**< Store generation when captured */
+}
+IniConfigSnapshot;
+
+/*!
+ * \brief Allocate a new IniConfigSnapshot instance
+ *
+ * \return A new IniConfigSnapshot instance, NULL on error
+ *
+ * \see IniConfigSnapshot_init()
+ */
+IniConfigSnapshot *IniConfigSnapshot_new( void );
+
+/*!
+ * \brief Initialize an empty snapshot
+ *
+ * \param self Pointer to the IniConfigSnapshot
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigFile_snapshot()
+ */
+bool IniConfigSnapshot_init( IniConfigSnapshot *self );
+
+/*!
+ * \brief Get a string
+ *
+ * \param self        Pointer to the IniConfigSnapshot
+ * \param section     Section name, NULL for the global area
+ * \param key         Key name
+ * \param defValue    Returned if the key did not exist
+ * \param buffer      Receives the value
+ * \param bufferSize  Size of buffer
+ *
+ * \return The number of characters copied into buffer
+ */
+int IniConfigSnapshot_getString( const IniConfigSnapshot *self, const char *section, const char *key,
+                                 const char *defValue, char *buffer, int bufferSize );
+
+/*!
+ * \brief Change a value of the snapshot only
+ *
+ * \param self     Pointer to the IniConfigSnapshot
+ * \param section  Section name, NULL for the global area
+ * \param key      Key name
+ * \param value    New value, NULL to remove the key
+ *
+ * The live file is not affected until the snapshot is rolled back into it.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigSnapshot_putString( IniConfigSnapshot *self, const char *section, const char *key,
+                                  const char *value );
+
+/*!
+ * \brief Return the generation of the file when the snapshot was taken
+ *
+ * \param self Pointer to the IniConfigSnapshot
+ *
+ * \return Generation, see IniConfigFile_getGeneration()
+ */
+unsigned long IniConfigSnapshot_getGeneration( const IniConfigSnapshot *self );
+
+/*!
+ * \brief Clear an IniConfigSnapshot instance
+ *
+ * \param self Pointer to the IniConfigSnapshot
+ *
+ * \return Nothing
+ */
+void IniConfigSnapshot_clear( IniConfigSnapshot *self );
+
+/*!
+ * \brief Delete an IniConfigSnapshot instance
+ *
+ * \param self Pointer to the IniConfigSnapshot
+ *
+ * \return Nothing
+ */
+void IniConfigSnapshot_delete( IniConfigSnapshot *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGSNAPSHOT_H */
@@ -0,0 +1,1008 @@
+/*
+ *  Concurrent key/value store of a loaded INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IniConfigStore.h>
+#include <IniConfigUnits.h>
+
+#define INICONFIGSTORE_VALID        0x3c0fa5e1
+#define INICONFIGSTORE_INVALID      0xb00db00f
+
+
+/*
+ * Private functions
+ */
+
+static char IniConfigStore_toLower( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? (char)( c + 'a' - 'A' ) : c;
+}
+
+
+static int IniConfigStore_equalsNoCase( const char *a, const char *b )
+{
+    while( *a != '\0' && IniConfigStore_toLower( *a ) == IniConfigStore_toLower( *b ) )
+    {
+        a++;
+        b++;
+    }
+
+    return ( IniConfigStore_toLower( *a ) == IniConfigStore_toLower( *b ) );
+}
+
+
+static int IniConfigStore_sameValue( const char *a, const char *b )
+{
+    return ( a == NULL || b == NULL ) ? ( a == b ) : ( strcmp( a, b ) == 0 );
+}
+
+
+static IniConfigStoreShard *IniConfigStore_shard( const IniConfigStore *self, unsigned int hash )
+{
+    return &self->shards[INICONFIGSTORE_SHARD( hash, self->shardMask )];
+}
+
+
+static void IniConfigStore_lockAll( IniConfigStore *self )
+{
+    unsigned int i = 0;
+
+    /* always in shard order, so two threads locking everything cannot deadlock */
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        pthread_mutex_lock( &self->shards[i].mutex );
+    }
+}
+
+
+static void IniConfigStore_unlockAll( IniConfigStore *self )
+{
+    unsigned int i = 0;
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        pthread_mutex_unlock( &self->shards[i].mutex );
+    }
+}
+
+
+/*
+ * Records that the document holds every put so far, all shards must be
+ * locked. Puts take their generation under their shard lock, so none can
+ * be half done.
+ */
+static void IniConfigStore_markFlushed( IniConfigStore *self )
+{
+    unsigned int i = 0;
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        if( self->shards[i].numDirty != 0 )
+        {
+            return;
+        }
+    }
+
+    __atomic_store_n( &self->flushed, __atomic_load_n( &self->generation, __ATOMIC_ACQUIRE ), __ATOMIC_RELEASE );
+}
+
+
+static int IniConfigStore_reserveDirty( IniConfigStoreShard *shard )
+{
+    if( shard->numDirty == shard->maxDirty )
+    {
+        unsigned int maxDirty = ( shard->maxDirty != 0 ) ? shard->maxDirty * 2 : 16;
+        IniConfigHamtNode **dirty = (IniConfigHamtNode **)realloc( shard->dirty,
+                                                                   maxDirty * sizeof( IniConfigHamtNode * ) );
+
+        if( dirty == NULL )
+        {
+            return 0;
+        }
+
+        shard->dirty = dirty;
+        shard->maxDirty = maxDirty;
+    }
+
+    return 1;
+}
+
+
+static void IniConfigStore_dropDirty( IniConfigStoreShard *shard )
+{
+    unsigned int i = 0;
+
+    for( i = 0; i < shard->numDirty; i++ )
+    {
+        IniConfigHamt_release( shard->dirty[i] );
+    }
+
+    shard->numDirty = 0;
+}
+
+
+/*
+ * Makes a leaf the current version of its key and remembers it for the
+ * next flush. The shard must be locked. The mark of a dirty leaf is its
+ * dirty slot plus one, so a key put over and over again between two
+ * flushes occupies a single slot.
+ */
+static int IniConfigStore_apply( IniConfigStoreShard *shard, IniConfigHamtNode *current, IniConfigHamtNode *leaf )
+{
+    IniConfigHamtNode *root = NULL;
+    unsigned int slot = shard->numDirty;
+
+    if( current != NULL && current->mark != 0 && current->mark <= shard->numDirty &&
+        shard->dirty[current->mark - 1] == current )
+    {
+        slot = current->mark - 1;
+    }
+    else if( !IniConfigStore_reserveDirty( shard ) )
+    {
+        return 0;
+    }
+
+    root = IniConfigHamt_insert( shard->root, leaf );
+
+    if( root == NULL )
+    {
+        return 0;
+    }
+
+    IniConfigHamt_release( shard->root );
+    shard->root = root;
+
+    if( slot == shard->numDirty )
+    {
+        shard->numDirty++;
+    }
+    else
+    {
+        IniConfigHamt_release( shard->dirty[slot] );
+    }
+
+    shard->dirty[slot] = IniConfigHamt_retain( leaf );
+    leaf->mark = slot + 1;
+
+    return 1;
+}
+
+
+static int IniConfigStore_compareGeneration( const void *a, const void *b )
+{
+    const IniConfigHamtNode *leafA = *(IniConfigHamtNode * const *)a;
+    const IniConfigHamtNode *leafB = *(IniConfigHamtNode * const *)b;
+
+    return ( leafA->generation > leafB->generation ) - ( leafA->generation < leafB->generation );
+}
+
+
+typedef struct IniConfigStoreReload
+{
+    IniConfigStore *store;
+    IniConfigHamtNode **roots;
+    int failed;
+}
+IniConfigStoreReload;
+
+
+static bool IniConfigStore_reloadKey( void *context, const char *section, const char *key, const char *value )
+{
+    IniConfigStoreReload *reload = (IniConfigStoreReload *)context;
+    IniConfigStore *self = reload->store;
+    unsigned int hash = IniConfigHamt_hash( section, key );
+    unsigned int shard = INICONFIGSTORE_SHARD( hash, self->shardMask );
+    IniConfigHamtNode *previous = IniConfigHamt_find( self->shards[shard].root, hash, section, key );
+    IniConfigHamtNode *leaf = NULL;
+    IniConfigHamtNode *root = NULL;
+
+    if( previous != NULL && IniConfigStore_sameValue( previous->value, value ) )
+    {
+        /* unchanged keys keep their generation and stay shared with snapshots */
+        leaf = IniConfigHamt_retain( previous );
+    }
+    else
+    {
+        leaf = IniConfigHamt_newLeaf( hash, section, key, value,
+                                      ( previous != NULL ) ? __atomic_add_fetch( &self->generation, 1,
+                                                                                 __ATOMIC_ACQ_REL ) : 0 );
+    }
+
+    /* the new roots are private until the reload ends, they are built in place */
+    if( leaf != NULL )
+    {
+        root = IniConfigHamt_insertOwned( reload->roots[shard], leaf );
+        IniConfigHamt_release( leaf );
+    }
+
+    if( root == NULL )
+    {
+        reload->failed = 1;
+        return false;
+    }
+
+    reload->roots[shard] = root;
+
+    return true;
+}
+
+
+typedef struct IniConfigStoreChanges
+{
+    IniConfigHamtNode **before;
+    IniConfigHamtNode **after;
+    unsigned int count;
+    unsigned int max;
+    int failed;
+}
+IniConfigStoreChanges;
+
+
+static void IniConfigStore_collectChange( void *context, IniConfigHamtNode *before, IniConfigHamtNode *after )
+{
+    IniConfigStoreChanges *changes = (IniConfigStoreChanges *)context;
+
+    if( IniConfigStore_sameValue( before != NULL ? before->value : NULL, after != NULL ? after->value : NULL ) )
+    {
+        return;
+    }
+
+    if( changes->count == changes->max )
+    {
+        unsigned int max = ( changes->max != 0 ) ? changes->max * 2 : 64;
+        IniConfigHamtNode **b = (IniConfigHamtNode **)realloc( changes->before, max * sizeof( IniConfigHamtNode * ) );
+        IniConfigHamtNode **a = NULL;
+
+        if( b == NULL )
+        {
+            changes->failed = 1;
+            return;
+        }
+
+        changes->before = b;
+
+        a = (IniConfigHamtNode **)realloc( changes->after, max * sizeof( IniConfigHamtNode * ) );
+
+        if( a == NULL )
+        {
+            changes->failed = 1;
+            return;
+        }
+
+        changes->after = a;
+        changes->max = max;
+    }
+
+    changes->before[changes->count] = before;
+    changes->after[changes->count] = after;
+    changes->count++;
+}
+
+
+typedef struct IniConfigStoreSection
+{
+    const char *section;
+    IniConfigHamtNode **leaves;
+    unsigned int count;
+    unsigned int max;
+}
+IniConfigStoreSection;
+
+
+static void IniConfigStore_collectSection( void *context, IniConfigHamtNode *leaf )
+{
+    IniConfigStoreSection *collect = (IniConfigStoreSection *)context;
+
+    if( !IniConfigStore_equalsNoCase( leaf->section, collect->section ) )
+    {
+        return;
+    }
+
+    if( collect->count == collect->max )
+    {
+        unsigned int max = ( collect->max != 0 ) ? collect->max * 2 : 16;
+        IniConfigHamtNode **leaves = (IniConfigHamtNode **)realloc( collect->leaves, max * sizeof( IniConfigHamtNode * ) );
+
+        if( leaves == NULL )
+        {
+            return;
+        }
+
+        collect->leaves = leaves;
+        collect->max = max;
+    }
+
+    collect->leaves[collect->count++] = leaf;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigStore *IniConfigStore_new( void )
+{
+    return ( ANY_TALLOC( IniConfigStore ) );
+}
+
+
+bool IniConfigStore_init( IniConfigStore *self, unsigned int numShards )
+{
+    unsigned int count = 1;
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+
+    self->valid = INICONFIGSTORE_INVALID;
+    self->generation = 0;
+    self->flushed = 0;
+
+    if( numShards == 0 )
+    {
+        numShards = INICONFIGSTORE_NUMSHARDS;
+    }
+
+    /* the shard is taken from the top 8 hash bits */
+    while( count < numShards && count < 256 )
+    {
+        count *= 2;
+    }
+
+    self->shards = ANY_NTALLOC( count, IniConfigStoreShard );
+
+    if( self->shards == NULL )
+    {
+        return false;
+    }
+
+    self->shardMask = count - 1;
+
+    for( i = 0; i < count; i++ )
+    {
+        pthread_mutex_init( &self->shards[i].mutex, NULL );
+    }
+
+    self->valid = INICONFIGSTORE_VALID;
+
+    return true;
+}
+
+
+bool IniConfigStore_reload( IniConfigStore *self, const IniConfigDocument *document, bool keepPending )
+{
+    IniConfigStoreReload reload;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( document );
+
+    reload.store = self;
+    reload.failed = 0;
+    reload.roots = ANY_NTALLOC( self->shardMask + 1, IniConfigHamtNode * );
+
+    if( reload.roots == NULL )
+    {
+        return false;
+    }
+
+    IniConfigStore_lockAll( self );
+
+    /* a visit which ran out of memory leaves partial roots, which are dropped */
+    if( !IniConfigDocument_forEach( document, IniConfigStore_reloadKey, &reload ) )
+    {
+        reload.failed = 1;
+    }
+
+    for( i = 0; i <= self->shardMask && !reload.failed; i++ )
+    {
+        IniConfigStoreShard *shard = &self->shards[i];
+
+        if( !keepPending )
+        {
+            continue;
+        }
+
+        /* puts made while the document was written still have to go there */
+        for( j = 0; j < shard->numDirty; j++ )
+        {
+            IniConfigHamtNode *leaf = shard->dirty[j];
+            IniConfigHamtNode *root = NULL;
+
+            if( IniConfigHamt_find( shard->root, leaf->hash, leaf->section, leaf->key ) != leaf )
+            {
+                continue;
+            }
+
+            root = IniConfigHamt_insertOwned( reload.roots[i], leaf );
+
+            if( root == NULL )
+            {
+                reload.failed = 1;
+                break;
+            }
+
+            reload.roots[i] = root;
+        }
+    }
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        IniConfigStoreShard *shard = &self->shards[i];
+
+        if( reload.failed )
+        {
+            IniConfigHamt_release( reload.roots[i] );
+            continue;
+        }
+
+        if( !keepPending )
+        {
+            IniConfigStore_dropDirty( shard );
+        }
+
+        IniConfigHamt_release( shard->root );
+        shard->root = reload.roots[i];
+    }
+
+    if( !reload.failed )
+    {
+        IniConfigStore_markFlushed( self );
+    }
+
+    IniConfigStore_unlockAll( self );
+
+    ANY_FREE( reload.roots );
+
+    return reload.failed ? false : true;
+}
+
+
+int IniConfigStore_get( IniConfigStore *self, const char *section, const char *key,
+                        char *buffer, int bufferSize, unsigned long *generation )
+{
+    ANY_REQUIRE( key );
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    return IniConfigStore_getHashed( self, IniConfigHamt_hash( section, key ), section, key, buffer, bufferSize,
+                                     generation );
+}
+
+
+int IniConfigStore_getHashed( IniConfigStore *self, unsigned int hash, const char *section, const char *key,
+                              char *buffer, int bufferSize, unsigned long *generation )
+{
+    IniConfigStoreShard *shard = NULL;
+    IniConfigHamtNode *leaf = NULL;
+    int retVal = INICONFIGSTORE_ABSENT;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( section );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( buffer );
+    ANY_REQUIRE( bufferSize > 0 );
+
+    shard = IniConfigStore_shard( self, hash );
+
+    pthread_mutex_lock( &shard->mutex );
+
+    leaf = IniConfigHamt_find( shard->root, hash, section, key );
+
+    if( generation != NULL )
+    {
+        *generation = ( leaf != NULL ) ? leaf->generation : 0;
+    }
+
+    if( leaf != NULL && leaf->value != NULL )
+    {
+        size_t length = strlen( leaf->value );
+
+        if( length > (size_t)bufferSize - 1 )
+        {
+            length = (size_t)bufferSize - 1;
+        }
+
+        memcpy( buffer, leaf->value, length );
+        buffer[length] = '\0';
+
+        retVal = (int)length;
+    }
+
+    pthread_mutex_unlock( &shard->mutex );
+
+    return retVal;
+}
+
+
+bool IniConfigStore_getQuantity( IniConfigStore *self, const char *section, const char *key, int *kind,
+                                 double *quantity )
+{
+    IniConfigStoreShard *shard = NULL;
+    IniConfigHamtNode *leaf = NULL;
+    unsigned int hash = 0;
+    bool retVal = false;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( kind );
+    ANY_REQUIRE( quantity );
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    hash = IniConfigHamt_hash( section, key );
+    shard = IniConfigStore_shard( self, hash );
+
+    pthread_mutex_lock( &shard->mutex );
+
+    leaf = IniConfigHamt_find( shard->root, hash, section, key );
+
+    if( leaf != NULL && leaf->value != NULL )
+    {
+        /* values never change within a leaf, so the result stays valid */
+        if( leaf->unit == 0 )
+        {
+            leaf->unit = IniConfigUnits_parse( leaf->value, &leaf->quantity );
+        }
+
+        *kind = leaf->unit;
+        *quantity = leaf->quantity;
+        retVal = true;
+    }
+
+    pthread_mutex_unlock( &shard->mutex );
+
+    return retVal;
+}
+
+
+void IniConfigStore_getBatch( IniConfigStore *self, unsigned int count, const char *const *sections,
+                              const char *const *keys, IniConfigStoreValueVisitor visitor, void *context )
+{
+    const char *names[INICONFIGHAMT_BATCH];
+    unsigned int hashes[INICONFIGHAMT_BATCH];
+    IniConfigHamtNode *roots[INICONFIGHAMT_BATCH];
+    IniConfigHamtNode *leaves[INICONFIGHAMT_BATCH];
+    unsigned char used[256];
+    unsigned int first = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( sections );
+    ANY_REQUIRE( keys );
+    ANY_REQUIRE( visitor );
+
+    for( first = 0; first < count; first += INICONFIGHAMT_BATCH )
+    {
+        unsigned int n = ( count - first < INICONFIGHAMT_BATCH ) ? count - first : INICONFIGHAMT_BATCH;
+        unsigned int i = 0;
+
+        memset( used, 0, self->shardMask + 1 );
+
+        for( i = 0; i < n; i++ )
+        {
+            ANY_REQUIRE( keys[first + i] );
+
+            names[i] = ( sections[first + i] != NULL ) ? sections[first + i] : "";
+            hashes[i] = IniConfigHamt_hash( names[i], keys[first + i] );
+            used[INICONFIGSTORE_SHARD( hashes[i], self->shardMask )] = 1;
+        }
+
+        /* in shard order like IniConfigStore_lockAll(), so batches cannot deadlock */
+        for( i = 0; i <= self->shardMask; i++ )
+        {
+            if( used[i] )
+            {
+                pthread_mutex_lock( &self->shards[i].mutex );
+            }
+        }
+
+        for( i = 0; i < n; i++ )
+        {
+            roots[i] = IniConfigStore_shard( self, hashes[i] )->root;
+        }
+
+        IniConfigHamt_findBatch( roots, hashes, names, keys + first, n, leaves );
+
+        for( i = 0; i < n; i++ )
+        {
+            visitor( context, first + i, ( leaves[i] != NULL ) ? leaves[i]->value : NULL );
+        }
+
+        for( i = 0; i <= self->shardMask; i++ )
+        {
+            if( used[i] )
+            {
+                pthread_mutex_unlock( &self->shards[i].mutex );
+            }
+        }
+    }
+}
+
+
+unsigned long IniConfigStore_put( IniConfigStore *self, const char *section, const char *key, const char *value,
+                                  IniConfigStoreCondition condition, unsigned long generation )
+{
+    IniConfigStoreShard *shard = NULL;
+    IniConfigHamtNode *current = NULL;
+    IniConfigHamtNode *leaf = NULL;
+    unsigned long retVal = 0;
+    unsigned int hash = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( key );
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    hash = IniConfigHamt_hash( section, key );
+    shard = IniConfigStore_shard( self, hash );
+
+    /* allocate outside of the lock, the generation is set once it is known */
+    leaf = IniConfigHamt_newLeaf( hash, section, key, value, 0 );
+
+    if( leaf == NULL )
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock( &shard->mutex );
+
+    current = IniConfigHamt_find( shard->root, hash, section, key );
+
+    if( condition == INICONFIGSTORE_IFKEY && ( current != NULL ? current->generation : 0 ) != generation )
+    {
+        goto out;
+    }
+
+    if( condition == INICONFIGSTORE_IFDOCUMENT )
+    {
+        unsigned long expected = generation;
+
+        /* fails as soon as any other put has taken a generation */
+        if( !__atomic_compare_exchange_n( &self->generation, &expected, generation + 1, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+        {
+            goto out;
+        }
+
+        leaf->generation = generation + 1;
+    }
+    else
+    {
+        leaf->generation = __atomic_add_fetch( &self->generation, 1, __ATOMIC_ACQ_REL );
+    }
+
+    if( IniConfigStore_apply( shard, current, leaf ) )
+    {
+        retVal = leaf->generation;
+    }
+
+    out:
+
+    pthread_mutex_unlock( &shard->mutex );
+
+    IniConfigHamt_release( leaf );
+
+    return retVal;
+}
+
+
+bool IniConfigStore_isFlushed( IniConfigStore *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+
+    return __atomic_load_n( &self->flushed, __ATOMIC_ACQUIRE ) ==
+           __atomic_load_n( &self->generation, __ATOMIC_ACQUIRE );
+}
+
+
+unsigned long IniConfigStore_getGeneration( IniConfigStore *self, const char *section, const char *key )
+{
+    IniConfigStoreShard *shard = NULL;
+    IniConfigHamtNode *leaf = NULL;
+    unsigned long retVal = 0;
+    unsigned int hash = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+
+    if( key == NULL )
+    {
+        return __atomic_load_n( &self->generation, __ATOMIC_ACQUIRE );
+    }
+
+    if( section == NULL )
+    {
+        section = "";
+    }
+
+    hash = IniConfigHamt_hash( section, key );
+    shard = IniConfigStore_shard( self, hash );
+
+    pthread_mutex_lock( &shard->mutex );
+
+    leaf = IniConfigHamt_find( shard->root, hash, section, key );
+    retVal = ( leaf != NULL ) ? leaf->generation : 0;
+
+    pthread_mutex_unlock( &shard->mutex );
+
+    return retVal;
+}
+
+
+bool IniConfigStore_flush( IniConfigStore *self, IniConfigDocument *document )
+{
+    IniConfigHamtNode **dirty = NULL;
+    unsigned int numDirty = 0;
+    unsigned int i = 0;
+    unsigned int j = 0;
+    bool retVal = true;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( document );
+
+    IniConfigStore_lockAll( self );
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        numDirty += self->shards[i].numDirty;
+    }
+
+    if( numDirty == 0 )
+    {
+        IniConfigStore_markFlushed( self );
+        goto out;
+    }
+
+    dirty = ANY_NTALLOC( numDirty, IniConfigHamtNode * );
+
+    if( dirty == NULL )
+    {
+        retVal = false;
+        goto out;
+    }
+
+    numDirty = 0;
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        const IniConfigStoreShard *shard = &self->shards[i];
+
+        for( j = 0; j < shard->numDirty; j++ )
+        {
+            /* of several puts to a key only the last one counts */
+            if( IniConfigHamt_find( shard->root, shard->dirty[j]->hash, shard->dirty[j]->section,
+                                    shard->dirty[j]->key ) == shard->dirty[j] )
+            {
+                dirty[numDirty++] = shard->dirty[j];
+            }
+        }
+    }
+
+    /* new keys end up in the file in the order they have been put */
+    qsort( dirty, numDirty, sizeof( IniConfigHamtNode * ), IniConfigStore_compareGeneration );
+
+    for( i = 0; i < numDirty && retVal; i++ )
+    {
+        const IniConfigHamtNode *leaf = dirty[i];
+
+        retVal = IniConfigDocument_putString( document, leaf->section, leaf->key, leaf->value ) ? true : false;
+    }
+
+    /* on failure everything stays pending, applying a put twice is harmless */
+    for( i = 0; i <= self->shardMask && retVal; i++ )
+    {
+        IniConfigStore_dropDirty( &self->shards[i] );
+    }
+
+    if( retVal )
+    {
+        IniConfigStore_markFlushed( self );
+    }
+
+    out:
+
+    IniConfigStore_unlockAll( self );
+
+    ANY_FREE( dirty );
+
+    return retVal;
+}
+
+
+void IniConfigStore_removeSection( IniConfigStore *self, const char *section )
+{
+    IniConfigStoreSection collect;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+
+    memset( &collect, 0, sizeof( collect ) );
+    collect.section = ( section != NULL ) ? section : "";
+
+    IniConfigStore_lockAll( self );
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        IniConfigStoreShard *shard = &self->shards[i];
+
+        collect.count = 0;
+        IniConfigHamt_forEach( shard->root, IniConfigStore_collectSection, &collect );
+
+        for( j = 0; j < collect.count; j++ )
+        {
+            const IniConfigHamtNode *leaf = collect.leaves[j];
+            IniConfigHamtNode *root = IniConfigHamt_remove( shard->root, leaf->hash, leaf->section, leaf->key );
+
+            /* the removed leaf may have been freed with the old root */
+            IniConfigHamt_release( shard->root );
+            shard->root = root;
+        }
+    }
+
+    IniConfigStore_unlockAll( self );
+
+    ANY_FREE( collect.leaves );
+}
+
+
+bool IniConfigStore_snapshot( IniConfigStore *self, IniConfigSnapshot *snapshot )
+{
+    IniConfigHamtNode **roots = NULL;
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( snapshot );
+
+    roots = ANY_NTALLOC( self->shardMask + 1, IniConfigHamtNode * );
+
+    if( roots == NULL )
+    {
+        return false;
+    }
+
+    IniConfigStore_lockAll( self );
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        roots[i] = IniConfigHamt_retain( self->shards[i].root );
+    }
+
+    snapshot->generation = __atomic_load_n( &self->generation, __ATOMIC_ACQUIRE );
+
+    IniConfigStore_unlockAll( self );
+
+    if( snapshot->roots != NULL )
+    {
+        for( i = 0; i <= snapshot->shardMask; i++ )
+        {
+            IniConfigHamt_release( snapshot->roots[i] );
+        }
+
+        ANY_FREE( snapshot->roots );
+    }
+
+    snapshot->roots = roots;
+    snapshot->shardMask = self->shardMask;
+
+    return true;
+}
+
+
+bool IniConfigStore_rollback( IniConfigStore *self, const IniConfigSnapshot *snapshot )
+{
+    IniConfigStoreChanges changes;
+    bool retVal = true;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+    ANY_REQUIRE( snapshot );
+    ANY_REQUIRE_MSG( snapshot->roots, "IniConfigStore_rollback() requires a captured snapshot" );
+    ANY_REQUIRE( snapshot->shardMask == self->shardMask );
+
+    memset( &changes, 0, sizeof( changes ) );
+
+    IniConfigStore_lockAll( self );
+
+    for( i = 0; i <= self->shardMask && retVal; i++ )
+    {
+        IniConfigStoreShard *shard = &self->shards[i];
+
+        changes.count = 0;
+        IniConfigHamt_diff( shard->root, snapshot->roots[i], IniConfigStore_collectChange, &changes );
+
+        if( changes.failed )
+        {
+            retVal = false;
+            break;
+        }
+
+        for( j = 0; j < changes.count && retVal; j++ )
+        {
+            const IniConfigHamtNode *name = ( changes.after[j] != NULL ) ? changes.after[j] : changes.before[j];
+            IniConfigHamtNode *leaf = IniConfigHamt_newLeaf( name->hash, name->section, name->key,
+                                                             ( changes.after[j] != NULL ) ? changes.after[j]->value : NULL,
+                                                             __atomic_add_fetch( &self->generation, 1, __ATOMIC_ACQ_REL ) );
+
+            retVal = ( leaf != NULL && IniConfigStore_apply( shard, changes.before[j], leaf ) );
+
+            IniConfigHamt_release( leaf );
+        }
+    }
+
+    IniConfigStore_unlockAll( self );
+
+    ANY_FREE( changes.before );
+    ANY_FREE( changes.after );
+
+    return retVal;
+}
+
+
+void IniConfigStore_clear( IniConfigStore *self )
+{
+    unsigned int i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGSTORE_VALID );
+
+    for( i = 0; i <= self->shardMask; i++ )
+    {
+        IniConfigStoreShard *shard = &self->shards[i];
+
+        IniConfigStore_dropDirty( shard );
+        IniConfigHamt_release( shard->root );
+        ANY_FREE( shard->dirty );
+        pthread_mutex_destroy( &shard->mutex );
+    }
+
+    ANY_FREE( self->shards );
+    self->shards = NULL;
+
+    self->valid = INICONFIGSTORE_INVALID;
+}
+
+
+void IniConfigStore_delete( IniConfigStore *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
@@ -0,0 +1,337 @@
+/*
+ *  Concurrent key/value store of a loaded INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigStore Concurrent key/value store
+ *
+ * An IniConfigStore sits in front of an IniConfigDocument and takes the
+ * puts and gets of many threads. Keys are spread over shards by hash, and
+ * each shard has its own mutex, so threads working on different keys
+ * rarely wait for each other. Puts only change the store; the modified
+ * entries are applied to the document in put order by
+ * IniConfigStore_flush() before the document is enumerated or saved.
+ *
+ * Puts only replace the entry in their shard and mark it dirty, so the
+ * put rate is limited by memory, not by the file system. The shards and
+ * the generation counter sit on separate cache lines, so threads hitting
+ * different shards do not invalidate each other's caches.
+ *
+ * Every put gets a generation number from a document-wide counter, which
+ * is also recorded in the entry. IniConfigStore_put() can make a put
+ * conditional on the generation of the key or of the whole store, which
+ * allows optimistic read-modify-write cycles without a global lock.
+ *
+ * Each shard keeps its keys in a persistent map (see \ref IniConfigHamt),
+ * so IniConfigStore_snapshot() only takes a reference on every shard, and
+ * IniConfigStore_rollback() only touches the keys which differ.
+ */
+
+#ifndef INICONFIGSTORE_H
+#define INICONFIGSTORE_H
+
+#include <pthread.h>
+
+#include <IniConfigDocument.h>
+#include <IniConfigHamt.h>
+#include <IniConfigSnapshot.h>
+
+/*!
+ * \brief Default number of shards
+ */
+#define INICONFIGSTORE_NUMSHARDS  64
+
+/*!
+ * \brief Size of a cache line, shards and the generation counter are kept apart by it
+ */
+#define INICONFIGSTORE_CACHELINE  64
+
+/*!
+ * \brief IniConfigStore_get() result for a key which does not exist
+ */
+#define INICONFIGSTORE_ABSENT     ( -1 )
+
+/*!
+ * \brief Shard of a key hash, the top hash bits select it
+ */
+#define INICONFIGSTORE_SHARD( hash, shardMask )  ( ( ( hash ) >> 24 ) & ( shardMask ) )
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Receives the values of IniConfigStore_getBatch()
+ *
+ * \param context  Context passed to IniConfigStore_getBatch()
+ * \param i        Number of the key in the batch
+ * \param value    Value of the key, NULL if it does not exist
+ */
+typedef void ( *IniConfigStoreValueVisitor )( void *context, unsigned int i, const char *value );
+
+/*!
+ * \brief Condition of a put
+ */
+typedef enum IniConfigStoreCondition
+{
+    INICONFIGSTORE_ALWAYS = 0,          /**< Unconditional put */
+    INICONFIGSTORE_IFKEY,               /**< Only if the key generation matches */
+    INICONFIGSTORE_IFDOCUMENT           /**< Only if the store generation matches */
+}
+IniConfigStoreCondition;
+
+/*!
+ * \brief A shard of the store
+ */
+typedef struct IniConfigStoreShard
+{
+    pthread_mutex_t mutex;              /**< Guards the shard */
+    IniConfigHamtNode *root;            /**< Current version of the keys */
+    IniConfigHamtNode **dirty;          /**< Leaves not yet applied to the document */
+    unsigned int numDirty;              /**< Number of dirty leaves */
+    unsigned int maxDirty;              /**< Allocated dirty slots */
+    char padding[INICONFIGSTORE_CACHELINE]; /**< Keeps neighbouring shards off each other's cache lines */
+}
+IniConfigStoreShard;
+
+/*!
+ * \brief IniConfigStore definition
+ */
+typedef struct IniConfigStore
+{
+    unsigned long valid;                /**< Object validity */
+    IniConfigStoreShard *shards;        /**< Shards */
+    unsigned int shardMask;             /**< Number of shards minus one */
+    char padding[INICONFIGSTORE_CACHELINE]; /**< Keeps the counter off the line read by every put */
+    unsigned long generation;           /**< Generation of the last put, updated atomically */
+    char padding2[INICONFIGSTORE_CACHELINE]; /**< Keeps the counter off the following data */
+    unsigned long flushed;              /**< Generation up to which all puts are in the document */
+}
+IniConfigStore;
+
+/*!
+ * \brief Allocate a new IniConfigStore instance
+ *
+ * \return A new IniConfigStore instance, NULL on error
+ *
+ * \see IniConfigStore_init()
+ */
+IniConfigStore *IniConfigStore_new( void );
+
+/*!
+ * \brief Initialize an empty store
+ *
+ * \param self       Pointer to the IniConfigStore
+ * \param numShards  Number of shards, rounded up to a power of two,
+ *                   0 for INICONFIGSTORE_NUMSHARDS
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigStore_init( IniConfigStore *self, unsigned int numShards );
+
+/*!
+ * \brief Replace the contents of the store with the keys of a document
+ *
+ * \param self          Pointer to the IniConfigStore
+ * \param document      Document to take the keys from
+ * \param keepPending   true to keep puts not yet applied to the document
+ *
+ * Keys whose value did not change keep their generation, all other keys
+ * get a new one.
+ *
+ * \return Returns true on success, false otherwise. A failed reload leaves
+ *         the previous contents in place.
+ */
+bool IniConfigStore_reload( IniConfigStore *self, const IniConfigDocument *document, bool keepPending );
+
+/*!
+ * \brief Look up a key
+ *
+ * \param self        Pointer to the IniConfigStore
+ * \param section     Section name, NULL for the global area
+ * \param key         Key name
+ * \param buffer      Receives the value, truncated to bufferSize - 1 characters
+ * \param bufferSize  Size of buffer
+ * \param generation  If not NULL, receives the generation of the key
+ *
+ * \return The length of the value, INICONFIGSTORE_ABSENT if the key does
+ *         not exist
+ */
+int IniConfigStore_get( IniConfigStore *self, const char *section, const char *key,
+                        char *buffer, int bufferSize, unsigned long *generation );
+
+/*!
+ * \brief Look up a key whose hash is already known
+ *
+ * \param self        Pointer to the IniConfigStore
+ * \param hash        IniConfigHamt_hash() of section and key
+ * \param section     Section name, "" for the global area
+ * \param key         Key name
+ * \param buffer      Receives the value, truncated to bufferSize - 1 characters
+ * \param bufferSize  Size of buffer
+ * \param generation  If not NULL, receives the generation of the key
+ *
+ * \return The length of the value, INICONFIGSTORE_ABSENT if the key does
+ *         not exist
+ */
+int IniConfigStore_getHashed( IniConfigStore *self, unsigned int hash, const char *section, const char *key,
+                              char *buffer, int bufferSize, unsigned long *generation );
+
+/*!
+ * \brief Look up a key and parse its value for units
+ *
+ * \param self      Pointer to the IniConfigStore
+ * \param section   Section name, NULL for the global area
+ * \param key       Key name
+ * \param kind      Receives the IniConfigUnitsKind of the value
+ * \param quantity  Receives the value in its canonical unit
+ *
+ * The value is parsed by the first call only, later calls return the
+ * result kept in the leaf until a put replaces it.
+ *
+ * \return Returns false if the key does not exist
+ */
+bool IniConfigStore_getQuantity( IniConfigStore *self, const char *section, const char *key, int *kind,
+                                 double *quantity );
+
+/*!
+ * \brief Look up several keys at once
+ *
+ * \param self      Pointer to the IniConfigStore
+ * \param count     Number of keys
+ * \param sections  Section names, NULL entries for the global area
+ * \param keys      Key names
+ * \param visitor   Called once per key, in order
+ * \param context   Passed to the visitor
+ *
+ * Takes the locks of all shards of a group of INICONFIGHAMT_BATCH keys
+ * together and interleaves their lookups (see IniConfigHamt_findBatch()).
+ * The visitor runs with these locks held; it must copy the value and
+ * must not call back into the store.
+ *
+ * \return Nothing
+ */
+void IniConfigStore_getBatch( IniConfigStore *self, unsigned int count, const char *const *sections,
+                              const char *const *keys, IniConfigStoreValueVisitor visitor, void *context );
+
+/*!
+ * \brief Set or remove a key
+ *
+ * \param self        Pointer to the IniConfigStore
+ * \param section     Section name, NULL for the global area
+ * \param key         Key name
+ * \param value       New value, NULL to remove the key
+ * \param condition   Condition under which the put takes place
+ * \param generation  Generation the key or the store must still have
+ *
+ * \return The generation of the put, 0 if the condition did not hold or
+ *         on error
+ */
+unsigned long IniConfigStore_put( IniConfigStore *self, const char *section, const char *key, const char *value,
+                                  IniConfigStoreCondition condition, unsigned long generation );
+
+/*!
+ * \brief Return the generation of a key
+ *
+ * \param self     Pointer to the IniConfigStore
+ * \param section  Section name, NULL for the global area
+ * \param key      Key name, NULL for the generation of the whole store
+ *
+ * \return The generation, 0 if the key has never been put
+ */
+unsigned long IniConfigStore_getGeneration( IniConfigStore *self, const char *section, const char *key );
+
+/*!
+ * \brief Apply all pending puts to a document
+ *
+ * \param self      Pointer to the IniConfigStore
+ * \param document  Document to update
+ *
+ * The puts are applied in the order they have been made. Blocks all
+ * shards while running.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigStore_flush( IniConfigStore *self, IniConfigDocument *document );
+
+/*!
+ * \brief Tell whether the document holds all puts made so far
+ *
+ * \param self  Pointer to the IniConfigStore
+ *
+ * Takes no lock, so callers may skip IniConfigStore_flush() and its
+ * locking of all shards when nothing is pending. A put made while this
+ * runs may or may not be taken into account.
+ *
+ * \return Returns true if no put is pending
+ */
+bool IniConfigStore_isFlushed( IniConfigStore *self );
+
+/*!
+ * \brief Forget all keys of a section
+ *
+ * \param self     Pointer to the IniConfigStore
+ * \param section  Section name, NULL for the global area
+ *
+ * \return Nothing
+ */
+void IniConfigStore_removeSection( IniConfigStore *self, const char *section );
+
+/*!
+ * \brief Capture the current values
+ *
+ * \param self      Pointer to the IniConfigStore
+ * \param snapshot  Initialized snapshot, a previous capture is dropped
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigStore_snapshot( IniConfigStore *self, IniConfigSnapshot *snapshot );
+
+/*!
+ * \brief Put back the values of a snapshot
+ *
+ * \param self      Pointer to the IniConfigStore
+ * \param snapshot  Snapshot taken from a store with the same number of shards
+ *
+ * Every key whose value differs from the snapshot is put (or removed)
+ * with a new generation, all other keys stay untouched.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigStore_rollback( IniConfigStore *self, const IniConfigSnapshot *snapshot );
+
+/*!
+ * \brief Clear an IniConfigStore instance
+ *
+ * \param self Pointer to the IniConfigStore
+ *
+ * \return Nothing
+ */
+void IniConfigStore_clear( IniConfigStore *self );
+
+/*!
+ * \brief Delete an IniConfigStore instance
+ *
+ * \param self Pointer to the IniConfigStore
+ *
+ * \return Nothing
+ */
+void IniConfigStore_delete( IniConfigStore *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGSTORE_H */
@@ -0,0 +1,450 @@
+/*
+ *  Text encoding checks and conversions of loaded files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <IniConfigText.h>
+
+/* the SSSE3 validator is compiled in any case and only called if the processor has it */
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#define INICONFIGTEXT_SIMD
+#endif
+
+#define INICONFIGTEXT_ASCIIMASK  0x8080808080808080ULL
+
+
+/*
+ * Private functions
+ */
+
+static unsigned int IniConfigText_unit( const unsigned char *bytes, int encoding )
+{
+    return ( encoding == INICONFIGTEXT_UTF16BE ) ? ( (unsigned int)bytes[0] << 8 ) | bytes[1]
+                                                 : ( (unsigned int)bytes[1] << 8 ) | bytes[0];
+}
+
+
+static uint64_t IniConfigText_load64( const unsigned char *bytes )
+{
+    uint64_t word = 0;
+
+    memcpy( &word, bytes, sizeof( word ) );
+
+    return word;
+}
+
+
+/*
+ * Returns the size of the valid sequence at text[i], 0 if it is not valid
+ * (Unicode 15, table 3-7)
+ */
+static size_t IniConfigText_sequence( const unsigned char *text, size_t i, size_t length )
+{
+    unsigned int c = text[i];
+    unsigned int min = 0x80;
+    unsigned int max = 0xbf;
+    size_t size = 0;
+    size_t j = 0;
+
+    if( c < 0x80 )
+    {
+        return 1;
+    }
+
+    if( c >= 0xc2 && c <= 0xdf )
+    {
+        size = 2;
+    }
+    else if( c >= 0xe0 && c <= 0xef )
+    {
+        size = 3;
+        min = ( c == 0xe0 ) ? 0xa0 : 0x80;
+        max = ( c == 0xed ) ? 0x9f : 0xbf;
+    }
+    else if( c >= 0xf0 && c <= 0xf4 )
+    {
+        size = 4;
+        min = ( c == 0xf0 ) ? 0x90 : 0x80;
+        max = ( c == 0xf4 ) ? 0x8f : 0xbf;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if( i + size > length || text[i + 1] < min || text[i + 1] > max )
+    {
+        return 0;
+    }
+
+    for( j = 2; j < size; j++ )
+    {
+        if( ( text[i + j] & 0xc0 ) != 0x80 )
+        {
+            return 0;
+        }
+    }
+
+    return size;
+}
+
+
+static size_t IniConfigText_validateScalar( const unsigned char *text, size_t length )
+{
+    size_t i = 0;
+
+    while( i < length )
+    {
+        size_t size = 0;
+
+        if( i + 8 <= length && ( IniConfigText_load64( text + i ) & INICONFIGTEXT_ASCIIMASK ) == 0 )
+        {
+            i += 8;
+            continue;
+        }
+
+        size = IniConfigText_sequence( text, i, length );
+
+        if( size == 0 )
+        {
+            return i;
+        }
+
+        i += size;
+    }
+
+    return length;
+}
+
+
+#if defined(INICONFIGTEXT_SIMD)
+
+/*
+ * Checks 16 bytes at a time by looking up the error classes of every pair
+ * of neighbouring bytes by their nibbles, see J. Keiser and D. Lemire,
+ * "Validating UTF-8 In Less Than One Instruction Per Byte", Software:
+ * Practice and Experience, 2021. Only tells whether the whole text is
+ * valid.
+ */
+__attribute__(( target( "ssse3" ) ))
+static bool IniConfigText_validateSsse3( const unsigned char *text, size_t length )
+{
+    /* error classes of the pair of bytes */
+    const int tooShort = 1 << 0;        /* lead byte followed by a lead byte or ASCII */
+    const int tooLong = 1 << 1;         /* ASCII followed by a continuation byte */
+    const int overlong3 = 1 << 2;       /* 11100000 100_____ */
+    const int tooLarge = 1 << 3;        /* 11110100 1001____ and above */
+    const int surrogate = 1 << 4;       /* 11101101 101_____ */
+    const int overlong2 = 1 << 5;       /* 1100000_ 10______ */
+    const int tooLarge1000 = 1 << 6;    /* 11110101 1000____ and above */
+    const int overlong4 = 1 << 6;       /* 11110000 1000____ */
+    const int twoConts = 1 << 7;        /* continuation byte followed by a continuation byte */
+    const int carry = tooShort | tooLong | twoConts;
+    const __m128i byte1High = _mm_setr_epi8( tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,
+                                             twoConts, twoConts, twoConts, twoConts, tooShort | overlong2, tooShort,
+                                             tooShort | overlong3 | surrogate,
+                                             (char)( tooShort | tooLarge | tooLarge1000 | overlong4 ) );
+    const __m128i byte1Low = _mm_setr_epi8( (char)( carry | overlong3 | overlong2 | overlong4 ),
+                                            (char)( carry | overlong2 ), (char)carry, (char)carry,
+                                            (char)( carry | tooLarge ), (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 | surrogate ),
+                                            (char)( carry | tooLarge | tooLarge1000 ),
+                                            (char)( carry | tooLarge | tooLarge1000 ) );
+    const __m128i byte2High = _mm_setr_epi8( tooShort, tooShort, tooShort, tooShort,
+                                             tooShort, tooShort, tooShort, tooShort,
+                                             (char)( tooLong | overlong2 | twoConts | overlong3 | tooLarge1000 |
+                                                     overlong4 ),
+                                             (char)( tooLong | overlong2 | twoConts | overlong3 | tooLarge ),
+                                             (char)( tooLong | overlong2 | twoConts | surrogate | tooLarge ),
+                                             (char)( tooLong | overlong2 | twoConts | surrogate | tooLarge ),
+                                             tooShort, tooShort, tooShort, tooShort );
+    /* the last bytes of a block which need more bytes */
+    const __m128i incompleteAbove = _mm_setr_epi8( -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                   (char)( 0xf0 - 1 ), (char)( 0xe0 - 1 ), (char)( 0xc0 - 1 ) );
+    const __m128i nibble = _mm_set1_epi8( 0x0f );
+    __m128i previous = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+    size_t i = 0;
+
+    /* the last block is padded with zeros, which also catches a truncated last sequence */
+    for( i = 0; i <= length; i += 16 )
+    {
+        unsigned char last[16];
+        __m128i block;
+
+        if( i + 16 <= length )
+        {
+            block = _mm_loadu_si128( (const __m128i *)( text + i ) );
+        }
+        else
+        {
+            memset( last, 0, sizeof( last ) );
+            memcpy( last, text + i, length - i );
+            block = _mm_loadu_si128( (const __m128i *)last );
+        }
+
+        if( _mm_movemask_epi8( block ) == 0 )
+        {
+            error = _mm_or_si128( error, incomplete );
+        }
+        else
+        {
+            __m128i prev1 = _mm_alignr_epi8( block, previous, 15 );
+            __m128i prev2 = _mm_alignr_epi8( block, previous, 14 );
+            __m128i prev3 = _mm_alignr_epi8( block, previous, 13 );
+            __m128i special = _mm_and_si128(
+                _mm_and_si128( _mm_shuffle_epi8( byte1High, _mm_and_si128( _mm_srli_epi16( prev1, 4 ), nibble ) ),
+                               _mm_shuffle_epi8( byte1Low, _mm_and_si128( prev1, nibble ) ) ),
+                _mm_shuffle_epi8( byte2High, _mm_and_si128( _mm_srli_epi16( block, 4 ), nibble ) ) );
+            /* third and fourth bytes must be continuations, which the pair lookup leaves open */
+            __m128i must23 = _mm_or_si128( _mm_subs_epu8( prev2, _mm_set1_epi8( (char)( 0xe0 - 0x80 ) ) ),
+                                           _mm_subs_epu8( prev3, _mm_set1_epi8( (char)( 0xf0 - 0x80 ) ) ) );
+
+            error = _mm_or_si128( error,
+                                  _mm_xor_si128( _mm_and_si128( must23, _mm_set1_epi8( (char)0x80 ) ), special ) );
+            incomplete = _mm_subs_epu8( block, incompleteAbove );
+        }
+
+        previous = block;
+    }
+
+    return _mm_movemask_epi8( _mm_cmpeq_epi8( error, _mm_setzero_si128() ) ) == 0xffff;
+}
+
+#endif
+
+
+/*
+ * Public functions
+ */
+
+int IniConfigText_detect( const char *buffer, size_t length, size_t *bomLength )
+{
+    const unsigned char *bytes = (const unsigned char *)buffer;
+
+    ANY_REQUIRE( buffer || length == 0 );
+    ANY_REQUIRE( bomLength );
+
+    *bomLength = 0;
+
+    if( length >= 3 && bytes[0] == 0xef && bytes[1] == 0xbb && bytes[2] == 0xbf )
+    {
+        *bomLength = 3;
+        return INICONFIGTEXT_UTF8;
+    }
+
+    if( length < 2 )
+    {
+        return INICONFIGTEXT_UTF8;
+    }
+
+    if( bytes[0] == 0xff && bytes[1] == 0xfe )
+    {
+        *bomLength = 2;
+        return INICONFIGTEXT_UTF16LE;
+    }
+
+    if( bytes[0] == 0xfe && bytes[1] == 0xff )
+    {
+        *bomLength = 2;
+        return INICONFIGTEXT_UTF16BE;
+    }
+
+    /* the first character of an INI file is ASCII, which UTF-16 pads with a zero */
+    if( bytes[0] != 0 && bytes[1] == 0 )
+    {
+        return INICONFIGTEXT_UTF16LE;
+    }
+
+    if( bytes[0] == 0 && bytes[1] != 0 )
+    {
+        return INICONFIGTEXT_UTF16BE;
+    }
+
+    return INICONFIGTEXT_UTF8;
+}
+
+
+char *IniConfigText_fromUtf16( const char *buffer, size_t length, int encoding, size_t *textLength,
+                               size_t *errorOffset )
+{
+    const unsigned char *bytes = (const unsigned char *)buffer;
+    unsigned char *text = NULL;
+    size_t o = 0;
+    size_t i = 0;
+
+    ANY_REQUIRE( buffer || length == 0 );
+    ANY_REQUIRE( encoding == INICONFIGTEXT_UTF16LE || encoding == INICONFIGTEXT_UTF16BE );
+    ANY_REQUIRE( textLength );
+    ANY_REQUIRE( errorOffset );
+
+    /* at most 3 bytes per unit, surrogate pairs need 4 bytes for 2 units */
+    text = (unsigned char *)ANY_BALLOC( ( length / 2 ) * 3 + 1 );
+
+    if( text == NULL )
+    {
+        return NULL;
+    }
+
+    while( i + 2 <= length )
+    {
+        unsigned int unit = 0;
+
+#if defined(INICONFIGTEXT_SIMD)
+        /* runs of 8 ASCII characters */
+        while( i + 16 <= length )
+        {
+            __m128i units = _mm_loadu_si128( (const __m128i *)( bytes + i ) );
+
+            if( encoding == INICONFIGTEXT_UTF16BE )
+            {
+                units = _mm_or_si128( _mm_slli_epi16( units, 8 ), _mm_srli_epi16( units, 8 ) );
+            }
+
+            if( _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( units, _mm_set1_epi16( (short)0xff80 ) ),
+                                                    _mm_setzero_si128() ) ) != 0xffff )
+            {
+                break;
+            }
+
+            _mm_storel_epi64( (__m128i *)( text + o ), _mm_packus_epi16( units, units ) );
+
+            i += 16;
+            o += 8;
+        }
+
+        if( i + 2 > length )
+        {
+            break;
+        }
+#endif
+
+        unit = IniConfigText_unit( bytes + i, encoding );
+
+        if( unit < 0x80 )
+        {
+            text[o++] = (unsigned char)unit;
+        }
+        else if( unit < 0x800 )
+        {
+            text[o++] = (unsigned char)( 0xc0 | ( unit >> 6 ) );
+            text[o++] = (unsigned char)( 0x80 | ( unit & 0x3f ) );
+        }
+        else if( unit < 0xd800 || unit > 0xdfff )
+        {
+            text[o++] = (unsigned char)( 0xe0 | ( unit >> 12 ) );
+            text[o++] = (unsigned char)( 0x80 | ( ( unit >> 6 ) & 0x3f ) );
+            text[o++] = (unsigned char)( 0x80 | ( unit & 0x3f ) );
+        }
+        else
+        {
+            unsigned int low = ( unit < 0xdc00 && i + 4 <= length ) ? IniConfigText_unit( bytes + i + 2, encoding )
+                                                                    : 0;
+            unsigned int codePoint = 0;
+
+            if( low < 0xdc00 || low > 0xdfff )
+            {
+                *errorOffset = i;
+                ANY_FREE( text );
+                return NULL;
+            }
+
+            codePoint = 0x10000 + ( ( unit - 0xd800 ) << 10 ) + ( low - 0xdc00 );
+
+            text[o++] = (unsigned char)( 0xf0 | ( codePoint >> 18 ) );
+            text[o++] = (unsigned char)( 0x80 | ( ( codePoint >> 12 ) & 0x3f ) );
+            text[o++] = (unsigned char)( 0x80 | ( ( codePoint >> 6 ) & 0x3f ) );
+            text[o++] = (unsigned char)( 0x80 | ( codePoint & 0x3f ) );
+
+            i += 2;
+        }
+
+        i += 2;
+    }
+
+    if( i != length )
+    {
+        *errorOffset = i;
+        ANY_FREE( text );
+        return NULL;
+    }
+
+    text[o] = '\0';
+    *textLength = o;
+
+    return (char *)text;
+}
+
+
+size_t IniConfigText_validate( const char *text, size_t length )
+{
+    ANY_REQUIRE( text || length == 0 );
+
+#if defined(INICONFIGTEXT_SIMD)
+    /* the exact offset is only needed for invalid files */
+    if( __builtin_cpu_supports( "ssse3" ) && IniConfigText_validateSsse3( (const unsigned char *)text, length ) )
+    {
+        return length;
+    }
+#endif
+
+    return IniConfigText_validateScalar( (const unsigned char *)text, length );
+}
+
+
+int IniConfigText_getLine( const char *text, size_t offset, int encoding )
+{
+    const unsigned char *bytes = (const unsigned char *)text;
+    int line = 1;
+    size_t i = 0;
+
+    ANY_REQUIRE( text || offset == 0 );
+
+    if( encoding == INICONFIGTEXT_UTF8 )
+    {
+        const char *eol = NULL;
+
+        while( i < offset && ( eol = (const char *)memchr( text + i, '\n', offset - i ) ) != NULL )
+        {
+            line++;
+            i = (size_t)( eol - text ) + 1;
+        }
+
+        return line;
+    }
+
+    for( i = 0; i + 2 <= offset; i += 2 )
+    {
+        if( IniConfigText_unit( bytes + i, encoding ) == '\n' )
+        {
+            line++;
+        }
+    }
+
+    return line;
+}
@@ -0,0 +1,129 @@
+/*
+ *  Text encoding checks and conversions of loaded files
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigText Text encodings
+ *
+ * minIni treats a file as bytes: a byte order mark ends up in the first
+ * key or section name, UTF-16 files cannot be read at all and invalid
+ * UTF-8 reaches every consumer of the values. IniConfigFile_setTextFlags()
+ * adds a stage between reading a file and parsing it:
+ *
+ *  - INICONFIGTEXT_TRANSCODE drops a UTF-8 byte order mark and converts
+ *    UTF-16 files, with or without byte order mark, to UTF-8. Saving
+ *    writes UTF-8 and keeps a byte order mark if the file had one.
+ *  - INICONFIGTEXT_VALIDATE refuses to load files which are not valid
+ *    UTF-8. The number of the offending line is logged and returned by
+ *    IniConfigFile_getInvalidLine().
+ *
+ * Both run over the whole file at once. On x86-64 the validator checks 16
+ * bytes per step with SSSE3 if the processor has it, and the converter
+ * copies runs of ASCII characters 8 at a time with SSE2; elsewhere both
+ * skip ASCII 8 bytes at a time. Either way they take a small fraction of
+ * the time parsing needs.
+ */
+
+#ifndef INICONFIGTEXT_H
+#define INICONFIGTEXT_H
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Stages run on a file before it is parsed
+ */
+typedef enum IniConfigTextFlags
+{
+    INICONFIGTEXT_NONE = 0,             /**< Bytes are parsed as they are, like minIni does */
+    INICONFIGTEXT_TRANSCODE = 1,        /**< Drop byte order marks, convert UTF-16 to UTF-8 */
+    INICONFIGTEXT_VALIDATE = 2          /**< Refuse files which are not valid UTF-8 */
+}
+IniConfigTextFlags;
+
+/*!
+ * \brief Encoding of a file
+ */
+typedef enum IniConfigTextEncoding
+{
+    INICONFIGTEXT_UTF8 = 0,             /**< UTF-8 or any other byte encoding */
+    INICONFIGTEXT_UTF16LE,              /**< UTF-16, little endian */
+    INICONFIGTEXT_UTF16BE               /**< UTF-16, big endian */
+}
+IniConfigTextEncoding;
+
+/*!
+ * \brief Find out the encoding of a file
+ *
+ * \param buffer     Contents of the file
+ * \param length     Size of buffer
+ * \param bomLength  Receives the size of the byte order mark, 0 if there
+ *                   is none
+ *
+ * Files without byte order mark are taken for UTF-16 if exactly one of
+ * their first two bytes is zero.
+ *
+ * \return The IniConfigTextEncoding of the file
+ */
+int IniConfigText_detect( const char *buffer, size_t length, size_t *bomLength );
+
+/*!
+ * \brief Convert UTF-16 to UTF-8
+ *
+ * \param buffer       UTF-16 text without byte order mark
+ * \param length       Size of buffer in bytes
+ * \param encoding     INICONFIGTEXT_UTF16LE or INICONFIGTEXT_UTF16BE
+ * \param textLength   Receives the size of the result
+ * \param errorOffset  Receives the byte offset of an unpaired surrogate or
+ *                     of an odd last byte
+ *
+ * \return The UTF-8 text allocated with ANY_BALLOC(), NULL on error
+ */
+char *IniConfigText_fromUtf16( const char *buffer, size_t length, int encoding, size_t *textLength,
+                               size_t *errorOffset );
+
+/*!
+ * \brief Check that a text is valid UTF-8
+ *
+ * \param text    Text to check
+ * \param length  Size of text
+ *
+ * Overlong forms, surrogates, code points above U+10FFFF and truncated
+ * sequences are invalid.
+ *
+ * \return The offset of the first invalid sequence, length if there is
+ *         none
+ */
+size_t IniConfigText_validate( const char *text, size_t length );
+
+/*!
+ * \brief Number of the line containing an offset
+ *
+ * \param text      Text
+ * \param offset    Byte offset into text
+ * \param encoding  IniConfigTextEncoding of text
+ *
+ * \return The line number, starting at 1
+ */
+int IniConfigText_getLine( const char *text, size_t offset, int encoding );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGTEXT_H */
@@ -0,0 +1,233 @@
+/*
+ *  Parser for values with units
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IniConfigUnits.h>
+
+#define INICONFIGUNITS_KIB   1024.0
+#define INICONFIGUNITS_MIB   ( 1024.0 * 1024.0 )
+#define INICONFIGUNITS_GIB   ( 1024.0 * 1024.0 * 1024.0 )
+#define INICONFIGUNITS_TIB   ( 1024.0 * 1024.0 * 1024.0 * 1024.0 )
+
+
+typedef struct IniConfigUnitsSuffix
+{
+    const char *suffix;
+    unsigned int length;
+    int kind;
+    double factor;                      /* to the canonical unit of kind */
+}
+IniConfigUnitsSuffix;
+
+
+static const IniConfigUnitsSuffix IniConfigUnits_suffixes[] =
+{
+    { "ns",         2, INICONFIGUNITS_DURATION,  1.0 },
+    { "us",         2, INICONFIGUNITS_DURATION,  1e3 },
+    { "\xc2\xb5s",  3, INICONFIGUNITS_DURATION,  1e3 },
+    { "ms",         2, INICONFIGUNITS_DURATION,  1e6 },
+    { "s",          1, INICONFIGUNITS_DURATION,  1e9 },
+    { "sec",        3, INICONFIGUNITS_DURATION,  1e9 },
+    { "min",        3, INICONFIGUNITS_DURATION,  60e9 },
+    { "h",          1, INICONFIGUNITS_DURATION,  3600e9 },
+    { "d",          1, INICONFIGUNITS_DURATION,  86400e9 },
+    { "B",          1, INICONFIGUNITS_BYTESIZE,  1.0 },
+    { "kB",         2, INICONFIGUNITS_BYTESIZE,  1e3 },
+    { "KB",         2, INICONFIGUNITS_BYTESIZE,  1e3 },
+    { "MB",         2, INICONFIGUNITS_BYTESIZE,  1e6 },
+    { "GB",         2, INICONFIGUNITS_BYTESIZE,  1e9 },
+    { "TB",         2, INICONFIGUNITS_BYTESIZE,  1e12 },
+    { "KiB",        3, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_KIB },
+    { "MiB",        3, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_MIB },
+    { "GiB",        3, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_GIB },
+    { "TiB",        3, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_TIB },
+    { "K",          1, INICONFIGUNITS_BYTESIZE,  1e3 },
+    { "k",          1, INICONFIGUNITS_BYTESIZE,  1e3 },
+    { "M",          1, INICONFIGUNITS_BYTESIZE,  1e6 },
+    { "G",          1, INICONFIGUNITS_BYTESIZE,  1e9 },
+    { "T",          1, INICONFIGUNITS_BYTESIZE,  1e12 },
+    { "Ki",         2, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_KIB },
+    { "Mi",         2, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_MIB },
+    { "Gi",         2, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_GIB },
+    { "Ti",         2, INICONFIGUNITS_BYTESIZE,  INICONFIGUNITS_TIB },
+    { "Hz",         2, INICONFIGUNITS_FREQUENCY, 1.0 },
+    { "kHz",        3, INICONFIGUNITS_FREQUENCY, 1e3 },
+    { "MHz",        3, INICONFIGUNITS_FREQUENCY, 1e6 },
+    { "GHz",        3, INICONFIGUNITS_FREQUENCY, 1e9 }
+};
+
+#define INICONFIGUNITS_NUMSUFFIXES  ( sizeof( IniConfigUnits_suffixes ) / sizeof( IniConfigUnits_suffixes[0] ) )
+
+
+/*
+ * Private functions
+ */
+
+static int IniConfigUnits_isSpace( char c )
+{
+    return ( c > '\0' && c <= ' ' );
+}
+
+
+/*
+ * Length of the decimal number at the start of text: digits with an
+ * optional fraction and exponent, no hexadecimal, "inf" or "nan"
+ */
+static size_t IniConfigUnits_decimalLength( const char *text )
+{
+    const char *p = text;
+    const char *exponent = NULL;
+    int numDigits = 0;
+
+    if( *p == '+' || *p == '-' )
+    {
+        p++;
+    }
+
+    for( ; *p >= '0' && *p <= '9'; p++ )
+    {
+        numDigits++;
+    }
+
+    if( *p == '.' )
+    {
+        for( p++; *p >= '0' && *p <= '9'; p++ )
+        {
+            numDigits++;
+        }
+    }
+
+    if( numDigits == 0 )
+    {
+        return 0;
+    }
+
+    if( *p == 'e' || *p == 'E' )
+    {
+        exponent = p++;
+
+        if( *p == '+' || *p == '-' )
+        {
+            p++;
+        }
+
+        if( !( *p >= '0' && *p <= '9' ) )
+        {
+            /* "2E" is the number 2 with a suffix */
+            return (size_t)( exponent - text );
+        }
+
+        while( *p >= '0' && *p <= '9' )
+        {
+            p++;
+        }
+    }
+
+    return (size_t)( p - text );
+}
+
+
+/*
+ * Public functions
+ */
+
+int IniConfigUnits_parse( const char *text, double *quantity )
+{
+    char *end = NULL;
+    double number = 0.0;
+    size_t length = 0;
+    unsigned int i = 0;
+
+    ANY_REQUIRE( text );
+    ANY_REQUIRE( quantity );
+
+    while( IniConfigUnits_isSpace( *text ) )
+    {
+        text++;
+    }
+
+    /* strtod() would also take hexadecimal numbers, "inf" and "nan" */
+    length = IniConfigUnits_decimalLength( text );
+
+    if( length == 0 )
+    {
+        return INICONFIGUNITS_TEXT;
+    }
+
+    number = strtod( text, &end );
+
+    if( end != text + length || !isfinite( number ) )
+    {
+        return INICONFIGUNITS_TEXT;
+    }
+
+    while( IniConfigUnits_isSpace( *end ) )
+    {
+        end++;
+    }
+
+    length = strlen( end );
+
+    while( length > 0 && IniConfigUnits_isSpace( end[length - 1] ) )
+    {
+        length--;
+    }
+
+    if( length == 0 )
+    {
+        *quantity = number;
+        return INICONFIGUNITS_NUMBER;
+    }
+
+    for( i = 0; i < INICONFIGUNITS_NUMSUFFIXES; i++ )
+    {
+        const IniConfigUnitsSuffix *entry = &IniConfigUnits_suffixes[i];
+
+        if( entry->length == length && memcmp( entry->suffix, end, length ) == 0 )
+        {
+            *quantity = number * entry->factor;
+            return entry->kind;
+        }
+    }
+
+    return INICONFIGUNITS_TEXT;
+}
+
+
+bool IniConfigUnits_convert( int kind, double quantity, int wanted, double *value )
+{
+    ANY_REQUIRE( value );
+
+    if( kind == wanted )
+    {
+        *value = quantity;
+        return true;
+    }
+
+    if( kind != INICONFIGUNITS_NUMBER )
+    {
+        return false;
+    }
+
+    /* plain numbers count in seconds, bytes or hertz */
+    *value = ( wanted == INICONFIGUNITS_DURATION ) ? quantity * 1e9 : quantity;
+
+    return true;
+}
@@ -0,0 +1,95 @@
+/*
+ *  Parser for values with units
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigUnits Values with units
+ *
+ * IniConfigFile_getDuration(), IniConfigFile_getByteSize() and
+ * IniConfigFile_getFrequency() read values like "250ms", "4 MiB" or
+ * "100Hz". A number may be followed by white space and one of these
+ * suffixes, which are case-sensitive:
+ *
+ * <table>
+ * <tr><th>Quantity</th><th>Suffixes</th><th>Canonical unit</th></tr>
+ * <tr><td>Duration</td><td>ns, us, &micro;s, ms, s, sec, min, h, d</td><td>nanosecond</td></tr>
+ * <tr><td>Byte size</td><td>B; k, K, kB, KB, M, MB, G, GB, T, TB (SI, powers
+ *         of 1000); Ki, KiB, Mi, MiB, Gi, GiB, Ti, TiB (IEC, powers of
+ *         1024)</td><td>byte</td></tr>
+ * <tr><td>Frequency</td><td>Hz, kHz, MHz, GHz</td><td>hertz</td></tr>
+ * </table>
+ *
+ * A number without suffix counts in seconds, bytes or hertz. Numbers are
+ * decimal, with an optional fraction and exponent; hexadecimal numbers,
+ * "inf", "nan" and numbers too large for a double are no quantities.
+ *
+ * Loaded files parse every value only once: the store keeps the result
+ * next to the value until a put replaces it, and frozen or published
+ * indexes convert all values while they are built.
+ */
+
+#ifndef INICONFIGUNITS_H
+#define INICONFIGUNITS_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief Kind of a parsed value
+ *
+ * Starts at 1, so that caches can use 0 for values not parsed yet.
+ */
+typedef enum IniConfigUnitsKind
+{
+    INICONFIGUNITS_TEXT = 1,            /**< Not a number, or an unknown suffix */
+    INICONFIGUNITS_NUMBER,              /**< Number without suffix */
+    INICONFIGUNITS_DURATION,            /**< Duration in nanoseconds */
+    INICONFIGUNITS_BYTESIZE,            /**< Size in bytes */
+    INICONFIGUNITS_FREQUENCY            /**< Frequency in hertz */
+}
+IniConfigUnitsKind;
+
+/*!
+ * \brief Parse a value with an optional unit suffix
+ *
+ * \param text      Value to parse
+ * \param quantity  Receives the value in the canonical unit of its kind,
+ *                  unchanged for INICONFIGUNITS_TEXT
+ *
+ * \return The IniConfigUnitsKind of the value
+ */
+int IniConfigUnits_parse( const char *text, double *quantity );
+
+/*!
+ * \brief Express a parsed value as a quantity of a given kind
+ *
+ * \param kind      Kind returned by IniConfigUnits_parse()
+ * \param quantity  Value returned by IniConfigUnits_parse()
+ * \param wanted    INICONFIGUNITS_DURATION, INICONFIGUNITS_BYTESIZE or
+ *                  INICONFIGUNITS_FREQUENCY
+ * \param value     Receives the value in the canonical unit of wanted
+ *
+ * Numbers without suffix count in seconds, bytes or hertz.
+ *
+ * \return Returns false if the value is not of the wanted kind
+ */
+bool IniConfigUnits_convert( int kind, double quantity, int wanted, double *value );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGUNITS_H */
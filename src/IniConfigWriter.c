@@ -0,0 +1,599 @@
+/*
+ *  Streaming INI file writer
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <Any.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <IniConfigWriter.h>
+
+#define INICONFIGWRITER_VALID       0x3b1e7a11
+#define INICONFIGWRITER_INVALID     0xb00db00f
+
+#define INICONFIGWRITER_ALIGNMENT   4096
+#define INICONFIGWRITER_NUMBERSIZE  32
+
+
+static const char IniConfigWriter_digits[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+
+/*
+ * Private functions
+ */
+
+static bool IniConfigWriter_setup( IniConfigWriter *self, size_t bufferSize )
+{
+    void *buffer = NULL;
+
+    self->bufferSize = ( bufferSize != 0 ) ? bufferSize : INICONFIGWRITER_BUFFERSIZE;
+
+    /* short lines must always fit into the buffer */
+    if( self->bufferSize < INICONFIGWRITER_ALIGNMENT )
+    {
+        self->bufferSize = INICONFIGWRITER_ALIGNMENT;
+    }
+
+    if( posix_memalign( &buffer, INICONFIGWRITER_ALIGNMENT, self->bufferSize ) != 0 )
+    {
+        return false;
+    }
+
+    self->buffer = (char *)buffer;
+    self->used = 0;
+    self->written = 0;
+    self->lines = 0;
+    self->error = 0;
+
+    return true;
+}
+
+
+static bool IniConfigWriter_flush( IniConfigWriter *self )
+{
+    struct iovec iov;
+
+    if( self->used == 0 || self->error )
+    {
+        return !self->error;
+    }
+
+    iov.iov_base = self->buffer;
+    iov.iov_len = self->used;
+
+    if( !IniConfigAtomicFile_writev( self->fd, &iov, 1 ) )
+    {
+        self->error = 1;
+        return false;
+    }
+
+    self->written += self->used;
+    self->used = 0;
+
+    return true;
+}
+
+
+static bool IniConfigWriter_append( IniConfigWriter *self, const char *data, size_t length )
+{
+    struct iovec iov[2];
+
+    if( self->error )
+    {
+        return false;
+    }
+
+    if( length <= self->bufferSize - self->used )
+    {
+        memcpy( self->buffer + self->used, data, length );
+        self->used += length;
+        return true;
+    }
+
+    if( length < self->bufferSize / 2 )
+    {
+        if( !IniConfigWriter_flush( self ) )
+        {
+            return false;
+        }
+
+        memcpy( self->buffer, data, length );
+        self->used = length;
+        return true;
+    }
+
+    /* large blocks go out together with the pending output, without a copy */
+    iov[0].iov_base = self->buffer;
+    iov[0].iov_len = self->used;
+    iov[1].iov_base = (void *)data;
+    iov[1].iov_len = length;
+
+    if( !IniConfigAtomicFile_writev( self->fd, iov, 2 ) )
+    {
+        self->error = 1;
+        return false;
+    }
+
+    self->written += self->used + length;
+    self->used = 0;
+
+    return true;
+}
+
+
+/*
+ * Returns room for at least "length" bytes in the output buffer
+ */
+static char *IniConfigWriter_reserve( IniConfigWriter *self, size_t length )
+{
+    if( self->error )
+    {
+        return NULL;
+    }
+
+    if( length > self->bufferSize - self->used && !IniConfigWriter_flush( self ) )
+    {
+        return NULL;
+    }
+
+    return self->buffer + self->used;
+}
+
+
+/*
+ * Formats an integer right-to-left two digits at a time, returns its length
+ */
+static size_t IniConfigWriter_formatLong( char *out, long long value )
+{
+    char digits[INICONFIGWRITER_NUMBERSIZE];
+    char *p = digits + sizeof( digits );
+    unsigned long long magnitude = ( value < 0 ) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    size_t length = 0;
+
+    while( magnitude >= 100 )
+    {
+        unsigned int pair = (unsigned int)( magnitude % 100 ) * 2;
+
+        magnitude /= 100;
+        *--p = IniConfigWriter_digits[pair + 1];
+        *--p = IniConfigWriter_digits[pair];
+    }
+
+    if( magnitude >= 10 )
+    {
+        *--p = IniConfigWriter_digits[magnitude * 2 + 1];
+        *--p = IniConfigWriter_digits[magnitude * 2];
+    }
+    else
+    {
+        *--p = (char)( '0' + magnitude );
+    }
+
+    if( value < 0 )
+    {
+        *--p = '-';
+    }
+
+    length = (size_t)( digits + sizeof( digits ) - p );
+    memcpy( out, p, length );
+
+    return length;
+}
+
+
+/*
+ * Formats a double with the shortest of %.15g and %.17g that reads back
+ * exactly; integral values take the integer path
+ */
+static size_t IniConfigWriter_formatDouble( char *out, double value )
+{
+    int length = 0;
+
+    if( value > -1e15 && value < 1e15 && (double)(long long)value == value && !( value == 0.0 && signbit( value ) ) )
+    {
+        return IniConfigWriter_formatLong( out, (long long)value );
+    }
+
+    length = snprintf( out, INICONFIGWRITER_NUMBERSIZE, "%.15g", value );
+
+    if( isfinite( value ) && strtod( out, NULL ) != value )
+    {
+        length = snprintf( out, INICONFIGWRITER_NUMBERSIZE, "%.17g", value );
+    }
+
+    return (size_t)length;
+}
+
+
+/*
+ * Writes "key=" into the output buffer
+ */
+static bool IniConfigWriter_beginKey( IniConfigWriter *self, const char *key )
+{
+    size_t length = strlen( key );
+
+    if( !IniConfigWriter_append( self, key, length ) || !IniConfigWriter_append( self, "=", 1 ) )
+    {
+        return false;
+    }
+
+    self->lines++;
+
+    return true;
+}
+
+
+static bool IniConfigWriter_putNumber( IniConfigWriter *self, const char *key, long long value )
+{
+    char *p = NULL;
+    size_t length = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+    ANY_REQUIRE( key );
+
+    if( !IniConfigWriter_beginKey( self, key ) )
+    {
+        return false;
+    }
+
+    p = IniConfigWriter_reserve( self, INICONFIGWRITER_NUMBERSIZE + 1 );
+
+    if( p == NULL )
+    {
+        return false;
+    }
+
+    length = IniConfigWriter_formatLong( p, value );
+    p[length] = '\n';
+    self->used += length + 1;
+
+    return true;
+}
+
+
+/*
+ * Public functions
+ */
+
+IniConfigWriter *IniConfigWriter_new( void )
+{
+    return ( ANY_TALLOC( IniConfigWriter ) );
+}
+
+
+bool IniConfigWriter_init( IniConfigWriter *self, const char *fileName, size_t bufferSize )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( fileName );
+
+    self->valid = INICONFIGWRITER_INVALID;
+    self->buffer = NULL;
+    self->file = IniConfigAtomicFile_new();
+
+    if( self->file == NULL )
+    {
+        return false;
+    }
+
+    if( !IniConfigAtomicFile_init( self->file, fileName ) )
+    {
+        IniConfigAtomicFile_delete( self->file );
+        self->file = NULL;
+        return false;
+    }
+
+    self->fd = IniConfigAtomicFile_getFd( self->file );
+
+    if( !IniConfigWriter_setup( self, bufferSize ) )
+    {
+        IniConfigAtomicFile_clear( self->file );
+        IniConfigAtomicFile_delete( self->file );
+        self->file = NULL;
+        return false;
+    }
+
+    self->valid = INICONFIGWRITER_VALID;
+
+    return true;
+}
+
+
+bool IniConfigWriter_initFd( IniConfigWriter *self, int fd, size_t bufferSize )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( fd >= 0 );
+
+    self->valid = INICONFIGWRITER_INVALID;
+    self->file = NULL;
+    self->fd = fd;
+
+    if( !IniConfigWriter_setup( self, bufferSize ) )
+    {
+        return false;
+    }
+
+    self->valid = INICONFIGWRITER_VALID;
+
+    return true;
+}
+
+
+void IniConfigWriter_setDurability( IniConfigWriter *self, IniConfigAtomicFileDurability durability )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+
+    if( self->file != NULL )
+    {
+        IniConfigAtomicFile_setDurability( self->file, durability );
+    }
+}
+
+
+bool IniConfigWriter_putSection( IniConfigWriter *self, const char *section )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+    ANY_REQUIRE( section );
+
+    /* an empty line between sections, like minIni writes them */
+    if( self->lines > 0 && !IniConfigWriter_append( self, "\n", 1 ) )
+    {
+        return false;
+    }
+
+    self->lines++;
+
+    return IniConfigWriter_append( self, "[", 1 ) &&
+           IniConfigWriter_append( self, section, strlen( section ) ) &&
+           IniConfigWriter_append( self, "]\n", 2 );
+}
+
+
+bool IniConfigWriter_putString( IniConfigWriter *self, const char *key, const char *value )
+{
+    const char *p = NULL;
+    const char *start = NULL;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( value );
+
+    if( !IniConfigWriter_beginKey( self, key ) )
+    {
+        return false;
+    }
+
+    /* same rule as IniConfigFile_putString(): quote on '"', ';', '#' or a trailing space */
+    for( p = value; *p != '\0' && *p != '"' && *p != ';' && *p != '#'; p++ )
+    {
+    }
+
+    if( *p == '\0' && !( p > value && p[-1] == ' ' ) )
+    {
+        return IniConfigWriter_append( self, value, (size_t)( p - value ) ) &&
+               IniConfigWriter_append( self, "\n", 1 );
+    }
+
+    if( !IniConfigWriter_append( self, "\"", 1 ) )
+    {
+        return false;
+    }
+
+    for( start = p = value; *p != '\0'; p++ )
+    {
+        if( *p == '"' )
+        {
+            if( !IniConfigWriter_append( self, start, (size_t)( p - start ) ) ||
+                !IniConfigWriter_append( self, "\\", 1 ) )
+            {
+                return false;
+            }
+
+            start = p;
+        }
+    }
+
+    return IniConfigWriter_append( self, start, (size_t)( p - start ) ) &&
+           IniConfigWriter_append( self, "\"\n", 2 );
+}
+
+
+bool IniConfigWriter_putInt( IniConfigWriter *self, const char *key, int value )
+{
+    return IniConfigWriter_putNumber( self, key, value );
+}
+
+
+bool IniConfigWriter_putLong( IniConfigWriter *self, const char *key, long value )
+{
+    return IniConfigWriter_putNumber( self, key, value );
+}
+
+
+bool IniConfigWriter_putDouble( IniConfigWriter *self, const char *key, double value )
+{
+    char *p = NULL;
+    size_t length = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+    ANY_REQUIRE( key );
+
+    if( !IniConfigWriter_beginKey( self, key ) )
+    {
+        return false;
+    }
+
+    p = IniConfigWriter_reserve( self, INICONFIGWRITER_NUMBERSIZE + 1 );
+
+    if( p == NULL )
+    {
+        return false;
+    }
+
+    length = IniConfigWriter_formatDouble( p, value );
+    p[length] = '\n';
+    self->used += length + 1;
+
+    return true;
+}
+
+
+bool IniConfigWriter_putLongArray( IniConfigWriter *self, const char *key, const long *values, size_t count )
+{
+    size_t i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( values || count == 0 );
+
+    if( !IniConfigWriter_beginKey( self, key ) )
+    {
+        return false;
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        char *p = IniConfigWriter_reserve( self, INICONFIGWRITER_NUMBERSIZE + 1 );
+
+        if( p == NULL )
+        {
+            return false;
+        }
+
+        if( i > 0 )
+        {
+            *p++ = ',';
+            self->used++;
+        }
+
+        self->used += IniConfigWriter_formatLong( p, values[i] );
+    }
+
+    return IniConfigWriter_append( self, "\n", 1 );
+}
+
+
+bool IniConfigWriter_putDoubleArray( IniConfigWriter *self, const char *key, const double *values, size_t count )
+{
+    size_t i = 0;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+    ANY_REQUIRE( key );
+    ANY_REQUIRE( values || count == 0 );
+
+    if( !IniConfigWriter_beginKey( self, key ) )
+    {
+        return false;
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        char *p = IniConfigWriter_reserve( self, INICONFIGWRITER_NUMBERSIZE + 1 );
+
+        if( p == NULL )
+        {
+            return false;
+        }
+
+        if( i > 0 )
+        {
+            *p++ = ',';
+            self->used++;
+        }
+
+        self->used += IniConfigWriter_formatDouble( p, values[i] );
+    }
+
+    return IniConfigWriter_append( self, "\n", 1 );
+}
+
+
+bool IniConfigWriter_close( IniConfigWriter *self )
+{
+    bool retVal = false;
+
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+
+    retVal = IniConfigWriter_flush( self );
+
+    if( self->file != NULL )
+    {
+        if( retVal )
+        {
+            retVal = IniConfigAtomicFile_commit( self->file );
+        }
+        else
+        {
+            IniConfigAtomicFile_abort( self->file );
+        }
+
+        IniConfigAtomicFile_clear( self->file );
+        IniConfigAtomicFile_delete( self->file );
+        self->file = NULL;
+    }
+
+    self->fd = -1;
+
+    return retVal;
+}
+
+
+void IniConfigWriter_clear( IniConfigWriter *self )
+{
+    ANY_REQUIRE( self );
+    ANY_REQUIRE( self->valid == INICONFIGWRITER_VALID );
+
+    if( self->file != NULL )
+    {
+        IniConfigAtomicFile_clear( self->file );
+        IniConfigAtomicFile_delete( self->file );
+        self->file = NULL;
+    }
+
+    free( self->buffer );
+    self->buffer = NULL;
+
+    self->valid = INICONFIGWRITER_INVALID;
+}
+
+
+void IniConfigWriter_delete( IniConfigWriter *self )
+{
+    ANY_REQUIRE( self );
+
+    ANY_FREE( self );
+}
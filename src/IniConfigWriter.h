@@ -0,0 +1,254 @@
+/*
+ *  Streaming INI file writer
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+/*!
+ * \page IniConfigWriter Streaming INI file writer
+ *
+ * IniConfigFile_putString() and friends rewrite the whole file on every
+ * call, which makes generating large files quadratic. An IniConfigWriter
+ * instead streams sections and key/value pairs front to back into a large
+ * page-aligned buffer which is flushed with write()/writev(). Values larger
+ * than the buffer are passed to writev() directly without being copied.
+ *
+ * When writing to a file name the output goes to a temporary file which
+ * replaces the destination atomically in IniConfigWriter_close(), so readers
+ * never see a half-written file. Alternatively the writer can stream to an
+ * already opened file descriptor (pipe, socket, ...).
+ *
+ * \code
+ *  IniConfigWriter *writer = IniConfigWriter_new();
+ *
+ *  IniConfigWriter_init( writer, "generated.ini", 0 );
+ *
+ *  IniConfigWriter_putSection( writer, "Joints" );
+ *
+ *  for( i = 0; i < numJoints; i++ )
+ *  {
+ *    Any_snprintf( key, 64, "offset%d", i );
+ *    IniConfigWriter_putDouble( writer, key, offsets[i] );
+ *  }
+ *
+ *  if( !IniConfigWriter_close( writer ) )
+ *  {
+ *    ANY_LOG( 0, "Unable to write generated.ini", ANY_LOG_ERROR );
+ *  }
+ *
+ *  IniConfigWriter_clear( writer );
+ *  IniConfigWriter_delete( writer );
+ * \endcode
+ *
+ * Values are quoted following the same rules as IniConfigFile_putString().
+ * Arrays are written as a comma-separated list on a single line.
+ */
+
+#ifndef INICONFIGWRITER_H
+#define INICONFIGWRITER_H
+
+#include <stddef.h>
+
+#include <IniConfigAtomicFile.h>
+
+/*!
+ * \brief Default size of the output buffer
+ */
+#define INICONFIGWRITER_BUFFERSIZE  ( 1024 * 1024 )
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+ * \brief IniConfigWriter definition
+ */
+typedef struct IniConfigWriter
+{
+    unsigned long valid;         /**< Object validity */
+    IniConfigAtomicFile *file;   /**< Temporary file, NULL when writing to a caller descriptor */
+    int fd;                      /**< Output descriptor */
+    char *buffer;                /**< Page-aligned output buffer */
+    size_t bufferSize;           /**< Size of the output buffer */
+    size_t used;                 /**< Bytes pending in the output buffer */
+    unsigned long long written;  /**< Bytes passed to the kernel so far */
+    int lines;                   /**< Number of lines written so far */
+    int error;                   /**< An output error occurred */
+}
+IniConfigWriter;
+
+/*!
+ * \brief Allocate a new IniConfigWriter instance
+ *
+ * \return A new IniConfigWriter instance, NULL on error
+ *
+ * \see IniConfigWriter_init()
+ */
+IniConfigWriter *IniConfigWriter_new( void );
+
+/*!
+ * \brief Start writing a new INI file
+ *
+ * \param self        Pointer to the IniConfigWriter
+ * \param fileName    Destination file, replaced atomically by IniConfigWriter_close()
+ * \param bufferSize  Size of the output buffer, 0 for INICONFIGWRITER_BUFFERSIZE
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigWriter_initFd()
+ * \see IniConfigWriter_close()
+ */
+bool IniConfigWriter_init( IniConfigWriter *self, const char *fileName, size_t bufferSize );
+
+/*!
+ * \brief Start writing to an open file descriptor
+ *
+ * \param self        Pointer to the IniConfigWriter
+ * \param fd          Output descriptor, not closed by the writer
+ * \param bufferSize  Size of the output buffer, 0 for INICONFIGWRITER_BUFFERSIZE
+ *
+ * \return Returns true on success, false otherwise
+ *
+ * \see IniConfigWriter_init()
+ */
+bool IniConfigWriter_initFd( IniConfigWriter *self, int fd, size_t bufferSize );
+
+/*!
+ * \brief Select the flushes done by IniConfigWriter_close()
+ *
+ * \param self        Pointer to the IniConfigWriter
+ * \param durability  Durability level, see IniConfigAtomicFile_setDurability()
+ *
+ * Has no effect on writers started with IniConfigWriter_initFd().
+ *
+ * \return Nothing
+ */
+void IniConfigWriter_setDurability( IniConfigWriter *self, IniConfigAtomicFileDurability durability );
+
+/*!
+ * \brief Start a new section
+ *
+ * \param self     Pointer to the IniConfigWriter
+ * \param section  Section name
+ *
+ * Keys written before the first section end up outside any section.
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putSection( IniConfigWriter *self, const char *section );
+
+/*!
+ * \brief Write a string value
+ *
+ * \param self   Pointer to the IniConfigWriter
+ * \param key    Key name
+ * \param value  Value, quoted if it contains '"', ';', '#' or trailing spaces
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putString( IniConfigWriter *self, const char *key, const char *value );
+
+/*!
+ * \brief Write an int value
+ *
+ * \param self   Pointer to the IniConfigWriter
+ * \param key    Key name
+ * \param value  Value to write
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putInt( IniConfigWriter *self, const char *key, int value );
+
+/*!
+ * \brief Write a long value
+ *
+ * \param self   Pointer to the IniConfigWriter
+ * \param key    Key name
+ * \param value  Value to write
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putLong( IniConfigWriter *self, const char *key, long value );
+
+/*!
+ * \brief Write a double value
+ *
+ * \param self   Pointer to the IniConfigWriter
+ * \param key    Key name
+ * \param value  Value to write, with the shortest representation that reads back exactly
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putDouble( IniConfigWriter *self, const char *key, double value );
+
+/*!
+ * \brief Write an array of long values
+ *
+ * \param self    Pointer to the IniConfigWriter
+ * \param key     Key name
+ * \param values  Values to write
+ * \param count   Number of values
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putLongArray( IniConfigWriter *self, const char *key, const long *values, size_t count );
+
+/*!
+ * \brief Write an array of double values
+ *
+ * \param self    Pointer to the IniConfigWriter
+ * \param key     Key name
+ * \param values  Values to write
+ * \param count   Number of values
+ *
+ * \return Returns true on success, false otherwise
+ */
+bool IniConfigWriter_putDoubleArray( IniConfigWriter *self, const char *key, const double *values, size_t count );
+
+/*!
+ * \brief Flush all pending output and finish the file
+ *
+ * \param self Pointer to the IniConfigWriter
+ *
+ * When writing to a file name, the temporary file replaces the destination
+ * only if no error occurred during the whole write.
+ *
+ * \return Returns true if everything has been written, false otherwise
+ */
+bool IniConfigWriter_close( IniConfigWriter *self );
+
+/*!
+ * \brief Clear an IniConfigWriter instance
+ *
+ * Output of a writer which has not been closed is discarded.
+ *
+ * \param self Pointer to the IniConfigWriter
+ *
+ * \return Nothing
+ */
+void IniConfigWriter_clear( IniConfigWriter *self );
+
+/*!
+ * \brief Delete an IniConfigWriter instance
+ *
+ * \param self Pointer to the IniConfigWriter
+ *
+ * \return Nothing
+ */
+void IniConfigWriter_delete( IniConfigWriter *self );
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INICONFIGWRITER_H */
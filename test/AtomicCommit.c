@@ -0,0 +1,395 @@
+/*
+ *  Test program checking atomic commits, aborts, group commits and locks
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigAtomicFile.h>
+
+
+#define DIRNAME    "AtomicCommit.d"
+#define FILENAME   DIRNAME "/target.ini"
+#define SMALLGROUP 3
+#define LARGEGROUP INICONFIGCOMMITGROUP_SYNCFSFILES
+
+
+static const char *levels[] = { "none", "data", "full" };
+
+
+static bool writeText( const char *fileName, const char *text )
+{
+    FILE *fp = fopen( fileName, "wb" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fputs( text, fp );
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool hasText( const char *fileName, const char *text )
+{
+    char buffer[256];
+    size_t length = 0;
+    FILE *fp = fopen( fileName, "rb" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    length = fread( buffer, 1, sizeof( buffer ) - 1, fp );
+    buffer[length] = '\0';
+    fclose( fp );
+
+    return strcmp( buffer, text ) == 0;
+}
+
+
+/*
+ * Number of files in the directory, temporary "~" files count as stray
+ */
+static int countFiles( int *numStray )
+{
+    struct dirent *entry = NULL;
+    DIR *dir = opendir( DIRNAME );
+    int count = 0;
+
+    *numStray = 0;
+
+    if( dir == NULL )
+    {
+        return -1;
+    }
+
+    while( ( entry = readdir( dir ) ) != NULL )
+    {
+        if( strcmp( entry->d_name, "." ) == 0 || strcmp( entry->d_name, ".." ) == 0 )
+        {
+            continue;
+        }
+
+        if( entry->d_name[0] == '~' )
+        {
+            ANY_LOG( 0, "Stray temporary file '%s'", ANY_LOG_ERROR, entry->d_name );
+            ( *numStray )++;
+        }
+
+        count++;
+    }
+
+    closedir( dir );
+
+    return count;
+}
+
+
+static bool writeFd( int fd, const char *text )
+{
+    return write( fd, text, strlen( text ) ) == (ssize_t)strlen( text );
+}
+
+
+/*
+ * Creates the temporary file with mkstemp(), like IniConfigAtomicFile_init()
+ * does where O_TMPFILE is missing
+ */
+static bool makeNamed( IniConfigAtomicFile *file )
+{
+    if( !file->anonymous )
+    {
+        return true;
+    }
+
+    close( file->fd );
+    file->fd = mkstemp( file->tempName );
+    file->anonymous = 0;
+
+    return file->fd != -1;
+}
+
+
+/*
+ * Commit, abort and clear without commit of a single file
+ */
+static bool checkSingle( IniConfigAtomicFileDurability durability, bool named )
+{
+    IniConfigAtomicFile *file = IniConfigAtomicFile_new();
+    const char *path = named ? "named" : "anonymous";
+    bool retVal = true;
+    int numStray = 0;
+
+    if( file == NULL || !writeText( FILENAME, "old\n" ) )
+    {
+        IniConfigAtomicFile_delete( file );
+        return false;
+    }
+
+    /* commit replaces the contents */
+    if( !IniConfigAtomicFile_init( file, FILENAME ) || ( named && !makeNamed( file ) ) )
+    {
+        ANY_LOG( 0, "%s/%s: unable to create the temporary file", ANY_LOG_ERROR, levels[durability], path );
+        IniConfigAtomicFile_delete( file );
+        return false;
+    }
+
+    IniConfigAtomicFile_setDurability( file, durability );
+
+    if( !writeFd( IniConfigAtomicFile_getFd( file ), "new\n" ) || !IniConfigAtomicFile_commit( file ) ||
+        !hasText( FILENAME, "new\n" ) || countFiles( &numStray ) != 1 || numStray != 0 )
+    {
+        ANY_LOG( 0, "%s/%s: commit went wrong", ANY_LOG_ERROR, levels[durability], path );
+        retVal = false;
+    }
+
+    IniConfigAtomicFile_clear( file );
+
+    /* abort leaves the destination as it was */
+    if( IniConfigAtomicFile_init( file, FILENAME ) && ( !named || makeNamed( file ) ) )
+    {
+        IniConfigAtomicFile_setDurability( file, durability );
+        writeFd( IniConfigAtomicFile_getFd( file ), "aborted\n" );
+        IniConfigAtomicFile_abort( file );
+
+        if( !hasText( FILENAME, "new\n" ) || countFiles( &numStray ) != 1 || numStray != 0 )
+        {
+            ANY_LOG( 0, "%s/%s: abort went wrong", ANY_LOG_ERROR, levels[durability], path );
+            retVal = false;
+        }
+
+        IniConfigAtomicFile_clear( file );
+    }
+    else
+    {
+        retVal = false;
+    }
+
+    /* so does clearing a file which was never committed */
+    if( IniConfigAtomicFile_init( file, FILENAME ) && ( !named || makeNamed( file ) ) )
+    {
+        writeFd( IniConfigAtomicFile_getFd( file ), "dropped\n" );
+        IniConfigAtomicFile_clear( file );
+
+        if( !hasText( FILENAME, "new\n" ) || countFiles( &numStray ) != 1 || numStray != 0 )
+        {
+            ANY_LOG( 0, "%s/%s: clear went wrong", ANY_LOG_ERROR, levels[durability], path );
+            retVal = false;
+        }
+    }
+    else
+    {
+        retVal = false;
+    }
+
+    IniConfigAtomicFile_delete( file );
+    remove( FILENAME );
+
+    return retVal;
+}
+
+
+/*
+ * A group renames all files or, if any of them failed, none. Large groups
+ * flush their file system at once, small ones every file.
+ */
+static bool checkGroup( IniConfigAtomicFileDurability durability, int numFiles, bool failing )
+{
+    IniConfigCommitGroup *group = IniConfigCommitGroup_new();
+    IniConfigAtomicFile *file = NULL;
+    char fileNames[LARGEGROUP][64];
+    char text[32];
+    bool retVal = true;
+    bool committed = false;
+    int numStray = 0;
+    int i = 0;
+
+    if( group == NULL || !IniConfigCommitGroup_init( group, durability ) )
+    {
+        IniConfigCommitGroup_delete( group );
+        return false;
+    }
+
+    for( i = 0; i < numFiles; i++ )
+    {
+        Any_snprintf( fileNames[i], 64, "%s/member%d.ini", DIRNAME, i );
+        Any_snprintf( text, sizeof( text ), "new %d\n", i );
+
+        writeText( fileNames[i], "old\n" );
+        file = IniConfigCommitGroup_add( group, fileNames[i] );
+
+        if( file == NULL || !writeFd( IniConfigAtomicFile_getFd( file ), text ) )
+        {
+            ANY_LOG( 0, "%s: unable to add %s", ANY_LOG_ERROR, levels[durability], fileNames[i] );
+            retVal = false;
+        }
+
+        /* a member whose write failed is aborted */
+        if( failing && i == 1 && file != NULL )
+        {
+            IniConfigAtomicFile_abort( file );
+        }
+    }
+
+    committed = IniConfigCommitGroup_commit( group );
+
+    if( committed == failing )
+    {
+        ANY_LOG( 0, "%s: group commit returned %d", ANY_LOG_ERROR, levels[durability], (int)committed );
+        retVal = false;
+    }
+
+    for( i = 0; i < numFiles; i++ )
+    {
+        Any_snprintf( text, sizeof( text ), "new %d\n", i );
+
+        if( !hasText( fileNames[i], failing ? "old\n" : text ) )
+        {
+            ANY_LOG( 0, "%s: %s has the wrong contents", ANY_LOG_ERROR, levels[durability], fileNames[i] );
+            retVal = false;
+        }
+    }
+
+    if( countFiles( &numStray ) != numFiles || numStray != 0 )
+    {
+        ANY_LOG( 0, "%s: group commit left files behind", ANY_LOG_ERROR, levels[durability] );
+        retVal = false;
+    }
+
+    IniConfigCommitGroup_clear( group );
+    IniConfigCommitGroup_delete( group );
+
+    for( i = 0; i < numFiles; i++ )
+    {
+        remove( fileNames[i] );
+    }
+
+    return retVal;
+}
+
+
+/*
+ * Tries to lock the sidecar from another process, returns its exit status
+ */
+static int tryLock( void )
+{
+    struct flock fl;
+    pid_t pid = fork();
+    int status = 0;
+
+    if( pid == 0 )
+    {
+        int fd = open( FILENAME ".lock", O_RDWR );
+
+        memset( &fl, 0, sizeof( fl ) );
+        fl.l_type = F_WRLCK;
+        fl.l_whence = SEEK_SET;
+
+        _exit( ( fd != -1 && fcntl( fd, F_SETLK, &fl ) == 0 ) ? 0 : 1 );
+    }
+
+    if( pid == -1 || waitpid( pid, &status, 0 ) != pid || !WIFEXITED( status ) )
+    {
+        return -1;
+    }
+
+    return WEXITSTATUS( status );
+}
+
+
+/*
+ * The lock is taken on "<name>.lock", the destination stays untouched
+ */
+static bool checkLock( void )
+{
+    struct stat st;
+    bool retVal = true;
+    int lockFd = -1;
+
+    writeText( FILENAME, "locked\n" );
+
+    lockFd = IniConfigAtomicFile_lock( FILENAME );
+
+    if( lockFd == -1 || stat( FILENAME ".lock", &st ) != 0 || tryLock() != 1 || !hasText( FILENAME, "locked\n" ) )
+    {
+        ANY_LOG( 0, "The lock file is not held", ANY_LOG_ERROR );
+        retVal = false;
+    }
+
+    IniConfigAtomicFile_unlock( lockFd );
+
+    if( tryLock() != 0 )
+    {
+        ANY_LOG( 0, "The lock file is still held after unlocking", ANY_LOG_ERROR );
+        retVal = false;
+    }
+
+    remove( FILENAME ".lock" );
+    remove( FILENAME );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    int status = EXIT_SUCCESS;
+    int durability = 0;
+
+    if( mkdir( DIRNAME, 0755 ) != 0 && errno != EEXIST )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    for( durability = INICONFIGATOMICFILE_DURABILITY_NONE; durability <= INICONFIGATOMICFILE_DURABILITY_FULL;
+         durability++ )
+    {
+        if( !checkSingle( (IniConfigAtomicFileDurability)durability, false ) ||
+            !checkSingle( (IniConfigAtomicFileDurability)durability, true ) ||
+            !checkGroup( (IniConfigAtomicFileDurability)durability, SMALLGROUP, false ) ||
+            !checkGroup( (IniConfigAtomicFileDurability)durability, SMALLGROUP, true ) ||
+            !checkGroup( (IniConfigAtomicFileDurability)durability, LARGEGROUP, false ) ||
+            !checkGroup( (IniConfigAtomicFileDurability)durability, LARGEGROUP, true ) )
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if( !checkLock() )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    rmdir( DIRNAME );
+
+    return( status );
+}
+
+
+/* EOF */
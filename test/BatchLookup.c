@@ -0,0 +1,199 @@
+/*
+ *  Test program checking that batch lookups give the values of single gets
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "BatchLookup.ini"
+#define NUMSECTIONS   20
+#define NUMKEYS       50
+
+/* more than fits into one group, plus keys which do not exist */
+#define NUMLOOKUPS    ( NUMSECTIONS * NUMKEYS + 100 )
+
+
+typedef struct Lookups
+{
+    const char *sections[NUMLOOKUPS];
+    const char *keys[NUMLOOKUPS];
+    char names[NUMLOOKUPS][2][32];
+    char values[NUMLOOKUPS][64];
+    bool visited[NUMLOOKUPS];
+}
+Lookups;
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+    int j = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "global=top\n" );
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        fprintf( fp, "[Section%d]\n", i );
+
+        for( j = 0; j < NUMKEYS; j++ )
+        {
+            fprintf( fp, "key%d=value %d.%d\n", j, i, j );
+        }
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static void Lookups_init( Lookups *self )
+{
+    int i = 0;
+
+    /* shuffled, in other case and with a few missing keys and the global area */
+    for( i = 0; i < NUMLOOKUPS; i++ )
+    {
+        int k = ( i * 7919 ) % NUMLOOKUPS;
+
+        Any_snprintf( self->names[i][0], 32, "SECTION%d", k / NUMKEYS );
+        Any_snprintf( self->names[i][1], 32, "Key%d", k % NUMKEYS );
+
+        self->sections[i] = self->names[i][0];
+        self->keys[i] = self->names[i][1];
+    }
+
+    self->sections[0] = NULL;
+    self->keys[0] = "GLOBAL";
+    self->sections[1] = "Section1";
+    self->keys[1] = "missing";
+}
+
+
+static void store( void *context, unsigned int i, const char *value )
+{
+    Lookups *self = (Lookups *)context;
+
+    Any_snprintf( self->values[i], 64, "%s", ( value != NULL ) ? value : "<none>" );
+    self->visited[i] = true;
+}
+
+
+static bool check( const IniConfigFile *ini, Lookups *lookups, const char *mode )
+{
+    char expected[64];
+    unsigned int found = 0;
+    unsigned int numExpected = 0;
+    int i = 0;
+
+    memset( lookups->visited, 0, sizeof( lookups->visited ) );
+
+    found = IniConfigFile_getBatch( ini, NUMLOOKUPS, lookups->sections, lookups->keys, store, lookups );
+
+    for( i = 0; i < NUMLOOKUPS; i++ )
+    {
+        IniConfigFile_getString( ini, lookups->sections[i], lookups->keys[i], "<none>", expected, 64 );
+
+        if( strcmp( expected, "<none>" ) != 0 )
+        {
+            numExpected++;
+        }
+
+        if( !lookups->visited[i] || strcmp( lookups->values[i], expected ) != 0 )
+        {
+            ANY_LOG( 0, "%s: [%s] %s is '%s' in the batch, '%s' alone", ANY_LOG_ERROR, mode,
+                     lookups->sections[i] ? lookups->sections[i] : "", lookups->keys[i],
+                     lookups->values[i], expected );
+            return false;
+        }
+    }
+
+    if( found != numExpected )
+    {
+        ANY_LOG( 0, "%s: %u keys reported found, %u expected", ANY_LOG_ERROR, mode, found, numExpected );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    Lookups *lookups = ANY_TALLOC( Lookups );
+    int status = EXIT_SUCCESS;
+
+    if( lookups == NULL || !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    Lookups_init( lookups );
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !IniConfigFile_load( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* pending puts are seen like by single gets */
+    IniConfigFile_putString( ini, "Section3", "key3", "changed" );
+    IniConfigFile_putString( ini, "Section4", "missing", "added" );
+
+    if( !check( ini, lookups, "loaded" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_freeze( ini ) || !check( ini, lookups, "frozen" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE ) ||
+        !check( ini, lookups, "double buffered" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( lookups );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,255 @@
+/*
+ *  Test program checking binary values encoded as base64 or hex
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "BlobValues.ini"
+#define MAXSIZE     300
+#define LARGESIZE   ( 3 * INICONFIGFILE_BUFFERSIZE + 7 )
+
+
+typedef struct Encoded
+{
+    int encoding;
+    const char *text;
+    long size;                          /* -1 if not valid */
+    const char *bytes;
+}
+Encoded;
+
+
+static const Encoded encodedValues[] =
+{
+    { INICONFIGBLOB_BASE64, "", 0, "" },
+    { INICONFIGBLOB_BASE64, "Zg==", 1, "f" },
+    { INICONFIGBLOB_BASE64, "Zm8=", 2, "fo" },
+    { INICONFIGBLOB_BASE64, "Zm9v", 3, "foo" },
+    { INICONFIGBLOB_BASE64, "Zm9vYg", 4, "foob" },            /* padding left out */
+    { INICONFIGBLOB_BASE64, "Zm9vYmE", 5, "fooba" },
+    { INICONFIGBLOB_BASE64, "Zm9vYmFy", 6, "foobar" },
+    { INICONFIGBLOB_BASE64, "+/+/", 3, "\xfb\xff\xbf" },
+    { INICONFIGBLOB_BASE64, "Zm9vY", -1, NULL },              /* one character too many */
+    { INICONFIGBLOB_BASE64, "Zg=", -1, NULL },                /* incomplete padding */
+    { INICONFIGBLOB_BASE64, "Z===", -1, NULL },
+    { INICONFIGBLOB_BASE64, "Zm=v", -1, NULL },
+    { INICONFIGBLOB_BASE64, "Zm9v Ym", -1, NULL },
+    { INICONFIGBLOB_BASE64, "Zm9-", -1, NULL },               /* URL alphabet */
+    { INICONFIGBLOB_HEX, "", 0, "" },
+    { INICONFIGBLOB_HEX, "00ff7F", 3, "\x00\xff\x7f" },
+    { INICONFIGBLOB_HEX, "DeadBeef", 4, "\xde\xad\xbe\xef" },
+    { INICONFIGBLOB_HEX, "abc", -1, NULL },
+    { INICONFIGBLOB_HEX, "0g", -1, NULL },
+    { INICONFIGBLOB_HEX, "0x12", -1, NULL }
+};
+
+#define NUMENCODED  ( sizeof( encodedValues ) / sizeof( encodedValues[0] ) )
+
+
+static void fill( unsigned char *data, size_t size, unsigned int seed )
+{
+    size_t i = 0;
+
+    for( i = 0; i < size; i++ )
+    {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (unsigned char)( seed >> 16 );
+    }
+}
+
+
+static bool checkEncoded( void )
+{
+    unsigned char buffer[16];
+    unsigned int i = 0;
+
+    for( i = 0; i < NUMENCODED; i++ )
+    {
+        const Encoded *value = &encodedValues[i];
+        long size = IniConfigBlob_decode( value->encoding, value->text, strlen( value->text ), buffer,
+                                          sizeof( buffer ) );
+
+        if( size != value->size || ( size > 0 && memcmp( buffer, value->bytes, (size_t)size ) != 0 ) )
+        {
+            ANY_LOG( 0, "'%s' decodes to %ld bytes, %ld expected", ANY_LOG_ERROR, value->text, size, value->size );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Every size round trips, and a wrong character at any place is found,
+ * whether it falls into a vectorized block or into the rest
+ */
+static bool checkRoundTrips( int encoding )
+{
+    unsigned char data[MAXSIZE];
+    unsigned char decoded[MAXSIZE + 16];
+    char text[2 * MAXSIZE + 4];
+    size_t size = 0;
+
+    for( size = 0; size <= MAXSIZE; size++ )
+    {
+        size_t length = 0;
+        size_t i = 0;
+
+        fill( data, size, (unsigned int)size );
+        length = IniConfigBlob_encode( encoding, data, size, text );
+
+        if( length != IniConfigBlob_getEncodedLength( encoding, size ) || strlen( text ) != length ||
+            IniConfigBlob_decode( encoding, text, length, decoded, size ) != (long)size ||
+            memcmp( data, decoded, size ) != 0 )
+        {
+            ANY_LOG( 0, "%zu bytes do not round trip", ANY_LOG_ERROR, size );
+            return false;
+        }
+
+        for( i = 0; i < length && size < 64; i++ )
+        {
+            char saved = text[i];
+
+            if( saved == '=' )
+            {
+                continue;
+            }
+
+            text[i] = '*';
+
+            if( IniConfigBlob_decode( encoding, text, length, decoded, sizeof( decoded ) ) != -1 )
+            {
+                ANY_LOG( 0, "Wrong character at %zu of %zu bytes accepted", ANY_LOG_ERROR, i, size );
+                return false;
+            }
+
+            text[i] = saved;
+        }
+    }
+
+    return true;
+}
+
+
+static bool checkFile( const IniConfigFile *ini, const char *mode, const unsigned char *large )
+{
+    unsigned char buffer[LARGESIZE];
+    unsigned char small[4];
+
+    memset( small, 0xaa, sizeof( small ) );
+
+    if( IniConfigFile_getBlob( ini, "Blobs", "large", INICONFIGBLOB_BASE64, buffer, sizeof( buffer ) ) != LARGESIZE ||
+        memcmp( buffer, large, LARGESIZE ) != 0 ||
+        IniConfigFile_getBlob( ini, "Blobs", "largehex", INICONFIGBLOB_HEX, buffer, sizeof( buffer ) ) != LARGESIZE ||
+        memcmp( buffer, large, LARGESIZE ) != 0 )
+    {
+        ANY_LOG( 0, "%s: large values differ", ANY_LOG_ERROR, mode );
+        return false;
+    }
+
+    /* a small buffer stays untouched and learns the size */
+    if( IniConfigFile_getBlob( ini, "Blobs", "large", INICONFIGBLOB_BASE64, small, sizeof( small ) ) != LARGESIZE ||
+        small[0] != 0xaa || IniConfigFile_getBlob( ini, "Blobs", "large", INICONFIGBLOB_BASE64, NULL, 0 ) != LARGESIZE )
+    {
+        ANY_LOG( 0, "%s: wrong size of a too small buffer", ANY_LOG_ERROR, mode );
+        return false;
+    }
+
+    if( IniConfigFile_getBlob( ini, "Blobs", "key", INICONFIGBLOB_HEX, small, sizeof( small ) ) != 4 ||
+        memcmp( small, "\xde\xad\xbe\xef", 4 ) != 0 ||
+        IniConfigFile_getBlob( ini, "Blobs", "key", INICONFIGBLOB_BASE64, small, sizeof( small ) ) != 6 ||
+        IniConfigFile_getBlob( ini, "Blobs", "broken", INICONFIGBLOB_BASE64, buffer, sizeof( buffer ) ) != -1 ||
+        IniConfigFile_getBlob( ini, "Blobs", "missing", INICONFIGBLOB_BASE64, small, sizeof( small ) ) != -1 ||
+        IniConfigFile_getBlob( ini, "Blobs", "empty", INICONFIGBLOB_HEX, NULL, 0 ) != 0 )
+    {
+        ANY_LOG( 0, "%s: wrong small values", ANY_LOG_ERROR, mode );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    unsigned char *large = (unsigned char *)NULL;
+    FILE *fp = (FILE *)NULL;
+    int status = EXIT_SUCCESS;
+
+    if( !checkEncoded() || !checkRoundTrips( INICONFIGBLOB_BASE64 ) || !checkRoundTrips( INICONFIGBLOB_HEX ) )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    fp = fopen( FILENAME, "w" );
+
+    if( fp == NULL )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    fprintf( fp, "[Blobs]\nkey=DEADBEEF\nbroken=Zm9v*mFy\nempty=\n" );
+    fclose( fp );
+
+    large = ANY_BALLOC( LARGESIZE );
+    fill( large, LARGESIZE, 42 );
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    /* values longer than INICONFIGFILE_BUFFERSIZE survive save and load */
+    if( !IniConfigFile_load( ini ) ||
+        !IniConfigFile_putBlob( ini, "Blobs", "large", INICONFIGBLOB_BASE64, large, LARGESIZE ) ||
+        !IniConfigFile_putBlob( ini, "Blobs", "largehex", INICONFIGBLOB_HEX, large, LARGESIZE ) ||
+        !checkFile( ini, "put", large ) ||
+        !IniConfigFile_save( ini ) || !IniConfigFile_load( ini ) || !checkFile( ini, "loaded", large ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    if( !IniConfigFile_freeze( ini ) || !checkFile( ini, "frozen", large ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE ) ||
+        !checkFile( ini, "double buffered", large ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( large );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,275 @@
+/*
+ *  Test program checking compare-and-put on keys and on the whole document
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <CppIniConfigFile.h>
+
+
+#define FILENAME        "ConditionalPuts.ini"
+#define NUMTHREADS      4
+#define NUMINCREMENTS   2000
+
+
+typedef struct Incrementer
+{
+    const IniConfigFile *ini;           /* C API if not NULL */
+    const CppIniConfigFile *cppIni;     /* C++ API otherwise */
+    pthread_t thread;
+    long retries;
+}
+Incrementer;
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "[Stats]\ncount=0\nother=x\n" );
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool expect( bool condition, const char *what )
+{
+    if( !condition )
+    {
+        ANY_LOG( 0, "%s", ANY_LOG_ERROR, what );
+    }
+
+    return condition;
+}
+
+
+/*
+ * Retries every increment until no other thread got in between, yielding
+ * between reading and writing to let them
+ */
+static void *Incrementer_run( void *arg )
+{
+    Incrementer *self = (Incrementer *)arg;
+    char value[32];
+    int i = 0;
+
+    for( i = 0; i < NUMINCREMENTS; i++ )
+    {
+        for( ;; )
+        {
+            unsigned long generation = 0;
+            long count = 0;
+            bool written = false;
+
+            if( self->ini != NULL )
+            {
+                generation = IniConfigFile_getGeneration( self->ini, "Stats", "count" );
+                count = IniConfigFile_getLong( self->ini, "Stats", "count", -1 );
+                sched_yield();
+                Any_snprintf( value, sizeof( value ), "%ld", count + 1 );
+                written = IniConfigFile_putIfUnchanged( self->ini, "Stats", "count", value, generation ) != 0;
+            }
+            else
+            {
+                generation = self->cppIni->getGeneration( "Stats", "count" );
+                count = self->cppIni->get( "Stats", "count", 0L );
+                sched_yield();
+                Any_snprintf( value, sizeof( value ), "%ld", count + 1 );
+                written = self->cppIni->compareAndPut( "Stats", "count", value, generation );
+            }
+
+            if( written )
+            {
+                break;
+            }
+
+            self->retries++;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Runs the retry loops of NUMTHREADS threads on one counter
+ */
+static bool checkCounter( const IniConfigFile *ini, const CppIniConfigFile *cppIni, long start, const char *api )
+{
+    Incrementer incrementers[NUMTHREADS];
+    long retries = 0;
+    long count = 0;
+    int i = 0;
+
+    for( i = 0; i < NUMTHREADS; i++ )
+    {
+        incrementers[i].ini = ini;
+        incrementers[i].cppIni = cppIni;
+        incrementers[i].retries = 0;
+
+        pthread_create( &incrementers[i].thread, NULL, Incrementer_run, &incrementers[i] );
+    }
+
+    for( i = 0; i < NUMTHREADS; i++ )
+    {
+        pthread_join( incrementers[i].thread, NULL );
+        retries += incrementers[i].retries;
+    }
+
+    count = ( ini != NULL ) ? IniConfigFile_getLong( ini, "Stats", "count", -1 )
+                            : cppIni->get( "Stats", "count", -1L );
+
+    ANY_LOG( 0, "%s: %d increments with %ld retries, count %ld", ANY_LOG_INFO, api, NUMTHREADS * NUMINCREMENTS,
+             retries, count );
+
+    return expect( count == start + NUMTHREADS * NUMINCREMENTS, "Increments got lost" );
+}
+
+
+static bool checkC( void )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    char buffer[32];
+    unsigned long generation = 0;
+    unsigned long document = 0;
+    bool retVal = true;
+
+    if( !IniConfigFile_init( ini, FILENAME ) || !IniConfigFile_load( ini ) )
+    {
+        IniConfigFile_delete( ini );
+        return false;
+    }
+
+    /* a matching key generation */
+    generation = IniConfigFile_getGeneration( ini, "Stats", "count" );
+
+    retVal &= expect( IniConfigFile_putIfUnchanged( ini, "Stats", "count", "1", generation ) == 1,
+                      "Put with the current key generation failed" );
+    retVal &= expect( IniConfigFile_getLong( ini, "Stats", "count", -1 ) == 1, "Put value not read back" );
+
+    /* a stale one */
+    retVal &= expect( IniConfigFile_putIfUnchanged( ini, "Stats", "count", "2", generation ) == 0,
+                      "Put with a stale key generation succeeded" );
+    retVal &= expect( IniConfigFile_getLong( ini, "Stats", "count", -1 ) == 1, "Failed put changed the value" );
+
+    /* a put to another key leaves the key generation alone, not the document's */
+    generation = IniConfigFile_getGeneration( ini, "Stats", "count" );
+    document = IniConfigFile_getGeneration( ini, NULL, NULL );
+
+    IniConfigFile_putString( ini, "Stats", "other", "y" );
+
+    retVal &= expect( IniConfigFile_putIfDocumentUnchanged( ini, "Stats", "count", "3", document ) == 0,
+                      "Put with a stale document generation succeeded" );
+    retVal &= expect( IniConfigFile_getLong( ini, "Stats", "count", -1 ) == 1, "Failed put changed the value" );
+
+    document = IniConfigFile_getGeneration( ini, NULL, NULL );
+
+    retVal &= expect( IniConfigFile_putIfDocumentUnchanged( ini, "Stats", "count", "3", document ) == 1,
+                      "Put with the current document generation failed" );
+    retVal &= expect( IniConfigFile_putIfUnchanged( ini, "Stats", "count", "4", generation ) == 0,
+                      "Put after a document put kept the key generation" );
+
+    /* removals are conditional as well */
+    generation = IniConfigFile_getGeneration( ini, "Stats", "other" );
+
+    IniConfigFile_putString( ini, "Stats", "other", "z" );
+
+    retVal &= expect( IniConfigFile_putIfUnchanged( ini, "Stats", "other", NULL, generation ) == 0,
+                      "Removal with a stale key generation succeeded" );
+
+    generation = IniConfigFile_getGeneration( ini, "Stats", "other" );
+
+    retVal &= expect( IniConfigFile_putIfUnchanged( ini, "Stats", "other", NULL, generation ) == 1,
+                      "Removal with the current key generation failed" );
+
+    IniConfigFile_getString( ini, "Stats", "other", "<none>", buffer, sizeof( buffer ) );
+
+    retVal &= expect( strcmp( buffer, "<none>" ) == 0, "Removed key still read" );
+
+    retVal &= checkCounter( ini, NULL, 3, "C" );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return retVal;
+}
+
+
+static bool checkCpp( void )
+{
+    CppIniConfigFile ini( FILENAME );
+    unsigned long generation = 0;
+    unsigned long document = 0;
+    bool retVal = true;
+
+    if( !ini.load() )
+    {
+        return false;
+    }
+
+    generation = ini.getGeneration( "Stats", "count" );
+
+    retVal &= expect( ini.compareAndPut( "Stats", "count", "1", generation ), "compareAndPut() failed" );
+    retVal &= expect( !ini.compareAndPut( "Stats", "count", "2", generation ),
+                      "compareAndPut() with a stale key generation succeeded" );
+    retVal &= expect( ini.get( "Stats", "count", -1L ) == 1, "Failed compareAndPut() changed the value" );
+
+    document = ini.getGeneration();
+
+    ini.put( "Stats", "other", "y" );
+
+    retVal &= expect( !ini.compareAndPut( "Stats", "count", "3", document, true ),
+                      "compareAndPut() with a stale document generation succeeded" );
+    retVal &= expect( ini.compareAndPut( "Stats", "count", "3", ini.getGeneration(), true ),
+                      "compareAndPut() with the current document generation failed" );
+
+    retVal &= checkCounter( NULL, &ini, 3, "C++" );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile() || !checkC() )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !writeFile() || !checkCpp() )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
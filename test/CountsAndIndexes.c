@@ -0,0 +1,336 @@
+/*
+ *  Test program checking section and key counts and indexed access
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME     "CountsAndIndexes.ini"
+#define NUMSECTIONS  200
+#define NUMKEYS      5
+#define NUMLISTERS   4
+#define NUMPUTS      2000
+
+
+typedef struct Lister
+{
+    IniConfigFile *ini;
+    pthread_t thread;
+    int expected;
+    int *done;
+    int failures;
+}
+Lister;
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+    int j = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "; global keys\nversion=3\nowner=lab\n" );
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        fprintf( fp, "[Joint%d]\n", i );
+
+        for( j = 0; j < NUMKEYS; j++ )
+        {
+            fprintf( fp, "key%d=%d\n", j, i * j );
+        }
+
+        fprintf( fp, "\n" );
+    }
+
+    /* a repeated section only lists the keys of its first header, an empty key name ends the listing */
+    fprintf( fp, "[Joint0]\nlate=1\n[Gaps]\na=1\n# comment\nb=2\n=3\nc=4\n[]\nhidden=1\n[After]\nx=1\n" );
+
+    fclose( fp );
+
+    return true;
+}
+
+
+/*
+ * Compares the counts with the enumerations and, if given, with a reference listing
+ */
+static bool check( const IniConfigFile *ini, const IniConfigFile *reference, const char *mode )
+{
+    static const char *sections[] = { NULL, "Joint0", "joint7", "Gaps", "After", "Missing" };
+    char expected[64];
+    char name[64];
+    int count = 0;
+    int i = 0;
+    int s = 0;
+
+    for( count = 0; IniConfigFile_getSection( ini, count, name, 64 ) > 0; count++ )
+    {
+        if( reference != NULL )
+        {
+            IniConfigFile_getSection( reference, count, expected, 64 );
+
+            if( strcmp( name, expected ) != 0 )
+            {
+                ANY_LOG( 0, "%s: section %d is '%s', expected '%s'", ANY_LOG_ERROR, mode, count, name, expected );
+                return false;
+            }
+        }
+    }
+
+    if( IniConfigFile_countSections( ini ) != count ||
+        ( reference != NULL && IniConfigFile_countSections( reference ) != count ) )
+    {
+        ANY_LOG( 0, "%s: %d sections counted, %d listed", ANY_LOG_ERROR, mode,
+                 IniConfigFile_countSections( ini ), count );
+        return false;
+    }
+
+    /* past the end the buffer is emptied */
+    strcpy( name, "stale" );
+
+    if( IniConfigFile_getSection( ini, count + 3, name, 64 ) != 0 || name[0] != '\0' )
+    {
+        ANY_LOG( 0, "%s: section past the end is '%s'", ANY_LOG_ERROR, mode, name );
+        return false;
+    }
+
+    for( s = 0; s < (int)( sizeof( sections ) / sizeof( sections[0] ) ); s++ )
+    {
+        for( count = 0; IniConfigFile_getKey( ini, sections[s], count, name, 64 ) > 0; count++ )
+        {
+            if( reference != NULL )
+            {
+                IniConfigFile_getKey( reference, sections[s], count, expected, 64 );
+
+                if( strcmp( name, expected ) != 0 )
+                {
+                    ANY_LOG( 0, "%s: key %d of [%s] is '%s', expected '%s'", ANY_LOG_ERROR, mode, count,
+                             sections[s] ? sections[s] : "", name, expected );
+                    return false;
+                }
+            }
+        }
+
+        if( IniConfigFile_countKeys( ini, sections[s] ) != count ||
+            ( reference != NULL && IniConfigFile_countKeys( reference, sections[s] ) != count ) )
+        {
+            ANY_LOG( 0, "%s: %d keys counted in [%s], %d listed", ANY_LOG_ERROR, mode,
+                     IniConfigFile_countKeys( ini, sections[s] ), sections[s] ? sections[s] : "", count );
+            return false;
+        }
+    }
+
+    for( i = 0; i < NUMKEYS + 2; i++ )
+    {
+        IniConfigFile_getKey( ini, "Joint42", i, name, 64 );
+        Any_snprintf( expected, sizeof( expected ), "key%d", i );
+
+        if( strcmp( name, ( i < NUMKEYS ) ? expected : "" ) != 0 )
+        {
+            ANY_LOG( 0, "%s: key %d of [Joint42] is '%s'", ANY_LOG_ERROR, mode, i, name );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Lists all sections over and over while values change, which leaves
+ * their number as it is
+ */
+static void *Lister_run( void *arg )
+{
+    Lister *self = (Lister *)arg;
+    char name[64];
+    int count = 0;
+    int i = 0;
+
+    while( !__atomic_load_n( self->done, __ATOMIC_ACQUIRE ) )
+    {
+        count = IniConfigFile_countSections( self->ini );
+
+        if( count != self->expected )
+        {
+            self->failures++;
+        }
+
+        for( i = 0; i < count; i++ )
+        {
+            if( IniConfigFile_getSection( self->ini, i, name, 64 ) <= 0 )
+            {
+                self->failures++;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Readers listing sections share the lock unless a put is pending
+ */
+static bool checkConcurrent( IniConfigFile *ini )
+{
+    Lister listers[NUMLISTERS];
+    int failures = 0;
+    int done = 0;
+    int i = 0;
+
+    for( i = 0; i < NUMLISTERS; i++ )
+    {
+        listers[i].ini = ini;
+        listers[i].expected = IniConfigFile_countSections( ini );
+        listers[i].done = &done;
+        listers[i].failures = 0;
+
+        pthread_create( &listers[i].thread, NULL, Lister_run, &listers[i] );
+    }
+
+    for( i = 0; i < NUMPUTS; i++ )
+    {
+        IniConfigFile_putLong( ini, "Joint3", "key1", i );
+    }
+
+    __atomic_store_n( &done, 1, __ATOMIC_RELEASE );
+
+    for( i = 0; i < NUMLISTERS; i++ )
+    {
+        pthread_join( listers[i].thread, NULL );
+        failures += listers[i].failures;
+    }
+
+    if( failures > 0 || IniConfigFile_getLong( ini, "Joint3", "key1", -1 ) != NUMPUTS - 1 )
+    {
+        ANY_LOG( 0, "Listing sections during puts failed %d times", ANY_LOG_ERROR, failures );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    IniConfigFile *reference = (IniConfigFile*)NULL;
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    /* the unloaded file lists what minIni reads */
+    reference = IniConfigFile_new();
+    IniConfigFile_init( reference, FILENAME );
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( IniConfigFile_countSections( reference ) != NUMSECTIONS + 2 ||
+        IniConfigFile_countKeys( reference, NULL ) != 2 ||
+        IniConfigFile_countKeys( reference, "Joint0" ) != NUMKEYS ||
+        IniConfigFile_countKeys( reference, "gaps" ) != 2 ||
+        IniConfigFile_countKeys( reference, "Missing" ) != 0 )
+    {
+        ANY_LOG( 0, "Unloaded counts are wrong", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    if( !check( ini, reference, "loaded" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* new keys and sections show up, replaced values keep the order */
+    IniConfigFile_putLong( ini, "Joint7", "key9", 9 );
+    IniConfigFile_putLong( ini, "Joint8", "key0", 99 );
+    IniConfigFile_putLong( ini, "Added", "first", 1 );
+    IniConfigFile_putLong( ini, NULL, "global", 1 );
+
+    if( IniConfigFile_countKeys( ini, "Joint7" ) != NUMKEYS + 1 ||
+        IniConfigFile_countKeys( ini, "Joint8" ) != NUMKEYS ||
+        IniConfigFile_countKeys( ini, NULL ) != 3 ||
+        IniConfigFile_countKeys( ini, "Added" ) != 1 ||
+        !check( ini, NULL, "after puts" ) )
+    {
+        ANY_LOG( 0, "Counts after adding keys are wrong", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* removed keys and sections disappear */
+    IniConfigFile_removeKey( ini, "Joint7", "key0" );
+    IniConfigFile_putString( ini, "Joint1", NULL, NULL );
+    IniConfigFile_putString( ini, "Missing", NULL, NULL );
+
+    if( IniConfigFile_countKeys( ini, "Joint7" ) != NUMKEYS ||
+        IniConfigFile_countKeys( ini, "Joint1" ) != 0 ||
+        !check( ini, NULL, "after removals" ) )
+    {
+        ANY_LOG( 0, "Counts after removals are wrong", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !checkConcurrent( ini ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_save( ini ) || !check( ini, reference, "saved" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_freeze( ini ) || !check( ini, reference, "frozen" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( reference );
+    IniConfigFile_delete( reference );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
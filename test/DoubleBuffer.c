@@ -0,0 +1,151 @@
+/*
+ *  Test program checking that a consumer sees consistent versions between syncs
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "DoubleBuffer.ini"
+#define NUMUPDATES  2000
+
+
+typedef struct Writer
+{
+    IniConfigFile *ini;
+    pthread_t thread;
+    int done;
+    bool ok;
+}
+Writer;
+
+
+/*
+ * Keeps the two keys of a pair equal in every version it publishes, and
+ * now and then saves and reloads the file
+ */
+static void *Writer_run( void *arg )
+{
+    Writer *self = (Writer *)arg;
+    long i = 0;
+
+    for( i = 1; i <= NUMUPDATES && self->ok; i++ )
+    {
+        IniConfigFile_putLong( self->ini, "Pair", "a", i );
+
+        /* a consumer syncing in between must still see the old pair */
+        sched_yield();
+
+        IniConfigFile_putLong( self->ini, "Pair", "b", i );
+
+        if( i % 100 == 0 )
+        {
+            self->ok = IniConfigFile_save( self->ini ) && IniConfigFile_load( self->ini );
+        }
+        else
+        {
+            self->ok = IniConfigFile_publish( self->ini );
+        }
+    }
+
+    __atomic_store_n( &self->done, 1, __ATOMIC_RELEASE );
+
+    return NULL;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    Writer writer;
+    long last = 0;
+    long switches = 0;
+    int status = EXIT_SUCCESS;
+
+    remove( FILENAME );
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE ) || !IniConfigFile_load( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    writer.ini = ini;
+    writer.done = 0;
+    writer.ok = true;
+
+    pthread_create( &writer.thread, NULL, Writer_run, &writer );
+
+    for( ;; )
+    {
+        /* read before the sync, so the last version is still picked up */
+        int finished = __atomic_load_n( &writer.done, __ATOMIC_ACQUIRE );
+        long a = 0;
+        long b = 0;
+        long again = 0;
+
+        if( IniConfigFile_sync( ini ) )
+        {
+            switches++;
+        }
+
+        a = IniConfigFile_getLong( ini, "Pair", "a", 0 );
+        sched_yield();
+        b = IniConfigFile_getLong( ini, "Pair", "b", 0 );
+        again = IniConfigFile_getLong( ini, "Pair", "a", 0 );
+
+        if( a != b || a != again || a < last )
+        {
+            ANY_LOG( 0, "Inconsistent version: a=%ld b=%ld a=%ld after %ld", ANY_LOG_ERROR, a, b, again, last );
+            status = EXIT_FAILURE;
+            break;
+        }
+
+        last = a;
+
+        if( finished )
+        {
+            break;
+        }
+    }
+
+    pthread_join( writer.thread, NULL );
+
+    if( !writer.ok || last != NUMUPDATES || switches == 0 )
+    {
+        ANY_LOG( 0, "Consumer ended at %ld after %ld switches", ANY_LOG_ERROR, last, switches );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
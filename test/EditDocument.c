@@ -0,0 +1,155 @@
+/*
+ *  Test program editing an INI file in memory
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME  "EditDocument.ini"
+
+
+static const char *original =
+    "; leading comment\n"
+    "\n"
+    "[Network]\n"
+    "  hostname = My Computer   ; trailing comment\n"
+    "address=dhcp\n"
+    "\n"
+    "# keep me\n"
+    "[Other]\n"
+    "quoted = \"  spaced  \"\n"
+    "removed : 1\n";
+
+static const char *expected =
+    "; leading comment\n"
+    "\n"
+    "[Network]\n"
+    "  hostname = Server   ; trailing comment\n"
+    "address=dhcp\n"
+    "dns=10.0.0.1\n"
+    "\n"
+    "# keep me\n"
+    "[Other]\n"
+    "quoted = \"  spaced  \"\n"
+    "\n"
+    "[New]\n"
+    "value=\"a;b\"\n";
+
+
+static bool writeFile( const char *text )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fputs( text, fp );
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool fileEquals( const char *text )
+{
+    char buffer[1024];
+    size_t length = 0;
+    FILE *fp = fopen( FILENAME, "r" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    length = fread( buffer, 1, sizeof( buffer ) - 1, fp );
+    buffer[length] = '\0';
+    fclose( fp );
+
+    return strcmp( buffer, text ) == 0;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    char value[64];
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile( original ) )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !IniConfigFile_load( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* an unmodified document saves byte-identical */
+    if( !IniConfigFile_save( ini ) || !fileEquals( original ) )
+    {
+        ANY_LOG( 0, "Unmodified document changed on save", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_getString( ini, "other", "QUOTED", "", value, 64 );
+
+    if( strcmp( value, "  spaced  " ) != 0 )
+    {
+        ANY_LOG( 0, "Unexpected value '%s'", ANY_LOG_ERROR, value );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_putString( ini, "Network", "hostname", "Server" );
+    IniConfigFile_putString( ini, "Network", "dns", "10.0.0.1" );
+    IniConfigFile_putString( ini, "New", "value", "a;b" );
+    IniConfigFile_removeKey( ini, "Other", "removed" );
+
+    if( IniConfigFile_getInt( ini, "Other", "removed", -1 ) != -1 ||
+        IniConfigFile_getKey( ini, "Network", 2, value, 64 ) == 0 || strcmp( value, "dns" ) != 0 )
+    {
+        ANY_LOG( 0, "In-memory edits not visible", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_save( ini ) || !fileEquals( expected ) )
+    {
+        ANY_LOG( 0, "Edited document differs from the expected output", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,225 @@
+/*
+ *  Test program checking that forked readers of a frozen file keep sharing its pages
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "ForkSharing.ini"
+#define NUMSECTIONS   64
+#define NUMKEYS       500
+#define NUMWORKERS    4
+#define NUMPASSES     5
+
+/* a few pages of stack and library state, far below the size of the data */
+#define MAXDIRTYKB    64
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+    int j = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        fprintf( fp, "[Section%d]\n", i );
+
+        for( j = 0; j < NUMKEYS; j++ )
+        {
+            fprintf( fp, "key%d=%d ; a value long enough to fill some memory\n", j, i * NUMKEYS + j );
+        }
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+/*
+ * Sums up the private dirty and proportional set sizes of the process in kB
+ */
+static bool readMemory( long *privateDirty, long *pss )
+{
+    char line[256];
+    FILE *fp = fopen( "/proc/self/smaps_rollup", "r" );
+
+    if( fp == NULL )
+    {
+        fp = fopen( "/proc/self/smaps", "r" );
+    }
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    *privateDirty = 0;
+    *pss = 0;
+
+    while( fgets( line, sizeof( line ), fp ) != NULL )
+    {
+        if( strncmp( line, "Private_Dirty:", 14 ) == 0 )
+        {
+            *privateDirty += atol( line + 14 );
+        }
+        else if( strncmp( line, "Pss:", 4 ) == 0 )
+        {
+            *pss += atol( line + 4 );
+        }
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static int runWorker( const IniConfigFile *ini, int id )
+{
+    char section[32];
+    char key[32];
+    char value[64];
+    long dirtyBefore = 0;
+    long dirtyAfter = 0;
+    long pssBefore = 0;
+    long pssAfter = 0;
+    long sum = 0;
+    int pass = 0;
+    int i = 0;
+    int j = 0;
+
+    /* the first measurement sets up the stdio buffers of the second */
+    readMemory( &dirtyBefore, &pssBefore );
+    readMemory( &dirtyBefore, &pssBefore );
+
+    for( pass = 0; pass < NUMPASSES; pass++ )
+    {
+        for( i = 0; i < NUMSECTIONS; i++ )
+        {
+            Any_snprintf( section, sizeof( section ), "Section%d", i );
+
+            for( j = 0; j < NUMKEYS; j++ )
+            {
+                Any_snprintf( key, sizeof( key ), "key%d", j );
+
+                sum += IniConfigFile_getLong( ini, section, key, -1 );
+                sum += IniConfigFile_getString( ini, section, key, "", value, sizeof( value ) );
+            }
+
+            IniConfigFile_getSection( ini, i, value, sizeof( value ) );
+            IniConfigFile_getKey( ini, section, i, value, sizeof( value ) );
+        }
+    }
+
+    readMemory( &dirtyAfter, &pssAfter );
+
+    ANY_LOG( 0, "worker %d: %d lookups, private dirty %+ld kB, Pss %ld kB (checksum %ld)", ANY_LOG_INFO,
+             id, NUMPASSES * NUMSECTIONS * NUMKEYS * 2, dirtyAfter - dirtyBefore, pssAfter, sum );
+
+    return ( dirtyAfter - dirtyBefore <= MAXDIRTYKB ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    pid_t workers[NUMWORKERS];
+    long dirty = 0;
+    long pss = 0;
+    int status = EXIT_SUCCESS;
+    int i = 0;
+
+    if( !readMemory( &dirty, &pss ) )
+    {
+        ANY_LOG( 0, "No /proc/self/smaps, skipping", ANY_LOG_INFO );
+        return( EXIT_SUCCESS );
+    }
+
+    if( !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_freeze( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    if( IniConfigFile_putString( ini, "Section0", "key0", "changed" ) != 0 ||
+        IniConfigFile_getLong( ini, "Section0", "key0", -1 ) != 0 )
+    {
+        ANY_LOG( 0, "Frozen file accepted a put", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    readMemory( &dirty, &pss );
+    ANY_LOG( 0, "parent: Pss %ld kB", ANY_LOG_INFO, pss );
+
+    fflush( stdout );
+    fflush( stderr );
+
+    for( i = 0; i < NUMWORKERS; i++ )
+    {
+        workers[i] = fork();
+
+        if( workers[i] == 0 )
+        {
+            _exit( runWorker( ini, i ) );
+        }
+    }
+
+    for( i = 0; i < NUMWORKERS; i++ )
+    {
+        int workerStatus = 0;
+
+        if( workers[i] == -1 || waitpid( workers[i], &workerStatus, 0 ) != workers[i] ||
+            !WIFEXITED( workerStatus ) || WEXITSTATUS( workerStatus ) != EXIT_SUCCESS )
+        {
+            ANY_LOG( 0, "Worker %d dirtied shared pages", ANY_LOG_ERROR, i );
+            status = EXIT_FAILURE;
+        }
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
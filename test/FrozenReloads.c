@@ -0,0 +1,242 @@
+/*
+ *  Test program checking that frozen files reload while other threads read them
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "FrozenReloads.ini"
+#define NUMKEYS       200
+#define NUMREADERS    4
+#define NUMRELOADS    50
+
+/* every version holds the values offset .. offset + NUMKEYS - 1 */
+#define STEP          1000
+
+
+typedef struct Reader
+{
+    const IniConfigFile *ini;
+    pthread_t thread;
+    const char *sections[NUMKEYS];
+    const char *keys[NUMKEYS];
+    char names[NUMKEYS][16];
+    long values[NUMKEYS];
+    long lookups;
+    bool ok;
+}
+Reader;
+
+
+static volatile int done = 0;
+
+
+static bool writeFile( long offset )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "[Values]\n" );
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        fprintf( fp, "key%d=%ld\n", i, offset + i );
+    }
+
+    /* the number of sections follows the version as well */
+    fprintf( fp, "[Version%ld]\nstep=%d\n", offset / STEP, STEP );
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static void Reader_visit( void *context, unsigned int i, const char *value )
+{
+    Reader *self = (Reader *)context;
+
+    self->values[i] = ( value != NULL ) ? strtol( value, NULL, 10 ) : -1;
+}
+
+
+/*
+ * Every batch must come from one version, and versions never go back
+ */
+static void *Reader_run( void *arg )
+{
+    Reader *self = (Reader *)arg;
+    long offset = 0;
+    char section[32];
+    int i = 0;
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        Any_snprintf( self->names[i], sizeof( self->names[i] ), "key%d", i );
+        self->sections[i] = "Values";
+        self->keys[i] = self->names[i];
+    }
+
+    while( !__atomic_load_n( &done, __ATOMIC_ACQUIRE ) && self->ok )
+    {
+        long single = 0;
+        long latest = 0;
+
+        if( IniConfigFile_getBatch( self->ini, NUMKEYS, self->sections, self->keys, Reader_visit,
+                                    self ) != NUMKEYS )
+        {
+            ANY_LOG( 0, "Keys missing from a version", ANY_LOG_ERROR );
+            self->ok = false;
+            break;
+        }
+
+        if( self->values[0] % STEP != 0 || self->values[0] < offset )
+        {
+            ANY_LOG( 0, "Read version %ld after %ld", ANY_LOG_ERROR, self->values[0], offset );
+            self->ok = false;
+            break;
+        }
+
+        offset = self->values[0];
+
+        for( i = 1; i < NUMKEYS; i++ )
+        {
+            if( self->values[i] != offset + i )
+            {
+                ANY_LOG( 0, "key%d is %ld in version %ld", ANY_LOG_ERROR, i, self->values[i], offset );
+                self->ok = false;
+                break;
+            }
+        }
+
+        /* single gets and listings are never older than the last batch */
+        single = IniConfigFile_getLong( self->ini, "Values", "key7", -1 );
+
+        if( single < offset + 7 || single % STEP != 7 )
+        {
+            ANY_LOG( 0, "key7 is %ld after version %ld", ANY_LOG_ERROR, single, offset );
+            self->ok = false;
+        }
+
+        if( IniConfigFile_countSections( self->ini ) != 2 ||
+            IniConfigFile_getSection( self->ini, 1, section, sizeof( section ) ) <= 0 ||
+            sscanf( section, "Version%ld", &latest ) != 1 || latest * STEP < offset )
+        {
+            ANY_LOG( 0, "Listed section '%s' after version %ld", ANY_LOG_ERROR, section, offset );
+            self->ok = false;
+        }
+
+        self->lookups++;
+    }
+
+    return NULL;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    Reader readers[NUMREADERS];
+    FILE *fp = (FILE*)NULL;
+    int status = EXIT_SUCCESS;
+    long lookups = 0;
+    int i = 0;
+
+    if( !writeFile( 0 ) )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_setNumaReplicas( ini, true );
+    IniConfigFile_setTextFlags( ini, INICONFIGTEXT_VALIDATE );
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_freeze( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    for( i = 0; i < NUMREADERS; i++ )
+    {
+        readers[i].ini = ini;
+        readers[i].lookups = 0;
+        readers[i].ok = true;
+
+        pthread_create( &readers[i].thread, NULL, Reader_run, &readers[i] );
+    }
+
+    for( i = 1; i <= NUMRELOADS && status == EXIT_SUCCESS; i++ )
+    {
+        if( !writeFile( (long)i * STEP ) || !IniConfigFile_refreeze( ini ) )
+        {
+            ANY_LOG( 0, "Reload %d failed", ANY_LOG_ERROR, i );
+            status = EXIT_FAILURE;
+        }
+    }
+
+    __atomic_store_n( &done, 1, __ATOMIC_RELEASE );
+
+    for( i = 0; i < NUMREADERS; i++ )
+    {
+        pthread_join( readers[i].thread, NULL );
+        lookups += readers[i].lookups;
+
+        if( !readers[i].ok )
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    ANY_LOG( 0, "%d reloads under %ld batches of lookups", ANY_LOG_INFO, NUMRELOADS, lookups );
+
+    /* a failed reload keeps the version in place */
+    fp = fopen( FILENAME, "w" );
+
+    if( fp != NULL )
+    {
+        fprintf( fp, "[Values]\nkey1=\xff\n" );
+        fclose( fp );
+    }
+
+    if( IniConfigFile_refreeze( ini ) || IniConfigFile_getLong( ini, "Values", "key1", -1 ) != NUMRELOADS * STEP + 1 )
+    {
+        ANY_LOG( 0, "A failed reload changed the file", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,173 @@
+/*
+ *  Test program checking that concurrent writer processes lose no updates
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME     "LockedWriters.ini"
+#define NUMWRITERS   4
+#define NUMUPDATES   100
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Every writer adds its own keys and bumps its own counter, so in the end
+ * all keys of all writers must be there
+ */
+static int runWriter( int writer, bool loaded )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    char section[32];
+    char key[32];
+    int i = 0;
+
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_setLocking( ini, true );
+
+    if( loaded && !IniConfigFile_load( ini ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    Any_snprintf( section, 32, "Writer%d", writer );
+
+    for( i = 0; i < NUMUPDATES; i++ )
+    {
+        Any_snprintf( key, 32, "key%d", i );
+
+        IniConfigFile_putInt( ini, section, key, i );
+        IniConfigFile_putInt( ini, "Counters", section, i + 1 );
+
+        if( loaded && !IniConfigFile_save( ini ) )
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return EXIT_SUCCESS;
+}
+
+
+static bool runWriters( bool loaded )
+{
+    pid_t pids[NUMWRITERS];
+    IniConfigFile *ini = NULL;
+    bool retVal = true;
+    double start = 0.0;
+    char section[32];
+    char key[32];
+    int status = 0;
+    int i = 0;
+    int j = 0;
+
+    remove( FILENAME );
+
+    start = now();
+
+    for( i = 0; i < NUMWRITERS; i++ )
+    {
+        pids[i] = fork();
+
+        if( pids[i] == 0 )
+        {
+            _exit( runWriter( i, loaded ) );
+        }
+    }
+
+    for( i = 0; i < NUMWRITERS; i++ )
+    {
+        if( pids[i] == -1 || waitpid( pids[i], &status, 0 ) != pids[i] ||
+            !WIFEXITED( status ) || WEXITSTATUS( status ) != EXIT_SUCCESS )
+        {
+            ANY_LOG( 0, "Writer %d failed", ANY_LOG_ERROR, i );
+            retVal = false;
+        }
+    }
+
+    ANY_LOG( 0, "%s mode: %d writers x %d updates in %.3f s = %.0f updates/s",
+             ANY_LOG_INFO, loaded ? "loaded" : "per-put", NUMWRITERS, NUMUPDATES,
+             now() - start, NUMWRITERS * NUMUPDATES / ( now() - start ) );
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    for( i = 0; i < NUMWRITERS; i++ )
+    {
+        Any_snprintf( section, 32, "Writer%d", i );
+
+        if( IniConfigFile_getInt( ini, "Counters", section, 0 ) != NUMUPDATES )
+        {
+            ANY_LOG( 0, "Lost counter updates of %s", ANY_LOG_ERROR, section );
+            retVal = false;
+        }
+
+        for( j = 0; j < NUMUPDATES; j++ )
+        {
+            Any_snprintf( key, 32, "key%d", j );
+
+            if( IniConfigFile_getInt( ini, section, key, -1 ) != j )
+            {
+                ANY_LOG( 0, "Lost update %s/%s", ANY_LOG_ERROR, section, key );
+                retVal = false;
+                break;
+            }
+        }
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    bool retVal = true;
+
+    retVal = runWriters( false ) && retVal;
+    retVal = runWriters( true ) && retVal;
+
+    remove( FILENAME ".lock" );
+
+    return retVal ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/* EOF */
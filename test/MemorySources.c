@@ -0,0 +1,212 @@
+/*
+ *  Test program reading INI contents from memory buffers and file descriptors
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME     "MemorySources.ini"
+#define NUMSECTIONS  2000
+
+
+static const char contents[] =
+    "; embedded defaults\n"
+    "version=3\n"
+    "[Network]\n"
+    "address = dhcp\n"
+    "port=8080\n"
+    "[Arm]\n"
+    "joints=7\n"
+    "name=\"left arm\"\n";
+
+
+/*
+ * Checks the values of contents
+ */
+static bool check( const IniConfigFile *ini, const char *mode )
+{
+    char value[64];
+
+    IniConfigFile_getString( ini, "Arm", "name", "", value, 64 );
+
+    if( IniConfigFile_getLong( ini, NULL, "version", 0 ) != 3 ||
+        IniConfigFile_getLong( ini, "network", "port", 0 ) != 8080 ||
+        IniConfigFile_getInt( ini, "Arm", "joints", 0 ) != 7 ||
+        strcmp( value, "left arm" ) != 0 ||
+        IniConfigFile_countSections( ini ) != 2 ||
+        IniConfigFile_countKeys( ini, "Network" ) != 2 )
+    {
+        ANY_LOG( 0, "%s: wrong values", ANY_LOG_ERROR, mode );
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Writes a configuration larger than a pipe holds into a pipe
+ */
+static void *writePipe( void *arg )
+{
+    FILE *fp = fdopen( *(int *)arg, "w" );
+    int i = 0;
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        fprintf( fp, "[Section%d]\nvalue=%d\n", i, i );
+    }
+
+    fclose( fp );
+
+    return NULL;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    char *copy = NULL;
+    pthread_t writer;
+    FILE *fp = NULL;
+    int status = EXIT_SUCCESS;
+    int fds[2];
+    int fd = -1;
+
+    ini = IniConfigFile_new();
+
+    /* a copied buffer may be changed right after the init */
+    copy = Any_strdup( (char *)contents );
+
+    if( !IniConfigFile_initFromBuffer( ini, copy, strlen( copy ), false ) )
+    {
+        ANY_LOG( 0, "Unable to parse a copied buffer", ANY_LOG_ERROR );
+        return( EXIT_FAILURE );
+    }
+
+    memset( copy, '#', strlen( copy ) );
+
+    if( !check( ini, "copied" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* puts work like on a loaded file, a load parses the buffer again */
+    IniConfigFile_putLong( ini, "Network", "port", 9090 );
+    IniConfigFile_putString( ini, "Added", "key", "value" );
+
+    if( IniConfigFile_getLong( ini, "Network", "port", 0 ) != 9090 || IniConfigFile_countSections( ini ) != 3 ||
+        !IniConfigFile_load( ini ) || !check( ini, "reloaded" ) )
+    {
+        ANY_LOG( 0, "Puts or reload of a buffer failed", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_freeze( ini ) || !check( ini, "frozen" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( ini );
+    ANY_FREE( copy );
+
+    /* a borrowed buffer is used in place */
+    if( !IniConfigFile_initFromBuffer( ini, contents, sizeof( contents ) - 1, true ) ||
+        !check( ini, "borrowed" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* text flags apply to the next load */
+    IniConfigFile_setTextFlags( ini, INICONFIGTEXT_VALIDATE );
+
+    if( !IniConfigFile_load( ini ) || !check( ini, "validated" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( ini );
+
+    if( !IniConfigFile_initFromBuffer( ini, "", 0, true ) || IniConfigFile_countSections( ini ) != 0 ||
+        IniConfigFile_getLong( ini, "Network", "port", -1 ) != -1 )
+    {
+        ANY_LOG( 0, "An empty buffer is not an empty file", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( ini );
+
+    /* a regular file is read from its current offset */
+    fp = fopen( FILENAME, "w" );
+
+    if( fp == NULL )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    fprintf( fp, "[Skipped]\n%s", contents );
+    fclose( fp );
+
+    fd = open( FILENAME, O_RDONLY );
+
+    if( fd == -1 || lseek( fd, strlen( "[Skipped]\n" ), SEEK_SET ) == -1 ||
+        !IniConfigFile_initFromFd( ini, fd ) || !check( ini, "file descriptor" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    close( fd );
+    remove( FILENAME );
+    IniConfigFile_clear( ini );
+
+    /* a pipe is read until the writer closes it */
+    if( pipe( fds ) != 0 || pthread_create( &writer, NULL, writePipe, &fds[1] ) != 0 )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    if( !IniConfigFile_initFromFd( ini, fds[0] ) )
+    {
+        ANY_LOG( 0, "Unable to read a pipe", ANY_LOG_ERROR );
+        pthread_join( writer, NULL );
+        return( EXIT_FAILURE );
+    }
+
+    pthread_join( writer, NULL );
+    close( fds[0] );
+
+    if( IniConfigFile_countSections( ini ) != NUMSECTIONS ||
+        IniConfigFile_getLong( ini, "Section1999", "value", 0 ) != NUMSECTIONS - 1 )
+    {
+        ANY_LOG( 0, "Contents of the pipe are wrong", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,265 @@
+/*
+ *  Test program checking that every NUMA node reads a complete, current copy
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "NumaReplicas.ini"
+#define NUMKEYS       1000
+
+
+typedef struct Reader
+{
+    const IniConfigFile *ini;
+    pthread_t thread;
+    int cpu;
+    long offset;
+    bool ok;
+}
+Reader;
+
+
+static bool writeFile( long offset )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "[Values]\n" );
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        fprintf( fp, "key%d=%ld\n", i, offset + i );
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static int countNodes( void )
+{
+    char path[64];
+    int numNodes = 1;
+    int node = 0;
+
+    for( node = 0; node < INICONFIGREPLICAS_MAXNODES; node++ )
+    {
+        Any_snprintf( path, sizeof( path ), "/sys/devices/system/node/node%d", node );
+
+        if( access( path, F_OK ) == 0 )
+        {
+            numNodes = node + 1;
+        }
+    }
+
+    return numNodes;
+}
+
+
+static bool checkIndex( const IniConfigIndex *index, long offset )
+{
+    char key[32];
+    int i = 0;
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        Any_snprintf( key, sizeof( key ), "key%d", i );
+
+        if( IniConfigIndex_getLong( index, "Values", key, -1 ) != offset + i )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Reads all keys from one CPU, through the replica of its node
+ */
+static void *Reader_run( void *arg )
+{
+    Reader *self = (Reader *)arg;
+    const IniConfigReplicas *replicas = self->ini->frozen;
+    cpu_set_t cpus;
+    char key[32];
+    int i = 0;
+
+    CPU_ZERO( &cpus );
+    CPU_SET( self->cpu, &cpus );
+
+    /* CPUs outside of the allowed set are skipped */
+    if( sched_setaffinity( 0, sizeof( cpus ), &cpus ) != 0 )
+    {
+        return NULL;
+    }
+
+    for( i = 0; i < NUMKEYS && self->ok; i++ )
+    {
+        Any_snprintf( key, sizeof( key ), "key%d", i );
+        self->ok = IniConfigFile_getLong( self->ini, "Values", key, -1 ) == self->offset + i;
+    }
+
+    if( replicas->numNodes > 1 &&
+        IniConfigReplicas_getLocal( replicas ) != IniConfigReplicas_getReplica( replicas, replicas->nodeOfCpu[self->cpu] ) )
+    {
+        ANY_LOG( 0, "CPU %d does not read the replica of its node", ANY_LOG_ERROR, self->cpu );
+        self->ok = false;
+    }
+
+    return NULL;
+}
+
+
+static bool readOnAllCpus( const IniConfigFile *ini, long offset )
+{
+    int numCpus = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    Reader *readers = NULL;
+    bool retVal = true;
+    int i = 0;
+
+    if( numCpus > CPU_SETSIZE )
+    {
+        numCpus = CPU_SETSIZE;
+    }
+
+    readers = ANY_NTALLOC( numCpus, Reader );
+
+    for( i = 0; i < numCpus; i++ )
+    {
+        readers[i].ini = ini;
+        readers[i].cpu = i;
+        readers[i].offset = offset;
+        readers[i].ok = true;
+
+        pthread_create( &readers[i].thread, NULL, Reader_run, &readers[i] );
+    }
+
+    for( i = 0; i < numCpus; i++ )
+    {
+        pthread_join( readers[i].thread, NULL );
+        retVal = retVal && readers[i].ok;
+    }
+
+    ANY_FREE( readers );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    IniConfigIndex copy;
+    int status = EXIT_SUCCESS;
+    int node = 0;
+
+    if( !writeFile( 0 ) )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_setNumaReplicas( ini, true );
+
+    IniConfigIndex_init( &copy );
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_freeze( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    if( IniConfigReplicas_getNumNodes( ini->frozen ) != countNodes() )
+    {
+        ANY_LOG( 0, "%d replicas for %d nodes", ANY_LOG_ERROR, IniConfigReplicas_getNumNodes( ini->frozen ),
+                 countNodes() );
+        status = EXIT_FAILURE;
+    }
+
+    for( node = 0; node < IniConfigReplicas_getNumNodes( ini->frozen ); node++ )
+    {
+        const IniConfigIndex *replica = IniConfigReplicas_getReplica( ini->frozen, node );
+
+        /* a copy placed on the node must read the same as the original */
+        if( !checkIndex( replica, 0 ) || !IniConfigIndex_copy( &copy, replica, node ) || !checkIndex( &copy, 0 ) )
+        {
+            ANY_LOG( 0, "Replica of node %d differs from the file", ANY_LOG_ERROR, node );
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if( !readOnAllCpus( ini, 0 ) )
+    {
+        ANY_LOG( 0, "A reader saw wrong values", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* a reload replaces the copies of all nodes */
+    if( !writeFile( 5000 ) || !IniConfigFile_load( ini ) || !IniConfigFile_freeze( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    for( node = 0; node < IniConfigReplicas_getNumNodes( ini->frozen ); node++ )
+    {
+        if( !checkIndex( IniConfigReplicas_getReplica( ini->frozen, node ), 5000 ) )
+        {
+            ANY_LOG( 0, "Replica of node %d kept old values", ANY_LOG_ERROR, node );
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if( !readOnAllCpus( ini, 5000 ) )
+    {
+        ANY_LOG( 0, "A reader saw old values after the reload", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigIndex_clear( &copy );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
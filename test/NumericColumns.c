@@ -0,0 +1,201 @@
+/*
+ *  Test program checking the numeric columns built at load time
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "NumericColumns.ini"
+#define NUMKEYS     1000
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "rate=100\nname=robot\n" );
+    fprintf( fp, "[Mixed]\n" );
+    fprintf( fp, "count=42\nnegative=-7\nmask=0x1F\ngain=0.25\nexp=1e3\n" );
+    fprintf( fp, "label=left arm\nempty=\nnotanumber=nan\nunit=12mm\nhuge=99999999999999999999\n" );
+    fprintf( fp, "[Labels]\nfirst=one\nsecond=two\n" );
+    fprintf( fp, "[Calibration]\n" );
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        fprintf( fp, "c%d=%d.5\n", i, i );
+    }
+
+    /* shadowed by the first [Mixed] */
+    fprintf( fp, "[Mixed]\nlater=1\n" );
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool expect( const IniConfigColumnsSpan *span, unsigned int i, const char *name, int type,
+                    long long intValue, double doubleValue )
+{
+    if( i >= span->count || strcmp( span->names[i], name ) != 0 || span->types[i] != type ||
+        span->ints[i] != intValue || span->doubles[i] != doubleValue )
+    {
+        ANY_LOG( 0, "Column %u is not %s", ANY_LOG_ERROR, i, name );
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool checkColumns( const IniConfigFile *ini )
+{
+    IniConfigColumnsSpan span;
+    double expected = 0.0;
+    double sum = 0.0;
+    unsigned int i = 0;
+
+    /* strings, values which are not complete numbers and the shadowed section are left out */
+    if( !IniConfigFile_getColumns( ini, "MIXED", &span ) || span.count != 6 ||
+        !expect( &span, 0, "count", INICONFIGCOLUMNS_INT, 42, 42.0 ) ||
+        !expect( &span, 1, "negative", INICONFIGCOLUMNS_INT, -7, -7.0 ) ||
+        !expect( &span, 2, "mask", INICONFIGCOLUMNS_INT, 31, 31.0 ) ||
+        !expect( &span, 3, "gain", INICONFIGCOLUMNS_DOUBLE, 0, 0.25 ) ||
+        !expect( &span, 4, "exp", INICONFIGCOLUMNS_DOUBLE, 0, 1000.0 ) ||
+        !expect( &span, 5, "huge", INICONFIGCOLUMNS_DOUBLE, 0, 1e20 ) )
+    {
+        ANY_LOG( 0, "Wrong columns of [Mixed]", ANY_LOG_ERROR );
+        return false;
+    }
+
+    if( !IniConfigFile_getColumns( ini, NULL, &span ) || span.count != 1 ||
+        !expect( &span, 0, "rate", INICONFIGCOLUMNS_INT, 100, 100.0 ) )
+    {
+        ANY_LOG( 0, "Wrong columns of the global area", ANY_LOG_ERROR );
+        return false;
+    }
+
+    if( IniConfigFile_getColumns( ini, "Labels", &span ) || span.count != 0 ||
+        IniConfigFile_getColumns( ini, "Missing", &span ) )
+    {
+        ANY_LOG( 0, "Sections without numbers have columns", ANY_LOG_ERROR );
+        return false;
+    }
+
+    if( !IniConfigFile_getColumns( ini, "Calibration", &span ) || span.count != NUMKEYS ||
+        ( (size_t)span.doubles % INICONFIGCOLUMNS_ALIGN ) != 0 || ( (size_t)span.ints % INICONFIGCOLUMNS_ALIGN ) != 0 )
+    {
+        ANY_LOG( 0, "Calibration columns missing or not aligned", ANY_LOG_ERROR );
+        return false;
+    }
+
+    for( i = 0; i < span.count; i++ )
+    {
+        char key[32];
+
+        Any_snprintf( key, sizeof( key ), "c%u", i );
+
+        if( strcmp( span.names[i], key ) != 0 )
+        {
+            ANY_LOG( 0, "Calibration key %u is %s", ANY_LOG_ERROR, i, span.names[i] );
+            return false;
+        }
+
+        expected += IniConfigFile_getDouble( ini, "Calibration", key, 0.0 );
+        sum += span.doubles[i];
+    }
+
+    if( sum != expected )
+    {
+        ANY_LOG( 0, "Calibration sums to %f, %f expected", ANY_LOG_ERROR, sum, expected );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    IniConfigColumnsSpan span;
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+    IniConfigFile_setColumnar( ini, true );
+
+    if( !IniConfigFile_load( ini ) || !checkColumns( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* the columns keep the values of the load */
+    IniConfigFile_putLong( ini, "Mixed", "count", 43 );
+
+    if( !IniConfigFile_getColumns( ini, "Mixed", &span ) || span.ints[0] != 42 )
+    {
+        ANY_LOG( 0, "Columns followed a put", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !checkColumns( ini ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* the columns do not depend on the mode gets are answered in */
+    if( !IniConfigFile_freeze( ini ) || !checkColumns( ini ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_setColumnar( ini, false );
+
+    if( ini->columns != NULL )
+    {
+        ANY_LOG( 0, "Disabling kept the columns", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,316 @@
+/*
+ *  Test program checking that parse time and memory grow linearly with the input
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define SCALE        4
+#define NUMRUNS      3
+
+/*
+ * A linear parse grows by SCALE, a quadratic one by SCALE * SCALE. Time
+ * gets some slack for the larger input missing the caches more often,
+ * memory for tables growing in powers of two.
+ */
+#define MAXTIMERATIO    ( SCALE * 3.0 )
+#define MAXMEMORYRATIO  ( SCALE * 2.0 )
+
+
+typedef size_t ( *Generator )( char *contents, size_t size, int count );
+
+typedef struct Shape
+{
+    const char *name;
+    Generator generate;
+    int count;                          /**< Units of the small input */
+    size_t unitSize;                    /**< Upper bound of the bytes per unit */
+    int degree;                         /**< 1 if the loaded file grows linearly, 2 if quadratically */
+}
+Shape;
+
+
+static size_t longLine( char *contents, size_t size, int count )
+{
+    size_t length = Any_snprintf( contents, size, "[A]\nkey=" );
+
+    memset( contents + length, 'x', count );
+    length += count;
+    contents[length++] = '\n';
+
+    return length;
+}
+
+
+static size_t manySections( char *contents, size_t size, int count )
+{
+    size_t length = 0;
+    int i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length, "[S%d]\nk=%d\n", i, i );
+    }
+
+    return length;
+}
+
+
+static size_t manyKeys( char *contents, size_t size, int count )
+{
+    size_t length = Any_snprintf( contents, size, "[A]\n" );
+    int i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length, "key%d=%d\n", i, i );
+    }
+
+    return length;
+}
+
+
+static size_t duplicateKeys( char *contents, size_t size, int count )
+{
+    size_t length = Any_snprintf( contents, size, "[A]\n" );
+    int i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length, "key=%d\n", i );
+    }
+
+    return length;
+}
+
+
+static size_t duplicateSections( char *contents, size_t size, int count )
+{
+    size_t length = 0;
+    int i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length, "[A]\nkey=%d\n", i );
+    }
+
+    return length;
+}
+
+
+static size_t comments( char *contents, size_t size, int count )
+{
+    size_t length = 0;
+    int i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length, "; comment %d\n\n", i );
+    }
+
+    return length;
+}
+
+
+/*
+ * Every section inherits the keys of all sections before it, so the loaded
+ * file itself grows quadratically
+ */
+static size_t inheritanceChain( char *contents, size_t size, int count )
+{
+    size_t length = Any_snprintf( contents, size, "[S0]\nk0=0\n" );
+    int i = 0;
+
+    for( i = 1; i < count; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length, "[S%d : S%d]\nk%d=%d\n", i, i - 1, i, i );
+    }
+
+    return length;
+}
+
+
+static const Shape shapes[] =
+{
+    { "long line",          longLine,           1 << 21, 1,  1 },
+    { "sections",           manySections,       50000,   32, 1 },
+    { "keys",               manyKeys,           50000,   32, 1 },
+    { "duplicate keys",     duplicateKeys,      50000,   32, 1 },
+    { "duplicate sections", duplicateSections,  50000,   32, 1 },
+    { "comments",           comments,           50000,   32, 1 },
+    { "inheritance chain",  inheritanceChain,   250,     48, 2 },
+    { NULL,                 NULL,               0,       0,  0 }
+};
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Bytes allocated from the heap, including mapped blocks
+ */
+static size_t heapInUse( void )
+{
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 33 ) )
+    struct mallinfo2 info = mallinfo2();
+
+    return info.uordblks + info.hblkhd;
+#else
+    struct mallinfo info = mallinfo();
+
+    return (size_t)(unsigned int)info.uordblks + (size_t)(unsigned int)info.hblkhd;
+#endif
+}
+
+
+/*
+ * Parses the input NUMRUNS times, returns the fastest time and the memory
+ * the loaded file holds
+ */
+static bool measure( const char *contents, size_t length, double *seconds, size_t *memory )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    size_t before = 0;
+    double start = 0.0;
+    int i = 0;
+
+    if( ini == NULL )
+    {
+        return false;
+    }
+
+    *seconds = 0.0;
+
+    for( i = 0; i < NUMRUNS; i++ )
+    {
+        before = heapInUse();
+        start = now();
+
+        if( !IniConfigFile_initFromBuffer( ini, contents, length, true ) )
+        {
+            IniConfigFile_delete( ini );
+            return false;
+        }
+
+        if( i == 0 || now() - start < *seconds )
+        {
+            *seconds = now() - start;
+        }
+
+        *memory = heapInUse() - before;
+
+        IniConfigFile_clear( ini );
+    }
+
+    IniConfigFile_delete( ini );
+
+    return true;
+}
+
+
+static bool check( const Shape *shape )
+{
+    double seconds[2];
+    size_t memory[2];
+    size_t length[2];
+    char *contents = NULL;
+    size_t size = 0;
+    double growth = 1.0;
+    bool retVal = true;
+    int i = 0;
+
+    for( i = 0; i < 2; i++ )
+    {
+        int count = ( i == 0 ) ? shape->count : shape->count * SCALE;
+
+        size = (size_t)count * shape->unitSize + 64;
+        contents = (char *)ANY_BALLOC( size );
+
+        if( contents == NULL )
+        {
+            return false;
+        }
+
+        length[i] = shape->generate( contents, size, count );
+
+        if( !measure( contents, length[i], &seconds[i], &memory[i] ) )
+        {
+            ANY_LOG( 0, "%s: unable to parse %lu bytes", ANY_LOG_ERROR, shape->name, (unsigned long)length[i] );
+            ANY_FREE( contents );
+            return false;
+        }
+
+        ANY_FREE( contents );
+    }
+
+    /* beyond the growth of the input itself */
+    for( i = 1; i < shape->degree; i++ )
+    {
+        growth *= (double)length[1] / length[0];
+    }
+
+    ANY_LOG( 0, "%-18s %8lu -> %8lu bytes: time x%5.1f (%7.2f ms), memory x%5.1f (%5.1f bytes per byte)",
+             ANY_LOG_INFO, shape->name, (unsigned long)length[0], (unsigned long)length[1],
+             seconds[1] / seconds[0], seconds[1] * 1e3, (double)memory[1] / memory[0],
+             (double)memory[1] / length[1] );
+
+    if( seconds[1] > seconds[0] * growth * MAXTIMERATIO * length[1] / ( length[0] * SCALE ) )
+    {
+        ANY_LOG( 0, "%s: parse time grows faster than the input", ANY_LOG_ERROR, shape->name );
+        retVal = false;
+    }
+
+    if( memory[1] > memory[0] * growth * MAXMEMORYRATIO * length[1] / ( length[0] * SCALE ) )
+    {
+        ANY_LOG( 0, "%s: memory grows faster than the input", ANY_LOG_ERROR, shape->name );
+        retVal = false;
+    }
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    int status = EXIT_SUCCESS;
+    int i = 0;
+
+    for( i = 0; shapes[i].name != NULL; i++ )
+    {
+        if( !check( &shapes[i] ) )
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,411 @@
+/*
+ *  Test program comparing the native parser with minIni
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Any.h>
+#include <minIni.h>
+
+#include <IniConfigDocument.h>
+
+
+#define FILENAME     "ParserConformance.ini"
+#define BUFFERSIZE   100
+#define MAXNAMES     48
+#define NUMRANDOM    1500
+#define NUMATOMS     22
+#define NUMROUNDS    20
+
+
+/*
+ * Handcrafted files for every rule of the minIni syntax. Section headers
+ * with a ':' are missing on purpose: the document reads them as section
+ * inheritance, minIni as a part of the name.
+ */
+static const char *cases[] =
+{
+    "",
+    "key=global\n[A]\nkey=a\n",
+    "[A]\nx=1\n[B]\nx=2\n[A]\nx=3\ny=4\n",
+    "[ Spaced ]\n  key  =  value  \n\tkey2\t=\tvalue2\t\n",
+    "[A]\nx=1 ; comment\ny=2 # comment\n; x=3\n# y=4\nz=\"quoted ; not a comment\"\n",
+    "[A]\nq=\"open\nr=\"\"\ns=\" spaced \"\nt='single'\nu=\"a\\\"b\"\n",
+    "[A]\nx:1\ny : 2\nz=a=b\nw=a:b\nv:a=b\n",
+    "[A]\nx=1\nx=2\n[a]\nx=3\nX=4\n",
+    "[A]\r\nx=1\r\n\r\n[B]\r\ny=2\r\n",
+    "[A]\nnoequals\n=empty\nx=\n[\n]\n[B\nx=2\n",
+    "[]\nx=1\n[A]]\ny=2\n[[C]\nz=3\n",
+    "[A]\nkey with spaces = value with spaces\n  [B]  \nx=1\n",
+    "[A]\nx=1\\\ny=2\n\\=3\n\"k\"=4\n",
+    "[A]\nx=1",
+    ";only a comment",
+    "\n\n\n[A]\n\n\nx=1\n\n",
+    "[A]\nx=1;a\ny=1 ;a\nz=1\t;a\nw=\"1\";a\n",
+    "[A]\n\tx=1\n[B]\n y=2\n[C]\n\t[D]\nz=3\n",
+    NULL
+};
+
+static const char *atoms[NUMATOMS] =
+{
+    "[", "]", "=", ":", ";", "#", " ", "\t", "\"", "\\", "\n", "\n", "\n", "\r\n",
+    "a", "B", "x", "sec", "key", "1", "a a", "[sec]\n"
+};
+
+static const char *fixedNames[] =
+{
+    "", "a", "A", "B", "x", "sec", "key", "a a", "missing"
+};
+
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static bool writeFile( const char *contents, size_t length )
+{
+    FILE *fp = fopen( FILENAME, "wb" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fwrite( contents, 1, length, fp );
+    fclose( fp );
+
+    return true;
+}
+
+
+/*
+ * Random text from the atoms of the syntax, ':' in section headers replaced
+ */
+static size_t makeRandom( char *contents, size_t size )
+{
+    size_t length = 0;
+    size_t line = 0;
+    size_t i = 0;
+    int count = rand() % 60;
+
+    contents[0] = '\0';
+
+    while( count-- > 0 )
+    {
+        const char *atom = atoms[rand() % NUMATOMS];
+
+        if( length + strlen( atom ) + 1 >= size )
+        {
+            break;
+        }
+
+        strcpy( contents + length, atom );
+        length += strlen( atom );
+    }
+
+    while( line < length )
+    {
+        i = line;
+
+        while( contents[i] == ' ' || contents[i] == '\t' )
+        {
+            i++;
+        }
+
+        if( contents[i] == '[' )
+        {
+            for( ; i < length && contents[i] != '\n'; i++ )
+            {
+                if( contents[i] == ':' )
+                {
+                    contents[i] = '.';
+                }
+            }
+        }
+
+        while( line < length && contents[line++] != '\n' )
+        {
+        }
+    }
+
+    return length;
+}
+
+
+/*
+ * A large file of the usual layout, to measure the speedup on
+ */
+static size_t makeLarge( char *contents, size_t size, int numSections )
+{
+    size_t length = 0;
+    int i = 0;
+
+    length += Any_snprintf( contents, size, "; robot setup\nversion=3\n" );
+
+    for( i = 0; i < numSections; i++ )
+    {
+        length += Any_snprintf( contents + length, size - length,
+                                "[Joint%d]\nangle = %d ; degrees\nspeed=%d.5\nname=\"joint %d\"\n\n", i, i, i, i );
+    }
+
+    return length;
+}
+
+
+/*
+ * The names to look up: fixed ones and those minIni lists
+ */
+static int collectNames( char names[MAXNAMES][BUFFERSIZE] )
+{
+    int numFixed = (int)( sizeof( fixedNames ) / sizeof( fixedNames[0] ) );
+    int count = 0;
+    int i = 0;
+
+    for( i = 0; i < numFixed; i++ )
+    {
+        Any_snprintf( names[count++], BUFFERSIZE, "%s", fixedNames[i] );
+    }
+
+    for( i = 0; count < MAXNAMES / 2 && ini_getsection( i, names[count], BUFFERSIZE, FILENAME ) > 0; i++ )
+    {
+        count++;
+    }
+
+    /* the keys of the global section and of the first section */
+    for( i = 0; count < MAXNAMES && ini_getkey( "", i, names[count], BUFFERSIZE, FILENAME ) > 0; i++ )
+    {
+        count++;
+    }
+
+    for( i = 0; count < MAXNAMES && ini_getkey( names[numFixed], i, names[count], BUFFERSIZE, FILENAME ) > 0; i++ )
+    {
+        count++;
+    }
+
+    return count;
+}
+
+
+/*
+ * Asserts identical results of every lookup, returns the number of differences
+ */
+static int compare( const char *description, const IniConfigDocument *document, char names[MAXNAMES][BUFFERSIZE],
+                    int numNames )
+{
+    char expected[BUFFERSIZE];
+    char actual[BUFFERSIZE];
+    int numErrors = 0;
+    int r1 = 0;
+    int r2 = 0;
+    int s = 0;
+    int k = 0;
+
+    for( s = 0; s < numNames; s++ )
+    {
+        for( k = 0; k < numNames; k++ )
+        {
+            r1 = ini_gets( names[s], names[k], "DEFAULT", expected, BUFFERSIZE, FILENAME );
+            r2 = IniConfigDocument_getString( document, names[s], names[k], "DEFAULT", actual, BUFFERSIZE );
+
+            if( r1 != r2 || strcmp( expected, actual ) != 0 )
+            {
+                ANY_LOG( 0, "%s: [%s] %s is '%s', minIni reads '%s'", ANY_LOG_ERROR, description, names[s],
+                         names[k], actual, expected );
+                numErrors++;
+            }
+        }
+
+        for( k = 0; k < numNames; k++ )
+        {
+            r1 = ini_getkey( names[s], k, expected, BUFFERSIZE, FILENAME );
+            r2 = IniConfigDocument_getKey( document, names[s], k, actual, BUFFERSIZE );
+
+            if( r1 != r2 || strcmp( expected, actual ) != 0 )
+            {
+                ANY_LOG( 0, "%s: key %d of [%s] is '%s', minIni reads '%s'", ANY_LOG_ERROR, description, k,
+                         names[s], actual, expected );
+                numErrors++;
+            }
+        }
+
+        r1 = ini_getsection( s, expected, BUFFERSIZE, FILENAME );
+        r2 = IniConfigDocument_getSection( document, s, actual, BUFFERSIZE );
+
+        if( r1 != r2 || strcmp( expected, actual ) != 0 )
+        {
+            ANY_LOG( 0, "%s: section %d is '%s', minIni reads '%s'", ANY_LOG_ERROR, description, s, actual,
+                     expected );
+            numErrors++;
+        }
+    }
+
+    return numErrors;
+}
+
+
+/*
+ * Compares a file and reports how much faster the document answers the lookups
+ */
+static int check( const char *description, const char *contents, size_t length, bool timed )
+{
+    char names[MAXNAMES][BUFFERSIZE];
+    char buffer[BUFFERSIZE];
+    IniConfigDocument document;
+    double minIniTime = 0.0;
+    double documentTime = 0.0;
+    double start = 0.0;
+    int numErrors = 0;
+    int numNames = 0;
+    int i = 0;
+    int j = 0;
+
+    if( !writeFile( contents, length ) )
+    {
+        return 1;
+    }
+
+    numNames = collectNames( names );
+
+    IniConfigDocument_init( &document );
+
+    if( !IniConfigDocument_load( &document, FILENAME ) )
+    {
+        ANY_LOG( 0, "%s: unable to load", ANY_LOG_ERROR, description );
+        IniConfigDocument_clear( &document );
+        return 1;
+    }
+
+    numErrors = compare( description, &document, names, numNames );
+
+    IniConfigDocument_clear( &document );
+
+    if( !timed )
+    {
+        return numErrors;
+    }
+
+    /* minIni parses the file for every lookup, the document once per round */
+    start = now();
+
+    for( i = 0; i < NUMROUNDS; i++ )
+    {
+        for( j = 0; j < numNames; j++ )
+        {
+            ini_gets( names[j], names[numNames - 1 - j], "", buffer, BUFFERSIZE, FILENAME );
+        }
+    }
+
+    minIniTime = now() - start;
+    start = now();
+
+    for( i = 0; i < NUMROUNDS; i++ )
+    {
+        IniConfigDocument_init( &document );
+        IniConfigDocument_load( &document, FILENAME );
+
+        for( j = 0; j < numNames; j++ )
+        {
+            IniConfigDocument_getString( &document, names[j], names[numNames - 1 - j], "", buffer, BUFFERSIZE );
+        }
+
+        IniConfigDocument_clear( &document );
+    }
+
+    documentTime = now() - start;
+
+    ANY_LOG( 0, "%-12s %8lu bytes, %2d lookups: minIni %9.3f ms, document %8.3f ms, speedup %7.1f",
+             ANY_LOG_INFO, description, (unsigned long)length, numNames, minIniTime * 1e3 / NUMROUNDS,
+             documentTime * 1e3 / NUMROUNDS, documentTime > 0.0 ? minIniTime / documentTime : 0.0 );
+
+    return numErrors;
+}
+
+
+int main( void )
+{
+    char description[32];
+    char random[512];
+    char *contents = NULL;
+    size_t length = 0;
+    size_t size = 0;
+    FILE *fp = NULL;
+    int numErrors = 0;
+    int i = 0;
+
+    /* the example file, run from the test directory */
+    fp = fopen( "Example.ini", "rb" );
+
+    if( fp != NULL )
+    {
+        size = 4096;
+        contents = (char *)ANY_BALLOC( size );
+        length = fread( contents, 1, size, fp );
+        fclose( fp );
+
+        numErrors += check( "Example.ini", contents, length, true );
+
+        ANY_FREE( contents );
+    }
+
+    for( i = 0; cases[i] != NULL; i++ )
+    {
+        Any_snprintf( description, sizeof( description ), "case %d", i );
+        numErrors += check( description, cases[i], strlen( cases[i] ), true );
+    }
+
+    size = 2000 * 80 + 64;
+    contents = (char *)ANY_BALLOC( size );
+
+    if( contents == NULL )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    length = makeLarge( contents, size, 2000 );
+    numErrors += check( "large", contents, length, true );
+
+    ANY_FREE( contents );
+
+    /* fixed seed, a failure can be reproduced */
+    srand( 74 );
+
+    for( i = 0; i < NUMRANDOM && numErrors < 20; i++ )
+    {
+        length = makeRandom( random, sizeof( random ) );
+        Any_snprintf( description, sizeof( description ), "random %d", i );
+        numErrors += check( description, random, length, false );
+    }
+
+    remove( FILENAME );
+
+    if( numErrors > 0 )
+    {
+        ANY_LOG( 0, "%d differences to minIni", ANY_LOG_ERROR, numErrors );
+        return( EXIT_FAILURE );
+    }
+
+    return( EXIT_SUCCESS );
+}
+
+
+/* EOF */
@@ -0,0 +1,240 @@
+/*
+ *  Test program checking that periodic persists neither rewrite clean files nor lose puts
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "PersistChanges.ini"
+#define NUMWRITERS    4
+#define NUMPUTS       2000
+
+
+typedef struct Writer
+{
+    const IniConfigFile *ini;
+    pthread_t thread;
+    int id;
+}
+Writer;
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "; persisted by the test\n[Settings]\nmode=idle\n" );
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool sameFile( const struct stat *a, const struct stat *b )
+{
+    return ( a->st_ino == b->st_ino && a->st_mtim.tv_sec == b->st_mtim.tv_sec &&
+             a->st_mtim.tv_nsec == b->st_mtim.tv_nsec );
+}
+
+
+/*
+ * Adds a key per put and keeps overwriting one more
+ */
+static void *Writer_run( void *arg )
+{
+    Writer *self = (Writer *)arg;
+    char section[32];
+    char key[32];
+    int i = 0;
+
+    Any_snprintf( section, sizeof( section ), "Writer%d", self->id );
+
+    for( i = 0; i < NUMPUTS; i++ )
+    {
+        Any_snprintf( key, sizeof( key ), "key%d", i );
+
+        IniConfigFile_putInt( self->ini, section, key, i );
+        IniConfigFile_putInt( self->ini, section, "last", i );
+
+        if( i % 64 == 0 )
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Reads the file from disk as another process would
+ */
+static bool checkDisk( void )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    char section[32];
+    char key[32];
+    bool retVal = true;
+    int i = 0;
+    int j = 0;
+
+    if( !IniConfigFile_init( ini, FILENAME ) || !IniConfigFile_load( ini ) )
+    {
+        IniConfigFile_delete( ini );
+        return false;
+    }
+
+    for( i = 0; i < NUMWRITERS && retVal; i++ )
+    {
+        Any_snprintf( section, sizeof( section ), "Writer%d", i );
+
+        for( j = 0; j < NUMPUTS && retVal; j++ )
+        {
+            Any_snprintf( key, sizeof( key ), "key%d", j );
+
+            if( IniConfigFile_getInt( ini, section, key, -1 ) != j )
+            {
+                ANY_LOG( 0, "[%s] %s lost", ANY_LOG_ERROR, section, key );
+                retVal = false;
+            }
+        }
+
+        if( IniConfigFile_getInt( ini, section, "last", -1 ) != NUMPUTS - 1 )
+        {
+            ANY_LOG( 0, "[%s] last is %d", ANY_LOG_ERROR, section, IniConfigFile_getInt( ini, section, "last", -1 ) );
+            retVal = false;
+        }
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    Writer writers[NUMWRITERS];
+    struct stat before;
+    struct stat after;
+    int status = EXIT_SUCCESS;
+    int persists = 0;
+    int i = 0;
+
+    if( !writeFile() || stat( FILENAME, &before ) != 0 )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !IniConfigFile_load( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* nothing to write */
+    if( !IniConfigFile_persist( ini ) || stat( FILENAME, &after ) != 0 || !sameFile( &before, &after ) )
+    {
+        ANY_LOG( 0, "Persisting an unmodified file rewrote it", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* a dirty key reaches the disk */
+    IniConfigFile_putString( ini, "Settings", "mode", "busy" );
+
+    if( !IniConfigFile_persist( ini ) || stat( FILENAME, &after ) != 0 || sameFile( &before, &after ) )
+    {
+        ANY_LOG( 0, "Persisting a modified file did not write it", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    before = after;
+
+    if( !IniConfigFile_persist( ini ) || stat( FILENAME, &after ) != 0 || !sameFile( &before, &after ) )
+    {
+        ANY_LOG( 0, "Persisting twice rewrote the file", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* puts during persists are either written or still dirty for the next one */
+    for( i = 0; i < NUMWRITERS; i++ )
+    {
+        writers[i].ini = ini;
+        writers[i].id = i;
+
+        pthread_create( &writers[i].thread, NULL, Writer_run, &writers[i] );
+    }
+
+    for( i = 0; i < NUMWRITERS; i++ )
+    {
+        /* persist as often as possible while the writers run */
+        while( pthread_tryjoin_np( writers[i].thread, NULL ) != 0 )
+        {
+            if( !IniConfigFile_persist( ini ) )
+            {
+                ANY_LOG( 0, "Persist failed", ANY_LOG_ERROR );
+                status = EXIT_FAILURE;
+            }
+
+            persists++;
+        }
+    }
+
+    if( !IniConfigFile_persist( ini ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    ANY_LOG( 0, "%d persists during %d puts", ANY_LOG_INFO, persists, NUMWRITERS * NUMPUTS * 2 );
+
+    if( !checkDisk() )
+    {
+        ANY_LOG( 0, "Puts made during persists got lost", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,360 @@
+/*
+ *  Test program proving that index lookups neither allocate nor enter the kernel
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "RealtimeReads.ini"
+#define NUMSECTIONS   16
+#define NUMKEYS       64
+
+
+/*
+ * Interposed functions: they count the calls made while the current
+ * thread is inside a guarded region and then do the real work.
+ */
+
+extern void *__libc_malloc( size_t size );
+extern void *__libc_calloc( size_t count, size_t size );
+extern void *__libc_realloc( void *ptr, size_t size );
+extern void __libc_free( void *ptr );
+
+static __thread int guarded = 0;
+static __thread long violations = 0;
+
+
+void *malloc( size_t size )
+{
+    violations += guarded;
+    return __libc_malloc( size );
+}
+
+
+void *calloc( size_t count, size_t size )
+{
+    violations += guarded;
+    return __libc_calloc( count, size );
+}
+
+
+void *realloc( void *ptr, size_t size )
+{
+    violations += guarded;
+    return __libc_realloc( ptr, size );
+}
+
+
+void free( void *ptr )
+{
+    violations += guarded;
+    __libc_free( ptr );
+}
+
+
+int open( const char *path, int flags, ... )
+{
+    va_list args;
+    int mode = 0;
+
+    va_start( args, flags );
+    mode = ( flags & O_CREAT ) ? va_arg( args, int ) : 0;
+    va_end( args );
+
+    violations += guarded;
+    return (int)syscall( SYS_openat, AT_FDCWD, path, flags, mode );
+}
+
+
+int open64( const char *path, int flags, ... )
+{
+    va_list args;
+    int mode = 0;
+
+    va_start( args, flags );
+    mode = ( flags & O_CREAT ) ? va_arg( args, int ) : 0;
+    va_end( args );
+
+    violations += guarded;
+    return (int)syscall( SYS_openat, AT_FDCWD, path, flags, mode );
+}
+
+
+int openat( int dirfd, const char *path, int flags, ... )
+{
+    va_list args;
+    int mode = 0;
+
+    va_start( args, flags );
+    mode = ( flags & O_CREAT ) ? va_arg( args, int ) : 0;
+    va_end( args );
+
+    violations += guarded;
+    return (int)syscall( SYS_openat, dirfd, path, flags, mode );
+}
+
+
+ssize_t read( int fd, void *buffer, size_t count )
+{
+    violations += guarded;
+    return (ssize_t)syscall( SYS_read, fd, buffer, count );
+}
+
+
+FILE *fopen( const char *path, const char *mode )
+{
+    int flags = O_RDONLY;
+    int fd = -1;
+
+    violations += guarded;
+
+    if( mode[0] == 'w' )
+    {
+        flags = O_CREAT | O_TRUNC | ( strchr( mode, '+' ) ? O_RDWR : O_WRONLY );
+    }
+    else if( mode[0] == 'a' )
+    {
+        flags = O_CREAT | O_APPEND | ( strchr( mode, '+' ) ? O_RDWR : O_WRONLY );
+    }
+    else if( strchr( mode, '+' ) )
+    {
+        flags = O_RDWR;
+    }
+
+    fd = open( path, flags, 0666 );
+
+    return ( fd != -1 ) ? fdopen( fd, mode ) : NULL;
+}
+
+
+static bool writeFile( void )
+{
+    char line[128];
+    int fd = open( FILENAME, O_CREAT | O_TRUNC | O_WRONLY, 0644 );
+    int i = 0;
+    int j = 0;
+
+    if( fd == -1 )
+    {
+        return false;
+    }
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        Any_snprintf( line, sizeof( line ), "[Section%d]\n", i );
+        write( fd, line, strlen( line ) );
+
+        for( j = 0; j < NUMKEYS; j++ )
+        {
+            Any_snprintf( line, sizeof( line ), "key%d=%d.5\nhex%d=0x%x\n", j, i * NUMKEYS + j, j, j );
+            write( fd, line, strlen( line ) );
+        }
+    }
+
+    close( fd );
+
+    return true;
+}
+
+
+/*
+ * Reads every key through the index and compares it with the file
+ */
+static bool readAll( const IniConfigFile *ini, const IniConfigIndex *index, long *count )
+{
+    char section[32];
+    char key[32];
+    char expected[64];
+    char value[64];
+    bool retVal = true;
+    int i = 0;
+    int j = 0;
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        for( j = 0; j < NUMKEYS; j++ )
+        {
+            long expectedLong = 0;
+            double expectedDouble = 0.0;
+            long hexValue = 0;
+
+            Any_snprintf( section, sizeof( section ), "section%d", i );
+            Any_snprintf( key, sizeof( key ), "KEY%d", j );
+
+            /* the reference values come from the file, outside of the guard */
+            IniConfigFile_getString( ini, section, key, "", expected, 64 );
+            expectedLong = IniConfigFile_getLong( ini, section, key, -1 );
+            expectedDouble = IniConfigFile_getDouble( ini, section, key, -1.0 );
+
+            guarded = 1;
+
+            IniConfigIndex_getString( index, section, key, "", value, 64 );
+            retVal = retVal && strcmp( value, expected ) == 0;
+            retVal = retVal && IniConfigIndex_getLong( index, section, key, -1 ) == expectedLong;
+            retVal = retVal && IniConfigIndex_getDouble( index, section, key, -1.0 ) == expectedDouble;
+            retVal = retVal && IniConfigIndex_find( index, section, "missing" ) == NULL;
+            retVal = retVal && IniConfigIndex_getInt( index, "Nowhere", key, 7 ) == 7;
+
+            Any_snprintf( key, sizeof( key ), "hex%d", j );
+            hexValue = IniConfigIndex_getLong( index, section, key, -1 );
+
+            guarded = 0;
+
+            retVal = retVal && hexValue == j;
+            *count += 6;
+        }
+    }
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    IniConfigFile *unloaded = (IniConfigFile*)NULL;
+    IniConfigIndex *index = (IniConfigIndex*)NULL;
+    char *blob = NULL;
+    char value[64];
+    long lookups = 0;
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile())
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    unloaded = IniConfigFile_new();
+    IniConfigFile_init( unloaded, FILENAME );
+
+    index = IniConfigIndex_new();
+    IniConfigIndex_init( index );
+
+    if( !IniConfigFile_load( ini ))
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    if( !IniConfigFile_buildIndex( ini, index, INICONFIGINDEX_LOCKED ))
+    {
+        ANY_LOG( 0, "Locking the index is not permitted here, testing without", ANY_LOG_INFO );
+
+        if( !IniConfigFile_buildIndex( ini, index, INICONFIGINDEX_NONE ))
+        {
+            status = EXIT_FAILURE;
+            goto out;
+        }
+    }
+
+    /* the interposition works: file based gets are caught */
+    guarded = 1;
+    IniConfigFile_getString( unloaded, "Section1", "key1", "", value, 64 );
+    guarded = 0;
+
+    if( violations == 0 )
+    {
+        ANY_LOG( 0, "Interposed functions did not see the file access", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    violations = 0;
+
+    if( !readAll( ini, index, &lookups ))
+    {
+        ANY_LOG( 0, "Index values differ from the file", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( violations != 0 )
+    {
+        ANY_LOG( 0, "%ld allocations or file accesses in %ld lookups", ANY_LOG_ERROR, violations, lookups );
+        status = EXIT_FAILURE;
+    }
+
+    if( IniConfigIndex_getSize( index ) != NUMSECTIONS * NUMKEYS * 2 || IniConfigIndex_getMaxProbe( index ) > 16 )
+    {
+        ANY_LOG( 0, "Unexpected index shape: %u keys, max probe %u", ANY_LOG_ERROR,
+                 IniConfigIndex_getSize( index ), IniConfigIndex_getMaxProbe( index ) );
+        status = EXIT_FAILURE;
+    }
+
+    /* large enough for huge pages, which must not change any lookup */
+    blob = ANY_NTALLOC( INICONFIGINDEX_HUGEPAGESIZE, char );
+    memset( blob, 'x', INICONFIGINDEX_HUGEPAGESIZE - 1 );
+    blob[INICONFIGINDEX_HUGEPAGESIZE - 1] = '\0';
+    IniConfigFile_putString( ini, "Padding", "blob", blob );
+
+    if( !IniConfigFile_buildIndex( ini, index, INICONFIGINDEX_HUGEPAGES ) ||
+        IniConfigIndex_find( index, "Padding", "blob" ) == NULL ||
+        strlen( IniConfigIndex_find( index, "Padding", "blob" ) ) != INICONFIGINDEX_HUGEPAGESIZE - 1 ||
+        !readAll( ini, index, &lookups ) )
+    {
+        ANY_LOG( 0, "Index on transparent huge pages differs from the file", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_buildIndex( ini, index, INICONFIGINDEX_HUGETLB ) )
+    {
+        ANY_LOG( 0, "No huge pages reserved here, testing without", ANY_LOG_INFO );
+    }
+    else if( !readAll( ini, index, &lookups ) )
+    {
+        ANY_LOG( 0, "Index on reserved huge pages differs from the file", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( violations != 0 )
+    {
+        ANY_LOG( 0, "%ld allocations or file accesses in huge page lookups", ANY_LOG_ERROR, violations );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    if( blob != NULL )
+    {
+        ANY_FREE( blob );
+    }
+
+    IniConfigIndex_clear( index );
+    IniConfigIndex_delete( index );
+
+    IniConfigFile_clear( unloaded );
+    IniConfigFile_delete( unloaded );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,182 @@
+/*
+ *  Test program checking section inheritance and pattern default sections
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "SectionInheritance.ini"
+
+
+typedef struct Expectation
+{
+    const char *section;
+    const char *key;
+    const char *value;
+}
+Expectation;
+
+
+static const Expectation expectations[] =
+{
+    { "robot_A", "gain", "3" },                 /* own key wins */
+    { "ROBOT_A", "speed", "1.0" },              /* from the parent */
+    { "robot_A", "timeout", "5" },              /* from the parent's parent */
+    { "robot_A", "rate", "10" },
+    { "sensor.front", "frame", "front" },
+    { "sensor.front", "rate", "10" },           /* parents come before patterns */
+    { "sensor.front", "range", "4.5" },         /* from the pattern */
+    { "sensor.front", "timeout", "5" },
+    { "sensor.rear", "frame", "base" },         /* only the pattern */
+    { "sensor.rear", "rate", "30" },
+    { "sensor.rear", "speed", "<none>" },
+    { "sensor.*", "frame", "base" },            /* patterns are sections, too */
+    { "loop_a", "y", "2" },                     /* cycles end */
+    { "loop_b", "x", "1" },
+    { "lonely", "k", "1" },                     /* unknown parents are ignored */
+    { "lonely", "timeout", "<none>" },
+    { "global", "gain", "<none>" },             /* nothing flows upwards */
+    { NULL, "top", "yes" },
+    { NULL, "rate", "<none>" }
+};
+
+#define NUMEXPECTATIONS  ( sizeof( expectations ) / sizeof( expectations[0] ) )
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "top=yes\n" );
+    fprintf( fp, "[global]\ntimeout=5\n" );
+    fprintf( fp, "[robot_defaults : global]\nspeed=1.0\ngain=2\nrate=10\n" );
+    fprintf( fp, "[sensor.*]\nrate=30\nframe=base\nrange=4.5\n" );
+    fprintf( fp, "[robot_A : robot_defaults]\ngain=3\n" );
+    fprintf( fp, "[ sensor.front : robot_A , missing ]\nframe=front\n" );
+    fprintf( fp, "[sensor.rear]\n" );
+    fprintf( fp, "[loop_a : loop_b]\nx=1\n[loop_b:loop_a]\ny=2\n" );
+    fprintf( fp, "[lonely : nowhere]\nk=1\n" );
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool check( const IniConfigFile *ini, const char *mode )
+{
+    char value[64];
+    unsigned int i = 0;
+
+    for( i = 0; i < NUMEXPECTATIONS; i++ )
+    {
+        const Expectation *expected = &expectations[i];
+
+        IniConfigFile_getString( ini, expected->section, expected->key, "<none>", value, sizeof( value ) );
+
+        if( strcmp( value, expected->value ) != 0 )
+        {
+            ANY_LOG( 0, "%s: [%s] %s is '%s', '%s' expected", ANY_LOG_ERROR, mode,
+                     expected->section ? expected->section : "", expected->key, value, expected->value );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    char buffer[64];
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !IniConfigFile_load( ini ) || !check( ini, "loaded" ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* the header names the section without its parents, which stay out of the key list */
+    IniConfigFile_getSection( ini, 3, buffer, sizeof( buffer ) );
+
+    if( strcmp( buffer, "robot_A" ) != 0 || IniConfigFile_getKey( ini, "robot_A", 1, buffer, sizeof( buffer ) ) != 0 )
+    {
+        ANY_LOG( 0, "Section or key list contains inherited names", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* overriding an inherited key only changes the section, saving keeps the header */
+    IniConfigFile_putString( ini, "robot_A", "speed", "2.0" );
+
+    if( IniConfigFile_getDouble( ini, "robot_A", "speed", 0.0 ) != 2.0 ||
+        IniConfigFile_getDouble( ini, "robot_defaults", "speed", 0.0 ) != 1.0 ||
+        !IniConfigFile_save( ini ) || !IniConfigFile_load( ini ) ||
+        IniConfigFile_getDouble( ini, "robot_A", "speed", 0.0 ) != 2.0 ||
+        IniConfigFile_getDouble( ini, "sensor.front", "speed", 0.0 ) != 2.0 )
+    {
+        ANY_LOG( 0, "Override of an inherited key failed", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_putString( ini, "robot_A", "speed", NULL );
+
+    if( !IniConfigFile_save( ini ) || !IniConfigFile_load( ini ) || !check( ini, "reloaded" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_freeze( ini ) || !check( ini, "frozen" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE ) ||
+        !check( ini, "double buffered" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
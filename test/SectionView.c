@@ -0,0 +1,190 @@
+/*
+ *  Test program checking that section views read and write like the file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+#include <IniConfigSection.h>
+
+
+#define FILENAME    "SectionView.ini"
+#define NUMKEYS     20
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "version=3\n[Arm]\n" );
+
+    for( i = 0; i < NUMKEYS; i++ )
+    {
+        fprintf( fp, "joint%d=%d.5\n", i, i );
+    }
+
+    fprintf( fp, "mask=0x1f\nname=left arm\n[Leg]\njoint0=-1\n" );
+
+    fclose( fp );
+
+    return true;
+}
+
+
+/*
+ * Compares every typed get and the key iteration of a view with the file
+ */
+static bool check( const IniConfigFile *ini, const IniConfigSection *view, const char *mode )
+{
+    const char *section = IniConfigSection_getName( view );
+    char expected[64];
+    char value[64];
+    char key[32];
+    int i = 0;
+
+    for( i = 0; i <= NUMKEYS + 3; i++ )
+    {
+        if( i < NUMKEYS )
+        {
+            Any_snprintf( key, sizeof( key ), "JOINT%d", i );
+        }
+        else
+        {
+            strcpy( key, ( i == NUMKEYS ) ? "mask" : ( i == NUMKEYS + 1 ) ? "name" : "missing" );
+        }
+
+        IniConfigFile_getString( ini, section, key, "none", expected, 64 );
+        IniConfigSection_getString( view, key, "none", value, 64 );
+
+        if( strcmp( value, expected ) != 0 ||
+            IniConfigSection_getLong( view, key, -7 ) != IniConfigFile_getLong( ini, section, key, -7 ) ||
+            IniConfigSection_getInt( view, key, -7 ) != IniConfigFile_getInt( ini, section, key, -7 ) ||
+            IniConfigSection_getDouble( view, key, -7.0 ) != IniConfigFile_getDouble( ini, section, key, -7.0 ) )
+        {
+            ANY_LOG( 0, "%s: [%s] %s is '%s' in the view, '%s' in the file", ANY_LOG_ERROR, mode,
+                     section ? section : "", key, value, expected );
+            return false;
+        }
+    }
+
+    for( i = 0; i < NUMKEYS + 4; i++ )
+    {
+        IniConfigFile_getKey( ini, section, i, expected, 64 );
+        IniConfigSection_getKey( view, i, value, 64 );
+
+        if( strcmp( value, expected ) != 0 )
+        {
+            ANY_LOG( 0, "%s: key %d is '%s' in the view, '%s' in the file", ANY_LOG_ERROR, mode, i, value, expected );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    IniConfigSection *arm = (IniConfigSection*)NULL;
+    IniConfigSection *global = (IniConfigSection*)NULL;
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    arm = IniConfigSection_new();
+    IniConfigSection_init( arm, ini, "ARM" );
+
+    global = IniConfigSection_new();
+    IniConfigSection_init( global, ini, NULL );
+
+    if( !check( ini, arm, "unloaded" ) ||
+        IniConfigSection_getLong( arm, "mask", 0 ) != 0x1f ||
+        IniConfigSection_getInt( global, "version", 0 ) != 3 )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* puts through the view land in the section of the file */
+    IniConfigSection_putDouble( arm, "joint3", 42.0 );
+    IniConfigSection_putLong( arm, "added", 12 );
+    IniConfigSection_removeKey( arm, "joint4" );
+
+    if( IniConfigFile_getDouble( ini, "Arm", "joint3", 0.0 ) != 42.0 ||
+        IniConfigFile_getLong( ini, "Arm", "added", 0 ) != 12 ||
+        IniConfigFile_getLong( ini, "Arm", "joint4", -1 ) != -1 ||
+        IniConfigFile_getLong( ini, "Leg", "added", -1 ) != -1 )
+    {
+        ANY_LOG( 0, "Puts through the view went astray", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !check( ini, arm, "loaded" ) || !check( ini, global, "loaded" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_freeze( ini ) || !check( ini, arm, "frozen" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* the view outlives a reload, which drops the unsaved puts */
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE ) ||
+        !check( ini, arm, "double buffered" ) || !check( ini, global, "double buffered" ) ||
+        IniConfigSection_getLong( arm, "added", -1 ) != -1 )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigSection_clear( global );
+    IniConfigSection_delete( global );
+
+    IniConfigSection_clear( arm );
+    IniConfigSection_delete( arm );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
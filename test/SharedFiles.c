@@ -0,0 +1,261 @@
+/*
+ *  Test program sharing one frozen copy of a file within the process
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME     "SharedFiles.ini"
+#define LINKNAME     "SharedFilesLink.ini"
+#define NUMREADERS   4
+#define NUMREWRITES  20
+
+
+typedef struct Reader
+{
+    int *stop;
+    bool ok;
+}
+Reader;
+
+
+static bool writeFile( long port )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    bool retVal = false;
+
+    /* saves replace the file, like any writer using IniConfigFile would */
+    if( IniConfigFile_init( ini, FILENAME ) && IniConfigFile_load( ini ) )
+    {
+        IniConfigFile_putLong( ini, "Network", "port", port );
+        IniConfigFile_putLong( ini, "Network", "check", port * 2 );
+        IniConfigFile_putString( ini, "Arm", "name", "left arm" );
+        retVal = IniConfigFile_save( ini );
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return retVal;
+}
+
+
+static void countChanges( void *context, const char *fileName, unsigned long generation )
+{
+    (void)fileName;
+    (void)generation;
+
+    __sync_fetch_and_add( (int *)context, 1 );
+}
+
+
+/*
+ * Keeps switching to the latest version while the file is rewritten
+ */
+static void *readShared( void *arg )
+{
+    Reader *self = (Reader *)arg;
+    IniConfigFile *ini = IniConfigFile_new();
+
+    self->ok = IniConfigFile_init( ini, FILENAME );
+
+    while( self->ok && !__sync_fetch_and_add( self->stop, 0 ) )
+    {
+        long port = 0;
+
+        if( !IniConfigFile_loadShared( ini ) )
+        {
+            self->ok = false;
+            break;
+        }
+
+        /* a version never changes under its readers */
+        port = IniConfigFile_getLong( ini, "Network", "port", -1 );
+
+        if( IniConfigFile_getLong( ini, "Network", "check", -1 ) != port * 2 )
+        {
+            ANY_LOG( 0, "Version with port %ld is inconsistent", ANY_LOG_ERROR, port );
+            self->ok = false;
+        }
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    return NULL;
+}
+
+
+int main( void )
+{
+    IniConfigFile *a = (IniConfigFile*)NULL;
+    IniConfigFile *b = (IniConfigFile*)NULL;
+    IniConfigFile *c = (IniConfigFile*)NULL;
+    IniConfigFile *d = (IniConfigFile*)NULL;
+    pthread_t threads[NUMREADERS];
+    Reader readers[NUMREADERS];
+    int stop = 0;
+    int changesA = 0;
+    int changesC = 0;
+    int status = EXIT_SUCCESS;
+    int i = 0;
+
+    remove( LINKNAME );
+
+    if( !writeFile( 1 ) || symlink( FILENAME, LINKNAME ) != 0 )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    a = IniConfigFile_new();
+    b = IniConfigFile_new();
+    c = IniConfigFile_new();
+    d = IniConfigFile_new();
+
+    IniConfigFile_init( a, FILENAME );
+    IniConfigFile_init( b, FILENAME );
+    IniConfigFile_init( c, LINKNAME );
+    IniConfigFile_init( d, FILENAME );
+
+    IniConfigFile_setListener( a, countChanges, &changesA );
+
+    /* another path to the same file shares as well, a private load is dropped */
+    if( !IniConfigFile_loadShared( a ) || !IniConfigFile_loadShared( b ) ||
+        !IniConfigFile_load( c ) || !IniConfigFile_loadShared( c ) ||
+        a->document != b->document || a->document != c->document )
+    {
+        ANY_LOG( 0, "Files do not share one copy", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    IniConfigFile_setListener( c, countChanges, &changesC );
+
+    if( IniConfigFile_getLong( c, "network", "port", 0 ) != 1 || IniConfigFile_countSections( b ) != 2 ||
+        IniConfigFile_putLong( b, "Network", "port", 5 ) != 0 || IniConfigFile_getLong( a, "Network", "port", 0 ) != 1 )
+    {
+        ANY_LOG( 0, "Shared copy reads wrong or accepts puts", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* other settings get a copy of their own */
+    IniConfigFile_setTextFlags( d, INICONFIGTEXT_VALIDATE );
+
+    if( !IniConfigFile_loadShared( d ) || d->document == a->document )
+    {
+        ANY_LOG( 0, "Files with other settings share a copy", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* the first one to look loads the changed file, the others are told */
+    if( !writeFile( 2 ) || !IniConfigFile_loadShared( b ) ||
+        IniConfigFile_getLong( b, "Network", "port", 0 ) != 2 ||
+        IniConfigFile_getLong( a, "Network", "port", 0 ) != 1 ||
+        changesA != 1 || changesC != 1 )
+    {
+        ANY_LOG( 0, "Reload of the changed file went wrong (%d, %d notifications)", ANY_LOG_ERROR,
+                 changesA, changesC );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_loadShared( a ) || !IniConfigFile_loadShared( c ) ||
+        a->document != b->document || c->document != b->document ||
+        IniConfigFile_getLong( a, "Network", "port", 0 ) != 2 || changesA != 1 || changesC != 1 )
+    {
+        ANY_LOG( 0, "Switching to the new version loaded it again", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* a load makes a file private and writable again */
+    if( !IniConfigFile_load( a ) || a->document == b->document ||
+        !IniConfigFile_putLong( a, "Network", "port", 7 ) || IniConfigFile_getLong( b, "Network", "port", 0 ) != 2 )
+    {
+        ANY_LOG( 0, "Private load of a shared file went wrong", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    for( i = 0; i < NUMREADERS; i++ )
+    {
+        readers[i].stop = &stop;
+        readers[i].ok = true;
+        pthread_create( &threads[i], NULL, readShared, &readers[i] );
+    }
+
+    for( i = 0; i < NUMREWRITES; i++ )
+    {
+        if( !writeFile( 10 + i ) )
+        {
+            status = EXIT_FAILURE;
+        }
+
+        usleep( 1000 );
+    }
+
+    __sync_lock_test_and_set( &stop, 1 );
+
+    for( i = 0; i < NUMREADERS; i++ )
+    {
+        pthread_join( threads[i], NULL );
+
+        if( !readers[i].ok )
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if( !IniConfigFile_loadShared( b ) || IniConfigFile_getLong( b, "Network", "port", 0 ) != 10 + NUMREWRITES - 1 )
+    {
+        ANY_LOG( 0, "Last version not picked up", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( a );
+    IniConfigFile_delete( a );
+    IniConfigFile_clear( b );
+    IniConfigFile_delete( b );
+    IniConfigFile_clear( c );
+    IniConfigFile_delete( c );
+    IniConfigFile_clear( d );
+    IniConfigFile_delete( d );
+
+    /* files which do not exist are not shared */
+    remove( LINKNAME );
+    remove( FILENAME );
+
+    a = IniConfigFile_new();
+    IniConfigFile_init( a, FILENAME );
+
+    if( IniConfigFile_loadShared( a ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( a );
+    IniConfigFile_delete( a );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,184 @@
+/*
+ *  Test program taking snapshots of a loaded INI file
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME      "Snapshots.ini"
+#define NUMSECTIONS   20
+#define NUMKEYS       100
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    int i = 0;
+    int j = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "; generated\nversion=1\n" );
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        fprintf( fp, "\n[Section%d]\n", i );
+
+        for( j = 0; j < NUMKEYS; j++ )
+        {
+            fprintf( fp, "key%d=%d\n", j, i * NUMKEYS + j );
+        }
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static bool hasValue( const IniConfigFile *ini, const IniConfigSnapshot *snapshot, const char *section,
+                      const char *key, const char *expected )
+{
+    char value[64];
+
+    if( ini != NULL )
+    {
+        IniConfigFile_getString( ini, section, key, "<none>", value, 64 );
+    }
+    else
+    {
+        IniConfigSnapshot_getString( snapshot, section, key, "<none>", value, 64 );
+    }
+
+    if( strcmp( value, expected ) != 0 )
+    {
+        ANY_LOG( 0, "[%s] %s is '%s' instead of '%s'", ANY_LOG_ERROR,
+                 section ? section : "", key, value, expected );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    IniConfigSnapshot *snapshot = (IniConfigSnapshot*)NULL;
+    unsigned long untouched = 0;
+    unsigned long generation = 0;
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile())
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    snapshot = IniConfigSnapshot_new();
+    IniConfigSnapshot_init( snapshot );
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_snapshot( ini, snapshot ))
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    untouched = IniConfigFile_getGeneration( ini, "Section3", "key3" );
+
+    IniConfigFile_putString( ini, "Section7", "key42", "changed" );
+    IniConfigFile_putString( ini, NULL, "version", "2" );
+    IniConfigFile_putString( ini, "Section0", "added", "yes" );
+    IniConfigFile_removeKey( ini, "Section19", "key99" );
+
+    /* the snapshot keeps the old values */
+    if( !hasValue( NULL, snapshot, "section7", "KEY42", "742" ) ||
+        !hasValue( NULL, snapshot, NULL, "version", "1" ) ||
+        !hasValue( NULL, snapshot, "Section0", "added", "<none>" ) ||
+        !hasValue( NULL, snapshot, "Section19", "key99", "1999" ) ||
+        !hasValue( ini, NULL, "Section7", "key42", "changed" ))
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* a modified snapshot is a clone, the file does not see it */
+    IniConfigSnapshot_putString( snapshot, "Section5", "key5", "clone" );
+
+    if( !hasValue( NULL, snapshot, "Section5", "key5", "clone" ) ||
+        !hasValue( ini, NULL, "Section5", "key5", "505" ))
+    {
+        status = EXIT_FAILURE;
+    }
+
+    generation = IniConfigFile_getGeneration( ini, NULL, NULL );
+
+    if( !IniConfigFile_rollback( ini, snapshot ))
+    {
+        ANY_LOG( 0, "Rollback failed", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    if( !hasValue( ini, NULL, "Section7", "key42", "742" ) ||
+        !hasValue( ini, NULL, NULL, "version", "1" ) ||
+        !hasValue( ini, NULL, "Section0", "added", "<none>" ) ||
+        !hasValue( ini, NULL, "Section19", "key99", "1999" ) ||
+        !hasValue( ini, NULL, "Section5", "key5", "clone" ))
+    {
+        status = EXIT_FAILURE;
+    }
+
+    /* only the five differing keys have been written */
+    if( IniConfigFile_getGeneration( ini, NULL, NULL ) != generation + 5 ||
+        IniConfigFile_getGeneration( ini, "Section3", "key3" ) != untouched )
+    {
+        ANY_LOG( 0, "Rollback touched unchanged keys", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    /* the rolled back values reach the file */
+    if( !IniConfigFile_save( ini ) || !IniConfigFile_load( ini ) ||
+        !hasValue( ini, NULL, "Section5", "key5", "clone" ) ||
+        !hasValue( ini, NULL, "Section19", "key99", "1999" ) ||
+        !hasValue( ini, NULL, "Section0", "added", "<none>" ))
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigSnapshot_clear( snapshot );
+    IniConfigSnapshot_delete( snapshot );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
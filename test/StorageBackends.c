@@ -0,0 +1,285 @@
+/*
+ *  Test program loading and saving INI files through the storage backends
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME     "StorageBackends.ini"
+#define NUMSECTIONS  3000
+#define NUMBACKENDS  4
+
+
+/*
+ * Writes a file larger than a block of the stdio backend
+ */
+static char *makeContents( size_t *length )
+{
+    size_t size = NUMSECTIONS * 64 + 64;
+    char *contents = (char *)ANY_BALLOC( size );
+    size_t used = 0;
+    int i = 0;
+
+    if( contents == NULL )
+    {
+        return NULL;
+    }
+
+    used += Any_snprintf( contents, size, "; robot setup\nversion=3\n" );
+
+    for( i = 0; i < NUMSECTIONS; i++ )
+    {
+        used += Any_snprintf( contents + used, size - used, "[Joint%d]\nangle = %d ; degrees\n\n", i, i );
+    }
+
+    *length = used;
+
+    return contents;
+}
+
+
+static bool writeFile( const IniConfigBackend *backend, IniConfigMemoryBackend *memory, const char *contents,
+                       size_t length )
+{
+    FILE *fp = NULL;
+
+    if( !backend->onDisk )
+    {
+        return IniConfigMemoryBackend_putFile( memory, FILENAME, contents, length );
+    }
+
+    fp = fopen( FILENAME, "wb" );
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fwrite( contents, 1, length, fp );
+    fclose( fp );
+
+    return true;
+}
+
+
+/*
+ * Loads, edits and saves the file, then checks it with a second instance
+ */
+static bool check( const IniConfigBackend *backend, const char *contents, size_t length, char **saved,
+                   size_t *savedLength, IniConfigMemoryBackend *memory )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    IniConfigFile *other = IniConfigFile_new();
+    bool retVal = false;
+    bool opened = false;
+    bool loaded = false;
+
+    loaded = writeFile( backend, memory, contents, length ) && IniConfigFile_initWithBackend( ini, FILENAME, backend );
+
+    if( !loaded || !IniConfigFile_load( ini ) )
+    {
+        ANY_LOG( 0, "%s: unable to load", ANY_LOG_ERROR, backend->name );
+        goto out;
+    }
+
+    if( IniConfigFile_getLong( ini, NULL, "version", 0 ) != 3 ||
+        IniConfigFile_getLong( ini, "Joint2999", "angle", 0 ) != 2999 ||
+        IniConfigFile_countSections( ini ) != NUMSECTIONS )
+    {
+        ANY_LOG( 0, "%s: wrong values", ANY_LOG_ERROR, backend->name );
+        goto out;
+    }
+
+    IniConfigFile_putLong( ini, "Joint5", "angle", -5 );
+    IniConfigFile_putString( ini, "Added", "name", "left arm" );
+    IniConfigFile_setDurability( ini, INICONFIGATOMICFILE_DURABILITY_DATA );
+
+    if( !IniConfigFile_save( ini ) )
+    {
+        ANY_LOG( 0, "%s: unable to save", ANY_LOG_ERROR, backend->name );
+        goto out;
+    }
+
+    /* a file which was not changed is not written again */
+    opened = IniConfigFile_persist( ini ) && IniConfigFile_initWithBackend( other, FILENAME, backend );
+
+    if( !opened || !IniConfigFile_load( other ) ||
+        IniConfigFile_getLong( other, "Joint5", "angle", 0 ) != -5 ||
+        IniConfigFile_getLong( other, "Joint6", "angle", 0 ) != 6 ||
+        IniConfigFile_countSections( other ) != NUMSECTIONS + 1 )
+    {
+        ANY_LOG( 0, "%s: saved file reads wrong", ANY_LOG_ERROR, backend->name );
+        goto out;
+    }
+
+    if( backend->onDisk )
+    {
+        FILE *fp = fopen( FILENAME, "rb" );
+
+        *saved = NULL;
+
+        if( fp != NULL )
+        {
+            *saved = (char *)ANY_BALLOC( length + 64 );
+            *savedLength = fread( *saved, 1, length + 64, fp );
+            fclose( fp );
+        }
+    }
+    else
+    {
+        *saved = IniConfigMemoryBackend_getFile( memory, FILENAME, savedLength );
+    }
+
+    retVal = ( *saved != NULL );
+
+    out:
+
+    if( opened )
+    {
+        IniConfigFile_clear( other );
+    }
+
+    if( loaded )
+    {
+        IniConfigFile_clear( ini );
+    }
+
+    IniConfigFile_delete( ini );
+    IniConfigFile_delete( other );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    IniConfigMemoryBackend *memory = IniConfigMemoryBackend_new();
+    const IniConfigBackend *backends[NUMBACKENDS];
+    const IniConfigBackend *backend = NULL;
+    char *saved[NUMBACKENDS];
+    size_t savedLength[NUMBACKENDS];
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    const char *block = NULL;
+    char *contents = NULL;
+    char *text = NULL;
+    size_t length = 0;
+    void *file = NULL;
+    int status = EXIT_SUCCESS;
+    int i = 0;
+
+    contents = makeContents( &length );
+
+    if( contents == NULL || !IniConfigMemoryBackend_init( memory ) )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    backends[0] = IniConfigBackend_getPosix();
+    backends[1] = IniConfigBackend_getStdio();
+    backends[2] = IniConfigBackend_getMmap();
+    backends[3] = IniConfigMemoryBackend_getBackend( memory );
+
+    /* every backend reads the same values and saves the same bytes */
+    for( i = 0; i < NUMBACKENDS; i++ )
+    {
+        saved[i] = NULL;
+
+        if( !check( backends[i], contents, length, &saved[i], &savedLength[i], memory ) )
+        {
+            status = EXIT_FAILURE;
+        }
+        else if( i > 0 && ( savedLength[i] != savedLength[0] || memcmp( saved[i], saved[0], savedLength[0] ) != 0 ) )
+        {
+            ANY_LOG( 0, "%s saved other contents than %s", ANY_LOG_ERROR, backends[i]->name, backends[0]->name );
+            status = EXIT_FAILURE;
+        }
+
+        remove( FILENAME );
+    }
+
+    for( i = 0; i < NUMBACKENDS; i++ )
+    {
+        ANY_FREE( saved[i] );
+    }
+
+    /* an open memory file keeps its contents when it is replaced */
+    backend = backends[3];
+    IniConfigMemoryBackend_putFile( memory, FILENAME, "[A]\nx=1\n", 8 );
+    file = backend->open( backend->context, FILENAME );
+    IniConfigMemoryBackend_putFile( memory, FILENAME, "[B]\n", 4 );
+
+    if( file == NULL || backend->readBlock( backend->context, file, &block ) != 8 ||
+        memcmp( block, "[A]\nx=1\n", 8 ) != 0 || backend->readBlock( backend->context, file, &block ) != 0 )
+    {
+        ANY_LOG( 0, "Replaced memory file changed under its reader", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( file != NULL )
+    {
+        backend->close( backend->context, file );
+    }
+
+    /* memory files are loaded by the init, a missing one is empty */
+    ini = IniConfigFile_new();
+
+    if( !IniConfigFile_initWithBackend( ini, FILENAME, backend ) || IniConfigFile_countSections( ini ) != 1 )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigMemoryBackend_removeFile( memory, FILENAME );
+
+    if( !IniConfigFile_initWithBackend( ini, FILENAME, backend ) || IniConfigFile_countSections( ini ) != 0 ||
+        IniConfigFile_getLong( ini, "A", "x", -1 ) != -1 )
+    {
+        ANY_LOG( 0, "A missing memory file is not empty", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_putLong( ini, "A", "x", 2 );
+
+    if( IniConfigFile_save( ini ) )
+    {
+        text = IniConfigMemoryBackend_getFile( memory, FILENAME, &length );
+    }
+
+    if( text == NULL || strcmp( text, "[A]\nx=2\n" ) != 0 )
+    {
+        ANY_LOG( 0, "Save of a new memory file went wrong", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    ANY_FREE( text );
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    ANY_FREE( contents );
+
+    IniConfigMemoryBackend_clear( memory );
+    IniConfigMemoryBackend_delete( memory );
+
+    return( status );
+}
+
+
+/* EOF */
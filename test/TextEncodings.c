@@ -0,0 +1,274 @@
+/*
+ *  Test program checking byte order marks, UTF-16 files and UTF-8 validation
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "TextEncodings.ini"
+#define CONTENTS    "[Names]\r\ncity=K\xc3\xb6ln\r\nprice=5\xe2\x82\xac\r\nmood=\xf0\x9f\x98\x80\r\n"
+
+
+static bool writeBytes( const char *bytes, size_t length )
+{
+    FILE *fp = fopen( FILENAME, "wb" );
+    bool retVal = false;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    retVal = ( fwrite( bytes, 1, length, fp ) == length );
+    fclose( fp );
+
+    return retVal;
+}
+
+
+static size_t readBytes( char *bytes, size_t size )
+{
+    FILE *fp = fopen( FILENAME, "rb" );
+    size_t length = 0;
+
+    if( fp == NULL )
+    {
+        return 0;
+    }
+
+    length = fread( bytes, 1, size, fp );
+    fclose( fp );
+
+    return length;
+}
+
+
+/*
+ * Encodes CONTENTS as UTF-16
+ */
+static size_t toUtf16( const char *bom, bool bigEndian, char *bytes )
+{
+    static const unsigned int codePoints[] =
+    {
+        '[', 'N', 'a', 'm', 'e', 's', ']', '\r', '\n',
+        'c', 'i', 't', 'y', '=', 'K', 0xf6, 'l', 'n', '\r', '\n',
+        'p', 'r', 'i', 'c', 'e', '=', '5', 0x20ac, '\r', '\n',
+        'm', 'o', 'o', 'd', '=', 0xd83d, 0xde00, '\r', '\n'
+    };
+    size_t length = strlen( bom );
+    unsigned int i = 0;
+
+    memcpy( bytes, bom, length );
+
+    for( i = 0; i < sizeof( codePoints ) / sizeof( codePoints[0] ); i++ )
+    {
+        bytes[length + ( bigEndian ? 1 : 0 )] = (char)( codePoints[i] & 0xff );
+        bytes[length + ( bigEndian ? 0 : 1 )] = (char)( codePoints[i] >> 8 );
+        length += 2;
+    }
+
+    return length;
+}
+
+
+static bool checkValues( const IniConfigFile *ini, const char *mode )
+{
+    char value[32];
+
+    IniConfigFile_getString( ini, "Names", "city", "", value, sizeof( value ) );
+
+    if( strcmp( value, "K\xc3\xb6ln" ) != 0 )
+    {
+        ANY_LOG( 0, "%s: city is '%s'", ANY_LOG_ERROR, mode, value );
+        return false;
+    }
+
+    IniConfigFile_getString( ini, "Names", "price", "", value, sizeof( value ) );
+
+    if( strcmp( value, "5\xe2\x82\xac" ) != 0 )
+    {
+        ANY_LOG( 0, "%s: price is '%s'", ANY_LOG_ERROR, mode, value );
+        return false;
+    }
+
+    IniConfigFile_getString( ini, "Names", "mood", "", value, sizeof( value ) );
+
+    if( strcmp( value, "\xf0\x9f\x98\x80" ) != 0 )
+    {
+        ANY_LOG( 0, "%s: mood is '%s'", ANY_LOG_ERROR, mode, value );
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool checkTranscoding( IniConfigFile *ini )
+{
+    static const char bomContents[] = "\xef\xbb\xbf" CONTENTS;
+    char bytes[256];
+    char saved[256];
+    size_t length = 0;
+    int i = 0;
+
+    /* the byte order mark is kept on save, nothing else changes */
+    if( !writeBytes( bomContents, sizeof( bomContents ) - 1 ) || !IniConfigFile_load( ini ) ||
+        !checkValues( ini, "UTF-8 with BOM" ) || !IniConfigFile_putString( ini, "Names", "city", "Bonn" ) ||
+        !IniConfigFile_putString( ini, "Names", "city", "K\xc3\xb6ln" ) || !IniConfigFile_save( ini ) ||
+        readBytes( saved, sizeof( saved ) ) != sizeof( bomContents ) - 1 ||
+        memcmp( saved, bomContents, sizeof( bomContents ) - 1 ) != 0 )
+    {
+        ANY_LOG( 0, "UTF-8 file with BOM not kept", ANY_LOG_ERROR );
+        return false;
+    }
+
+    for( i = 0; i < 3; i++ )
+    {
+        const char *modes[] = { "UTF-16LE", "UTF-16BE", "UTF-16LE without BOM" };
+
+        length = toUtf16( ( i == 0 ) ? "\xff\xfe" : ( i == 1 ) ? "\xfe\xff" : "", i == 1, bytes );
+
+        if( !writeBytes( bytes, length ) || !IniConfigFile_load( ini ) || !checkValues( ini, modes[i] ) )
+        {
+            return false;
+        }
+
+        /* saved as UTF-8, with a BOM if the file had one */
+        IniConfigFile_putString( ini, "Names", "city", "Bonn" );
+        IniConfigFile_putString( ini, "Names", "city", "K\xc3\xb6ln" );
+
+        length = ( i < 2 ) ? sizeof( bomContents ) - 1 : sizeof( CONTENTS ) - 1;
+
+        if( !IniConfigFile_save( ini ) || readBytes( saved, sizeof( saved ) ) != length ||
+            memcmp( saved, ( i < 2 ) ? bomContents : CONTENTS, length ) != 0 )
+        {
+            ANY_LOG( 0, "%s not saved as UTF-8", ANY_LOG_ERROR, modes[i] );
+            return false;
+        }
+    }
+
+    /* an unpaired surrogate in line 3 */
+    length = toUtf16( "\xff\xfe", false, bytes );
+    bytes[2 + 2 * 36] = 'x';
+    bytes[2 + 2 * 36 + 1] = 0;
+
+    if( !writeBytes( bytes, length ) || IniConfigFile_load( ini ) || IniConfigFile_getInvalidLine( ini ) != 4 )
+    {
+        ANY_LOG( 0, "Unpaired surrogate not found in line 4", ANY_LOG_ERROR );
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Moves an invalid byte through several 16 byte blocks
+ */
+static bool checkValidation( IniConfigFile *ini )
+{
+    static const char *invalid[] =
+    {
+        "\x80", "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xf8\x88\x80\x80\x80",
+        "\xc3", "\xe2\x82", "\xf0\x9f\x98"
+    };
+    char bytes[512];
+    unsigned int i = 0;
+    int line = 0;
+
+    for( i = 0; i < sizeof( invalid ) / sizeof( invalid[0] ); i++ )
+    {
+        for( line = 1; line <= 12; line++ )
+        {
+            size_t length = 0;
+            int j = 0;
+
+            for( j = 1; j <= 12; j++ )
+            {
+                length += Any_snprintf( bytes + length, sizeof( bytes ) - length, "k%d=%s\n", j,
+                                        ( j == line ) ? invalid[i] : "\xc3\xa4\xe2\x82\xac" );
+            }
+
+            /* the last line also checks sequences cut off at the end of the file */
+            if( line == 12 )
+            {
+                length--;
+            }
+
+            if( !writeBytes( bytes, length ) || IniConfigFile_load( ini ) ||
+                IniConfigFile_getInvalidLine( ini ) != line )
+            {
+                ANY_LOG( 0, "Invalid sequence %u not found in line %d", ANY_LOG_ERROR, i, line );
+                return false;
+            }
+        }
+    }
+
+    if( !writeBytes( CONTENTS, sizeof( CONTENTS ) - 1 ) || !IniConfigFile_load( ini ) ||
+        IniConfigFile_getInvalidLine( ini ) != 0 || !checkValues( ini, "valid" ) )
+    {
+        ANY_LOG( 0, "Valid file refused", ANY_LOG_ERROR );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    int status = EXIT_SUCCESS;
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    /* without flags the bytes are taken as they are */
+    if( !writeBytes( "\xef\xbb\xbf" "a=1\n\xff=2\n", 11 ) || !IniConfigFile_load( ini ) ||
+        IniConfigFile_getInt( ini, NULL, "a", 0 ) != 0 )
+    {
+        ANY_LOG( 0, "Loading without text flags changed", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_setTextFlags( ini, INICONFIGTEXT_TRANSCODE );
+
+    if( !checkTranscoding( ini ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_setTextFlags( ini, INICONFIGTEXT_VALIDATE );
+
+    if( !checkValidation( ini ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -0,0 +1,219 @@
+/*
+ *  Test program checking the getters for durations, byte sizes and frequencies
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+
+
+#define FILENAME    "UnitGetters.ini"
+#define MISSING     -1LL
+
+
+typedef struct Expectation
+{
+    const char *key;
+    const char *value;
+    int kind;
+    double expected;
+}
+Expectation;
+
+
+static const Expectation expectations[] =
+{
+    { "t_ns", "15ns", INICONFIGUNITS_DURATION, 15.0 },
+    { "t_us", "20us", INICONFIGUNITS_DURATION, 20e3 },
+    { "t_micro", "20\xc2\xb5s", INICONFIGUNITS_DURATION, 20e3 },
+    { "t_ms", "250ms", INICONFIGUNITS_DURATION, 250e6 },
+    { "t_s", " 1.5 s ", INICONFIGUNITS_DURATION, 1.5e9 },
+    { "t_sec", "2sec", INICONFIGUNITS_DURATION, 2e9 },
+    { "t_min", "-1min", INICONFIGUNITS_DURATION, -60e9 },
+    { "t_h", "2h", INICONFIGUNITS_DURATION, 7200e9 },
+    { "t_d", "1d", INICONFIGUNITS_DURATION, 86400e9 },
+    { "t_plain", "3", INICONFIGUNITS_DURATION, 3e9 },           /* seconds */
+    { "b_B", "512B", INICONFIGUNITS_BYTESIZE, 512.0 },
+    { "b_kB", "2kB", INICONFIGUNITS_BYTESIZE, 2000.0 },
+    { "b_KB", "2KB", INICONFIGUNITS_BYTESIZE, 2000.0 },
+    { "b_MB", "3 MB", INICONFIGUNITS_BYTESIZE, 3e6 },
+    { "b_GB", "4GB", INICONFIGUNITS_BYTESIZE, 4e9 },
+    { "b_TB", "1TB", INICONFIGUNITS_BYTESIZE, 1e12 },
+    { "b_KiB", "64 KiB", INICONFIGUNITS_BYTESIZE, 65536.0 },
+    { "b_MiB", "1.5MiB", INICONFIGUNITS_BYTESIZE, 1572864.0 },
+    { "b_GiB", "2GiB", INICONFIGUNITS_BYTESIZE, 2147483648.0 },
+    { "b_TiB", "1TiB", INICONFIGUNITS_BYTESIZE, 1099511627776.0 },
+    { "b_K", "4K", INICONFIGUNITS_BYTESIZE, 4000.0 },           /* SI like KB */
+    { "b_k", "4k", INICONFIGUNITS_BYTESIZE, 4000.0 },
+    { "b_M", "1M", INICONFIGUNITS_BYTESIZE, 1e6 },
+    { "b_G", "1G", INICONFIGUNITS_BYTESIZE, 1e9 },
+    { "b_T", "1T", INICONFIGUNITS_BYTESIZE, 1e12 },
+    { "b_Ki", "4Ki", INICONFIGUNITS_BYTESIZE, 4096.0 },         /* IEC like KiB */
+    { "b_Mi", "1Mi", INICONFIGUNITS_BYTESIZE, 1048576.0 },
+    { "b_Gi", "1Gi", INICONFIGUNITS_BYTESIZE, 1073741824.0 },
+    { "b_Ti", "1Ti", INICONFIGUNITS_BYTESIZE, 1099511627776.0 },
+    { "b_exp", "1.5e3B", INICONFIGUNITS_BYTESIZE, 1500.0 },
+    { "b_plain", "100", INICONFIGUNITS_BYTESIZE, 100.0 },       /* bytes */
+    { "f_Hz", "50Hz", INICONFIGUNITS_FREQUENCY, 50.0 },
+    { "f_kHz", "1.5 kHz", INICONFIGUNITS_FREQUENCY, 1500.0 },
+    { "f_MHz", "8MHz", INICONFIGUNITS_FREQUENCY, 8e6 },
+    { "f_GHz", "2.4GHz", INICONFIGUNITS_FREQUENCY, 2.4e9 },
+    { "f_plain", "1000", INICONFIGUNITS_FREQUENCY, 1000.0 },    /* hertz */
+    { "w_kind", "250ms", INICONFIGUNITS_BYTESIZE, MISSING },     /* wrong kind */
+    { "w_case", "10mS", INICONFIGUNITS_DURATION, MISSING },      /* suffixes are case-sensitive */
+    { "w_unit", "10 parsecs", INICONFIGUNITS_DURATION, MISSING },
+    { "w_text", "fast", INICONFIGUNITS_FREQUENCY, MISSING },
+    { "w_nan", "nan", INICONFIGUNITS_FREQUENCY, MISSING },
+    { "w_inf", "-inf s", INICONFIGUNITS_DURATION, MISSING },
+    { "w_hex", "0x10", INICONFIGUNITS_BYTESIZE, MISSING },       /* decimal numbers only */
+    { "w_hexunit", "0x1p3 KiB", INICONFIGUNITS_BYTESIZE, MISSING },
+    { "w_overflow", "1e400Hz", INICONFIGUNITS_FREQUENCY, MISSING },
+    { "w_empty", "", INICONFIGUNITS_DURATION, MISSING },
+    { "w_huge", "1e30s", INICONFIGUNITS_DURATION, MISSING },     /* does not fit */
+    { "missing", NULL, INICONFIGUNITS_DURATION, MISSING }
+};
+
+#define NUMEXPECTATIONS  ( sizeof( expectations ) / sizeof( expectations[0] ) )
+
+
+static bool writeFile( void )
+{
+    FILE *fp = fopen( FILENAME, "w" );
+    unsigned int i = 0;
+
+    if( fp == NULL )
+    {
+        return false;
+    }
+
+    fprintf( fp, "[Units]\n" );
+
+    for( i = 0; i < NUMEXPECTATIONS; i++ )
+    {
+        if( expectations[i].value != NULL )
+        {
+            fprintf( fp, "%s=%s\n", expectations[i].key, expectations[i].value );
+        }
+    }
+
+    fclose( fp );
+
+    return true;
+}
+
+
+static double get( const IniConfigFile *ini, const char *key, int kind )
+{
+    switch( kind )
+    {
+        case INICONFIGUNITS_DURATION:
+            return (double)IniConfigFile_getDuration( ini, "Units", key, MISSING );
+
+        case INICONFIGUNITS_BYTESIZE:
+            return (double)IniConfigFile_getByteSize( ini, "Units", key, MISSING );
+
+        default:
+            return IniConfigFile_getFrequency( ini, "Units", key, (double)MISSING );
+    }
+}
+
+
+static bool check( const IniConfigFile *ini, const char *mode )
+{
+    unsigned int i = 0;
+    int round = 0;
+
+    /* the second round is answered from the cached values */
+    for( round = 0; round < 2; round++ )
+    {
+        for( i = 0; i < NUMEXPECTATIONS; i++ )
+        {
+            const Expectation *expected = &expectations[i];
+            double value = get( ini, expected->key, expected->kind );
+
+            if( value != expected->expected )
+            {
+                ANY_LOG( 0, "%s: %s is %f, %f expected", ANY_LOG_ERROR, mode, expected->key, value,
+                         expected->expected );
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    IniConfigFile *ini = (IniConfigFile*)NULL;
+    int status = EXIT_SUCCESS;
+
+    if( !writeFile() )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    ini = IniConfigFile_new();
+    IniConfigFile_init( ini, FILENAME );
+
+    if( !check( ini, "unloaded" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !check( ini, "loaded" ) )
+    {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* a put replaces the cached value */
+    IniConfigFile_putString( ini, "Units", "t_ms", "10s" );
+    IniConfigFile_putString( ini, "Units", "f_Hz", "fast" );
+
+    if( IniConfigFile_getDuration( ini, "Units", "t_ms", 0 ) != 10000000000LL ||
+        IniConfigFile_getFrequency( ini, "Units", "f_Hz", 1.0 ) != 1.0 )
+    {
+        ANY_LOG( 0, "Cached values survived a put", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_freeze( ini ) || !check( ini, "frozen" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    if( !IniConfigFile_load( ini ) || !IniConfigFile_setDoubleBuffering( ini, true, INICONFIGINDEX_NONE ) ||
+        !check( ini, "double buffered" ) )
+    {
+        status = EXIT_FAILURE;
+    }
+
+    out:
+
+    IniConfigFile_clear( ini );
+    IniConfigFile_delete( ini );
+
+    remove( FILENAME );
+
+    return( status );
+}
+
+
+/* EOF */
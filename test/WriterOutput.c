@@ -0,0 +1,273 @@
+/*
+ *  Test program reading back what an IniConfigWriter wrote
+ *
+ *  Copyright (C)
+ *  Honda Research Institute Europe GmbH
+ *  Carl-Legien-Str. 30
+ *  63073 Offenbach/Main
+ *  Germany
+ *
+ *  UNPUBLISHED PROPRIETARY MATERIAL.
+ *  ALL RIGHTS RESERVED.
+ *
+ */
+
+
+#include <fcntl.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Any.h>
+
+#include <IniConfigFile.h>
+#include <IniConfigWriter.h>
+
+
+#define FILENAME     "WriterOutput.ini"
+#define SMALLBUFFER  16
+#define LARGESIZE    3000
+#define HUGESIZE     20000
+
+
+/* doubles %.15g does not read back exactly */
+static const double doubles[] =
+{
+    0.1 + 0.2, 1.0 / 3.0, DBL_MIN, DBL_MAX, -DBL_EPSILON, 123456.78901234567, 5e-324, 1e15, -2.5
+};
+
+static const char *strings[][2] =
+{
+    { "plain",    "left arm" },
+    { "quote",    "say \"hi\"" },
+    { "quotes",   "\"\"" },
+    { "semi",     "a ; b" },
+    { "hash",     "# not a comment" },
+    { "trailing", "space " },
+    { "empty",    "" }
+};
+
+
+static void fill( char *value, size_t length )
+{
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        value[i] = (char)( 'a' + i % 26 );
+    }
+
+    value[length] = '\0';
+}
+
+
+/*
+ * Writes every kind of value, a buffer size of 0 selects the default
+ */
+static bool writeAll( IniConfigWriter *writer, const char *large, const char *huge )
+{
+    char key[32];
+    bool retVal = true;
+    size_t i = 0;
+
+    retVal = retVal && IniConfigWriter_putSection( writer, "Numbers" );
+    retVal = retVal && IniConfigWriter_putLong( writer, "min", LONG_MIN );
+    retVal = retVal && IniConfigWriter_putLong( writer, "max", LONG_MAX );
+    retVal = retVal && IniConfigWriter_putLong( writer, "zero", 0 );
+    retVal = retVal && IniConfigWriter_putInt( writer, "int", INT_MIN );
+    retVal = retVal && IniConfigWriter_putDouble( writer, "negativeZero", -0.0 );
+    retVal = retVal && IniConfigWriter_putDouble( writer, "nan", NAN );
+
+    for( i = 0; i < sizeof( doubles ) / sizeof( doubles[0] ); i++ )
+    {
+        Any_snprintf( key, sizeof( key ), "double%d", (int)i );
+        retVal = retVal && IniConfigWriter_putDouble( writer, key, doubles[i] );
+    }
+
+    retVal = retVal && IniConfigWriter_putSection( writer, "Strings" );
+
+    for( i = 0; i < sizeof( strings ) / sizeof( strings[0] ); i++ )
+    {
+        retVal = retVal && IniConfigWriter_putString( writer, strings[i][0], strings[i][1] );
+    }
+
+    /* larger than half the buffer, written without a copy */
+    retVal = retVal && IniConfigWriter_putString( writer, "large", large );
+    retVal = retVal && IniConfigWriter_putString( writer, "huge", huge );
+    retVal = retVal && IniConfigWriter_putString( writer, "after", "end" );
+
+    return retVal;
+}
+
+
+static bool checkAll( const char *description, const char *large, const char *huge )
+{
+    IniConfigFile *ini = IniConfigFile_new();
+    char *value = (char *)ANY_BALLOC( HUGESIZE + 1 );
+    double number = 0.0;
+    bool retVal = false;
+    size_t i = 0;
+
+    if( ini == NULL || value == NULL || !IniConfigFile_init( ini, FILENAME ) )
+    {
+        goto out;
+    }
+
+    if( !IniConfigFile_load( ini ) )
+    {
+        IniConfigFile_clear( ini );
+        goto out;
+    }
+
+    retVal = true;
+
+    if( IniConfigFile_getLong( ini, "Numbers", "min", 0 ) != LONG_MIN ||
+        IniConfigFile_getLong( ini, "Numbers", "max", 0 ) != LONG_MAX ||
+        IniConfigFile_getLong( ini, "Numbers", "zero", 1 ) != 0 ||
+        IniConfigFile_getInt( ini, "Numbers", "int", 0 ) != INT_MIN )
+    {
+        ANY_LOG( 0, "%s: integers read back wrong", ANY_LOG_ERROR, description );
+        retVal = false;
+    }
+
+    number = IniConfigFile_getDouble( ini, "Numbers", "negativeZero", 1.0 );
+
+    if( number != 0.0 || !signbit( number ) || !isnan( IniConfigFile_getDouble( ini, "Numbers", "nan", 0.0 ) ) )
+    {
+        ANY_LOG( 0, "%s: -0.0 or NaN read back wrong", ANY_LOG_ERROR, description );
+        retVal = false;
+    }
+
+    for( i = 0; i < sizeof( doubles ) / sizeof( doubles[0] ); i++ )
+    {
+        char key[32];
+
+        Any_snprintf( key, sizeof( key ), "double%d", (int)i );
+
+        if( IniConfigFile_getDouble( ini, "Numbers", key, 0.0 ) != doubles[i] )
+        {
+            ANY_LOG( 0, "%s: %s is not %.17g", ANY_LOG_ERROR, description, key, doubles[i] );
+            retVal = false;
+        }
+    }
+
+    for( i = 0; i < sizeof( strings ) / sizeof( strings[0] ); i++ )
+    {
+        IniConfigFile_getString( ini, "Strings", strings[i][0], "missing", value, HUGESIZE + 1 );
+
+        if( strcmp( value, strings[i][1] ) != 0 )
+        {
+            ANY_LOG( 0, "%s: %s is '%s', not '%s'", ANY_LOG_ERROR, description, strings[i][0], value,
+                     strings[i][1] );
+            retVal = false;
+        }
+    }
+
+    if( IniConfigFile_getString( ini, "Strings", "large", "", value, HUGESIZE + 1 ) != LARGESIZE ||
+        strcmp( value, large ) != 0 ||
+        IniConfigFile_getString( ini, "Strings", "huge", "", value, HUGESIZE + 1 ) != HUGESIZE ||
+        strcmp( value, huge ) != 0 ||
+        IniConfigFile_getString( ini, "Strings", "after", "", value, HUGESIZE + 1 ) != 3 )
+    {
+        ANY_LOG( 0, "%s: large values read back wrong", ANY_LOG_ERROR, description );
+        retVal = false;
+    }
+
+    IniConfigFile_clear( ini );
+
+    out:
+
+    IniConfigFile_delete( ini );
+    ANY_FREE( value );
+
+    return retVal;
+}
+
+
+int main( void )
+{
+    static const size_t bufferSizes[] = { 0, SMALLBUFFER, 4096, 8192 };
+    IniConfigWriter *writer = IniConfigWriter_new();
+    char description[32];
+    char *large = (char *)ANY_BALLOC( LARGESIZE + 1 );
+    char *huge = (char *)ANY_BALLOC( HUGESIZE + 1 );
+    int status = EXIT_SUCCESS;
+    size_t i = 0;
+    int fd = -1;
+
+    if( writer == NULL || large == NULL || huge == NULL )
+    {
+        return( EXIT_FAILURE );
+    }
+
+    fill( large, LARGESIZE );
+    fill( huge, HUGESIZE );
+
+    /* the smallest buffers are raised to a page, values take every path of the output */
+    for( i = 0; i < sizeof( bufferSizes ) / sizeof( bufferSizes[0] ); i++ )
+    {
+        Any_snprintf( description, sizeof( description ), "buffer %d", (int)bufferSizes[i] );
+
+        if( !IniConfigWriter_init( writer, FILENAME, bufferSizes[i] ) )
+        {
+            ANY_LOG( 0, "%s: unable to create the writer", ANY_LOG_ERROR, description );
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        if( !writeAll( writer, large, huge ) || !IniConfigWriter_close( writer ) )
+        {
+            ANY_LOG( 0, "%s: unable to write", ANY_LOG_ERROR, description );
+            status = EXIT_FAILURE;
+        }
+        else if( !checkAll( description, large, huge ) )
+        {
+            status = EXIT_FAILURE;
+        }
+
+        IniConfigWriter_clear( writer );
+        remove( FILENAME );
+    }
+
+    /* a caller descriptor stays open and is written to the same way */
+    fd = open( FILENAME, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+
+    if( fd == -1 || !IniConfigWriter_initFd( writer, fd, SMALLBUFFER ) )
+    {
+        ANY_LOG( 0, "Unable to write to a descriptor", ANY_LOG_ERROR );
+        status = EXIT_FAILURE;
+    }
+    else
+    {
+        if( !writeAll( writer, large, huge ) || !IniConfigWriter_close( writer ) ||
+            write( fd, "[Tail]\nx=1\n", 11 ) != 11 )
+        {
+            ANY_LOG( 0, "Writing to a descriptor failed", ANY_LOG_ERROR );
+            status = EXIT_FAILURE;
+        }
+
+        IniConfigWriter_clear( writer );
+        close( fd );
+
+        if( !checkAll( "descriptor", large, huge ) )
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    remove( FILENAME );
+
+    IniConfigWriter_delete( writer );
+
+    ANY_FREE( large );
+    ANY_FREE( huge );
+
+    return( status );
+}
+
+
+/* EOF */
@@ -41,6 +41,31 @@ export LD_LIBRARY_PATH=${CWD}/lib/${MAKEFILE_PLATFORM}:${LD_LIBRARY_PATH}
 
 
 cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/ReadFile
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/EditDocument
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/WriterOutput
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/AtomicCommit
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/LockedWriters
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/ConditionalPuts
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/Snapshots
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/PersistChanges
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/RealtimeReads
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/DoubleBuffer
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/ForkSharing
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/NumaReplicas
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/FrozenReloads
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/BatchLookup
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/SectionView
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/NumericColumns
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/SectionInheritance
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/UnitGetters
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/BlobValues
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/TextEncodings
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/CountsAndIndexes
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/MemorySources
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/SharedFiles
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/StorageBackends
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/ParserConformance
+cd ${CWD}/test && runTest ./${MAKEFILE_PLATFORM}/ParseComplexity
 
 
 # EOF